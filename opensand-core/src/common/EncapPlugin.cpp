@@ -67,6 +67,18 @@ void EncapPlugin::EncapContext::setFilterTalId(uint8_t tal_id)
 	this->dst_tal_id = tal_id;
 }
 
+double EncapPlugin::EncapContext::getFillRatio(int UNUSED(context_id)) const
+{
+	return 0.0;
+}
+
+int EncapPlugin::EncapContext::getContextId(tal_id_t UNUSED(src_tal_id),
+                                            tal_id_t UNUSED(dst_tal_id),
+                                            qos_t UNUSED(qos)) const
+{
+	return -1;
+}
+
 bool EncapPlugin::EncapContext::init()
 {
 	this->log = Output::Get()->registerLog(LEVEL_WARNING,
@@ -118,6 +130,12 @@ bool EncapPlugin::EncapPacketHandler::encapNextPacket(std::unique_ptr<NetPacket>
 }
 
 
+bool EncapPlugin::EncapPacketHandler::isEncapReentrant() const
+{
+	return true;
+}
+
+
 bool EncapPlugin::EncapPacketHandler::getEncapsulatedPackets(std::unique_ptr<NetContainer> packet,
                                                              bool &partial_decap,
                                                              std::vector<std::unique_ptr<NetPacket>> &decap_packets,
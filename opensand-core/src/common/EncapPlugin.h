@@ -112,6 +112,18 @@ public:
 		                     std::unique_ptr<NetPacket> &encap_packet,
 		                     std::unique_ptr<NetPacket> &remaining_data) override;
 
+		/**
+		 * @brief Whether encapNextPacket can be called concurrently from
+		 *        several threads on packets of different destinations
+		 *
+		 * The default encapsulation only relies on getChunk which does not
+		 * modify the handler; handlers keeping encapsulation contexts
+		 * should return false.
+		 *
+		 * @return true if encapNextPacket is reentrant, false otherwise
+		 */
+		virtual bool isEncapReentrant() const;
+
 		/**
 		 * @brief Get encapsulated packet from payload
 		 *
@@ -208,6 +220,30 @@ public:
 		 */
 		virtual NetBurst *flushAll() = 0;
 
+		/**
+		 * @brief Get how much of the encapsulation context identified by
+		 *        context_id is filled with data waiting to be flushed
+		 *
+		 * @param context_id  the context to check
+		 * @return            the fill ratio between 0 and 1,
+		 *                    0 if the context does not buffer data
+		 */
+		virtual double getFillRatio(int context_id) const;
+
+		/**
+		 * @brief Get the ID of the encapsulation context holding the
+		 *        packets of a flow
+		 *
+		 * @param src_tal_id  the source terminal of the flow
+		 * @param dst_tal_id  the destination terminal of the flow
+		 * @param qos         the QoS of the flow
+		 * @return            the context ID,
+		 *                    -1 if the context does not buffer data
+		 */
+		virtual int getContextId(tal_id_t src_tal_id,
+		                         tal_id_t dst_tal_id,
+		                         qos_t qos) const;
+
 		/**
 		 * @brief Set the filter on destination TAL Id.
 		 *
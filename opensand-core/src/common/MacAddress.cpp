@@ -114,3 +114,38 @@ bool MacAddress::matches(const MacAddress *addr) const
 	}
 	return true;
 }
+
+
+bool MacAddress::isGeneric() const
+{
+	for(std::size_t i = 0; i < MacAddress::bytes_count; ++i)
+	{
+		if(this->generic_bytes[i])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+uint64_t MacAddress::getKey() const
+{
+	uint64_t key = 0;
+	for(std::size_t i = 0; i < MacAddress::bytes_count; ++i)
+	{
+		key = (key << 8) | (this->generic_bytes[i] ? 0 : this->mac[i]);
+	}
+	return key;
+}
+
+
+uint64_t MacAddress::getMatchMask() const
+{
+	uint64_t mask = 0;
+	for(std::size_t i = 0; i < MacAddress::bytes_count; ++i)
+	{
+		mask = (mask << 8) | (this->generic_bytes[i] ? 0x00 : 0xff);
+	}
+	return mask;
+}
@@ -108,6 +108,29 @@ public:
 	 * @return true if MAC addresses matches, false otherwise
 	 */
 	bool matches(const MacAddress *addr) const;
+
+	/**
+	 * @brief Check whether some bytes of the MAC address match any value
+	 *
+	 * @return true if the address contains generic bytes, false otherwise
+	 */
+	bool isGeneric() const;
+
+	/**
+	 * @brief Get the MAC address as a 48-bits integer,
+	 *        generic bytes are set to 0
+	 *
+	 * @return the integer value of the MAC address
+	 */
+	uint64_t getKey() const;
+
+	/**
+	 * @brief Get the mask of the bits compared when matching
+	 *        an address given as a 48-bits integer
+	 *
+	 * @return the mask with generic bytes cleared
+	 */
+	uint64_t getMatchMask() const;
 };
 
 
@@ -40,7 +40,9 @@ NetPacket::NetPacket(const unsigned char *data, std::size_t length):
 		type{NET_PROTO::ERROR},
 		qos{},
 		src_tal_id{},
-		dst_tal_id{}
+		dst_tal_id{},
+		eth_header{},
+		eth_header_parsed{false}
 {
 	this->name = "NetPacket";
 }
@@ -51,7 +53,9 @@ NetPacket::NetPacket(const Data &data):
 		type{NET_PROTO::ERROR},
 		qos{},
 		src_tal_id{},
-		dst_tal_id{}
+		dst_tal_id{},
+		eth_header{},
+		eth_header_parsed{false}
 {
 	this->name = "NetPacket";
 }
@@ -62,7 +66,9 @@ NetPacket::NetPacket(const Data &data, std::size_t length):
 		type{NET_PROTO::ERROR},
 		qos{},
 		src_tal_id{},
-		dst_tal_id{}
+		dst_tal_id{},
+		eth_header{},
+		eth_header_parsed{false}
 {
 	this->name = "NetPacket";
 }
@@ -73,7 +79,9 @@ NetPacket::NetPacket(const NetPacket &pkt):
 		type{pkt.getType()},
 		qos{pkt.getQos()},
 		src_tal_id{pkt.getSrcTalId()},
-		dst_tal_id{pkt.getDstTalId()}
+		dst_tal_id{pkt.getDstTalId()},
+		eth_header{pkt.eth_header},
+		eth_header_parsed{pkt.eth_header_parsed}
 {
 	this->name = pkt.getName();
 	this->spot = pkt.getSpot();
@@ -85,7 +93,9 @@ NetPacket::NetPacket():
 		type{NET_PROTO::ERROR},
 		qos{},
 		src_tal_id{},
-		dst_tal_id{}
+		dst_tal_id{},
+		eth_header{},
+		eth_header_parsed{false}
 {
 	this->name = "NetPacket";
 }
@@ -103,7 +113,30 @@ NetPacket::NetPacket(const Data &data,
 	type{type},
 	qos{qos},
 	src_tal_id{src_tal_id},
-	dst_tal_id{dst_tal_id}
+	dst_tal_id{dst_tal_id},
+	eth_header{},
+	eth_header_parsed{false}
+{
+	this->name = name;
+	this->header_length = header_length;
+}
+
+
+NetPacket::NetPacket(const unsigned char *data,
+                     std::size_t length,
+                     std::string name,
+                     NET_PROTO type,
+                     uint8_t qos,
+                     uint8_t src_tal_id,
+                     uint8_t dst_tal_id,
+                     std::size_t header_length):
+	NetContainer{data, length},
+	type{type},
+	qos{qos},
+	src_tal_id{src_tal_id},
+	dst_tal_id{dst_tal_id},
+	eth_header{},
+	eth_header_parsed{false}
 {
 	this->name = name;
 	this->header_length = header_length;
@@ -155,3 +188,16 @@ uint8_t NetPacket::getDstTalId() const
 {
 	return this->dst_tal_id;
 }
+
+
+void NetPacket::setEthHeader(const eth_header_desc_t &header)
+{
+	this->eth_header = header;
+	this->eth_header_parsed = true;
+}
+
+
+const eth_header_desc_t *NetPacket::getEthHeader() const
+{
+	return this->eth_header_parsed ? &this->eth_header : nullptr;
+}
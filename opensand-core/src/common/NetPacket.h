@@ -115,6 +115,31 @@ enum class NET_PROTO : uint16_t
 #define MAX_ETHERNET_SIZE ETHERNET_802_1AD_SIZE
 
 
+/**
+ * @brief The Ethernet header fields, parsed once per frame and cached
+ *        on the packet so they are not read again by each processing step
+ */
+struct eth_header_desc_t
+{
+	/// The type of frame: Ethernet II, 802.1Q or 802.1ad, ERROR if invalid
+	NET_PROTO frame_type;
+	/// The EtherType of the payload
+	NET_PROTO ether_type;
+	/// The destination MAC address as a 48-bits integer
+	uint64_t dst_mac;
+	/// The source MAC address as a 48-bits integer
+	uint64_t src_mac;
+	/// The 802.1Q TCI (inner TCI for 802.1ad), 0 if no tag
+	uint16_t q_tci;
+	/// The 802.1ad outer TCI, 0 if no tag
+	uint16_t ad_tci;
+	/// The PCP of the 802.1Q TCI
+	uint8_t pcp;
+	/// The length of the Ethernet header
+	std::size_t header_length;
+};
+
+
 /**
  * @class NetPacket
  * @brief Network-layer packet
@@ -130,6 +155,10 @@ protected:
 	uint8_t src_tal_id;
 	/// The packet destination TalID
 	uint8_t dst_tal_id;
+	/// The parsed Ethernet header, if eth_header_parsed is set
+	eth_header_desc_t eth_header;
+	/// Whether the Ethernet header was parsed
+	bool eth_header_parsed;
 
 public:
 	/**
@@ -184,6 +213,27 @@ public:
 	          uint8_t dst_tal_id,
 	          std::size_t header_length);
 
+	/**
+	 * Build a network-layer packet initialized from a raw buffer
+	 *
+	 * @param data              raw data from which a network-layer packet can be created
+	 * @param length            length of raw data
+	 * @param name              the name of the network protocol
+	 * @param type              the type of the network protocol
+	 * @param qos               the QoS value to associate with the packet
+	 * @param src_tal_id        the source terminal ID to associate with the packet
+	 * @param dst_tal_id        the destination terminal ID to associate with the packet
+	 * @param header_length     the header length of the packet
+	 */
+	NetPacket(const unsigned char *data,
+	          std::size_t length,
+	          std::string name,
+	          NET_PROTO type,
+	          uint8_t qos,
+	          uint8_t src_tal_id,
+	          uint8_t dst_tal_id,
+	          std::size_t header_length);
+
 	/**
 	 * Destroy the network-layer packet
 	 */
@@ -237,6 +287,21 @@ public:
 	 * @return the type of network protocol
 	 */
 	NET_PROTO getType() const;
+
+	/**
+	 * Cache the parsed Ethernet header of the packet,
+	 * the packet data should not be modified afterwards
+	 *
+	 * @param header  the parsed Ethernet header
+	 */
+	void setEthHeader(const eth_header_desc_t &header);
+
+	/**
+	 * Get the cached Ethernet header of the packet
+	 *
+	 * @return the parsed Ethernet header, nullptr if it was not parsed yet
+	 */
+	const eth_header_desc_t *getEthHeader() const;
 };
 
 
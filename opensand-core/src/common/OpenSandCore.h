@@ -137,6 +137,7 @@ enum class InternalMessageType : uint8_t
 	link_up,         ///< link up message
 	sig,             ///< message containing signalisation
 	saloha,          ///< message containing Slotted Aloha content
+	batch,           ///< message containing several DVB frames (type DvbFrameBatch, below BlockDvb)
 	unknown,         ///< when the msg type is unknown or unused
 };
 
@@ -39,7 +39,8 @@
 
 
 AttenuationModelPlugin::AttenuationModelPlugin():
-		OpenSandPlugin()
+		OpenSandPlugin(),
+		terminal_id(BROADCAST_TAL_ID)
 {
 	this->log_init = Output::Get()->registerLog(LEVEL_WARNING, "PhysicalLayer.init");
 	this->log_attenuation = Output::Get()->registerLog(LEVEL_WARNING, "PhysicalLayer.Attenuation");
@@ -59,6 +60,11 @@ double AttenuationModelPlugin::getAttenuation() const
 	return this->attenuation;
 }
 
+void AttenuationModelPlugin::setTerminalId(tal_id_t terminal_id)
+{
+	this->terminal_id = terminal_id;
+}
+
 
 MinimalConditionPlugin::MinimalConditionPlugin():
 		OpenSandPlugin()
@@ -88,11 +94,17 @@ ErrorInsertionPlugin::~ErrorInsertionPlugin()
 {
 }
 
+bool ErrorInsertionPlugin::accessesPayload() const
+{
+	return true;
+}
+
 
 SatDelayPlugin::SatDelayPlugin():
 		OpenSandPlugin(),
 		delay(0),
 		refresh_period_ms(1000),
+		terminal_id(BROADCAST_TAL_ID),
 		delay_mutex()
 {
 	this->log_init = Output::Get()->registerLog(LEVEL_WARNING, "SatDelay.init");
@@ -103,6 +115,11 @@ SatDelayPlugin::~SatDelayPlugin()
 {
 }
 
+void SatDelayPlugin::setTerminalId(tal_id_t terminal_id)
+{
+	this->terminal_id = terminal_id;
+}
+
 time_ms_t SatDelayPlugin::getSatDelay() const
 {
 	std::lock_guard<std::mutex> lock{this->delay_mutex};
@@ -40,12 +40,12 @@
 #include "OpenSandCore.h"
 #include "OpenSandPlugin.h"
 
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <string>
 
 
-class Data;
 class OutputLog;
 enum class EmulatedMessageType: uint8_t;
 
@@ -67,6 +67,9 @@ protected:
 	/* channel refreshing period */
 	time_ms_t refresh_period_ms;
 
+	/* The terminal whose channel is emulated, BROADCAST_TAL_ID for the local entity */
+	tal_id_t terminal_id;
+
 public:
 	/**
 	 * @brief AttenuationModelPlugin constructor
@@ -89,6 +92,14 @@ public:
 	 */
 	virtual bool init(time_ms_t refresh_period_ms, std::string link) = 0;
 
+	/**
+	 * @brief Emulate the channel of a given terminal instead of
+	 *        the one of the local entity, must be called before init
+	 *
+	 * @param terminal_id  the terminal ID
+	 */
+	void setTerminalId(tal_id_t terminal_id);
+
 	/**
 	 * @brief Get the model current attenuation
 	 */
@@ -196,16 +207,26 @@ public:
 	virtual bool isToBeModifiedPacket(double cn_total,
 	                                  double threshold_qef) = 0;
 
+	/**
+	 * @brief Whether modifyPacket reads or writes the frame payload
+	 *
+	 * @return false if the payload is never accessed, in which case
+	 *         modifyPacket is called without it
+	 */
+	virtual bool accessesPayload() const;
+
 	/**
 	 * @brief Corrupt a packet with error bits 
 	 *
-	 * @param payload the payload to the frame that should be modified 
+	 * @param payload  the payload of the frame that should be modified,
+	 *                 in place; nullptr if the plugin does not access it
+	 * @param length   the payload length
 	 * @return true if DVB header should be tagged as corrupted,
 	 *         false otherwise
 	 *         If packet is modified by the function but should be forwarded
 	 *         to other layers return false else it will be discarded
 	 */
-	virtual bool modifyPacket(const Data &payload) = 0;
+	virtual bool modifyPacket(uint8_t *payload, std::size_t length) = 0;
 
 protected:
 	/* Output log */
@@ -231,6 +252,9 @@ protected:
 	/* satdelay refreshing period */
 	time_ms_t refresh_period_ms;
 
+	/* The terminal whose delay is emulated, BROADCAST_TAL_ID for the local entity */
+	tal_id_t terminal_id;
+
 private:
 	/* Mutex to prevent concurrent access to delay */
 	mutable std::mutex delay_mutex;
@@ -253,6 +277,14 @@ public:
 	*/
 	virtual bool init() = 0;
 
+	/**
+	* @brief Emulate the delay of a given terminal instead of
+	*        the one of the local entity, must be called before init
+	*
+	* @param terminal_id  the terminal ID
+	*/
+	void setTerminalId(tal_id_t terminal_id);
+
 	/**
 	* @brief Get the model current sat delay
 	*/
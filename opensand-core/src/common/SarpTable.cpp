@@ -36,12 +36,44 @@
 #include "SarpTable.h"
 #include "MacAddress.h"
 
+#include <chrono>
+
+
+/// Marker of a slot that was never used, stops the lookups
+constexpr uint64_t SARP_SLOT_EMPTY = ~uint64_t(0);
+
 
 SarpTable::SarpTable(unsigned int max_entries):
-	eth_sarp{}
+	eth_sarp{},
+	generic_sarp{},
+	configured_by_tal{},
+	slots{},
+	tal_slots{},
+	slots_mask{0},
+	version{0},
+	learned_number{0},
+	aging_time{SarpTable::SARP_AGING_TIME},
+	default_dest{255},
+	mutex{}
 {
 	this->max_entries = (max_entries == 0 ? SarpTable::SARP_MAX : max_entries);
 
+	// keep the load factor under 1/2 so that lookups stay short
+	uint64_t slots_number = 1;
+	while(slots_number < 2 * this->max_entries)
+	{
+		slots_number <<= 1;
+	}
+	this->slots.reset(new SarpSlot[slots_number]);
+	this->tal_slots.reset(new std::atomic<uint64_t>[slots_number]);
+	this->slots_mask = slots_number - 1;
+	for(uint64_t i = 0; i < slots_number; i++)
+	{
+		this->slots[i].entry.store(SARP_SLOT_EMPTY, std::memory_order_relaxed);
+		this->slots[i].last_seen.store(0, std::memory_order_relaxed);
+		this->tal_slots[i].store(SARP_SLOT_EMPTY, std::memory_order_relaxed);
+	}
+
 	// Output Log
 	this->log_sarp = Output::Get()->registerLog(LEVEL_WARNING, "LanAdaptation.SarpTable");
 }
@@ -54,11 +86,10 @@ SarpTable::~SarpTable()
 
 bool SarpTable::add(std::unique_ptr<MacAddress> mac_address, tal_id_t tal)
 {
-	LOG(this->log_sarp, LEVEL_INFO,
-	    "add new entry in SARP table (%s)\n",
-	    mac_address->str().c_str());
+	RtLock lock(this->mutex);
 
-	if((this->eth_sarp.size() >= this->max_entries) || mac_address == nullptr)
+	if((this->eth_sarp.size() + this->learned_number >= this->max_entries) ||
+	   mac_address == nullptr || tal >= 0xFFFE)
 	{
 		LOG(this->log_sarp, LEVEL_ERROR,
 		    "SARP table full or address is empry, "
@@ -66,24 +97,138 @@ bool SarpTable::add(std::unique_ptr<MacAddress> mac_address, tal_id_t tal)
 		return false;
 	}
 
+	LOG(this->log_sarp, LEVEL_INFO,
+	    "add new entry in SARP table (%s)\n",
+	    mac_address->str().c_str());
+
 	// add entry to if not presents
-	tal_id_t tal_id = 255;
-	if(!SarpTable::getTalByMac(*mac_address, tal_id))
+	tal_id_t tal_id;
+	if(SarpTable::getTalByMac(*mac_address, tal_id))
+	{
+		return true;
+	}
+
+	if(mac_address->isGeneric())
+	{
+		this->generic_sarp.push_back(this->eth_sarp.size());
+	}
+	else
 	{
-		// set entry
-		this->eth_sarp.push_back({std::move(mac_address), tal});
-	}	
+		uint8_t mac[6];
+		for(unsigned int i = 0; i < 6; i++)
+		{
+			mac[i] = mac_address->at(i);
+		}
+		if(!this->insert(SarpTable::getKey(mac), tal, 0))
+		{
+			return false;
+		}
+	}
+	this->configured_by_tal.emplace(tal, this->eth_sarp.size());
+	this->eth_sarp.push_back({std::move(mac_address), tal});
 
 	return true;
 }
 
 
+bool SarpTable::learn(const uint8_t *mac, tal_id_t tal)
+{
+	uint64_t key = SarpTable::getKey(mac);
+	uint32_t now = SarpTable::getTime();
+	uint64_t entry;
+	uint32_t last_seen;
+
+	// known address already refreshed during this second
+	if(this->read(key, entry, last_seen) &&
+	   (last_seen == 0 || ((entry & 0xFFFF) == tal && last_seen == now)))
+	{
+		return true;
+	}
+
+	RtLock lock(this->mutex);
+
+	// check again as the other channel may have learned the address
+	SarpSlot *slot = this->find(key);
+	if(slot != nullptr)
+	{
+		if(slot->last_seen.load(std::memory_order_relaxed) != 0)
+		{
+			// refresh the address, the host may also have moved behind
+			// another terminal
+			slot->last_seen.store(now, std::memory_order_relaxed);
+			slot->entry.store((key << 16) | tal, std::memory_order_release);
+			this->indexTal((key << 16) | tal);
+		}
+		return true;
+	}
+	for(auto &&index : this->generic_sarp)
+	{
+		MacAddress mac_address{mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]};
+		if(this->eth_sarp[index].mac->matches(&mac_address))
+		{
+			// configured multicast or broadcast address
+			return true;
+		}
+	}
+	if(tal >= 0xFFFE)
+	{
+		return false;
+	}
+
+	if(this->eth_sarp.size() + this->learned_number >= this->max_entries)
+	{
+		this->removeExpired(now);
+		if(this->eth_sarp.size() + this->learned_number >= this->max_entries)
+		{
+			LOG(this->log_sarp, LEVEL_WARNING,
+			    "SARP table full, cannot learn new address\n");
+			return false;
+		}
+	}
+	if(!this->insert(key, tal, now))
+	{
+		return false;
+	}
+	this->learned_number++;
+	this->indexTal((key << 16) | tal);
+	return true;
+}
+
+
 bool SarpTable::getTalByMac(const MacAddress &mac_address, tal_id_t &tal_id) const
 {
+	uint8_t mac[6];
+
+	for(unsigned int i = 0; i < 6; i++)
+	{
+		mac[i] = mac_address.at(i);
+	}
+	return this->getTalByMac(mac, tal_id);
+}
+
+
+bool SarpTable::getTalByMac(const uint8_t *mac, tal_id_t &tal_id) const
+{
+	uint64_t entry;
+	uint32_t last_seen;
+
 	tal_id = this->default_dest;
 
-	for(auto&& entry : this->eth_sarp)
+	if(this->read(SarpTable::getKey(mac), entry, last_seen) &&
+	   !this->isExpired(last_seen, SarpTable::getTime()))
+	{
+		tal_id = entry & 0xFFFF;
+		return true;
+	}
+
+	if(this->generic_sarp.empty())
+	{
+		return false;
+	}
+	MacAddress mac_address{mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]};
+	for(auto &&index : this->generic_sarp)
 	{
+		const SarpEthEntry &entry = this->eth_sarp[index];
 		if(entry.mac->matches(&mac_address))
 		{
 			tal_id = entry.tal_id;
@@ -97,20 +242,298 @@ bool SarpTable::getTalByMac(const MacAddress &mac_address, tal_id_t &tal_id) con
 
 bool SarpTable::getMacByTal(tal_id_t tal_id, std::vector<MacAddress> &mac_address) const
 {
-	for(auto&& entry : this->eth_sarp)
+	// configured entries first, in configuration order
+	auto configured = this->configured_by_tal.find(tal_id);
+	if(configured != this->configured_by_tal.end())
+	{
+		mac_address.emplace_back(this->eth_sarp[configured->second].mac->str());
+		return true;
+	}
+
+	uint64_t tal_entry;
+	uint32_t current_version;
+	do
+	{
+		current_version = this->version.load(std::memory_order_acquire);
+		std::atomic<uint64_t> *tal_slot = this->findTal(tal_id);
+		tal_entry = (tal_slot != nullptr ?
+		             tal_slot->load(std::memory_order_acquire) : SARP_SLOT_EMPTY);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	while((current_version & 1) ||
+	      this->version.load(std::memory_order_relaxed) != current_version);
+	if(tal_entry == SARP_SLOT_EMPTY || (tal_entry & 0xFFFF) != tal_id)
+	{
+		return false;
+	}
+
+	// the indexed address may have moved or expired since
+	uint64_t key = tal_entry >> 16;
+	uint64_t entry;
+	uint32_t last_seen;
+	if(!this->read(key, entry, last_seen) || entry != tal_entry ||
+	   this->isExpired(last_seen, SarpTable::getTime()))
+	{
+		return false;
+	}
+	mac_address.emplace_back((key >> 40) & 0xFF, (key >> 32) & 0xFF,
+	                         (key >> 24) & 0xFF, (key >> 16) & 0xFF,
+	                         (key >> 8) & 0xFF, key & 0xFF);
+	return true;
+}
+
+
+void SarpTable::setDefaultTal(tal_id_t dflt)
+{
+	this->default_dest = dflt;
+}
+
+
+void SarpTable::setAgingTime(unsigned int aging_time)
+{
+	this->aging_time = aging_time;
+}
+
+
+SarpSlot *SarpTable::find(uint64_t key) const
+{
+	uint64_t index = SarpTable::getHash(key);
+
+	for(uint64_t probe = 0; probe <= this->slots_mask; probe++)
 	{
-		if(entry.tal_id == tal_id)
+		SarpSlot *slot = &this->slots[(index + probe) & this->slots_mask];
+		uint64_t entry = slot->entry.load(std::memory_order_acquire);
+		if(entry == SARP_SLOT_EMPTY)
 		{
-			mac_address.emplace_back(entry.mac->str());
-			return true;
+			break;
+		}
+		if((entry >> 16) == key)
+		{
+			return slot;
+		}
+	}
+	return nullptr;
+}
+
+
+bool SarpTable::read(uint64_t key, uint64_t &entry, uint32_t &last_seen) const
+{
+	uint32_t current_version;
+	bool found;
+
+	// the slot is read again if a writer moved entries meanwhile
+	do
+	{
+		current_version = this->version.load(std::memory_order_acquire);
+		SarpSlot *slot = this->find(key);
+		found = false;
+		if(slot != nullptr)
+		{
+			entry = slot->entry.load(std::memory_order_acquire);
+			last_seen = slot->last_seen.load(std::memory_order_relaxed);
+			found = (entry != SARP_SLOT_EMPTY && (entry >> 16) == key);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+	while((current_version & 1) ||
+	      this->version.load(std::memory_order_relaxed) != current_version);
+
+	return found;
+}
+
+
+std::atomic<uint64_t> *SarpTable::findTal(tal_id_t tal) const
+{
+	uint64_t index = SarpTable::getHash(tal);
+
+	for(uint64_t probe = 0; probe <= this->slots_mask; probe++)
+	{
+		std::atomic<uint64_t> *slot = &this->tal_slots[(index + probe) & this->slots_mask];
+		uint64_t entry = slot->load(std::memory_order_acquire);
+		if(entry == SARP_SLOT_EMPTY)
+		{
+			break;
+		}
+		if((entry & 0xFFFF) == tal)
+		{
+			return slot;
 		}
 	}
+	return nullptr;
+}
+
+
+void SarpTable::indexTal(uint64_t entry)
+{
+	tal_id_t tal = entry & 0xFFFF;
+	uint64_t index = SarpTable::getHash(tal);
+
+	for(uint64_t probe = 0; probe <= this->slots_mask; probe++)
+	{
+		std::atomic<uint64_t> *slot = &this->tal_slots[(index + probe) & this->slots_mask];
+		uint64_t tal_entry = slot->load(std::memory_order_relaxed);
+		if(tal_entry == SARP_SLOT_EMPTY || (tal_entry & 0xFFFF) == tal)
+		{
+			slot->store(entry, std::memory_order_release);
+			return;
+		}
+	}
+
+	// the index is full of terminals without address anymore
+	this->beginUpdate();
+	this->rebuildTalIndex(SarpTable::getTime());
+	this->endUpdate();
+}
+
+
+void SarpTable::rebuildTalIndex(uint32_t now)
+{
+	for(uint64_t i = 0; i <= this->slots_mask; i++)
+	{
+		this->tal_slots[i].store(SARP_SLOT_EMPTY, std::memory_order_relaxed);
+	}
+	for(uint64_t i = 0; i <= this->slots_mask; i++)
+	{
+		uint64_t entry = this->slots[i].entry.load(std::memory_order_relaxed);
+		uint32_t last_seen = this->slots[i].last_seen.load(std::memory_order_relaxed);
+		if(entry == SARP_SLOT_EMPTY || last_seen == 0 || this->isExpired(last_seen, now))
+		{
+			continue;
+		}
+		tal_id_t tal = entry & 0xFFFF;
+		uint64_t index = SarpTable::getHash(tal);
+		for(uint64_t probe = 0; probe <= this->slots_mask; probe++)
+		{
+			std::atomic<uint64_t> *slot = &this->tal_slots[(index + probe) & this->slots_mask];
+			uint64_t tal_entry = slot->load(std::memory_order_relaxed);
+			if(tal_entry == SARP_SLOT_EMPTY)
+			{
+				slot->store(entry, std::memory_order_relaxed);
+				break;
+			}
+			if((tal_entry & 0xFFFF) == tal)
+			{
+				break;
+			}
+		}
+	}
+}
+
 
+bool SarpTable::insert(uint64_t key, tal_id_t tal, uint32_t last_seen)
+{
+	uint64_t index = SarpTable::getHash(key);
+
+	for(uint64_t probe = 0; probe <= this->slots_mask; probe++)
+	{
+		SarpSlot *slot = &this->slots[(index + probe) & this->slots_mask];
+		uint64_t entry = slot->entry.load(std::memory_order_relaxed);
+		if(entry == SARP_SLOT_EMPTY)
+		{
+			// publish the age before the entry so that readers never see
+			// the entry with the age of the previous one
+			slot->last_seen.store(last_seen, std::memory_order_relaxed);
+			slot->entry.store((key << 16) | tal, std::memory_order_release);
+			return true;
+		}
+	}
 	return false;
 }
 
 
-void SarpTable::setDefaultTal(tal_id_t dflt)
+void SarpTable::erase(uint64_t index)
 {
-	this->default_dest = dflt;
+	uint64_t hole = index;
+	uint64_t next = (hole + 1) & this->slots_mask;
+
+	// move back the entries whose probe sequence crosses the hole
+	while(true)
+	{
+		uint64_t entry = this->slots[next].entry.load(std::memory_order_relaxed);
+		if(entry == SARP_SLOT_EMPTY)
+		{
+			break;
+		}
+		uint64_t home = SarpTable::getHash(entry >> 16) & this->slots_mask;
+		if(((next - home) & this->slots_mask) >= ((next - hole) & this->slots_mask))
+		{
+			this->slots[hole].last_seen.store(this->slots[next].last_seen.load(std::memory_order_relaxed),
+			                                  std::memory_order_relaxed);
+			this->slots[hole].entry.store(entry, std::memory_order_relaxed);
+			hole = next;
+		}
+		next = (next + 1) & this->slots_mask;
+	}
+	this->slots[hole].entry.store(SARP_SLOT_EMPTY, std::memory_order_relaxed);
+}
+
+
+void SarpTable::removeExpired(uint32_t now)
+{
+	this->beginUpdate();
+	for(uint64_t i = 0; i <= this->slots_mask; i++)
+	{
+		// an entry shifted into the slot is checked too
+		while(true)
+		{
+			SarpSlot *slot = &this->slots[i];
+			uint64_t entry = slot->entry.load(std::memory_order_relaxed);
+			uint32_t last_seen = slot->last_seen.load(std::memory_order_relaxed);
+			if(entry == SARP_SLOT_EMPTY || last_seen == 0 || !this->isExpired(last_seen, now))
+			{
+				break;
+			}
+			this->erase(i);
+			this->learned_number--;
+		}
+	}
+	this->rebuildTalIndex(now);
+	this->endUpdate();
+}
+
+
+void SarpTable::beginUpdate()
+{
+	this->version.store(this->version.load(std::memory_order_relaxed) + 1,
+	                    std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+
+void SarpTable::endUpdate()
+{
+	this->version.store(this->version.load(std::memory_order_relaxed) + 1,
+	                    std::memory_order_release);
+}
+
+
+bool SarpTable::isExpired(uint32_t last_seen, uint32_t now) const
+{
+	return last_seen != 0 && this->aging_time != 0 &&
+	       now > last_seen + this->aging_time;
+}
+
+
+uint32_t SarpTable::getTime()
+{
+	static const auto start = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration_cast<std::chrono::seconds>(elapsed).count() + 1;
+}
+
+
+uint64_t SarpTable::getKey(const uint8_t *mac)
+{
+	return (uint64_t(mac[0]) << 40) | (uint64_t(mac[1]) << 32) |
+	       (uint64_t(mac[2]) << 24) | (uint64_t(mac[3]) << 16) |
+	       (uint64_t(mac[4]) << 8) | uint64_t(mac[5]);
+}
+
+
+uint64_t SarpTable::getHash(uint64_t key)
+{
+	// multiplicative hashing then fold the high bits, so that addresses
+	// sharing their vendor prefix spread over the table
+	uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 32);
 }
@@ -35,8 +35,12 @@
 #define SARP_TABLE_H
 
 
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+
+#include <opensand_rt/RtMutex.h>
 
 #include "OpenSandCore.h"
 
@@ -53,18 +57,162 @@ struct SarpEthEntry
 };
 
 
+/// SARP table slot for exact MAC addresses
+struct SarpSlot
+{
+	/// The 48 bits MAC address and the terminal ID packed as
+	/// (mac << 16) | tal_id, or the empty marker
+	std::atomic<uint64_t> entry;
+	/// The last time the entry was learned (in seconds since the table
+	/// creation, 0 for configured entries that never age)
+	std::atomic<uint32_t> last_seen;
+};
+
+
 /**
  * @class SarpTable
  * @brief SARP table
+ *
+ * The exact MAC addresses are stored in an open addressing hash table keyed
+ * on the 48 bits of the address, and a second one keyed on the terminal ID
+ * gives a learned address of each terminal. Lookups do not take any lock so
+ * they can be done from both channels while the other one learns new
+ * addresses; writers are serialized by a mutex. Removals shift the following
+ * entries back instead of leaving tombstones, so writers that move entries
+ * make the version odd and lookups retry until they read a stable version.
+ *
+ * The configured entries are added before the table is shared between the
+ * channels. The MAC addresses containing generic bytes are only set from
+ * configuration and are checked after the exact ones.
  */
 class SarpTable
 {
 private:
-	static constexpr unsigned int SARP_MAX = 50;
+	static constexpr unsigned int SARP_MAX = 4096;
+	static constexpr unsigned int SARP_AGING_TIME = 300;
 
 	unsigned int max_entries;    ///< maximum number of entries in SARP table
-	std::vector<SarpEthEntry> eth_sarp; ///< The Ethernet entries in SARP table
+	std::vector<SarpEthEntry> eth_sarp; ///< The configured Ethernet entries in SARP table
+	std::vector<std::size_t> generic_sarp; ///< The index of the configured entries with generic bytes
+	std::unordered_map<tal_id_t, std::size_t> configured_by_tal; ///< The first configured entry of each terminal
+	std::unique_ptr<SarpSlot[]> slots; ///< The hash table of exact MAC addresses
+	std::unique_ptr<std::atomic<uint64_t>[]> tal_slots; ///< The hash table of a learned address per terminal
+	uint64_t slots_mask;    ///< The number of slots minus one (power of 2)
+	std::atomic<uint32_t> version;  ///< Odd while writers move entries
+	unsigned int learned_number;  ///< The number of learned entries
+	unsigned int aging_time;  ///< The learned entries lifetime (s)
 	tal_id_t default_dest;  ///< the default terminal ID if no entry is found
+	RtMutex mutex;  ///< Serializes the writers
+
+	/**
+	 * @brief Find the slot of a MAC address, the result is only valid if
+	 *        the version did not change or if the mutex is held
+	 *
+	 * @param key  the 48 bits MAC address
+	 * @return the slot containing the address, NULL if not found
+	 */
+	SarpSlot *find(uint64_t key) const;
+
+	/**
+	 * @brief Read the entry of a MAC address without lock
+	 *
+	 * @param key        the 48 bits MAC address
+	 * @param entry      the packed entry if found
+	 * @param last_seen  the entry learning time if found
+	 * @return true if the address is in the table
+	 */
+	bool read(uint64_t key, uint64_t &entry, uint32_t &last_seen) const;
+
+	/**
+	 * @brief Find the index slot of a terminal, see find()
+	 *
+	 * @param tal  the terminal ID
+	 * @return the slot of the terminal, NULL if not found
+	 */
+	std::atomic<uint64_t> *findTal(tal_id_t tal) const;
+
+	/**
+	 * @brief Make a learned entry the address of its terminal in the
+	 *        index, the mutex should be held
+	 *
+	 * @param entry  the packed entry
+	 */
+	void indexTal(uint64_t entry);
+
+	/**
+	 * @brief Fill the terminal index again from the learned entries,
+	 *        the mutex should be held and the version odd
+	 *
+	 * @param now  the current time
+	 */
+	void rebuildTalIndex(uint32_t now);
+
+	/**
+	 * @brief Remove the entry of a slot and shift back the following
+	 *        entries of its cluster, the mutex should be held and the
+	 *        version odd
+	 *
+	 * @param index  the slot index
+	 */
+	void erase(uint64_t index);
+
+	/**
+	 * @brief Make the version odd before moving entries
+	 */
+	void beginUpdate();
+
+	/**
+	 * @brief Make the version even once entries are moved
+	 */
+	void endUpdate();
+
+	/**
+	 * @brief Insert a MAC address that is not in the table yet,
+	 *        the mutex should be held
+	 *
+	 * @param key        the 48 bits MAC address
+	 * @param tal        the terminal ID
+	 * @param last_seen  the learning time, 0 if the entry never ages
+	 * @return true on success, false if the table is full
+	 */
+	bool insert(uint64_t key, tal_id_t tal, uint32_t last_seen);
+
+	/**
+	 * @brief Remove the expired learned entries, the mutex should be held
+	 *
+	 * @param now  the current time
+	 */
+	void removeExpired(uint32_t now);
+
+	/**
+	 * @brief Check whether a learned entry is expired
+	 *
+	 * @param last_seen  the entry learning time
+	 * @param now        the current time
+	 * @return true if the entry should not be used anymore
+	 */
+	bool isExpired(uint32_t last_seen, uint32_t now) const;
+
+	/**
+	 * @brief Get the current time in seconds, never 0
+	 */
+	static uint32_t getTime();
+
+	/**
+	 * @brief Get the 48 bits key of a MAC address
+	 *
+	 * @param mac  the 6 bytes of the MAC address
+	 * @return the key
+	 */
+	static uint64_t getKey(const uint8_t *mac);
+
+	/**
+	 * @brief Get the hash of a MAC address key
+	 *
+	 * @param key  the 48 bits MAC address
+	 * @return the hash, to be masked with the slots mask
+	 */
+	static uint64_t getHash(uint64_t key);
 
 protected:
 	// Output Log
@@ -85,7 +233,7 @@ public:
 	~SarpTable();
 
 	/**
-	 * Add an Ethernet entry in the SARP table
+	 * Add a configured Ethernet entry in the SARP table, it never ages
 	 *
 	 * @param max_addr  the MAC address for the SARP entry
 	 * @param tal the tal ID associated with the IP address
@@ -94,6 +242,17 @@ public:
 	 */
 	bool add(std::unique_ptr<MacAddress> mac_address, tal_id_t tal);
 
+	/**
+	 * Learn the terminal behind a MAC address, the entry expires if the
+	 * address is not learned again during the aging time
+	 *
+	 * @param mac  the 6 bytes of the MAC address
+	 * @param tal  the tal ID associated with the MAC address
+	 * @return true if the address is known or was added,
+	 *         false if the table is full
+	 */
+	bool learn(const uint8_t *mac, tal_id_t tal);
+
 	/**
 	 * Get the tal ID associated with the MAC address in the SARP table
 	 *
@@ -104,6 +263,16 @@ public:
 	 */
 	bool getTalByMac(const MacAddress &mac_address, tal_id_t &tal_id) const;
 
+	/**
+	 * Get the tal ID associated with the MAC address in the SARP table
+	 *
+	 * @param mac     the 6 bytes of the MAC address to search for
+	 * @param tal_id  the tal ID associated with the MAC address if found
+	 *                the default tal_id otherwise (false will be returned)
+	 * @return true on success, false otherwise
+	 */
+	bool getTalByMac(const uint8_t *mac, tal_id_t &tal_id) const;
+
 	/**
 	 * Get the MAC address associated with the terminal ID in the SARP table
 	 *
@@ -119,6 +288,13 @@ public:
 	 * @param dlft  the default terminal ID
 	 */
 	void setDefaultTal(tal_id_t dflt);
+
+	/**
+	 * @brief Set the lifetime of the learned entries
+	 *
+	 * @param aging_time  the lifetime (s), 0 to never remove them
+	 */
+	void setAgingTime(unsigned int aging_time);
 };
 
 
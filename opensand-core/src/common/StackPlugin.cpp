@@ -62,6 +62,16 @@ std::string StackPlugin::StackPacketHandler::getName() const
 }
 
 
+std::unique_ptr<NetPacket> StackPlugin::StackPacketHandler::build(const unsigned char *data,
+                                                                  std::size_t data_length,
+                                                                  uint8_t qos,
+                                                                  uint8_t src_tal_id,
+                                                                  uint8_t dst_tal_id) const
+{
+	return this->build(Data(data, data_length), data_length, qos, src_tal_id, dst_tal_id);
+}
+
+
 StackPlugin::StackContext::StackContext(StackPlugin &pl):
 	current_upper{nullptr},
 	plugin{pl}
@@ -76,7 +86,7 @@ StackPlugin::StackContext::~StackContext()
 
 NetBurst *StackPlugin::StackContext::encapsulate(NetBurst *burst)
 {
-	std::map<long, int> time_contexts;
+	std::map<int, long> time_contexts;
 	return this->encapsulate(burst, time_contexts);
 }
 
@@ -128,6 +138,16 @@ std::unique_ptr<NetPacket> StackPlugin::StackContext::createPacket(const Data &d
 }
 
 
+std::unique_ptr<NetPacket> StackPlugin::StackContext::createPacket(const unsigned char *data,
+                                                                   std::size_t data_length,
+                                                                   uint8_t qos,
+                                                                   uint8_t src_tal_id,
+                                                                   uint8_t dst_tal_id)
+{
+	return plugin.packet_handler->build(data, data_length, qos, src_tal_id, dst_tal_id);
+}
+
+
 StackPlugin::StackPlugin(NET_PROTO ether_type):
 	OpenSandPlugin{},
 	ether_type{ether_type}
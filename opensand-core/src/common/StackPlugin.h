@@ -103,6 +103,25 @@ public:
 		                                         uint8_t src_tal_id,
 		                                         uint8_t dst_tal_id) const = 0;
 
+		/**
+		 * @brief Create a NetPacket from a raw buffer with the relevant
+		 *        attributes, handlers should override it to copy the
+		 *        buffer only once into the packet
+		 *
+		 * @param data        The packet data
+		 * @param data_length The packet length
+		 * @param qos         The QoS value to associate with the packet
+		 * @param src_tal_id  The source terminal ID to associate with the packet
+		 * @param dst_tal_id  The destination terminal ID to associate with the packet
+		 *
+		 * @return The packet
+		 */
+		virtual std::unique_ptr<NetPacket> build(const unsigned char *data,
+		                                         std::size_t data_length,
+		                                         uint8_t qos,
+		                                         uint8_t src_tal_id,
+		                                         uint8_t dst_tal_id) const;
+
 		/**
 		 * @brief Get a packet length
 		 *
@@ -203,19 +222,20 @@ public:
 		/**
 		 * Encapsulate some packets into one or several packets.
 		 * The function returns a context ID and expiration time map.
-		 * It's the caller charge to arm the timers to manage contextis expiration.
+		 * It's the caller charge to flush the contexts when they expire.
 		 * It's also the caller charge to delete the returned NetBurst after use.
 		 *
 		 * @param burst        the packets to encapsulate
-		 * @param time_contexts a map of time and context ID where:
+		 * @param time_contexts a map of context ID and time where:
 		 *                       - context ID identifies the context in which the
 		 *                         packet was encapsulated
 		 *                       - time is the time before the context identified by
-		 *                         the context ID expires
+		 *                         the context ID expires, 0 if the context does
+		 *                         not hold any data anymore
 		 * @return              a list of packets
 		 */
 		virtual NetBurst *encapsulate(NetBurst *burst,
-		                              std::map<long, int> &time_contexts) = 0;
+		                              std::map<int, long> &time_contexts) = 0;
 
 		/**
 		 * Encapsulate some packets into one or several packets for contexts with
@@ -286,6 +306,22 @@ public:
 		                                        uint8_t src_tal_id,
 		                                        uint8_t dst_tal_id);
 
+		/**
+		 * @brief Create a NetPacket from a raw buffer with the relevant attributes
+		 *
+		 * @param data        The packet data
+		 * @param data_length The packet length
+		 * @param qos         The QoS value to associate with the packet
+		 * @param src_tal_id  The source terminal ID to associate with the packet
+		 * @param dst_tal_id  The destination terminal ID to associate with the packet
+		 * @return the packet on success, NULL otherwise
+		 */
+		std::unique_ptr<NetPacket> createPacket(const unsigned char *data,
+		                                        std::size_t data_length,
+		                                        uint8_t qos,
+		                                        uint8_t src_tal_id,
+		                                        uint8_t dst_tal_id);
+
 		/**
 		 * @brief perform some plugin initialization
 		 *
@@ -0,0 +1,412 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file TimeSeriesTrace.cpp
+ * @brief Binary time series traces, memory-mapped and read with a cursor
+ */
+
+
+#include "TimeSeriesTrace.h"
+
+#include <opensand_output/Output.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/// the files already mapped, shared by all their cursors
+static std::map<std::string, std::weak_ptr<TraceFile>> mapped_files;
+static std::mutex mapped_files_mutex;
+
+
+static bool recordBefore(const trace_record_t &record, unsigned int time)
+{
+	return record.time < time;
+}
+
+
+TraceFile::TraceFile(const std::string &path, void *data, std::size_t length):
+	path{path},
+	data{data},
+	length{length},
+	series{}
+{
+}
+
+
+TraceFile::~TraceFile()
+{
+	munmap(this->data, this->length);
+}
+
+
+bool TraceFile::isBinary(const std::string &path)
+{
+	char magic[sizeof(trace_header_t::magic)];
+	std::ifstream file(path, std::ios::binary);
+	if(!file.read(magic, sizeof(magic)))
+	{
+		return false;
+	}
+	return memcmp(magic, TRACE_MAGIC, sizeof(magic)) == 0;
+}
+
+
+std::shared_ptr<TraceFile> TraceFile::open(const std::string &path)
+{
+	std::lock_guard<std::mutex> lock{mapped_files_mutex};
+
+	auto mapped = mapped_files[path].lock();
+	if(mapped != nullptr)
+	{
+		return mapped;
+	}
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		DFLTLOG(LEVEL_ERROR, "cannot open trace file %s: %s\n",
+		        path.c_str(), strerror(errno));
+		return nullptr;
+	}
+	struct stat info;
+	if(fstat(fd, &info) < 0 || std::size_t(info.st_size) < sizeof(trace_header_t))
+	{
+		DFLTLOG(LEVEL_ERROR, "trace file %s is too short\n", path.c_str());
+		close(fd);
+		return nullptr;
+	}
+	std::size_t length = info.st_size;
+	void *data = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED)
+	{
+		DFLTLOG(LEVEL_ERROR, "cannot map trace file %s: %s\n",
+		        path.c_str(), strerror(errno));
+		return nullptr;
+	}
+	mapped.reset(new TraceFile(path, data, length));
+
+	// check the header and the index before any record is read
+	auto header = static_cast<const trace_header_t *>(data);
+	if(memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+	   header->version != TRACE_VERSION ||
+	   header->record_size != sizeof(trace_record_t))
+	{
+		DFLTLOG(LEVEL_ERROR, "%s is not a version %u trace file\n",
+		        path.c_str(), TRACE_VERSION);
+		return nullptr;
+	}
+	std::size_t index_end = sizeof(trace_header_t) +
+	                        std::size_t(header->series_count) * sizeof(trace_series_t);
+	if(index_end > length)
+	{
+		DFLTLOG(LEVEL_ERROR, "truncated index in trace file %s\n", path.c_str());
+		return nullptr;
+	}
+	auto index = reinterpret_cast<const trace_series_t *>(header + 1);
+	for(uint32_t i = 0; i < header->series_count; ++i)
+	{
+		const trace_series_t &entry = index[i];
+		if(entry.offset < index_end ||
+		   entry.offset % alignof(trace_record_t) != 0 ||
+		   entry.offset + uint64_t(entry.count) * sizeof(trace_record_t) > length)
+		{
+			DFLTLOG(LEVEL_ERROR, "truncated series %u in trace file %s\n",
+			        entry.id, path.c_str());
+			return nullptr;
+		}
+		mapped->series[entry.id] = &entry;
+	}
+
+	mapped_files[path] = mapped;
+	return mapped;
+}
+
+
+bool TraceFile::getSeries(uint32_t id, const trace_record_t *&records, uint32_t &count) const
+{
+	auto it = this->series.find(id);
+	if(it == this->series.end())
+	{
+		return false;
+	}
+	records = reinterpret_cast<const trace_record_t *>(
+		static_cast<const uint8_t *>(this->data) + it->second->offset);
+	count = it->second->count;
+	return true;
+}
+
+
+std::vector<uint32_t> TraceFile::getSeriesIds() const
+{
+	std::vector<uint32_t> ids;
+	ids.reserve(this->series.size());
+	for(auto &&it : this->series)
+	{
+		ids.push_back(it.first);
+	}
+	return ids;
+}
+
+
+bool TraceFile::write(const std::string &path,
+                      const std::map<uint32_t, std::vector<trace_record_t>> &series)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if(!file)
+	{
+		DFLTLOG(LEVEL_ERROR, "cannot create trace file %s\n", path.c_str());
+		return false;
+	}
+
+	trace_header_t header;
+	memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+	header.version = TRACE_VERSION;
+	header.record_size = sizeof(trace_record_t);
+	header.series_count = series.size();
+	header.reserved = 0;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	// the records of all the series follow the index
+	uint64_t offset = sizeof(header) + series.size() * sizeof(trace_series_t);
+	for(auto &&it : series)
+	{
+		trace_series_t entry;
+		entry.id = it.first;
+		entry.count = it.second.size();
+		entry.offset = offset;
+		file.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+		offset += it.second.size() * sizeof(trace_record_t);
+	}
+	for(auto &&it : series)
+	{
+		file.write(reinterpret_cast<const char *>(it.second.data()),
+		           it.second.size() * sizeof(trace_record_t));
+	}
+
+	if(!file)
+	{
+		DFLTLOG(LEVEL_ERROR, "cannot write trace file %s\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+bool TraceFile::parseText(const std::string &path, std::vector<trace_record_t> &records)
+{
+	std::ifstream file(path);
+	std::string line;
+	unsigned int line_number = 0;
+
+	if(!file)
+	{
+		DFLTLOG(LEVEL_ERROR, "Cannot open file %s\n", path.c_str());
+		return false;
+	}
+
+	records.clear();
+	while(std::getline(file, line))
+	{
+		line_number++;
+
+		// skip line if empty
+		if(line == "" || line[0] == '#')
+		{
+			continue;
+		}
+
+		const char *start = line.c_str();
+		char *end;
+		errno = 0;
+		unsigned long time = strtoul(start, &end, 10);
+		if(end == start || errno != 0)
+		{
+			DFLTLOG(LEVEL_ERROR,
+			        "Bad syntax in file '%s', line %u: there should be a "
+			        "timestamp (integer) instead of '%s'\n",
+			        path.c_str(), line_number, line.c_str());
+			return false;
+		}
+		start = end;
+		double value = strtod(start, &end);
+		if(end == start)
+		{
+			DFLTLOG(LEVEL_ERROR,
+			        "Bad syntax in file '%s', line %u: missing value\n",
+			        path.c_str(), line_number);
+			return false;
+		}
+		records.push_back(trace_record_t{uint32_t(time), 0, value});
+	}
+
+	// sort by time, a time given twice keeps its last value
+	std::stable_sort(records.begin(), records.end(),
+	                 [](const trace_record_t &a, const trace_record_t &b)
+	                 {
+	                     return a.time < b.time;
+	                 });
+	auto last = std::unique(records.rbegin(), records.rend(),
+	                        [](const trace_record_t &a, const trace_record_t &b)
+	                        {
+	                            return a.time == b.time;
+	                        });
+	records.erase(records.begin(), last.base());
+	return true;
+}
+
+
+TraceCursor::TraceCursor():
+	file{nullptr},
+	loaded{},
+	records{nullptr},
+	count{0},
+	position{0},
+	last_time{0}
+{
+}
+
+
+bool TraceCursor::open(const std::string &path, uint32_t id)
+{
+	this->position = 0;
+	this->last_time = 0;
+
+	if(!TraceFile::isBinary(path))
+	{
+		this->file = nullptr;
+		if(!TraceFile::parseText(path, this->loaded))
+		{
+			return false;
+		}
+		this->records = this->loaded.data();
+		this->count = this->loaded.size();
+	}
+	else
+	{
+		this->loaded.clear();
+		this->file = TraceFile::open(path);
+		if(this->file == nullptr)
+		{
+			return false;
+		}
+		if(!this->file->getSeries(id, this->records, this->count))
+		{
+			// a file with a single series is used by everyone
+			auto ids = this->file->getSeriesIds();
+			if(ids.size() != 1 ||
+			   !this->file->getSeries(ids.front(), this->records, this->count))
+			{
+				DFLTLOG(LEVEL_ERROR, "no series %u in trace file %s\n",
+				        id, path.c_str());
+				return false;
+			}
+		}
+	}
+
+	if(this->count == 0)
+	{
+		DFLTLOG(LEVEL_ERROR, "empty trace %s\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+bool TraceCursor::getValue(unsigned int time, double &value)
+{
+	if(time < this->last_time)
+	{
+		// going back in time, search the position again
+		this->position = std::lower_bound(this->records,
+		                                  this->records + this->count,
+		                                  time, recordBefore) - this->records;
+	}
+	else
+	{
+		while(this->position < this->count &&
+		      this->records[this->position].time < time)
+		{
+			this->position++;
+		}
+	}
+	this->last_time = time;
+
+	if(this->position >= this->count)
+	{
+		return false;
+	}
+
+	const trace_record_t &next = this->records[this->position];
+	if(this->position == 0 || next.time == time)
+	{
+		value = next.value;
+		return true;
+	}
+
+	// linear interpolation
+	const trace_record_t &previous = this->records[this->position - 1];
+	double coef = (next.value - previous.value) / (double(next.time) - previous.time);
+	value = previous.value + coef * (time - previous.time);
+	return true;
+}
+
+
+double TraceCursor::getLastValue() const
+{
+	return this->records[this->count - 1].value;
+}
+
+
+double TraceCursor::getMaxValue() const
+{
+	return std::max_element(this->records, this->records + this->count,
+	                        [](const trace_record_t &a, const trace_record_t &b)
+	                        {
+	                            return a.value < b.value;
+	                        })->value;
+}
+
+
+double TraceCursor::rewind()
+{
+	this->position = 0;
+	this->last_time = 0;
+	return this->records[0].value;
+}
@@ -0,0 +1,248 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file TimeSeriesTrace.h
+ * @brief Binary time series traces, memory-mapped and read with a cursor
+ */
+
+#ifndef TIME_SERIES_TRACE_H
+#define TIME_SERIES_TRACE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/// The magic number at the beginning of a binary trace file
+#define TRACE_MAGIC "OSTS"
+/// The version of the binary trace format
+#define TRACE_VERSION 1
+
+
+/**
+ * @brief Header of a binary trace file
+ *
+ * A trace file holds one or several series of samples, for instance one
+ * per terminal. The header is followed by series_count index entries,
+ * then by the records of every series, sorted by time. All the fields
+ * are in host byte order.
+ */
+struct trace_header_t
+{
+	char magic[4];          ///< TRACE_MAGIC
+	uint16_t version;       ///< TRACE_VERSION
+	uint16_t record_size;   ///< the size of a record
+	uint32_t series_count;  ///< the number of series in the file
+	uint32_t reserved;
+};
+
+/**
+ * @brief Index entry of a series in a binary trace file
+ */
+struct trace_series_t
+{
+	uint32_t id;      ///< the series identifier, e.g. a terminal ID
+	uint32_t count;   ///< the number of records in the series
+	uint64_t offset;  ///< the offset of the first record from the file start
+};
+
+/**
+ * @brief A sample of a series
+ */
+struct trace_record_t
+{
+	uint32_t time;  ///< the sample time, in refresh periods
+	uint32_t reserved;
+	double value;   ///< the sample value
+};
+
+
+/**
+ * @class TraceFile
+ * @brief A binary trace file mapped in memory
+ *
+ * A file is mapped once per process and shared by all the cursors
+ * reading one of its series.
+ */
+class TraceFile
+{
+public:
+	~TraceFile();
+
+	/**
+	 * @brief Map a binary trace file, or get the mapping already done
+	 *
+	 * @param path  the trace file path
+	 * @return the mapped file, nullptr on error
+	 */
+	static std::shared_ptr<TraceFile> open(const std::string &path);
+
+	/**
+	 * @brief Check whether a file is a binary trace file
+	 *
+	 * @param path  the file path
+	 * @return true if the file starts with the trace magic number
+	 */
+	static bool isBinary(const std::string &path);
+
+	/**
+	 * @brief Get the records of a series
+	 *
+	 * @param id       the series identifier
+	 * @param records  OUT: the first record of the series
+	 * @param count    OUT: the number of records
+	 * @return true if the series exists, false otherwise
+	 */
+	bool getSeries(uint32_t id, const trace_record_t *&records, uint32_t &count) const;
+
+	/**
+	 * @brief Get the identifiers of the series in the file
+	 *
+	 * @return the series identifiers, in file order
+	 */
+	std::vector<uint32_t> getSeriesIds() const;
+
+	/**
+	 * @brief Write a binary trace file
+	 *
+	 * @param path    the trace file path
+	 * @param series  the records of each series, per identifier,
+	 *                the records are sorted by time
+	 * @return true on success, false otherwise
+	 */
+	static bool write(const std::string &path,
+	                  const std::map<uint32_t, std::vector<trace_record_t>> &series);
+
+	/**
+	 * @brief Parse a text trace file
+	 *
+	 * Each line holds a time and a value separated by spaces, empty lines
+	 * and lines starting with '#' are skipped. A time given twice keeps
+	 * its last value.
+	 *
+	 * @param path     the text file path
+	 * @param records  OUT: the records sorted by time
+	 * @return true on success, false otherwise
+	 */
+	static bool parseText(const std::string &path, std::vector<trace_record_t> &records);
+
+private:
+	TraceFile(const std::string &path, void *data, std::size_t length);
+
+	/// the file path
+	std::string path;
+
+	/// the mapped file
+	void *data;
+	std::size_t length;
+
+	/// the index of the series, per identifier
+	std::map<uint32_t, const trace_series_t *> series;
+};
+
+
+/**
+ * @class TraceCursor
+ * @brief Read a series of a trace with an interpolating cursor
+ *
+ * Reading a time greater than the previous one only advances the
+ * cursor, so a trace read at each refresh period costs O(1) per read.
+ */
+class TraceCursor
+{
+public:
+	TraceCursor();
+
+	/**
+	 * @brief Open a series in a text or binary trace file
+	 *
+	 * A text file holds a single series. In a binary file, the series
+	 * with the given identifier is read, or the only series of the file
+	 * if there is no such series.
+	 *
+	 * @param path  the trace file path
+	 * @param id    the series identifier
+	 * @return true on success, false otherwise
+	 */
+	bool open(const std::string &path, uint32_t id = 0);
+
+	/**
+	 * @brief Get the value at a given time
+	 *
+	 * The value is linearly interpolated between the surrounding records,
+	 * the first record gives the value before it.
+	 *
+	 * @param time   the time, in refresh periods
+	 * @param value  OUT: the value
+	 * @return true on success, false if time is after the last record
+	 */
+	bool getValue(unsigned int time, double &value);
+
+	/**
+	 * @brief Get the value of the last record
+	 *
+	 * @return the last value
+	 */
+	double getLastValue() const;
+
+	/**
+	 * @brief Get the maximum value of the series
+	 *
+	 * @return the maximum value
+	 */
+	double getMaxValue() const;
+
+	/**
+	 * @brief Get the value of the first record and rewind the cursor
+	 *
+	 * @return the first value
+	 */
+	double rewind();
+
+private:
+	/// the mapped file of a binary trace
+	std::shared_ptr<TraceFile> file;
+
+	/// the records of a text trace
+	std::vector<trace_record_t> loaded;
+
+	/// the records of the series
+	const trace_record_t *records;
+	uint32_t count;
+
+	/// the first record whose time is not lesser than the last read time
+	uint32_t position;
+	unsigned int last_time;
+};
+
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file TraceConvert.cpp
+ * @brief Convert text attenuation or delay traces into a binary trace file
+ *
+ * usage: opensand_trace_convert OUTPUT [ID:]TEXT_FILE...
+ *
+ * Each text file becomes one series of the binary trace, identified by
+ * the entity ID given before its path or by its rank on the command line.
+ */
+
+
+#include "TimeSeriesTrace.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+
+int main(int argc, char **argv)
+{
+	std::map<uint32_t, std::vector<trace_record_t>> series;
+
+	if(argc < 3)
+	{
+		fprintf(stderr, "usage: %s OUTPUT [ID:]TEXT_FILE...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	for(int arg = 2; arg < argc; ++arg)
+	{
+		std::string path = argv[arg];
+		uint32_t id = arg - 2;
+
+		std::size_t separator = path.find(':');
+		if(separator != std::string::npos)
+		{
+			char *end;
+			id = strtoul(path.c_str(), &end, 10);
+			if(end != path.c_str() + separator)
+			{
+				fprintf(stderr, "bad series ID in '%s'\n", argv[arg]);
+				return EXIT_FAILURE;
+			}
+			path = path.substr(separator + 1);
+		}
+
+		if(series.count(id) != 0)
+		{
+			fprintf(stderr, "series %u given twice\n", id);
+			return EXIT_FAILURE;
+		}
+		if(!TraceFile::parseText(path, series[id]))
+		{
+			fprintf(stderr, "cannot read text trace '%s'\n", path.c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(!TraceFile::write(argv[1], series))
+	{
+		fprintf(stderr, "cannot write binary trace '%s'\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -235,8 +235,6 @@ UdpChannel::UdpChannel(std::string name,
 		    "channel doesn't receive and doesn't send data\n");
 		goto error;
 	}
-	bzero(this->send_buffer, sizeof(this->send_buffer));
-
 	LOG(this->log_init, LEVEL_NOTICE,
 	    "UDP channel %u created with local IP %s and local "
 	    "port %u\n", getChannelID(),
@@ -381,19 +379,19 @@ int UdpChannel::receive(NetSocketEvent *const event,
 		goto error;
 	}
 
-	// we need to memcpy as the start pointer cannot be reused
+	// strip the sequencing field in place rather than in a copy,
+	// the buffer start has to be kept as it will be freed
 	recv_len = event->getSize() - 1;
-	recv_data = (unsigned char *)calloc(recv_len, sizeof(unsigned char));
 	data = event->getData();
-	memcpy(recv_data, data + 1, recv_len);
+	nb_sequencing = data[0];
+	memmove(data, data + 1, recv_len);
+	recv_data = data;
 	remote_addr = event->getSrcAddr();
 
 	// get the IP address of the sender
 	ip_address = inet_ntoa(remote_addr.sin_addr);
 
 	// check the sequencing of the datagramm
-	nb_sequencing = data[0];
-	free(data);
 	ip_count_it = this->udp_counters.find(ip_address);
 	if(ip_count_it == this->udp_counters.end())
 	{
@@ -526,6 +524,16 @@ void UdpChannel::handleStack(unsigned char **buf, size_t &data_len,
 
 bool UdpChannel::send(const unsigned char *data, size_t length)
 {
+	struct iovec iov[2];
+	iov[1].iov_base = const_cast<unsigned char *>(data);
+	iov[1].iov_len = length;
+	return this->send(iov, 2);
+}
+
+
+bool UdpChannel::send(struct iovec *iov, size_t iov_count)
+{
+	struct msghdr msg;
 	ssize_t slen;
 
 	LOG(this->log_sat_carrier, LEVEL_INFO,
@@ -548,18 +556,24 @@ bool UdpChannel::send(const unsigned char *data, size_t length)
 		goto error;
 	}
 
-	// add a sequencing field
-	bzero(this->send_buffer, sizeof(this->send_buffer));
-	this->send_buffer[0] = this->counter;
-	memcpy(send_buffer + 1, data, length);
-	slen = length + 1;
+	// add a sequencing field in the reserved buffer
+	iov[0].iov_base = &this->counter;
+	iov[0].iov_len = sizeof(this->counter);
+	slen = 0;
+	for(size_t i = 0; i < iov_count; ++i)
+	{
+		slen += iov[i].iov_len;
+	}
 
-	if(sendto(this->sock_channel, this->send_buffer, slen, 0,
-	          (struct sockaddr *) &this->m_remoteIPAddress,
-	          sizeof(this->m_remoteIPAddress)) < slen)
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_name = &this->m_remoteIPAddress;
+	msg.msg_namelen = sizeof(this->m_remoteIPAddress);
+	msg.msg_iov = iov;
+	msg.msg_iovlen = iov_count;
+	if(sendmsg(this->sock_channel, &msg, 0) < slen)
 	{
 		LOG(this->log_sat_carrier, LEVEL_ERROR,
-		    "Error:  sendto(..,0,..) errno %s (%d)\n",
+		    "Error:  sendmsg(..,0,..) errno %s (%d)\n",
 		    strerror(errno), errno);
 		goto error;
 	}
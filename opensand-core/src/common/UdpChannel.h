@@ -38,6 +38,7 @@
 
 
 #include <netinet/in.h>
+#include <sys/uio.h>
 
 #include <map>
 #include <string>
@@ -92,6 +93,17 @@ public:
 	 * @return true on success, false otherwise
 	 */
 	bool send(const unsigned char *data, std::size_t length);
+
+	/**
+	 * @brief Send data gathered from several buffers on the satellite
+	 *        carrier, in a single datagram and without copy
+	 *
+	 * @param iov        The buffers to send, the first one is reserved
+	 *                   for the channel sequencing field
+	 * @param iov_count  The number of buffers, including the reserved one
+	 * @return true on success, false otherwise
+	 */
+	bool send(struct iovec *iov, std::size_t iov_count);
 	int receive(NetSocketEvent *const event,
 	            unsigned char **buf,
 	            std::size_t &data_len);
@@ -160,9 +172,6 @@ protected:
 	/// Counter for sending packets
 	uint8_t counter;
 
-	/// internal buffer to build and send udp datagramms
-	unsigned char send_buffer[MAX_SOCK_SIZE];
-
 	/// sometimes an UDP datagram containing unfragmented IP packet overtake one
 	/// containing fragmented IP packets during its reassembly
 	/// Thus, we use the stacks per IP sources to keep the UDP datagram arrived too early
@@ -0,0 +1,695 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Micro-benchmark for encapsulation plugins
+ *
+ * The application generates a synthetic flow of 802.1Q tagged Ethernet
+ * frames (IMIX sizes, several PCP values and several destination
+ * terminals), then pushes it through the same path as the emulator:
+ * Ethernet lan adaptation, encapsulation context, packing into frames of
+ * fixed size with encapNextPacket, extraction with getEncapsulatedPackets
+ * then decapsulation back to Ethernet frames.
+ *
+ * Each decapsulated frame is compared with the generated one and the
+ * application reports packets/s, bytes/s, allocations per packet and the
+ * 99th percentile of the per-packet processing time for each scheme.
+ *
+ * Launch the application with -h to learn how to use it.
+ */
+
+// OpenSAND includes
+#include "EncapPlugin.h"
+#include "LanAdaptationPlugin.h"
+#include "Plugin.h"
+#include "NetBurst.h"
+#include "NetPacket.h"
+#include "MacAddress.h"
+#include "Ethernet.h"
+#include "PacketSwitch.h"
+#include "OpenSandModelConf.h"
+
+#include <opensand_output/Output.h>
+
+// system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <new>
+#include <sstream>
+#include <algorithm>
+#include <arpa/inet.h>
+
+
+/// The program version
+#define VERSION   "Encapsulation plugins benchmark application, version 0.1\n"
+
+/// The program usage
+#define USAGE \
+"Encapsulation plugins benchmark application: measure the encapsulation plugins with synthetic traffic\n\n\
+usage: bench [-h] [-v] [-d level] [-n count] [-b burst] [-c dst] [-f length] [-e schemes] profile\n\
+\t-h         print this usage and exit\n\
+\t-v         print version information and exit\n\
+\t-d level   print debug information\n\
+\t-n count   number of Ethernet frames to send for each scheme (default: 100000)\n\
+\t-b burst   number of Ethernet frames handled per burst (default: 1)\n\
+\t-c dst     number of destination terminals, from 1 to 30 (default: 8)\n\
+\t-f length  length of the frames carrying encapsulated packets in bytes\n\
+\t           (default: 4026 for GSE, 536 for RLE)\n\
+\t-e schemes comma separated list of encapsulation schemes (default: GSE,RLE)\n\
+\tprofile    profile with the network and encap sections (see bench_profile.xml)\n\n"
+
+
+static unsigned int verbose;
+
+/** DEBUG macro */
+#define INFO(format, ...) \
+	do { \
+		if(verbose) \
+			printf(format, ##__VA_ARGS__); \
+	} while(0)
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+/// The terminal ID of the emulated gateway sending the traffic
+constexpr tal_id_t BENCH_GW_ID = 0;
+
+/// The maximum number of destinations, RLE labels carry 5 bits terminal IDs
+constexpr unsigned int BENCH_MAX_DST = 30;
+
+/// The default frame length for GSE: a normal BBFrame with QPSK 1/2
+constexpr std::size_t GSE_FRAME_LENGTH = 4026;
+
+/// The default frame length for RLE: a DVB-RCS2 burst
+constexpr std::size_t RLE_FRAME_LENGTH = 536;
+
+/// The length of the 802.1Q tagged Ethernet header
+constexpr std::size_t BENCH_ETH_HDR_LEN = 18;
+
+/// The IMIX frame sizes, in Ethernet frame length, repeated 7:4:1
+static const std::vector<std::size_t> imix_sizes = {
+	64, 576, 64, 64, 576, 64, 1500, 64, 576, 64, 64, 576,
+};
+
+
+/// The number of C++ allocations since the start of the process
+static std::atomic<unsigned long> allocations_count{0};
+
+void *operator new(std::size_t size)
+{
+	allocations_count.fetch_add(1, std::memory_order_relaxed);
+	void *ptr = malloc(size ? size : 1);
+	if(!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+	free(ptr);
+}
+
+
+/**
+ * @brief The results of a benchmark run
+ */
+struct bench_result_t
+{
+	unsigned long packets;
+	unsigned long bytes;
+	unsigned long frames;
+	unsigned long allocations;
+	unsigned long mismatches;
+	double duration_s;
+	std::vector<double> samples_ns;
+};
+
+
+/**
+ * @brief The state of the frame currently filled by the scheduler
+ */
+struct bench_frame_t
+{
+	Data payload;
+	unsigned int packets_count;
+};
+
+
+static bool run_bench(EncapPlugin *plugin,
+                      LanAdaptationPlugin::LanAdaptationContext *lan_context,
+                      const std::vector<Data> &flow,
+                      unsigned int count,
+                      unsigned int burst_size,
+                      std::size_t frame_length,
+                      bench_result_t &result);
+static bool close_frame(EncapPlugin *plugin,
+                        LanAdaptationPlugin::LanAdaptationContext *lan_context,
+                        bench_frame_t &frame,
+                        std::deque<const Data *> &expected,
+                        bench_result_t &result);
+static void generate_flow(unsigned int dst_count,
+                          unsigned int count,
+                          std::vector<Data> &flow);
+static MacAddress get_terminal_mac(unsigned int index);
+static void print_result(const std::string &name, std::size_t frame_length,
+                         bench_result_t &result);
+
+
+int main(int argc, char *argv[])
+{
+	std::string profile_filename = "";
+	std::string schemes = "GSE,RLE";
+	unsigned int count = 100000;
+	unsigned int burst_size = 1;
+	unsigned int dst_count = 8;
+	std::size_t frame_length = 0;
+	int args_used;
+	bool success = true;
+
+	if(argc <= 1)
+	{
+		ERROR(USAGE);
+		return EXIT_FAILURE;
+	}
+
+	for(argc--, argv++; argc > 0; argc -= args_used, argv += args_used)
+	{
+		args_used = 1;
+
+		if(!strcmp(*argv, "-v"))
+		{
+			// print version
+			ERROR(VERSION);
+			return EXIT_FAILURE;
+		}
+		else if(!strcmp(*argv, "-h"))
+		{
+			// print help
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-d"))
+		{
+			verbose = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-n"))
+		{
+			count = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-b"))
+		{
+			burst_size = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-c"))
+		{
+			dst_count = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-f"))
+		{
+			frame_length = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-e"))
+		{
+			schemes = argv[1];
+			args_used++;
+		}
+		else if(profile_filename.empty())
+		{
+			profile_filename = argv[0];
+		}
+		else
+		{
+			// do not accept more than one filename without option name
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(profile_filename.empty() || count == 0 || burst_size == 0 ||
+	   dst_count == 0 || dst_count > BENCH_MAX_DST)
+	{
+		ERROR(USAGE);
+		return EXIT_FAILURE;
+	}
+
+	// load the plugins and the parts of the profile they need
+	if(!Plugin::loadPlugins(false))
+	{
+		ERROR("cannot load the plugins\n");
+		return EXIT_FAILURE;
+	}
+	auto Conf = OpenSandModelConf::Get();
+	Conf->createModels();
+	Ethernet::generateConfiguration();
+	Plugin::generatePluginsConfiguration(nullptr,
+	                                     PluginType::Encapsulation,
+	                                     "encapsulation_scheme",
+	                                     "Encapsulation Scheme");
+	if(!Conf->readProfile(profile_filename))
+	{
+		ERROR("cannot load profile '%s'\n", profile_filename.c_str());
+		Plugin::releasePlugins();
+		return EXIT_FAILURE;
+	}
+	Output::Get()->finalizeConfiguration();
+
+	// the emulated gateway knows the MAC address of each terminal
+	GatewayPacketSwitch packet_switch{BENCH_GW_ID};
+	for(unsigned int i = 0; i < dst_count; ++i)
+	{
+		std::unique_ptr<MacAddress> mac{new MacAddress(get_terminal_mac(i))};
+		packet_switch.getSarpTable()->add(std::move(mac), i + 1);
+	}
+
+	LanAdaptationPlugin *lan_plugin = Ethernet::constructPlugin();
+	if(!lan_plugin)
+	{
+		ERROR("cannot initialize the Ethernet lan adaptation\n");
+		Plugin::releasePlugins();
+		return EXIT_FAILURE;
+	}
+	LanAdaptationPlugin::LanAdaptationContext *lan_context = lan_plugin->getContext();
+	if(!lan_context->setUpperPacketHandler(nullptr) ||
+	   !lan_context->initLanAdaptationContext(BENCH_GW_ID, &packet_switch))
+	{
+		ERROR("cannot use Ethernet for generated frames\n");
+		Plugin::releasePlugins();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Data> flow;
+	generate_flow(dst_count, count, flow);
+	INFO("%zu Ethernet frames generated for %u destinations\n",
+	     flow.size(), dst_count);
+
+	std::stringstream scheme_list(schemes);
+	std::string name;
+	while(std::getline(scheme_list, name, ','))
+	{
+		EncapPlugin *plugin = nullptr;
+		bench_result_t result{};
+
+		if(!Plugin::getEncapsulationPlugin(name, &plugin))
+		{
+			ERROR("failed to initialize plugin %s\n", name.c_str());
+			success = false;
+			continue;
+		}
+		if(!plugin->getContext()->setUpperPacketHandler(lan_plugin->getPacketHandler()))
+		{
+			ERROR("%s does not support %s as upper layer\n",
+			      name.c_str(), lan_plugin->getName().c_str());
+			success = false;
+			continue;
+		}
+
+		std::size_t length = frame_length;
+		if(length == 0)
+		{
+			length = (name == "RLE") ? RLE_FRAME_LENGTH : GSE_FRAME_LENGTH;
+		}
+
+		if(!run_bench(plugin, lan_context, flow, count, burst_size, length, result))
+		{
+			ERROR("FAILURE %s\n", name.c_str());
+			success = false;
+		}
+		print_result(name, length, result);
+		if(result.mismatches > 0 || result.packets != count)
+		{
+			success = false;
+		}
+	}
+
+	Plugin::releasePlugins();
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+/**
+ * @brief Push the flow through a Ethernet/encapsulation stack
+ *
+ * @param plugin        The encapsulation plugin
+ * @param lan_context   The Ethernet lan adaptation context
+ * @param flow          The generated Ethernet frames
+ * @param count         The number of frames to send
+ * @param burst_size    The number of frames handled per burst
+ * @param frame_length  The length of the frames carrying encapsulated packets
+ * @param result        OUT: the measurements
+ *
+ * @return true on success, false otherwise
+ */
+static bool run_bench(EncapPlugin *plugin,
+                      LanAdaptationPlugin::LanAdaptationContext *lan_context,
+                      const std::vector<Data> &flow,
+                      unsigned int count,
+                      unsigned int burst_size,
+                      std::size_t frame_length,
+                      bench_result_t &result)
+{
+	EncapPlugin::EncapContext *context = plugin->getContext();
+	EncapPlugin::EncapPacketHandler *handler = plugin->getPacketHandler();
+	std::map<int, long> time_contexts;
+	std::deque<const Data *> expected;
+	bench_frame_t frame;
+	unsigned int sent = 0;
+
+	frame.payload.reserve(frame_length);
+	frame.packets_count = 0;
+	result.samples_ns.reserve(count / burst_size + 1);
+
+	unsigned long allocations_start = allocations_count.load();
+	auto bench_start = std::chrono::steady_clock::now();
+	while(sent < count)
+	{
+		unsigned int burst_length = std::min(burst_size, count - sent);
+		auto burst_start = std::chrono::steady_clock::now();
+
+		// frames read on the TAP interface
+		NetBurst *packets = new NetBurst();
+		for(unsigned int i = 0; i < burst_length; ++i)
+		{
+			const Data &eth_frame = flow[(sent + i) % flow.size()];
+			packets->add(std::unique_ptr<NetPacket>{new NetPacket(eth_frame.data(), eth_frame.length())});
+			expected.push_back(&eth_frame);
+		}
+		sent += burst_length;
+
+		// lan adaptation then encapsulation
+		packets = lan_context->encapsulate(packets, time_contexts);
+		if(packets)
+		{
+			packets = context->encapsulate(packets, time_contexts);
+		}
+		NetBurst *flushed = context->flushAll();
+		if(flushed)
+		{
+			if(!packets)
+			{
+				packets = new NetBurst();
+			}
+			for(auto&& packet : *flushed)
+			{
+				packets->add(std::move(packet));
+			}
+			delete flushed;
+		}
+		if(!packets)
+		{
+			continue;
+		}
+
+		// pack the encapsulated packets in frames as the DVB schedulings do
+		for(auto&& packet : *packets)
+		{
+			std::unique_ptr<NetPacket> encap_packet = std::move(packet);
+			while(encap_packet)
+			{
+				std::unique_ptr<NetPacket> data;
+				std::unique_ptr<NetPacket> remaining_data;
+				if(!handler->encapNextPacket(std::move(encap_packet),
+				                             frame_length - frame.payload.length(),
+				                             frame.packets_count == 0,
+				                             data, remaining_data))
+				{
+					ERROR("%s failed to pack a packet in a %zu bytes frame\n",
+					      plugin->getName().c_str(), frame_length);
+					delete packets;
+					return false;
+				}
+				if(data)
+				{
+					frame.payload.append(data->getRawData(), data->getTotalLength());
+					frame.packets_count++;
+				}
+				else if(frame.packets_count == 0)
+				{
+					ERROR("%s cannot put any data in an empty %zu bytes frame\n",
+					      plugin->getName().c_str(), frame_length);
+					delete packets;
+					return false;
+				}
+				if(remaining_data || frame.payload.length() >= frame_length)
+				{
+					// the frame is full, send it
+					if(!close_frame(plugin, lan_context, frame, expected, result))
+					{
+						delete packets;
+						return false;
+					}
+				}
+				encap_packet = std::move(remaining_data);
+			}
+		}
+		delete packets;
+
+		auto burst_end = std::chrono::steady_clock::now();
+		result.samples_ns.push_back(
+			std::chrono::duration<double, std::nano>(burst_end - burst_start).count() / burst_length);
+	}
+	// send the last incomplete frame
+	if(!close_frame(plugin, lan_context, frame, expected, result))
+	{
+		return false;
+	}
+	auto bench_end = std::chrono::steady_clock::now();
+
+	result.allocations = allocations_count.load() - allocations_start;
+	result.duration_s = std::chrono::duration<double>(bench_end - bench_start).count();
+	result.mismatches += expected.size();
+	return true;
+}
+
+
+/**
+ * @brief Extract and decapsulate the packets of a frame, then compare
+ *        the Ethernet frames with the ones sent
+ *
+ * @param plugin       The encapsulation plugin
+ * @param lan_context  The Ethernet lan adaptation context
+ * @param frame        The frame to send, emptied on return
+ * @param expected     The Ethernet frames sent and not received yet
+ * @param result       OUT: the measurements
+ *
+ * @return true on success, false otherwise
+ */
+static bool close_frame(EncapPlugin *plugin,
+                        LanAdaptationPlugin::LanAdaptationContext *lan_context,
+                        bench_frame_t &frame,
+                        std::deque<const Data *> &expected,
+                        bench_result_t &result)
+{
+	std::vector<std::unique_ptr<NetPacket>> decap_packets;
+	bool partial_decap;
+
+	if(frame.packets_count == 0)
+	{
+		return true;
+	}
+
+	std::unique_ptr<NetContainer> received{new NetPacket(frame.payload.data(),
+	                                                     frame.payload.length())};
+	unsigned int packets_count = frame.packets_count;
+	frame.payload.clear();
+	frame.packets_count = 0;
+	result.frames++;
+
+	if(!plugin->getPacketHandler()->getEncapsulatedPackets(std::move(received),
+	                                                       partial_decap,
+	                                                       decap_packets,
+	                                                       packets_count))
+	{
+		ERROR("%s failed to extract packets from frame #%lu\n",
+		      plugin->getName().c_str(), result.frames);
+		return false;
+	}
+
+	NetBurst *packets = new NetBurst();
+	for(auto&& packet : decap_packets)
+	{
+		packets->add(std::move(packet));
+	}
+	packets = plugin->getContext()->deencapsulate(packets);
+	if(packets && !packets->empty())
+	{
+		packets = lan_context->deencapsulate(packets);
+	}
+	if(!packets)
+	{
+		return true;
+	}
+
+	for(auto&& packet : *packets)
+	{
+		if(expected.empty() ||
+		   packet->getTotalLength() != expected.front()->length() ||
+		   memcmp(packet->getRawData(), expected.front()->data(),
+		          packet->getTotalLength()) != 0)
+		{
+			INFO("[packet #%lu] %s round trip differs from the sent frame\n",
+			     result.packets + 1, plugin->getName().c_str());
+			result.mismatches++;
+		}
+		if(!expected.empty())
+		{
+			expected.pop_front();
+		}
+		result.packets++;
+		result.bytes += packet->getTotalLength();
+	}
+	delete packets;
+	return true;
+}
+
+
+/**
+ * @brief Generate 802.1Q tagged Ethernet frames with IMIX sizes, going
+ *        to several terminals with several PCP values
+ *
+ * @param dst_count  The number of destination terminals
+ * @param count      The number of frames that will be sent
+ * @param flow       OUT: the generated frames
+ */
+static void generate_flow(unsigned int dst_count,
+                          unsigned int count,
+                          std::vector<Data> &flow)
+{
+	// enough frames to combine sizes, destinations and PCP values
+	std::size_t flow_length = std::min<std::size_t>(count,
+	                                                imix_sizes.size() * dst_count * 8);
+	MacAddress src_mac(0x02, 0x00, 0x00, 0x00, 0x00, 0xff);
+
+	flow.reserve(flow_length);
+	for(std::size_t i = 0; i < flow_length; ++i)
+	{
+		std::size_t length = imix_sizes[i % imix_sizes.size()];
+		MacAddress dst_mac = get_terminal_mac(i % dst_count);
+		uint16_t pcp = (i / dst_count) % 8;
+		uint16_t tci = htons((pcp << 13) | (i % 4095 + 1));
+		uint16_t tpid = htons(to_underlying(NET_PROTO::IEEE_802_1Q));
+		uint16_t ether_type = htons(to_underlying(NET_PROTO::IPV4));
+		Data eth_frame;
+
+		eth_frame.reserve(length);
+		for(unsigned int j = 0; j < 6; ++j)
+		{
+			eth_frame.push_back(dst_mac.at(j));
+		}
+		for(unsigned int j = 0; j < 6; ++j)
+		{
+			eth_frame.push_back(src_mac.at(j));
+		}
+		eth_frame.append((const unsigned char *)&tpid, sizeof(tpid));
+		eth_frame.append((const unsigned char *)&tci, sizeof(tci));
+		eth_frame.append((const unsigned char *)&ether_type, sizeof(ether_type));
+		for(std::size_t j = BENCH_ETH_HDR_LEN; j < length; ++j)
+		{
+			eth_frame.push_back((i + j) & 0xff);
+		}
+		flow.push_back(eth_frame);
+	}
+}
+
+
+/**
+ * @brief Get the MAC address of a destination terminal
+ *
+ * @param index  The index of the terminal
+ * @return the MAC address of the terminal
+ */
+static MacAddress get_terminal_mac(unsigned int index)
+{
+	return MacAddress(0x02, 0x00, 0x00, 0x00, 0x00, index + 1);
+}
+
+
+/**
+ * @brief Print the measurements of a benchmark run
+ *
+ * @param name          The name of the encapsulation scheme
+ * @param frame_length  The length of the frames carrying encapsulated packets
+ * @param result        The measurements
+ */
+static void print_result(const std::string &name, std::size_t frame_length,
+                         bench_result_t &result)
+{
+	double p99_ns = 0.0;
+	if(!result.samples_ns.empty())
+	{
+		std::size_t rank = (result.samples_ns.size() * 99) / 100;
+		rank = std::min(rank, result.samples_ns.size() - 1);
+		std::nth_element(result.samples_ns.begin(),
+		                 result.samples_ns.begin() + rank,
+		                 result.samples_ns.end());
+		p99_ns = result.samples_ns[rank];
+	}
+	double duration_s = result.duration_s > 0 ? result.duration_s : 1.0;
+	unsigned long packets = result.packets > 0 ? result.packets : 1;
+
+	printf("%s (%zu bytes frames): %lu packets in %lu frames, %.0f packets/s, "
+	       "%.0f bytes/s, %.2f allocations/packet, p99 %.0f ns/packet, "
+	       "%lu round trip errors\n",
+	       name.c_str(), frame_length, result.packets, result.frames,
+	       result.packets / duration_s, result.bytes / duration_s,
+	       (double)result.allocations / packets, p99_ns,
+	       result.mismatches);
+}
@@ -406,7 +406,7 @@ static bool test_iter(std::string src_filename, std::string encap_filename,
 	NetBurst::iterator it;
 	NetBurst::iterator it2;
 
-	std::map<long, int> time_contexts;
+	std::map<int, long> time_contexts;
 
 	unsigned int counter_src = 0;
 	unsigned int counter_encap = 0;
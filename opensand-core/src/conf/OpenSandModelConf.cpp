@@ -87,6 +87,8 @@ void OpenSandModelConf::createModels()
 	types->addEnumType("log_level", "Log Level", {"debug", "info", "notice", "warning", "error", "critical"});
 	types->addEnumType("entity_type", "Entity Type", {"Gateway", "Gateway Net Access", "Gateway Phy", "Satellite", "Terminal"});
 	types->addEnumType("isl_type", "Type of ISL", {"LanAdaptation", "Interconnect", "None"});
+	types->addEnumType("interco_transport", "Interconnect Transport", {"UDP", "TCP", "Unix", "SharedMemory"});
+	types->addEnumType("interco_compression", "Interconnect Compression", {"None", "Headers", "Headers and Payloads"});
 
 	auto entity = infrastructure_model->getRoot()->addComponent("entity", "Emulated Entity");
 	auto entity_type = entity->addParameter("entity_type", "Entity Type", types->getType("entity_type"));
@@ -127,6 +129,15 @@ void OpenSandModelConf::createModels()
 		interco_params->addParameter("interco_udp_stack", "UDP Stack (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_rmem", "UDP RMem (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_wmem", "UDP WMem (Interconnect)", types->getType("int"))->setAdvanced(true);
+		interco_params->addParameter("interco_transport", "Transport (Interconnect)", types->getType("interco_transport"),
+		                             "Datagrams, length-prefixed frames over a TCP or a Unix socket stream, "
+		                             "or a shared memory ring for co-located processes")->setAdvanced(true);
+		interco_params->addParameter("interco_socket_dir", "Unix Socket Directory (Interconnect)", types->getType("string"))->setAdvanced(true);
+		interco_params->addParameter("interco_compression", "Compression (Interconnect)", types->getType("interco_compression"),
+		                             "Code the packets metadata of the messages sent, "
+		                             "and compress the messages above the threshold")->setAdvanced(true);
+		interco_params->addParameter("interco_compression_threshold", "Compression Threshold (Interconnect)", types->getType("int"),
+		                             "Minimum size of the messages to compress")->setAdvanced(true);
 
 		// LanAdaptation params
 		auto lan_params = isl_settings->addComponent("lan_adaptation", "Lan Adaptation",
@@ -190,6 +201,15 @@ void OpenSandModelConf::createModels()
 		interco_params->addParameter("interco_udp_stack", "UDP Stack (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_rmem", "UDP RMem (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_wmem", "UDP WMem (Interconnect)", types->getType("int"))->setAdvanced(true);
+		interco_params->addParameter("interco_transport", "Transport (Interconnect)", types->getType("interco_transport"),
+		                             "Datagrams, length-prefixed frames over a TCP or a Unix socket stream, "
+		                             "or a shared memory ring for co-located processes")->setAdvanced(true);
+		interco_params->addParameter("interco_socket_dir", "Unix Socket Directory (Interconnect)", types->getType("string"))->setAdvanced(true);
+		interco_params->addParameter("interco_compression", "Compression (Interconnect)", types->getType("interco_compression"),
+		                             "Code the packets metadata of the messages sent, "
+		                             "and compress the messages above the threshold")->setAdvanced(true);
+		interco_params->addParameter("interco_compression_threshold", "Compression Threshold (Interconnect)", types->getType("int"),
+		                             "Minimum size of the messages to compress")->setAdvanced(true);
 		gateway_net_acc->addParameter("pep_port", "PEP DAMA Port", types->getType("int"))->setAdvanced(true);
 		gateway_net_acc->addParameter("svno_port", "SVNO Port", types->getType("int"))->setAdvanced(true);
 	}
@@ -218,6 +238,15 @@ void OpenSandModelConf::createModels()
 		interco_params->addParameter("interco_udp_stack", "UDP Stack (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_rmem", "UDP RMem (Interconnect)", types->getType("int"))->setAdvanced(true);
 		interco_params->addParameter("interco_udp_wmem", "UDP WMem (Interconnect)", types->getType("int"))->setAdvanced(true);
+		interco_params->addParameter("interco_transport", "Transport (Interconnect)", types->getType("interco_transport"),
+		                             "Datagrams, length-prefixed frames over a TCP or a Unix socket stream, "
+		                             "or a shared memory ring for co-located processes")->setAdvanced(true);
+		interco_params->addParameter("interco_socket_dir", "Unix Socket Directory (Interconnect)", types->getType("string"))->setAdvanced(true);
+		interco_params->addParameter("interco_compression", "Compression (Interconnect)", types->getType("interco_compression"),
+		                             "Code the packets metadata of the messages sent, "
+		                             "and compress the messages above the threshold")->setAdvanced(true);
+		interco_params->addParameter("interco_compression_threshold", "Compression Threshold (Interconnect)", types->getType("int"),
+		                             "Minimum size of the messages to compress")->setAdvanced(true);
 		gateway_phy->addParameter("emu_address", "Emulation Address", types->getType("string"), "Address this gateway should listen on for messages from the satellite");
 		gateway_phy->addParameter("ctrl_multicast_address", "Multicast IP Address (Control Messages)", types->getType("string"))->setAdvanced(true);
 		gateway_phy->addParameter("data_multicast_address", "Multicast IP Address (Data)", types->getType("string"))->setAdvanced(true);
@@ -329,6 +358,11 @@ void OpenSandModelConf::createModels()
 	                    "Default Gateway ID for a packet destination when the MAC "
 	                    "address is not found in the SARP Table; use -1 to drop "
 	                    "such packets")->setAdvanced(true);
+	auto sarp_aging_time = infra->addParameter("sarp_aging_time", "SARP Aging Time", types->getType("int"),
+	                                           "Lifetime of the MAC addresses learned in the SARP Table "
+	                                           "without traffic from them; use 0 to never remove them");
+	sarp_aging_time->setUnit("s");
+	sarp_aging_time->setAdvanced(true);
 
 
 	topology_model = std::make_shared<OpenSANDConf::MetaModel>("1.0.0");
@@ -1052,6 +1086,11 @@ bool OpenSandModelConf::getSarp(SarpTable& sarp_table) const
 	extractParameterData(infra, "default_gw", default_gw);
 	sarp_table.setDefaultTal(default_gw);
 
+	int aging_time;
+	if (extractParameterData(infra, "sarp_aging_time", aging_time) && aging_time >= 0) {
+		sarp_table.setAgingTime(aging_time);
+	}
+
 	// Broadcast
 	sarp_table.add(make_unique_mac("ff:ff:ff:ff:ff:ff"), 31);
 	// Multicast
@@ -1538,6 +1577,12 @@ std::unordered_set<tal_id_t> OpenSandModelConf::getSatellites() const
 }
 
 
+const std::unordered_map<tal_id_t, Component> &OpenSandModelConf::getEntitiesType() const
+{
+	return entities_type;
+}
+
+
 Component OpenSandModelConf::getEntityType(tal_id_t tal_id) const
 {
 	if (infrastructure == nullptr) {
@@ -1982,31 +2027,8 @@ bool OpenSandModelConf::getInterconnectCarrier(bool upward,
 
 	std::string direction = upward ? "upward_" : "downward_";
 
-	std::shared_ptr<OpenSANDConf::DataComponent> interco_params;
-	if (type == "sat")
-	{
-		auto isl_settings = infrastructure->getRoot()
-		                        ->getComponent("entity")
-		                        ->getComponent("entity_" + type)
-		                        ->getList("isl_settings")
-		                        ->getItems();
-		if (isl_settings.size() <= isl_index)
-		{
-			LOG(log, LEVEL_ERROR, "ISL configuration #%d requested but this satellite only have %d.",
-			    isl_index, isl_settings.size());
-			return false;
-		}
-		interco_params = std::dynamic_pointer_cast<OpenSANDConf::DataComponent>(isl_settings[isl_index])
-		                     ->getComponent("interconnect_params");
-	}
-	else
-	{
-		interco_params = infrastructure->getRoot()
-		                     ->getComponent("entity")
-		                     ->getComponent("entity_" + type)
-		                     ->getComponent("interconnect_params");
-	}
-	if (!extractParameterData(interco_params, "interconnect_remote", remote))
+	auto interco_params = this->getInterconnectParams(type, isl_index);
+	if (interco_params == nullptr || !extractParameterData(interco_params, "interconnect_remote", remote))
 	{
 		return false;
 	}
@@ -2032,6 +2054,102 @@ bool OpenSandModelConf::getInterconnectCarrier(bool upward,
 }
 
 
+bool OpenSandModelConf::getInterconnectTransport(std::string &transport,
+                                                 std::string &socket_dir,
+                                                 std::size_t isl_index) const
+{
+	if (infrastructure == nullptr) {
+		return false;
+	}
+
+	std::string type;
+	tal_id_t id;
+	if (!this->getComponentType(type, id)) {
+		return false;
+	}
+
+	if (type != "gw_net_acc" && type != "gw_phy" && type != "sat")
+	{
+		return false;
+	}
+
+	auto interco_params = this->getInterconnectParams(type, isl_index);
+	if (interco_params == nullptr)
+	{
+		return false;
+	}
+
+	transport = "UDP";
+	extractParameterData(interco_params, "interco_transport", transport);
+	socket_dir = "/tmp";
+	extractParameterData(interco_params, "interco_socket_dir", socket_dir);
+
+	return true;
+}
+
+
+bool OpenSandModelConf::getInterconnectCompression(std::string &compression,
+                                                   unsigned int &threshold,
+                                                   std::size_t isl_index) const
+{
+	if (infrastructure == nullptr) {
+		return false;
+	}
+
+	std::string type;
+	tal_id_t id;
+	if (!this->getComponentType(type, id)) {
+		return false;
+	}
+
+	if (type != "gw_net_acc" && type != "gw_phy" && type != "sat")
+	{
+		return false;
+	}
+
+	auto interco_params = this->getInterconnectParams(type, isl_index);
+	if (interco_params == nullptr)
+	{
+		return false;
+	}
+
+	compression = "None";
+	extractParameterData(interco_params, "interco_compression", compression);
+	int threshold_value = 256;
+	extractParameterData(interco_params, "interco_compression_threshold", threshold_value);
+	threshold = threshold_value;
+
+	return true;
+}
+
+
+std::shared_ptr<OpenSANDConf::DataComponent> OpenSandModelConf::getInterconnectParams(const std::string &type,
+                                                                                     std::size_t isl_index) const
+{
+	if (type == "sat")
+	{
+		auto isl_settings = infrastructure->getRoot()
+		                        ->getComponent("entity")
+		                        ->getComponent("entity_" + type)
+		                        ->getList("isl_settings")
+		                        ->getItems();
+		if (isl_settings.size() <= isl_index)
+		{
+			LOG(log, LEVEL_ERROR, "ISL configuration #%d requested but this satellite only have %d.",
+			    isl_index, isl_settings.size());
+			return nullptr;
+		}
+		return std::dynamic_pointer_cast<OpenSANDConf::DataComponent>(isl_settings[isl_index])
+		           ->getComponent("interconnect_params");
+	}
+
+	return infrastructure->getRoot()
+	           ->getComponent("entity")
+	           ->getComponent("entity_" + type)
+	           ->getComponent("interconnect_params");
+}
+
+
 bool OpenSandModelConf::getTerminalAffectation(spot_id_t &default_spot_id,
                                                std::string &default_category_name,
                                                std::map<tal_id_t, std::pair<spot_id_t, std::string>> &terminal_categories) const
@@ -199,6 +199,7 @@ public:
 	bool getGwWithCarrierId(unsigned int carrier_id, tal_id_t &gw) const;
 	bool isGw(tal_id_t gw_id) const;
 	std::unordered_set<tal_id_t> getSatellites() const;
+	const std::unordered_map<tal_id_t, Component> &getEntitiesType() const;
 	Component getEntityType(tal_id_t tal_id) const;
 	bool getScpcEnabled(bool &scpc_enabled) const;
 	bool getScpcEncapStack(std::vector<std::string> &encap_stack) const;
@@ -213,6 +214,12 @@ public:
 	                            unsigned int &udp_rmem,
 	                            unsigned int &udp_wmem,
 								std::size_t isl_index = 0) const;
+	bool getInterconnectTransport(std::string &transport,
+	                              std::string &socket_dir,
+	                              std::size_t isl_index = 0) const;
+	bool getInterconnectCompression(std::string &compression,
+	                                unsigned int &threshold,
+	                                std::size_t isl_index = 0) const;
 	bool getTerminalAffectation(spot_id_t &default_spot_id,
 	                            std::string &default_category_name,
 	                            std::map<tal_id_t, std::pair<spot_id_t, std::string>> &terminal_categories) const;
@@ -238,6 +245,8 @@ private:
 	std::unordered_map<spot_id_t, SpotTopology> spots_topology;
 
 	bool getSpotCarriers(uint16_t gw_id, OpenSandModelConf::spot &spot, bool forward) const;
+	std::shared_ptr<OpenSANDConf::DataComponent> getInterconnectParams(const std::string &type,
+	                                                                   std::size_t isl_index) const;
 };
 
 
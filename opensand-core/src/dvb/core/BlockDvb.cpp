@@ -36,6 +36,7 @@
 
 #include "BlockDvb.h"
 #include "BBFrame.h"
+#include "DvbFrameBatch.h"
 #include "Sac.h"
 #include "Ttp.h"
 
@@ -149,6 +150,14 @@ bool BlockDvb::DvbDownward::sendBursts(std::list<DvbFrame *> *complete_frames,
 	LOG(this->log_send, LEVEL_DEBUG,
 	    "send all %zu complete DVB frames...\n",
 	    complete_frames->size());
+	if(complete_frames->size() > 1)
+	{
+		// hand the whole burst to the lower layer in a single message
+		status = this->sendDvbFrames(complete_frames, carrier_id);
+		complete_frames->clear();
+		return status;
+	}
+
 	for(auto&& frame: *complete_frames)
 	{
 		// Send DVB frames to lower layer
@@ -169,6 +178,50 @@ bool BlockDvb::DvbDownward::sendBursts(std::list<DvbFrame *> *complete_frames,
 }
 
 
+bool BlockDvb::DvbDownward::sendDvbFrames(std::list<DvbFrame *> *frames,
+                                          uint8_t carrier_id)
+{
+	bool status = true;
+	auto batch = new DvbFrameBatch(InternalMessageType::unknown);
+	batch->reserve(frames->size());
+
+	for(auto&& frame: *frames)
+	{
+		if(!frame || frame->getTotalLength() <= 0)
+		{
+			LOG(this->log_send, LEVEL_ERROR,
+			    "empty frame, header and payload are not present\n");
+			delete frame;
+			status = false;
+			continue;
+		}
+		frame->setCarrierId(carrier_id);
+		batch->push(frame);
+	}
+
+	if(batch->empty())
+	{
+		delete batch;
+		return status;
+	}
+
+	// send the frames to the lower layer at once
+	std::size_t count = batch->size();
+	if(!this->enqueueMessage((void **)&batch, 0, to_underlying(InternalMessageType::batch)))
+	{
+		LOG(this->log_send, LEVEL_ERROR,
+		    "failed to send batch of DVB frames to lower layer\n");
+		delete batch;
+		return false;
+	}
+	LOG(this->log_send, LEVEL_INFO,
+	    "batch of %zu complete DVB frames sent to carrier %u\n",
+	    count, carrier_id);
+
+	return status;
+}
+
+
 bool BlockDvb::DvbDownward::sendDvbFrame(DvbFrame *dvb_frame,
                                          uint8_t carrier_id)
 {
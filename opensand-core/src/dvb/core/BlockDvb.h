@@ -158,6 +158,16 @@ public:
 		 */
 		bool sendDvbFrame(DvbFrame *frame, uint8_t carrier_id);
 
+		/**
+		 * @brief Send a single message to lower layer with all the given
+		 *        DVB frames
+		 *
+		 * @param frames      the DVB frames to put in the message
+		 * @param carrier_id  the carrier ID used to send the message
+		 * @return            true on success, false otherwise
+		 */
+		bool sendDvbFrames(std::list<DvbFrame *> *frames, uint8_t carrier_id);
+
 		virtual bool handleDvbFrame(DvbFrame *frame) = 0;
 		
 		/**
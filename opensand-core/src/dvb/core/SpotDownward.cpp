@@ -40,6 +40,7 @@
 #include "DamaCtrlRcs2Legacy.h"
 #include "DamaCtrlRcs2.h"
 #include "Scheduling.h"
+#include "SchedulingWorkers.h"
 #include "SlottedAlohaNcc.h"
 #include "SvnoRequest.h"
 #include "FileSimulator.h"
@@ -48,6 +49,7 @@
 #include "FifoElement.h"
 
 #include <errno.h>
+#include <chrono>
 #include <opensand_output/OutputEvent.h>
 
 
@@ -63,6 +65,10 @@ SpotDownward::SpotDownward(spot_id_t spot_id,
 	DvbFmt(),
 	dama_ctrl(NULL),
 	scheduling(),
+	scheduling_workers(NULL),
+	scheduling_tasks(),
+	scheduled_frames(),
+	scheduling_time(0),
 	fwd_frame_counter(0),
 	ctrl_carrier_id(),
 	sof_carrier_id(),
@@ -86,6 +92,8 @@ SpotDownward::SpotDownward(spot_id_t spot_id,
 	simulate(none_simu),
 	probe_gw_l2_to_sat_total(),
 	l2_to_sat_total_bytes(),
+	probe_scheduling_duration(),
+	probe_scheduling_total_duration(),
 	probe_frame_interval(NULL),
 	probe_sent_modcod(NULL),
 	log_request_simulation(NULL),
@@ -110,6 +118,10 @@ SpotDownward::~SpotDownward()
 
 	delete this->dama_ctrl;
 
+	// stop the workers before deleting the schedulers they use
+	delete this->scheduling_workers;
+	this->scheduling_tasks.clear();
+
 	for (auto& it : this->scheduling)
 	{
 		delete it.second;
@@ -208,6 +220,17 @@ void SpotDownward::generateConfiguration(std::shared_ptr<OpenSANDConf::MetaParam
 	Conf->setProfileReference(fca, disable_ctrl_plane, false);
 	auto dama_algo = conf->addParameter("dama_algorithm", "DAMA Algorithm", types->getType("dama_algorithm"));
 	Conf->setProfileReference(dama_algo, disable_ctrl_plane, false);
+	auto skip_idle = conf->addParameter("ttp_skip_idle",
+	                                    "Skip Idle Time Plans",
+	                                    types->getType("bool"),
+	                                    "Do not send the TTP entries of terminals without "
+	                                    "allocation whose MODCOD did not change");
+	Conf->setProfileReference(skip_idle, disable_ctrl_plane, false);
+	conf->addParameter("fwd_scheduling_threads",
+	                   "Forward Scheduling Threads",
+	                   types->getType("int"),
+	                   "Number of threads scheduling the terminal categories "
+	                   "concurrently, 0 or 1 to schedule them sequentially");
 }
 
 
@@ -262,6 +285,13 @@ bool SpotDownward::onInit(void)
 		return false;
 	}
 
+	if(!this->initSchedulingWorkers())
+	{
+		LOG(this->log_init_channel, LEVEL_ERROR,
+		    "failed to initialize the scheduling workers\n");
+		return false;
+	}
+
 	this->initStatsTimer(this->fwd_down_frame_duration_ms);
 
 	if(!this->initRequestSimulation())
@@ -405,6 +435,63 @@ bool SpotDownward::initMode(void)
 }
 
 
+bool SpotDownward::initSchedulingWorkers(void)
+{
+	auto network = OpenSandModelConf::Get()->getProfileData()->getComponent("network");
+
+	// optional, schedule sequentially if not set
+	int nb_threads;
+	if(!OpenSandModelConf::extractParameterData(network->getParameter("fwd_scheduling_threads"), nb_threads))
+	{
+		nb_threads = 1;
+	}
+	if(nb_threads < 0)
+	{
+		LOG(this->log_init_channel, LEVEL_ERROR,
+		    "invalid number of forward scheduling threads %d\n",
+		    nb_threads);
+		return false;
+	}
+
+	// no need for more threads than categories
+	unsigned int threads = std::min<unsigned int>(nb_threads, this->scheduling.size());
+	if(threads <= 1)
+	{
+		return true;
+	}
+	if(!this->pkt_hdl->isEncapReentrant())
+	{
+		LOG(this->log_init_channel, LEVEL_WARNING,
+		    "%s encapsulation cannot be used from several threads, "
+		    "the categories will be scheduled sequentially\n",
+		    this->pkt_hdl->getName().c_str());
+		return true;
+	}
+
+	// each category fills its own list, so the tasks share nothing but
+	// the FMT simulation which is protected
+	for (auto&& it : this->scheduling)
+	{
+		const std::string &label = it.first;
+		Scheduling *scheduler = it.second;
+		std::list<DvbFrame *> *frames = &this->scheduled_frames[label];
+
+		this->scheduling_tasks.push_back([this, &label, scheduler, frames]()
+		{
+			return this->scheduleCategory(label, scheduler, frames,
+			                              this->scheduling_time);
+		});
+	}
+	this->scheduling_workers = new SchedulingWorkers(threads);
+
+	LOG(this->log_init_channel, LEVEL_NOTICE,
+	    "%zu categories scheduled on %u threads\n",
+	    this->scheduling.size(), threads);
+
+	return true;
+}
+
+
 // TODO this function is NCC part but other functions are related to GW,
 //      we could maybe create two classes inside the block to keep them separated
 bool SpotDownward::initDama(void)
@@ -558,6 +645,14 @@ bool SpotDownward::initDama(void)
 	}
 	this->dama_ctrl->setRecordFile(this->event_file);
 
+	// optional, keep sending all the Time Plans if not set
+	bool ttp_skip_idle;
+	if(!OpenSandModelConf::extractParameterData(ncc->getParameter("ttp_skip_idle"), ttp_skip_idle))
+	{
+		ttp_skip_idle = false;
+	}
+	this->dama_ctrl->setTtpSkipIdle(ttp_skip_idle);
+
 	return true;
 
 release_dama:
@@ -868,7 +963,15 @@ bool SpotDownward::initOutput(void)
 		this->probe_gw_l2_to_sat_total[cat_label] =
 		    output->registerProbe<int>(prefix + cat_label + ".Throughputs.L2_to_SAT_after_sched.total",
 		                               "Kbits/s", true, SAMPLE_AVG);
+		this->probe_scheduling_duration[cat_label] =
+		    output->registerProbe<int>(prefix + cat_label + ".Scheduling.Duration",
+		                               "us", true, SAMPLE_AVG);
 	}
+	// compared to the sum of the categories durations,
+	// shows the gain of the parallel scheduling
+	this->probe_scheduling_total_duration =
+	    output->registerProbe<int>(prefix + "Scheduling.Duration",
+	                               "us", true, SAMPLE_AVG);
 
 	return true;
 }
@@ -1202,34 +1305,81 @@ bool SpotDownward::handleFwdFrameTimer(time_sf_t fwd_frame_counter)
 	// schedule encapsulation packets
 	// TODO In regenerative mode we should schedule in frame_timer ??
 	// do not schedule on all categories, in regenerative we only schedule on the GW category
-	for (auto&& it : this->scheduling)
+	auto start = std::chrono::steady_clock::now();
+	this->scheduling_time = getCurrentTime();
+	if(this->scheduling_workers)
 	{
-		uint32_t remaining_alloc_sym = 0;
-		std::string label = it.first;
-		Scheduling *scheduler = it.second;
-
-		if(!scheduler->schedule(this->fwd_frame_counter,
-		                        getCurrentTime(),
-		                        &this->complete_dvb_frames,
-		                        remaining_alloc_sym))
+		if(!this->scheduling_workers->run(this->scheduling_tasks))
 		{
-			LOG(this->log_receive_channel, LEVEL_ERROR,
-			    "failed to schedule encapsulation "
-			    "packets stored in DVB FIFO for category %s\n",
-			    label.c_str());
 			return false;
 		}
-
-		LOG(this->log_receive_channel, LEVEL_INFO,
-		    "SF#%u: %u symbols remaining after "
-		    "scheduling in category %s\n", this->super_frame_counter,
-		    remaining_alloc_sym, label.c_str());
+		// merge in the categories order so the sent frames do not depend
+		// on the threads timing
+		for (auto&& it : this->scheduled_frames)
+		{
+			this->complete_dvb_frames.splice(this->complete_dvb_frames.end(),
+			                                 it.second);
+		}
+	}
+	else
+	{
+		for (auto&& it : this->scheduling)
+		{
+			if(!this->scheduleCategory(it.first, it.second,
+			                           &this->complete_dvb_frames,
+			                           this->scheduling_time))
+			{
+				return false;
+			}
+		}
+	}
+	auto duration = std::chrono::steady_clock::now() - start;
+	if(this->probe_scheduling_total_duration)
+	{
+		this->probe_scheduling_total_duration->put(
+		    std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
 	}
 
 	return true;
 
 }
 
+bool SpotDownward::scheduleCategory(const std::string &label,
+                                    Scheduling *scheduler,
+                                    std::list<DvbFrame *> *frames,
+                                    clock_t current_time)
+{
+	uint32_t remaining_alloc_sym = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	if(!scheduler->schedule(this->fwd_frame_counter,
+	                        current_time,
+	                        frames,
+	                        remaining_alloc_sym))
+	{
+		LOG(this->log_receive_channel, LEVEL_ERROR,
+		    "failed to schedule encapsulation "
+		    "packets stored in DVB FIFO for category %s\n",
+		    label.c_str());
+		return false;
+	}
+
+	LOG(this->log_receive_channel, LEVEL_INFO,
+	    "SF#%u: %u symbols remaining after "
+	    "scheduling in category %s\n", this->super_frame_counter,
+	    remaining_alloc_sym, label.c_str());
+
+	auto probe = this->probe_scheduling_duration.find(label);
+	if(probe != this->probe_scheduling_duration.end())
+	{
+		auto duration = std::chrono::steady_clock::now() - start;
+		probe->second->put(
+		    std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+	}
+
+	return true;
+}
+
 void SpotDownward::updateFmt(void)
 {
 	if(!this->dama_ctrl)
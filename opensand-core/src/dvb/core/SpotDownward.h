@@ -37,7 +37,9 @@
 #ifndef SPOT_DOWNWARD_H
 #define SPOT_DOWNWARD_H
 
+#include <functional>
 #include <list>
+#include <vector>
 #include <opensand_rt/Types.h>
 
 #include "DvbChannel.h"
@@ -52,6 +54,7 @@ class SvnoRequest;
 class Ttp;
 class DamaCtrlRcs2;
 class Scheduling;
+class SchedulingWorkers;
 class RequestSimulator;
 
 
@@ -201,6 +204,29 @@ protected:
 	 */
 	bool initMode(void);
 
+	/**
+	 * @brief Start the workers scheduling the categories concurrently
+	 *        if more than one thread is configured
+	 *
+	 * @return  true on success, false otherwise
+	 */
+	bool initSchedulingWorkers(void);
+
+	/**
+	 * @brief Schedule the packets of one category for the current
+	 *        forward frame
+	 *
+	 * @param label         The category label
+	 * @param scheduler     The category scheduler
+	 * @param frames        OUT: the list the scheduled frames are added to
+	 * @param current_time  The current time
+	 * @return  true on success, false otherwise
+	 */
+	bool scheduleCategory(const std::string &label,
+	                      Scheduling *scheduler,
+	                      std::list<DvbFrame *> *frames,
+	                      clock_t current_time);
+
 	/**
 	 * Read configuration for the DAMA algorithm
 	 *
@@ -257,6 +283,20 @@ protected:
 	/// The uplink or forward scheduling per category
 	std::map<std::string, Scheduling*> scheduling;
 
+	/// The workers scheduling the categories concurrently, NULL if the
+	/// categories are scheduled sequentially
+	SchedulingWorkers *scheduling_workers;
+
+	/// The scheduling task of each category when using the workers
+	std::vector<std::function<bool(void)>> scheduling_tasks;
+
+	/// The frames scheduled by each category when using the workers,
+	/// merged in the categories order once all are scheduled
+	std::map<std::string, std::list<DvbFrame *>> scheduled_frames;
+
+	/// The time of the current forward scheduling
+	clock_t scheduling_time;
+
 	/// counter for forward frames
 	time_sf_t fwd_frame_counter;
 
@@ -333,6 +373,9 @@ protected:
 	std::map<std::string, ProbeListPerId> probe_gw_l2_to_sat_after_sched;
 	std::map<std::string, std::shared_ptr<Probe<int>>> probe_gw_l2_to_sat_total;
 	std::map<std::string, int> l2_to_sat_total_bytes;
+	// Scheduling duration, per category and for the whole frame
+	std::map<std::string, std::shared_ptr<Probe<int>>> probe_scheduling_duration;
+	std::shared_ptr<Probe<int>> probe_scheduling_total_duration;
 	// Frame interval
 	std::shared_ptr<Probe<float>> probe_frame_interval;
 	// Physical layer information
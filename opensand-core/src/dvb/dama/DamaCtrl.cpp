@@ -48,6 +48,7 @@
 DamaCtrl::DamaCtrl(spot_id_t spot):
 	is_parent_init(false),
 	terminals(), // TODO not very useful, they are stored in categories
+	terminal_table(),
 	current_superframe_sf(0),
 	frame_duration_ms(0),
 	rbdc_timeout_sf(0),
@@ -61,6 +62,8 @@ DamaCtrl::DamaCtrl(spot_id_t spot):
 	input_sts(NULL),
 	input_modcod_def(NULL),
 	simulated(false),
+	event_file(NULL),
+	ttp_skip_idle(false),
 	spot_id(spot)
 {
 	// Output Log
@@ -89,6 +92,7 @@ DamaCtrl::~DamaCtrl()
 		delete it->second;
 	}
 	this->terminals.clear();
+	this->terminal_table.clear();
 
 	for(cat_it = this->categories.begin();
 	    cat_it != this->categories.end(); ++cat_it)
@@ -345,6 +349,11 @@ bool DamaCtrl::hereIsLogon(const LogonRequest *logon)
 
 		// Add the new terminal to the list
 		this->terminals.insert({tal_id, terminal});
+		if(tal_id >= this->terminal_table.size())
+		{
+			this->terminal_table.resize(tal_id + 1, NULL);
+		}
+		this->terminal_table[tal_id] = terminal;
 
 		// add terminal in category and inform terminal of its category
 		category->addTerminal(terminal);
@@ -423,6 +432,7 @@ bool DamaCtrl::hereIsLogoff(const Logoff *logoff)
 
 	// remove terminal from the list
 	this->terminals.erase(terminal->getTerminalId());
+	this->terminal_table[terminal->getTerminalId()] = NULL;
 
 	// remove terminal from the terminal category
 	category_it = this->categories.find(terminal->getCurrentCategory());
@@ -572,6 +582,11 @@ void DamaCtrl::setRecordFile(FILE *event_stream)
 	DC_RECORD_EVENT("%s", "# --------------------------------------\n");
 }
 
+void DamaCtrl::setTtpSkipIdle(bool skip_idle)
+{
+	this->ttp_skip_idle = skip_idle;
+}
+
 // TODO disable timers on probes if output is disabled
 // and event to reactivate them ?!
 void DamaCtrl::updateStatistics(time_ms_t UNUSED(period_ms))
@@ -648,13 +663,10 @@ TerminalCategories<TerminalCategoryDama> *DamaCtrl::getCategories()
 
 TerminalContextDama *DamaCtrl::getTerminalContext(tal_id_t tal_id) const
 {
-	DamaTerminalList::const_iterator it;
-
-	it = this->terminals.find(tal_id);
-	if(it == this->terminals.end())
+	if(tal_id >= this->terminal_table.size())
 	{
 		return NULL;
 	}
 
-	return it->second;
+	return this->terminal_table[tal_id];
 }
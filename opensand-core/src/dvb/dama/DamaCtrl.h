@@ -168,6 +168,16 @@ public:
 	 */
 	virtual void setRecordFile(FILE * event_stream);
 
+	/**
+	 * @brief Do not send the Time Plans of terminals without allocation
+	 *        when their MODCOD did not change since the last sent TP,
+	 *        a terminal without TP in the TTP has no allocation and keeps
+	 *        its MODCOD
+	 *
+	 * @param skip_idle  Whether idle Time Plans are skipped
+	 */
+	void setTtpSkipIdle(bool skip_idle);
+
 	/**
 	 * @brief    Get a pointer to the categories
 	 * @warning  the categories can be modified
@@ -312,6 +322,10 @@ protected:
 	/** List of registered terminals */
 	DamaTerminalList terminals;
 
+	/** The registered terminals indexed by terminal ID for constant time
+	 *  lookup on each received SAC (NULL if not registered) */
+	std::vector<TerminalContextDama *> terminal_table;
+
 	/** Current SuperFrame number */
 	time_sf_t current_superframe_sf;
 
@@ -361,6 +375,9 @@ protected:
 	/// if set to other than NULL, the fd where recording events
 	FILE *event_file;
 
+	/// Whether the TP of idle terminals with unchanged MODCOD are skipped
+	bool ttp_skip_idle;
+
 	/// Output probe and stats
 
 	typedef std::map<tal_id_t, std::shared_ptr<Probe<int> > > ProbeListPerTerminal;
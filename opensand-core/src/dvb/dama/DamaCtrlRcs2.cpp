@@ -50,7 +50,8 @@
  */
 DamaCtrlRcs2::DamaCtrlRcs2(spot_id_t spot):
 	DamaCtrl(spot),
-	converter(NULL)
+	converter(NULL),
+	ttp_fmt_ids()
 {
 }
 
@@ -113,7 +114,7 @@ bool DamaCtrlRcs2::hereIsSAC(const Sac *sac)
 	vol_kb_t request_kb;
 	rate_kbps_t request_kbps;
 	tal_id_t tal_id = sac->getTerminalId();
-	std::vector<cr_info_t> requests = sac->getRequests();
+	uint8_t cr_number = sac->getRequestsNumber();
 
 	// Checking if the station is registered
 	// if we get GW terminal ID this is for physical layer parameters
@@ -125,9 +126,17 @@ bool DamaCtrlRcs2::hereIsSAC(const Sac *sac)
 		    "Discarded.\n" , this->current_superframe_sf, tal_id);
 		goto error;
 	}
+	if(terminal == NULL)
+	{
+		// GW SAC only carries physical layer parameters
+		return true;
+	}
 
-	for (auto&& cr_info: requests)
+	// decode the requests in place in the received frame
+	for(unsigned int i = 0; i < cr_number; i++)
 	{
+		cr_info_t cr_info = sac->getRequest(i);
+
 		// take into account the new request
 		switch(cr_info.type)
 		{
@@ -233,6 +242,20 @@ bool DamaCtrlRcs2::buildTTP(Ttp *ttp)
 			    terminal->getTerminalId(),
 			    total_allocation_kb);
 
+			tal_id_t tal_id = terminal->getTerminalId();
+			if(this->ttp_skip_idle)
+			{
+				if(tal_id >= this->ttp_fmt_ids.size())
+				{
+					this->ttp_fmt_ids.resize(tal_id + 1, -1);
+				}
+				// the terminal would get the same state without TP
+				if(total_allocation_kb == 0 && this->ttp_fmt_ids[tal_id] == int16_t(terminal->getFmtId()))
+				{
+					continue;
+				}
+			}
+
 			//FIXME: is the offset to be 0 ???
 			if(!ttp->addTimePlan(0 /*FIXME: should it be the frame_counter of the bloc_ncc ?*/,
 			                     terminal->getTerminalId(),
@@ -246,6 +269,11 @@ bool DamaCtrlRcs2::buildTTP(Ttp *ttp)
 				    this->current_superframe_sf, terminal->getTerminalId());
 				continue;
 			}
+			if(this->ttp_skip_idle)
+			{
+				// the terminal state is only known once its TP is sent
+				this->ttp_fmt_ids[tal_id] = terminal->getFmtId();
+			}
 		}
 	}
 	ttp->build();
@@ -503,6 +531,12 @@ bool DamaCtrlRcs2::createTerminal(TerminalContextDama **terminal,
 	fmt_id_t fmt_id;
 	TerminalContextDamaRcs *term;
 
+	// a new terminal needs a TP to get its MODCOD
+	if(tal_id < this->ttp_fmt_ids.size())
+	{
+		this->ttp_fmt_ids[tal_id] = -1;
+	}
+
 	term = new TerminalContextDamaRcs(tal_id,
 	                                  cra_kbps,
 	                                  max_rbdc_kbps,
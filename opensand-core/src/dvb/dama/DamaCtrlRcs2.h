@@ -46,6 +46,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <map>
+#include <vector>
 
 
 /**
@@ -83,6 +84,9 @@ public:
 protected:
 	UnitConverter *converter;
 
+	/// The MODCOD of the last TP sent per terminal ID, -1 if none
+	std::vector<int16_t> ttp_fmt_ids;
+
 	/// Create a terminal context
 	virtual bool createTerminal(TerminalContextDama **terminal,
 	                            tal_id_t tal_id,
@@ -100,6 +100,8 @@ ForwardSchedulingS2::ForwardSchedulingS2(time_ms_t fwd_timer_ms,
 	incomplete_bb_frames(),
 	incomplete_bb_frames_ordered(),
 	pending_bbframes(),
+	dst_modcods(),
+	sched_pass(0),
 	fwd_modcod_def(fwd_modcod_def),
 	category(category),
 	spot_id(spot),
@@ -128,14 +130,16 @@ ForwardSchedulingS2::ForwardSchedulingS2(time_ms_t fwd_timer_ms,
 	                                                        "modcod index",
 	                                                        true, SAMPLE_LAST);
 
-	std::vector<CarriersGroupDama *> carriers_group = this->category->getCarriersGroups();
-	for (auto &&carriers: carriers_group)
+	// one BBFrame slot per MODCOD, grown if an unexpected MODCOD shows up
+	this->incomplete_bb_frames.resize(this->fwd_modcod_def->getMaxId() + 1, NULL);
+
+	for (auto &&carriers: this->category->getCarriersGroups())
 	{
 		std::vector<std::shared_ptr<Probe<int>>> remain_probes;
 		std::vector<std::shared_ptr<Probe<int>>> avail_probes;
 		unsigned int carriers_id = carriers->getCarriersId();
 
-		std::vector<CarriersGroupDama *> vcm_carriers = carriers->getVcmCarriers();
+		const std::vector<CarriersGroupDama *> &vcm_carriers = carriers->getVcmCarriers();
 		for(auto *vcm: vcm_carriers)
 		{
 			this->checkBBFrameSize(vcm, vcm_carriers);
@@ -167,9 +171,9 @@ bool ForwardSchedulingS2::schedule(const time_sf_t current_superframe_sf,
                                    uint32_t &remaining_allocation)
 {
 	fifos_t::const_iterator fifo_it;
-	std::vector<CarriersGroupDama *> carriers_group;
-	std::vector<CarriersGroupDama *>::iterator carrier_it;
-	carriers_group = this->category->getCarriersGroups();
+	std::vector<CarriersGroupDama *>::const_iterator carrier_it;
+	// the carriers are owned by the category, no need to copy them
+	const std::vector<CarriersGroupDama *> &carriers_group = this->category->getCarriersGroups();
 	vol_sym_t init_capacity_sym;
 	int total_capa = 0;
 
@@ -178,11 +182,10 @@ bool ForwardSchedulingS2::schedule(const time_sf_t current_superframe_sf,
 	     ++carrier_it)
 	{
 		CarriersGroupDama *carriers = *carrier_it;
-		std::vector<CarriersGroupDama *> vcm_carriers;
-		std::vector<CarriersGroupDama *>::iterator vcm_it;
+		const std::vector<CarriersGroupDama *> &vcm_carriers = carriers->getVcmCarriers();
+		std::vector<CarriersGroupDama *>::const_iterator vcm_it;
 		unsigned int vcm_id = 0;
 
-		vcm_carriers = carriers->getVcmCarriers();
 		// if no VCM, getVcm() will return only one carrier
 		for (vcm_it = vcm_carriers.begin();
 		     vcm_it != vcm_carriers.end();
@@ -294,7 +297,7 @@ bool ForwardSchedulingS2::schedule(const time_sf_t current_superframe_sf,
 				{
 					unsigned int modcod = (*it)->getModcodId();
 
-					this->incomplete_bb_frames.erase(modcod);
+					this->incomplete_bb_frames[modcod] = NULL;
 					// incomplete ordered erased in loop
 				}
 				else if(ret == status_full)
@@ -325,7 +328,7 @@ bool ForwardSchedulingS2::schedule(const time_sf_t current_superframe_sf,
 		unsigned int carriers_id = carriers->getCarriersId();
 		unsigned int id = 0;
 
-		std::vector<CarriersGroupDama *> vcm_carriers = carriers->getVcmCarriers();
+		const std::vector<CarriersGroupDama *> &vcm_carriers = carriers->getVcmCarriers();
 		for(auto *vcm: vcm_carriers)
 		{
 			unsigned int remain = vcm->getRemainingCapacity();
@@ -387,7 +390,12 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 	FifoElement *elem;
 	long max_to_send;
 	BBFrame *current_bbframe;
-	std::list<fmt_id_t> supported_modcods = carriers->getFmtIds();
+	const std::list<fmt_id_t> &supported_modcods = carriers->getFmtIds();
+	// the packets are dequeued in runs toward the same destination, the
+	// BBFrame of the run is only looked up on the first packet
+	tal_id_t run_tal_id = 0;
+	BBFrame *run_bbframe = NULL;
+	tal_id_t broadcast_tal_id = std::numeric_limits<tal_id_t>::max();
 
 	// retrieve the number of packets waiting for retransmission
 	max_to_send = fifo->getCurrentSize();
@@ -413,7 +421,7 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 	// all the previous capacity was not consumed, remove it as we are not on
 	// pending frames anymore of if there is no incomplete frame
 	// (we consider incomplete frames can use previous capacity)
-	if(this->incomplete_bb_frames.size() == 0)
+	if(this->incomplete_bb_frames_ordered.size() == 0)
 	{
 		capacity_sym = std::min(init_capa, capacity_sym);
 	}
@@ -424,6 +432,9 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 		return true;
 	}
 
+	// MODCODs resolved on other carriers are not relevant anymore
+	this->sched_pass++;
+
 	// there are really packets to send
 	LOG(this->log_scheduling, LEVEL_INFO,
 	    "SF#%u: send at most %ld encapsulation packets "
@@ -465,42 +476,58 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 
 		// retrieve the ST ID associated to the packet
 		tal_id = encap_packet->getDstTalId();
-		// This is a broadcast/multicast destination
-		if(tal_id == BROADCAST_TAL_ID)
+		if(run_bbframe != NULL && tal_id == run_tal_id)
+		{
+			// same destination as the previous packet, keep on filling
+			// the BBFrame of the current run
+			current_bbframe = run_bbframe;
+		}
+		else
 		{
-			// Select the tal_id corresponding to the lower modcod in order to
-			// make all terminal able to read the message
-			tal_id = this->simu_sts->getTalIdWithLowerModcod();
-			if (tal_id == std::numeric_limits<decltype(tal_id)>::max())
+			run_tal_id = tal_id;
+			// This is a broadcast/multicast destination
+			if(tal_id == BROADCAST_TAL_ID)
 			{
-				LOG(this->log_scheduling, LEVEL_ERROR,
-				    "SF#%u: The scheduling of a "
-				    "multicast frame failed\n",
-				    current_superframe_sf);
-				LOG(this->log_scheduling, LEVEL_ERROR,
-				    "SF#%u: The Tal_Id corresponding to "
-				    "the terminal using the lower modcod can not "
-				    "be retrieved\n", current_superframe_sf);
-				return false;
+				// Select the tal_id corresponding to the lower modcod in order to
+				// make all terminal able to read the message
+				if(broadcast_tal_id == std::numeric_limits<tal_id_t>::max())
+				{
+					broadcast_tal_id = this->simu_sts->getTalIdWithLowerModcod();
+				}
+				tal_id = broadcast_tal_id;
+				if (tal_id == std::numeric_limits<decltype(tal_id)>::max())
+				{
+					LOG(this->log_scheduling, LEVEL_ERROR,
+					    "SF#%u: The scheduling of a "
+					    "multicast frame failed\n",
+					    current_superframe_sf);
+					LOG(this->log_scheduling, LEVEL_ERROR,
+					    "SF#%u: The Tal_Id corresponding to "
+					    "the terminal using the lower modcod can not "
+					    "be retrieved\n", current_superframe_sf);
+					delete elem;
+					return false;
+				}
+				LOG(this->log_scheduling, LEVEL_INFO,
+				    "SF#%u: TAL_ID corresponding to lower "
+				    "MODCOD = %u\n", current_superframe_sf,
+				    tal_id);
 			}
-			LOG(this->log_scheduling, LEVEL_INFO,
-			    "SF#%u: TAL_ID corresponding to lower "
-			    "MODCOD = %u\n", current_superframe_sf,
-			    tal_id);
-		}
 
-		if(!this->getIncompleteBBFrame(tal_id, carriers, current_superframe_sf,
-		                               &current_bbframe))
-		{
-			// cannot initialize incomplete BB Frame
-			delete elem;
-			return false;
-		}
-		else if(!current_bbframe)
-		{
-			// cannot get modcod for the ST delete the element
-			delete elem;
-			continue;
+			if(!this->getIncompleteBBFrame(tal_id, carriers, current_superframe_sf,
+			                               &current_bbframe))
+			{
+				// cannot initialize incomplete BB Frame
+				delete elem;
+				return false;
+			}
+			else if(!current_bbframe)
+			{
+				// cannot get modcod for the ST delete the element
+				delete elem;
+				continue;
+			}
+			run_bbframe = current_bbframe;
 		}
 
 		LOG(this->log_scheduling, LEVEL_DEBUG,
@@ -508,7 +535,7 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 		    "there is now %zu complete BBFrames and %zu "
 		    "incomplete\n", current_superframe_sf,
 		    sent_packets + 1, complete_dvb_frames->size(),
-		    this->incomplete_bb_frames.size());
+		    this->incomplete_bb_frames_ordered.size());
 
 		// Encapsulate packet
 		auto encap_packet_total_length = encap_packet->getTotalLength();
@@ -523,6 +550,7 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 			    "#%u\n", current_superframe_sf,
 			    sent_packets + 1);
 			delete elem;
+			continue;
 		}
 
 		bool partial_encap = remaining_data != nullptr;
@@ -593,7 +621,9 @@ bool ForwardSchedulingS2::scheduleEncapPackets(DvbFifo *fifo,
 				unsigned int modcod = current_bbframe->getModcodId();
 
 				this->incomplete_bb_frames_ordered.remove(current_bbframe);
-				this->incomplete_bb_frames.erase(modcod);
+				this->incomplete_bb_frames[modcod] = NULL;
+				// the next packet starts a new run
+				run_bbframe = NULL;
 				if(ret == status_full)
 				{
 					time_sf_t next_sf = current_superframe_sf + 1;
@@ -723,16 +753,22 @@ unsigned int ForwardSchedulingS2::getBBFrameSizeBytes(unsigned int modcod_id)
 
 
 
-bool ForwardSchedulingS2::getIncompleteBBFrame(tal_id_t tal_id,
-                                               CarriersGroupDama *carriers,
-                                               const time_sf_t current_superframe_sf,
-                                               BBFrame **bbframe)
+fmt_id_t ForwardSchedulingS2::getDestinationModcod(tal_id_t tal_id,
+                                                  CarriersGroupDama *carriers,
+                                                  const time_sf_t current_superframe_sf)
 {
-	std::map<unsigned int, BBFrame *>::iterator iter;
 	unsigned int desired_modcod;
-	unsigned int modcod_id;
+	fmt_id_t modcod_id = 0;
 
-	*bbframe = NULL;
+	if(tal_id >= this->dst_modcods.size())
+	{
+		this->dst_modcods.resize(tal_id + 1, {0, 0});
+	}
+	dst_modcod_t &cached = this->dst_modcods[tal_id];
+	if(cached.pass == this->sched_pass)
+	{
+		return cached.modcod;
+	}
 
 	// retrieve the current MODCOD for the ST
 	if(!this->simu_sts->isStPresent(tal_id))
@@ -740,13 +776,13 @@ bool ForwardSchedulingS2::getIncompleteBBFrame(tal_id_t tal_id,
 		LOG(this->log_scheduling, LEVEL_WARNING,
 		    "encapsulation packet is for ST%u that is not registered\n",
 		    tal_id);
-		goto skip;
+		goto end;
 	}
 	desired_modcod = this->getCurrentModcodId(tal_id);
 	if(desired_modcod == 0)
 	{
-		// cannot get modcod for the ST skip this element
-		goto skip;
+		// cannot get modcod for the ST
+		goto end;
 	}
 
 	// get best modcod ID according to carrier
@@ -757,44 +793,65 @@ bool ForwardSchedulingS2::getIncompleteBBFrame(tal_id_t tal_id,
 		    "SF#%u: cannot serve terminal %u with any modcod (desired %u) "
 		    "on carrier %u\n", current_superframe_sf, tal_id, desired_modcod,
 		    carriers->getCarriersId());
-
-		goto skip;
+		goto end;
 	}
 	LOG(this->log_scheduling, LEVEL_DEBUG,
 	    "SF#%u: Available MODCOD for ST id %u = %u\n",
 	    current_superframe_sf, tal_id, modcod_id);
 
+end:
+	cached.pass = this->sched_pass;
+	cached.modcod = modcod_id;
+	return modcod_id;
+}
+
+
+bool ForwardSchedulingS2::getIncompleteBBFrame(tal_id_t tal_id,
+                                               CarriersGroupDama *carriers,
+                                               const time_sf_t current_superframe_sf,
+                                               BBFrame **bbframe)
+{
+	fmt_id_t modcod_id;
+
+	*bbframe = NULL;
+
+	modcod_id = this->getDestinationModcod(tal_id, carriers,
+	                                       current_superframe_sf);
+	if(modcod_id == 0)
+	{
+		// cannot get modcod for the ST skip this element
+		return true;
+	}
+	if(modcod_id >= this->incomplete_bb_frames.size())
+	{
+		this->incomplete_bb_frames.resize(modcod_id + 1, NULL);
+	}
+
 	// find if the BBFrame exists
-	iter = this->incomplete_bb_frames.find(modcod_id);
-	if(iter != this->incomplete_bb_frames.end() && (*iter).second != NULL)
+	if(this->incomplete_bb_frames[modcod_id] != NULL)
 	{
 		LOG(this->log_scheduling, LEVEL_DEBUG,
 		    "SF#%u: Found a BBFrame for MODCOD %u\n",
 		    current_superframe_sf, modcod_id);
-		*bbframe = (*iter).second;
+		*bbframe = this->incomplete_bb_frames[modcod_id];
+		return true;
 	}
+
 	// no BBFrame for this MOCDCOD create a new one
-	else
+	LOG(this->log_scheduling, LEVEL_INFO,
+	    "SF#%u: Create a new BBFrame for MODCOD %u\n",
+	    current_superframe_sf, modcod_id);
+	if(!this->createIncompleteBBFrame(bbframe, current_superframe_sf,
+	                                  modcod_id))
 	{
-		LOG(this->log_scheduling, LEVEL_INFO,
-		    "SF#%u: Create a new BBFrame for MODCOD %u\n",
-		    current_superframe_sf, modcod_id);
-		// if there is no incomplete BB frame create a new one
-		if(!this->createIncompleteBBFrame(bbframe, current_superframe_sf,
-		                                  modcod_id))
-		{
-			goto error;
-		}
-
-		// add the BBFrame in the map and list
-		this->incomplete_bb_frames[modcod_id] = *bbframe;
-		this->incomplete_bb_frames_ordered.push_back(*bbframe);
+		return false;
 	}
 
-skip:
+	// add the BBFrame in the table and list
+	this->incomplete_bb_frames[modcod_id] = *bbframe;
+	this->incomplete_bb_frames_ordered.push_back(*bbframe);
+
 	return true;
-error:
-	return false;
 }
 
 
@@ -843,7 +900,7 @@ sched_status_t ForwardSchedulingS2::addCompleteBBFrame(std::list<DvbFrame *> *co
 }
 
 
-void ForwardSchedulingS2::schedulePending(const std::list<fmt_id_t> supported_modcods,
+void ForwardSchedulingS2::schedulePending(const std::list<fmt_id_t> &supported_modcods,
                                           const time_sf_t current_superframe_sf,
                                           std::list<DvbFrame *> *complete_dvb_frames,
                                           vol_sym_t &remaining_capacity_sym)
@@ -897,12 +954,12 @@ void ForwardSchedulingS2::schedulePending(const std::list<fmt_id_t> supported_mo
 }
 
 void ForwardSchedulingS2::checkBBFrameSize(CarriersGroupDama *vcm,
-                                           std::vector<CarriersGroupDama *> vcm_carriers)
+                                           const std::vector<CarriersGroupDama *> &vcm_carriers)
 {
 	unsigned int vcm_id = 0;
 	vol_sym_t carrier_size_sym = vcm->getTotalCapacity() /
 	                             vcm->getCarriersNumber();
-	std::list<fmt_id_t> fmt_ids = vcm->getFmtIds();
+	const std::list<fmt_id_t> &fmt_ids = vcm->getFmtIds();
 
 	for(std::list<fmt_id_t>::const_iterator fmt_it = fmt_ids.begin();
 	    fmt_it != fmt_ids.end(); ++fmt_it)
@@ -961,7 +1018,7 @@ void ForwardSchedulingS2::checkBBFrameSize(CarriersGroupDama *vcm,
 }
 
 void ForwardSchedulingS2::createProbes(CarriersGroupDama *vcm,
-                                       std::vector<CarriersGroupDama *> vcm_carriers,
+                                       const std::vector<CarriersGroupDama *> &vcm_carriers,
                                        std::vector<std::shared_ptr<Probe<int>>> &remain_probes,
                                        std::vector<std::shared_ptr<Probe<int>>> &avail_probes,
                                        unsigned int carriers_id)
@@ -42,6 +42,8 @@
 #include "BBFrame.h"
 #include "TerminalCategoryDama.h"
 
+#include <vector>
+
 
 /** Status for the carrier capacity */
 typedef enum
@@ -51,6 +53,13 @@ typedef enum
 	status_full,  // The carrier is full, cannot add the BBFrame
 } sched_status_t;
 
+/** The MODCOD resolved for a destination terminal during a scheduling pass */
+typedef struct
+{
+	uint32_t pass;    ///< The scheduling pass the MODCOD was resolved in
+	fmt_id_t modcod;  ///< The MODCOD on the scheduled carriers (0 if unusable)
+} dst_modcod_t;
+
 
 
 /**
@@ -82,8 +91,8 @@ protected:
 	/** The timer for forward scheduling (ms) */
 	time_ms_t fwd_timer_ms;
 
-	/** the BBFrame being built identified by their modcod */
-	std::map<unsigned int, BBFrame *> incomplete_bb_frames;
+	/** the BBFrame being built indexed by their modcod (NULL if none) */
+	std::vector<BBFrame *> incomplete_bb_frames;
 
 	/** the BBframe being built in their created order */
 	std::list<BBFrame *> incomplete_bb_frames_ordered;
@@ -92,6 +101,14 @@ protected:
 	 *  for the corresponding MODCOD */
 	std::list<BBFrame *> pending_bbframes;
 
+	/** The MODCOD of each destination terminal indexed by terminal ID,
+	 *  only valid for the scheduling pass it was resolved in */
+	std::vector<dst_modcod_t> dst_modcods;
+
+	/** The current scheduling pass, incremented on each FIFO/carriers
+	 *  scheduling as the resolved MODCOD depends on the carriers */
+	uint32_t sched_pass;
+
 	/** The FMT Definition Table associed */
 	const FmtDefinitionTable *fwd_modcod_def;
 
@@ -147,6 +164,19 @@ protected:
 	                             const time_sf_t current_superframe_sf,
 	                             unsigned int modcod_id);
 
+	/**
+	 * @brief Get the MODCOD used to serve a terminal on the current carriers,
+	 *        resolved once per scheduling pass
+	 *
+	 * @param tal_id    the terminal ID we want to send the frame
+	 * @param carriers  the carriers group to which the terminal belongs
+	 * @param current_superframe_sf  The current superframe number
+	 * @return the MODCOD ID, 0 if the terminal cannot be served
+	 */
+	fmt_id_t getDestinationModcod(tal_id_t tal_id,
+	                              CarriersGroupDama *carriers,
+	                              const time_sf_t current_superframe_sf);
+
 	/**
 	 * @brief Get the incomplete BBFrame for the current destination terminal
 	 *
@@ -185,7 +215,7 @@ protected:
 	 * @param complete_dvb_frames  IN/OUT: The list of complete DVB frames
 	 * @param capacity_sym         IN/OUT: The remaining capacity on carriers
 	 */
-	void schedulePending(const std::list<fmt_id_t> supported_modcods,
+	void schedulePending(const std::list<fmt_id_t> &supported_modcods,
 	                     const time_sf_t current_superframe_sf,
 	                     std::list<DvbFrame *> *complete_dvb_frames,
 	                     vol_sym_t &remaining_capacity_sym);
@@ -216,7 +246,7 @@ protected:
 	 * @brief  Create the associated probes
 	 */
 	void createProbes(CarriersGroupDama *vcm,
-	                  std::vector<CarriersGroupDama *> vcm_carriers,
+	                  const std::vector<CarriersGroupDama *> &vcm_carriers,
 	                  std::vector<std::shared_ptr<Probe<int>>> &remain_probes,
 	                  std::vector<std::shared_ptr<Probe<int>>> &avail_probes,
 	                  unsigned int carriers_id);
@@ -225,7 +255,7 @@ protected:
 	 * @brief  Check that the size of the carrier is compatible with the BBFrame size
 	 */
 	void checkBBFrameSize(CarriersGroupDama *vcm,
-	                      std::vector<CarriersGroupDama *> vcm_carriers);
+	                      const std::vector<CarriersGroupDama *> &vcm_carriers);
 };
 
 #endif
@@ -0,0 +1,154 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+
+/**
+ * @file SchedulingWorkers.cpp
+ * @brief A small pool of threads running independent schedulings
+ *        of the same frame concurrently
+ */
+
+#include "SchedulingWorkers.h"
+
+
+SchedulingWorkers::SchedulingWorkers(unsigned int nb_threads):
+	workers(),
+	lock(),
+	start_cond(),
+	done_cond(),
+	tasks(nullptr),
+	next_task(0),
+	pending(0),
+	generation(0),
+	failed(false),
+	stopping(false)
+{
+	for(unsigned int i = 1; i < nb_threads; i++)
+	{
+		this->workers.emplace_back(&SchedulingWorkers::work, this);
+	}
+}
+
+SchedulingWorkers::~SchedulingWorkers()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->stopping = true;
+	}
+	this->start_cond.notify_all();
+	for(auto &&worker : this->workers)
+	{
+		worker.join();
+	}
+}
+
+bool SchedulingWorkers::run(const std::vector<task_t> &tasks)
+{
+	if(tasks.empty())
+	{
+		return true;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->tasks = &tasks;
+		this->next_task = 0;
+		this->pending = tasks.size();
+		this->failed = false;
+		this->generation++;
+	}
+	this->start_cond.notify_all();
+
+	// help the workers instead of only waiting for them
+	this->execute();
+
+	std::unique_lock<std::mutex> guard(this->lock);
+	this->done_cond.wait(guard, [this]{ return this->pending == 0; });
+	this->tasks = nullptr;
+	return !this->failed;
+}
+
+unsigned int SchedulingWorkers::getThreadsNumber() const
+{
+	return this->workers.size() + 1;
+}
+
+void SchedulingWorkers::work()
+{
+	unsigned long seen = 0;
+
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> guard(this->lock);
+			this->start_cond.wait(guard, [this, seen]{
+				return this->stopping || this->generation != seen;
+			});
+			if(this->stopping)
+			{
+				return;
+			}
+			seen = this->generation;
+		}
+		this->execute();
+	}
+}
+
+bool SchedulingWorkers::execute()
+{
+	bool success = true;
+
+	while(true)
+	{
+		const task_t *task;
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			if(this->tasks == nullptr || this->next_task >= this->tasks->size())
+			{
+				break;
+			}
+			task = &(*this->tasks)[this->next_task++];
+		}
+
+		bool status = (*task)();
+
+		std::lock_guard<std::mutex> guard(this->lock);
+		if(!status)
+		{
+			this->failed = true;
+			success = false;
+		}
+		this->pending--;
+		if(this->pending == 0)
+		{
+			this->done_cond.notify_all();
+		}
+	}
+	return success;
+}
@@ -0,0 +1,124 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+
+/**
+ * @file SchedulingWorkers.h
+ * @brief A small pool of threads running independent schedulings
+ *        of the same frame concurrently
+ */
+
+#ifndef _SCHEDULING_WORKERS_H_
+#define _SCHEDULING_WORKERS_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * @class SchedulingWorkers
+ * @brief Run a set of scheduling tasks concurrently
+ *
+ * The workers are started once and wait for the tasks of each frame.
+ * The calling thread also executes tasks, so a pool of N threads
+ * only starts N - 1 workers.
+ */
+class SchedulingWorkers
+{
+public:
+	using task_t = std::function<bool(void)>;
+
+	/**
+	 * @brief Create the pool
+	 *
+	 * @param nb_threads  The number of threads running tasks,
+	 *                    including the calling thread
+	 */
+	SchedulingWorkers(unsigned int nb_threads);
+
+	~SchedulingWorkers();
+
+	SchedulingWorkers(const SchedulingWorkers &) = delete;
+	SchedulingWorkers &operator=(const SchedulingWorkers &) = delete;
+
+	/**
+	 * @brief Run all the tasks and wait for their completion
+	 *
+	 * @param tasks  The tasks to run, each one must be independent
+	 *               from the others
+	 * @return true if all the tasks succeeded, false otherwise
+	 */
+	bool run(const std::vector<task_t> &tasks);
+
+	/**
+	 * @brief Get the number of threads running tasks
+	 *
+	 * @return the number of threads, including the calling one
+	 */
+	unsigned int getThreadsNumber() const;
+
+private:
+	/// Worker loop
+	void work();
+
+	/**
+	 * @brief Execute tasks until there is no more to pick
+	 *
+	 * @return false if one of the executed tasks failed
+	 */
+	bool execute();
+
+	/// The worker threads
+	std::vector<std::thread> workers;
+
+	/// Protects the fields below
+	std::mutex lock;
+	/// Signals new tasks or stop to the workers
+	std::condition_variable start_cond;
+	/// Signals the end of the tasks to the caller
+	std::condition_variable done_cond;
+
+	/// The tasks being run
+	const std::vector<task_t> *tasks;
+	/// The index of the next task to pick
+	std::size_t next_task;
+	/// The number of tasks not finished yet
+	std::size_t pending;
+	/// Incremented on each run to wake up the workers
+	unsigned long generation;
+	/// Whether one task failed during the current run
+	bool failed;
+	/// Whether the workers should exit
+	bool stopping;
+};
+
+#endif
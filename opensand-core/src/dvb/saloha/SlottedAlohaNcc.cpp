@@ -43,6 +43,7 @@
 
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
 
 
 // functor for SlottedAlohaPacket comparison
@@ -56,7 +57,8 @@ SlottedAlohaNcc::SlottedAlohaNcc():
 	spot_id(0),
 	terminals(),
 	algo(NULL),
-	simu()
+	simu(),
+	random(time(NULL))
 {
 }
 
@@ -115,6 +117,7 @@ bool SlottedAlohaNcc::init(TerminalCategories<TerminalCategorySaloha> &categorie
                            UnitConverter *converter)
 {
 	std::string algo_name;
+	SalohaSimuAlgo simu_algo;
 	TerminalCategories<TerminalCategorySaloha>::const_iterator cat_iter;
 	auto conf = OpenSandModelConf::Get()->getProfileData()->getComponent("access");
 
@@ -183,10 +186,12 @@ bool SlottedAlohaNcc::init(TerminalCategories<TerminalCategorySaloha> &categorie
 	if (algo_name == "DSA")
 	{
 		this->algo = new SlottedAlohaAlgoDsa();
+		simu_algo = SalohaSimuAlgo::dsa;
 	}
 	else if (algo_name == "CRDSA")
 	{
 		this->algo = new SlottedAlohaAlgoCrdsa();
+		simu_algo = SalohaSimuAlgo::crdsa;
 	}
 	else
 	{
@@ -263,7 +268,8 @@ bool SlottedAlohaNcc::init(TerminalCategories<TerminalCategorySaloha> &categorie
 		SlottedAlohaSimu *simulation = new SlottedAlohaSimu(cat_iter->second,
 		                                                    nb_max_packets,
 		                                                    nb_replicas,
-		                                                    ratio);
+		                                                    ratio,
+		                                                    simu_algo);
 		this->simu.push_back(simulation);
 	}
 
@@ -587,50 +593,27 @@ void SlottedAlohaNcc::removeCollisions(TerminalCategorySaloha *category)
 }
 
 void SlottedAlohaNcc::simulateTraffic(TerminalCategorySaloha *category,
-                                      const SlottedAlohaSimu *simulation)
+                                      SlottedAlohaSimu *simulation)
 {
+	std::map<unsigned int, Slot *> slots = category->getSlots();
+	uint16_t nb_replicas = simulation->getNbReplicas();
+	std::vector<uint16_t> replicas(nb_replicas);
+
 	for(unsigned int cpt = 0; cpt < simulation->getNbTal(); cpt++)
 	{
-		saloha_ts_list_t tmp;
-		saloha_ts_list_t time_slots;
-		saloha_ts_list_t::iterator it;
-		uint16_t slots_per_carrier;
-		uint16_t slot;
-		uint16_t pdu_id;
-
-		slots_per_carrier = floor(category->getSlotsNumber() /
-		                          category->getCarriersNumber());
-
-		// see SlottedAlohaTal
-		tmp.clear();
-		time_slots.clear();
-		while(tmp.size() < simulation->getNbPacketsPerTal())
+		// see SlottedAlohaTal, slots are drawn directly in a flat ordered
+		// list with a per-context generator
+		const std::vector<uint16_t> &time_slots = simulation->drawTimeSlots(this->random);
+		uint16_t pdu_id = 0;
+
+		for(size_t first = 0;
+		    first + nb_replicas <= time_slots.size();
+		    first += nb_replicas)
 		{
-			slot = (rand() / (double)RAND_MAX) * slots_per_carrier;
-			tmp.insert(slot);
-		}
-		for(it = tmp.begin(); it != tmp.end(); ++it)
-		{
-			unsigned int slot_id = *it;
-			slot = (int)((rand() / (double)RAND_MAX) * category->getCarriersNumber()) *
-			       slots_per_carrier + slot_id;
-			time_slots.insert(slot);
-		}
+			std::copy(time_slots.begin() + first,
+			          time_slots.begin() + first + nb_replicas,
+			          replicas.begin());
 
-
-		pdu_id = 0;
-		it = time_slots.begin();
-		while(it != time_slots.end())
-		{
-			std::map<unsigned int, Slot *> slots = category->getSlots();
-			uint16_t nb_replicas = simulation->getNbReplicas();
-			uint16_t replicas[nb_replicas];
-			for(uint16_t rep_cpt = 0; rep_cpt < nb_replicas; rep_cpt++)
-			{
-				replicas[rep_cpt] = *it;
-				it++;
-			}
- 
 			for(uint16_t rep_cpt = 0; rep_cpt < nb_replicas; rep_cpt++)
 			{
 				uint16_t slot_id = replicas[rep_cpt];
@@ -647,7 +630,7 @@ void SlottedAlohaNcc::simulateTraffic(TerminalCategorySaloha *category,
 				// as for request simulation use tal id > BROADCAST_TAL_ID
 				// used for filtering
 				sa_packet->setSrcTalId(BROADCAST_TAL_ID + 1 + cpt);
-				sa_packet->setReplicas(replicas, nb_replicas);
+				sa_packet->setReplicas(replicas.data(), nb_replicas);
 				sa_packet->setTs(slot_id);
 				// no need to check here if id exists as we directly
 				// get info from the map itself to get IDs
@@ -44,6 +44,8 @@
 #include "TerminalContextSaloha.h"
 #include "TerminalCategorySaloha.h"
 #include "SlottedAlohaAlgo.h"
+#include "SlottedAlohaRandom.h"
+#include "SlottedAlohaSimuEngine.h"
 #include "UnitConverter.h"
 #include "opensand_conf/MetaParameter.h"
 
@@ -82,6 +84,9 @@ private:
 	/// Parameters to simulate Slotted Aloha traffic
 	std::vector<SlottedAlohaSimu *> simu;
 
+	/// The generator for simulated traffic
+	SlottedAlohaRandom random;
+
 	typedef std::map<std::string, std::shared_ptr<Probe<int> > > probe_per_cat_t;
 	/// Statistics
 	probe_per_cat_t probe_collisions;
@@ -159,7 +164,7 @@ private:
 	 * @param simulation  The simulation parameters
 	 */
 	void simulateTraffic(TerminalCategorySaloha *category,
-	                     const SlottedAlohaSimu *simulation);
+	                     SlottedAlohaSimu *simulation);
 
 	/**
 	 * Schedule Slotted Aloha packets per category
@@ -233,13 +238,19 @@ public:
 	 * @param nb_max_packets  The maximum number of packets on the category
 	 * @param nb_replicas     The number of replicas
 	 * @param ratio           The ratio of the band the traffic should occupy
+	 * @param algo            The collision resolution algorithm
 	 */
 	SlottedAlohaSimu(const TerminalCategorySaloha *category,
 	                 uint16_t nb_max_packets,
 	                 uint16_t nb_replicas,
-	                 uint8_t ratio):
+	                 uint8_t ratio,
+	                 SalohaSimuAlgo algo):
 		cat_label(category->getLabel()),
-		nb_replicas(nb_replicas)
+		nb_replicas(nb_replicas),
+		engine(floor(category->getSlotsNumber() / category->getCarriersNumber()),
+		       category->getCarriersNumber(),
+		       nb_replicas,
+		       algo)
 	{
 		uint16_t nb_packets;
 		uint16_t nb_slots;
@@ -316,6 +327,17 @@ public:
 		return this->nb_replicas;
 	};
 
+	/**
+	 * @brief Draw the slots used by a simulated terminal on this category
+	 *
+	 * @param random  The generator to use
+	 * @return the ordered slots, valid until next call
+	 */
+	const std::vector<uint16_t> &drawTimeSlots(SlottedAlohaRandom &random)
+	{
+		return this->engine.drawTimeSlots(random, this->nb_packets_per_tal);
+	};
+
 protected:
 	// TODO this would be better to do something more random with mean nbr of pkt per tal,
 	//      mean number of tal
@@ -327,6 +349,8 @@ protected:
 	tal_id_t nb_tal;
 	/// The number of packets per terminal
 	uint16_t nb_packets_per_tal;
+	/// The slots generator
+	SlottedAlohaSimuEngine engine;
 	/// Logger
 	std::shared_ptr<OutputLog> log_init;
 };
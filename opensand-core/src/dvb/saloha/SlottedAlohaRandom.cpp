@@ -0,0 +1,56 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file SlottedAlohaRandom.cpp
+ * @brief A small reentrant pseudo-random generator for Slotted Aloha
+ */
+
+#include "SlottedAlohaRandom.h"
+
+
+SlottedAlohaRandom::SlottedAlohaRandom(uint64_t seed)
+{
+	this->seed(seed);
+}
+
+void SlottedAlohaRandom::seed(uint64_t seed)
+{
+	// splitmix64 spreads the seed so that close seeds (e.g. thread index)
+	// give uncorrelated sequences and the state is never all zeros
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z = z ^ (z >> 31);
+		this->state[i] = uint32_t(z);
+		this->state[i + 1] = uint32_t(z >> 32);
+	}
+}
@@ -0,0 +1,130 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file SlottedAlohaRandom.h
+ * @brief A small reentrant pseudo-random generator for Slotted Aloha
+ *        (xoshiro128**), each instance owns its own state
+ */
+
+#ifndef SALOHA_RANDOM_H
+#define SALOHA_RANDOM_H
+
+#include <stdint.h>
+
+
+/**
+ * @class SlottedAlohaRandom
+ * @brief xoshiro128** generator seeded with splitmix64
+ *
+ * Contrary to rand(), the state is held by the instance so that several
+ * generators can be used concurrently (one per thread) without locking
+ */
+class SlottedAlohaRandom
+{
+public:
+	/**
+	 * @brief Build a generator
+	 *
+	 * @param seed  The seed, two generators with the same seed produce
+	 *              the same sequence
+	 */
+	SlottedAlohaRandom(uint64_t seed);
+
+	/**
+	 * @brief Reset the generator state from a seed
+	 *
+	 * @param seed  The new seed
+	 */
+	void seed(uint64_t seed);
+
+	/**
+	 * @brief Get the next 32 bits random value
+	 *
+	 * @return a random value
+	 */
+	inline uint32_t next()
+	{
+		const uint32_t result = rotl(this->state[1] * 5, 7) * 9;
+		const uint32_t t = this->state[1] << 9;
+
+		this->state[2] ^= this->state[0];
+		this->state[3] ^= this->state[1];
+		this->state[1] ^= this->state[2];
+		this->state[0] ^= this->state[3];
+		this->state[2] ^= t;
+		this->state[3] = rotl(this->state[3], 11);
+
+		return result;
+	};
+
+	/**
+	 * @brief Get a random value in [0, bound[ without modulo bias
+	 *        (Lemire's multiply and reject method)
+	 *
+	 * @param bound  The exclusive upper bound, must not be 0
+	 * @return a random value lower than bound
+	 */
+	inline uint32_t nextBelow(uint32_t bound)
+	{
+		uint64_t product = uint64_t(this->next()) * bound;
+		uint32_t low = uint32_t(product);
+		if(low < bound)
+		{
+			const uint32_t threshold = -bound % bound;
+			while(low < threshold)
+			{
+				product = uint64_t(this->next()) * bound;
+				low = uint32_t(product);
+			}
+		}
+		return product >> 32;
+	};
+
+	/**
+	 * @brief Get a random value in [0, 1[
+	 *
+	 * @return a random value
+	 */
+	inline double nextDouble()
+	{
+		return (this->next() >> 8) * (1.0 / (1U << 24));
+	};
+
+private:
+	static inline uint32_t rotl(const uint32_t x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	};
+
+	/// The generator state
+	uint32_t state[4];
+};
+
+#endif
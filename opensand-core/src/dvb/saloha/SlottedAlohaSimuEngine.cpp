@@ -0,0 +1,263 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file SlottedAlohaSimuEngine.cpp
+ * @brief Slotted Aloha traffic simulation on a flat slot representation
+ */
+
+#include "SlottedAlohaSimuEngine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <thread>
+
+
+SlottedAlohaSimuEngine::SlottedAlohaSimuEngine(uint16_t slots_per_carrier,
+                                               uint16_t carriers_number,
+                                               uint16_t nb_replicas,
+                                               SalohaSimuAlgo algo):
+	slots_per_carrier(std::max<uint16_t>(slots_per_carrier, 1)),
+	// slots are indexed on 16 bits in the category
+	carriers_number(std::min<uint16_t>(std::max<uint16_t>(carriers_number, 1),
+	                                   UINT16_MAX / this->slots_per_carrier)),
+	nb_replicas(std::max<uint16_t>(nb_replicas, 1)),
+	algo(algo),
+	time_slots(),
+	used_time_slots(this->slots_per_carrier, 0),
+	slot_count(this->getSlotsNumber(), 0),
+	slot_xor(this->getSlotsNumber(), 0),
+	replicas(),
+	singletons()
+{
+	this->time_slots.reserve(this->slots_per_carrier);
+	this->singletons.reserve(this->getSlotsNumber());
+}
+
+uint32_t SlottedAlohaSimuEngine::getSlotsNumber() const
+{
+	return uint32_t(this->slots_per_carrier) * this->carriers_number;
+}
+
+uint16_t SlottedAlohaSimuEngine::getCarriersNumber() const
+{
+	return this->carriers_number;
+}
+
+const std::vector<uint16_t> &SlottedAlohaSimuEngine::drawTimeSlots(SlottedAlohaRandom &random,
+                                                                   uint16_t nb_slots)
+{
+	nb_slots = std::min(nb_slots, this->slots_per_carrier);
+	this->time_slots.clear();
+
+	// First step: draw distinct time slots in a carrier (to keep the
+	//             concept of chronology), the marks are reset below so the
+	//             cost only depends on the number of drawn slots
+	while(this->time_slots.size() < nb_slots)
+	{
+		uint16_t slot = random.nextBelow(this->slots_per_carrier);
+		if(!this->used_time_slots[slot])
+		{
+			this->used_time_slots[slot] = 1;
+			this->time_slots.push_back(slot);
+		}
+	}
+	// Second step: move each time slot on a random carrier to simulate
+	//              frequency changes
+	for(auto &&slot : this->time_slots)
+	{
+		this->used_time_slots[slot] = 0;
+		slot += random.nextBelow(this->carriers_number) * this->slots_per_carrier;
+	}
+	std::sort(this->time_slots.begin(), this->time_slots.end());
+	return this->time_slots;
+}
+
+uint32_t SlottedAlohaSimuEngine::simulateFrame(SlottedAlohaRandom &random,
+                                               uint32_t nb_packets)
+{
+	uint32_t nb_decoded = 0;
+
+	std::fill(this->slot_count.begin(), this->slot_count.end(), 0);
+	std::fill(this->slot_xor.begin(), this->slot_xor.end(), 0);
+	this->replicas.resize(size_t(nb_packets) * this->nb_replicas);
+
+	// each packet is sent with its replicas on distinct time slots
+	for(uint32_t pkt = 0; pkt < nb_packets; pkt++)
+	{
+		const std::vector<uint16_t> &slots = this->drawTimeSlots(random,
+		                                                         this->nb_replicas);
+		for(uint16_t rep = 0; rep < slots.size(); rep++)
+		{
+			uint16_t slot = slots[rep];
+			this->replicas[size_t(pkt) * this->nb_replicas + rep] = slot;
+			this->slot_count[slot]++;
+			this->slot_xor[slot] ^= pkt;
+		}
+	}
+
+	switch(this->algo)
+	{
+		case SalohaSimuAlgo::dsa:
+			// a packet is decoded if one of its replicas is alone in its slot
+			for(uint32_t pkt = 0; pkt < nb_packets; pkt++)
+			{
+				for(uint16_t rep = 0; rep < this->nb_replicas; rep++)
+				{
+					if(this->slot_count[this->replicas[size_t(pkt) * this->nb_replicas + rep]] == 1)
+					{
+						nb_decoded++;
+						break;
+					}
+				}
+			}
+			break;
+
+		case SalohaSimuAlgo::crdsa:
+			// decode singleton slots then remove the replicas of the decoded
+			// packet from the other slots, which may create new singletons
+			this->singletons.clear();
+			for(uint32_t slot = 0; slot < this->slot_count.size(); slot++)
+			{
+				if(this->slot_count[slot] == 1)
+				{
+					this->singletons.push_back(slot);
+				}
+			}
+			while(!this->singletons.empty())
+			{
+				uint16_t slot = this->singletons.back();
+				this->singletons.pop_back();
+				if(this->slot_count[slot] != 1)
+				{
+					continue;
+				}
+				uint32_t pkt = this->slot_xor[slot];
+				nb_decoded++;
+				for(uint16_t rep = 0; rep < this->nb_replicas; rep++)
+				{
+					uint16_t replica = this->replicas[size_t(pkt) * this->nb_replicas + rep];
+					this->slot_count[replica]--;
+					this->slot_xor[replica] ^= pkt;
+					if(this->slot_count[replica] == 1)
+					{
+						this->singletons.push_back(replica);
+					}
+				}
+			}
+			break;
+	}
+
+	return nb_decoded;
+}
+
+saloha_simu_point_t SlottedAlohaSimuEngine::run(double load,
+                                                unsigned int nb_frames,
+                                                unsigned int nb_threads,
+                                                uint64_t seed) const
+{
+	return this->runCurve(std::vector<double>(1, load),
+	                      nb_frames, nb_threads, seed).front();
+}
+
+std::vector<saloha_simu_point_t> SlottedAlohaSimuEngine::runCurve(const std::vector<double> &loads,
+                                                                  unsigned int nb_frames,
+                                                                  unsigned int nb_threads,
+                                                                  uint64_t seed) const
+{
+	std::vector<saloha_simu_point_t> points(loads.size());
+	std::vector<std::thread> workers;
+	std::atomic<size_t> next_task(0);
+	size_t nb_tasks;
+	unsigned int nb_chunks;
+
+	nb_threads = std::max(nb_threads, 1U);
+	// split each load in as many chunks as threads, a chunk has its own
+	// generator so the results do not depend on the threads scheduling
+	nb_chunks = std::max(std::min(nb_threads, nb_frames), 1U);
+	nb_tasks = loads.size() * nb_chunks;
+
+	std::vector<uint64_t> decoded(nb_tasks, 0);
+	std::vector<uint64_t> sent(nb_tasks, 0);
+	std::vector<uint64_t> frames(nb_tasks, 0);
+
+	auto worker = [&]()
+	{
+		SlottedAlohaSimuEngine engine(*this);
+		size_t task;
+		while((task = next_task++) < nb_tasks)
+		{
+			size_t point = task / nb_chunks;
+			unsigned int chunk = task % nb_chunks;
+			unsigned int chunk_frames = nb_frames / nb_chunks +
+			                            (chunk < nb_frames % nb_chunks ? 1 : 0);
+			uint32_t nb_packets = lround(loads[point] * engine.getSlotsNumber());
+			SlottedAlohaRandom random(seed ^ (uint64_t(task) << 32));
+
+			for(unsigned int frame = 0; frame < chunk_frames; frame++)
+			{
+				decoded[task] += engine.simulateFrame(random, nb_packets);
+			}
+			sent[task] = uint64_t(nb_packets) * chunk_frames;
+			frames[task] = chunk_frames;
+		}
+	};
+
+	for(unsigned int cpt = 1; cpt < std::min<size_t>(nb_threads, nb_tasks); cpt++)
+	{
+		workers.emplace_back(worker);
+	}
+	worker();
+	for(auto &&thread : workers)
+	{
+		thread.join();
+	}
+
+	for(size_t point = 0; point < loads.size(); point++)
+	{
+		saloha_simu_point_t &result = points[point];
+		result.load = loads[point];
+		result.frames = 0;
+		result.sent_packets = 0;
+		result.decoded_packets = 0;
+		for(unsigned int chunk = 0; chunk < nb_chunks; chunk++)
+		{
+			result.frames += frames[point * nb_chunks + chunk];
+			result.sent_packets += sent[point * nb_chunks + chunk];
+			result.decoded_packets += decoded[point * nb_chunks + chunk];
+		}
+		result.throughput = result.frames ?
+		                    double(result.decoded_packets) /
+		                    (double(result.frames) * this->getSlotsNumber()) : 0.0;
+		result.loss_ratio = result.sent_packets ?
+		                    1.0 - double(result.decoded_packets) / result.sent_packets : 0.0;
+	}
+	return points;
+}
@@ -0,0 +1,190 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file SlottedAlohaSimuEngine.h
+ * @brief Slotted Aloha traffic simulation on a flat slot representation,
+ *        used for background load on the NCC and for offline Monte-Carlo
+ *        throughput vs load evaluation of DSA and CRDSA
+ */
+
+#ifndef SALOHA_SIMU_ENGINE_H
+#define SALOHA_SIMU_ENGINE_H
+
+#include "SlottedAlohaRandom.h"
+
+#include <stdint.h>
+#include <vector>
+
+
+/// The collision resolution algorithm used by the simulation
+enum class SalohaSimuAlgo : uint8_t
+{
+	dsa,
+	crdsa,
+};
+
+/// The result of a simulation for a given load
+typedef struct
+{
+	double load;             ///< The offered load (packets per slot)
+	double throughput;       ///< The decoded packets per slot
+	double loss_ratio;       ///< The ratio of packets that were not decoded
+	uint64_t frames;         ///< The number of simulated frames
+	uint64_t sent_packets;   ///< The number of sent packets (without replicas)
+	uint64_t decoded_packets;///< The number of decoded packets
+} saloha_simu_point_t;
+
+
+/**
+ * @class SlottedAlohaSimuEngine
+ * @brief Generate Slotted Aloha slot occupancy and resolve collisions
+ *        without building packets
+ *
+ * Slots are indexed in the category as in SlottedAlohaTal:
+ * carrier * slots_per_carrier + time slot. The occupancy of a frame is kept
+ * in flat arrays (packets count and XOR of the packets indexes per slot) so
+ * that a singleton slot directly gives the packet it carries. This makes DSA
+ * and CRDSA (successive interference cancellation) linear in the number of
+ * replicas.
+ *
+ * An instance holds scratch buffers and must be used by one thread at a time,
+ * run() and runCurve() internally copy it for each worker.
+ */
+class SlottedAlohaSimuEngine
+{
+public:
+	/**
+	 * @brief Constructor
+	 *
+	 * The slots of the category are indexed on 16 bits, the number of
+	 * carriers is limited so that slots_per_carrier * carriers_number
+	 * does not exceed UINT16_MAX.
+	 *
+	 * @param slots_per_carrier  The number of slots per carrier
+	 * @param carriers_number    The number of carriers, see above
+	 * @param nb_replicas        The number of replicas per packet
+	 * @param algo               The collision resolution algorithm
+	 */
+	SlottedAlohaSimuEngine(uint16_t slots_per_carrier,
+	                       uint16_t carriers_number,
+	                       uint16_t nb_replicas,
+	                       SalohaSimuAlgo algo);
+
+	/**
+	 * @brief Draw the slots used by a terminal on a frame, as done by
+	 *        SlottedAlohaTal: distinct time slots in a carrier, each one
+	 *        sent on a random carrier
+	 *
+	 * @param random    The generator to use
+	 * @param nb_slots  The number of slots to draw, limited to the number
+	 *                  of slots per carrier
+	 * @return the ordered slots, valid until next call
+	 */
+	const std::vector<uint16_t> &drawTimeSlots(SlottedAlohaRandom &random,
+	                                           uint16_t nb_slots);
+
+	/**
+	 * @brief Simulate one frame
+	 *
+	 * @param random      The generator to use
+	 * @param nb_packets  The number of packets sent on the frame, each one
+	 *                    with its replicas
+	 * @return the number of decoded packets
+	 */
+	uint32_t simulateFrame(SlottedAlohaRandom &random, uint32_t nb_packets);
+
+	/**
+	 * @brief Monte-Carlo simulation of a given load
+	 *
+	 * @param load        The offered load in packets per slot
+	 * @param nb_frames   The number of frames to simulate
+	 * @param nb_threads  The number of worker threads
+	 * @param seed        The seed, results only depend on the seed and the
+	 *                    number of threads
+	 * @return the simulation result
+	 */
+	saloha_simu_point_t run(double load,
+	                        unsigned int nb_frames,
+	                        unsigned int nb_threads,
+	                        uint64_t seed) const;
+
+	/**
+	 * @brief Monte-Carlo simulation of several loads on a thread pool
+	 *
+	 * @param loads       The offered loads in packets per slot
+	 * @param nb_frames   The number of frames to simulate per load
+	 * @param nb_threads  The number of worker threads
+	 * @param seed        The seed
+	 * @return the simulation results, in the loads order
+	 */
+	std::vector<saloha_simu_point_t> runCurve(const std::vector<double> &loads,
+	                                          unsigned int nb_frames,
+	                                          unsigned int nb_threads,
+	                                          uint64_t seed) const;
+
+	/**
+	 * @brief Get the number of slots in a frame
+	 *
+	 * @return the number of slots
+	 */
+	uint32_t getSlotsNumber() const;
+
+	/**
+	 * @brief Get the number of carriers actually simulated
+	 *
+	 * @return the number of carriers
+	 */
+	uint16_t getCarriersNumber() const;
+
+private:
+	/// The number of slots per carrier
+	uint16_t slots_per_carrier;
+	/// The number of carriers
+	uint16_t carriers_number;
+	/// The number of replicas per packet
+	uint16_t nb_replicas;
+	/// The collision resolution algorithm
+	SalohaSimuAlgo algo;
+
+	/// The slots drawn for a terminal
+	std::vector<uint16_t> time_slots;
+	/// Marks the time slots already drawn in a carrier
+	std::vector<uint8_t> used_time_slots;
+	/// The number of packets per slot
+	std::vector<uint16_t> slot_count;
+	/// The XOR of the packets indexes per slot
+	std::vector<uint32_t> slot_xor;
+	/// The slots of each packet replicas
+	std::vector<uint16_t> replicas;
+	/// The singleton slots to process (CRDSA)
+	std::vector<uint16_t> singletons;
+};
+
+#endif
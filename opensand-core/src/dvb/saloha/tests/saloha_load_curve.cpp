@@ -0,0 +1,187 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/*
+ * Offline Slotted Aloha load simulator
+ *
+ * The application runs Monte-Carlo simulations of a Slotted Aloha
+ * category for a range of offered loads and outputs the throughput vs load
+ * curve (CSV) for DSA or CRDSA. It allows sizing the random access carriers
+ * without running a platform.
+ *
+ * Launch the application with -h to learn how to use it.
+ */
+
+#include "SlottedAlohaSimuEngine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <thread>
+#include <vector>
+
+
+/// The program usage
+#define USAGE \
+"Slotted Aloha load simulator: compute the throughput vs load curve of a random access category\n\n\
+usage: saloha_load_curve [-h] [-a algo] [-s slots] [-c carriers] [-r replicas]\n\
+                         [-f frames] [-t threads] [-S seed] [-l min:max:step]\n\
+\t-h                print this usage and exit\n\
+\t-a algo           the algorithm: DSA or CRDSA (default: CRDSA)\n\
+\t-s slots          the number of slots per carrier (default: 100)\n\
+\t-c carriers       the number of carriers (default: 1)\n\
+\t-r replicas       the number of replicas per packet (default: 2)\n\
+\t-f frames         the number of frames per load (default: 10000)\n\
+\t-t threads        the number of threads (default: number of CPUs)\n\
+\t-S seed           the random seed (default: current time)\n\
+\t-l min:max:step   the offered loads in packets per slot (default: 0.1:1.5:0.1)\n\n"
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+int main(int argc, char *argv[])
+{
+	SalohaSimuAlgo algo = SalohaSimuAlgo::crdsa;
+	unsigned int slots_per_carrier = 100;
+	unsigned int carriers_number = 1;
+	unsigned int nb_replicas = 2;
+	unsigned int nb_frames = 10000;
+	unsigned int nb_threads = std::thread::hardware_concurrency();
+	uint64_t seed = time(NULL);
+	double load_min = 0.1;
+	double load_max = 1.5;
+	double load_step = 0.1;
+	std::vector<double> loads;
+	int args_used;
+
+	for(argc--, argv++; argc > 0; argc -= args_used, argv += args_used)
+	{
+		args_used = 2;
+
+		if(!strcmp(*argv, "-h"))
+		{
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+		if(argc < 2)
+		{
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+
+		if(!strcmp(*argv, "-a"))
+		{
+			if(!strcmp(argv[1], "DSA"))
+			{
+				algo = SalohaSimuAlgo::dsa;
+			}
+			else if(!strcmp(argv[1], "CRDSA"))
+			{
+				algo = SalohaSimuAlgo::crdsa;
+			}
+			else
+			{
+				ERROR("unknown algorithm %s\n", argv[1]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if(!strcmp(*argv, "-s"))
+		{
+			slots_per_carrier = atoi(argv[1]);
+		}
+		else if(!strcmp(*argv, "-c"))
+		{
+			carriers_number = atoi(argv[1]);
+		}
+		else if(!strcmp(*argv, "-r"))
+		{
+			nb_replicas = atoi(argv[1]);
+		}
+		else if(!strcmp(*argv, "-f"))
+		{
+			nb_frames = atoi(argv[1]);
+		}
+		else if(!strcmp(*argv, "-t"))
+		{
+			nb_threads = atoi(argv[1]);
+		}
+		else if(!strcmp(*argv, "-S"))
+		{
+			seed = strtoull(argv[1], NULL, 10);
+		}
+		else if(!strcmp(*argv, "-l"))
+		{
+			if(sscanf(argv[1], "%lf:%lf:%lf",
+			          &load_min, &load_max, &load_step) != 3 ||
+			   load_step <= 0 || load_min > load_max)
+			{
+				ERROR("bad load range %s\n", argv[1]);
+				return EXIT_FAILURE;
+			}
+		}
+		else
+		{
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(!slots_per_carrier || slots_per_carrier > UINT16_MAX ||
+	   !carriers_number || slots_per_carrier * carriers_number > UINT16_MAX ||
+	   !nb_replicas || nb_replicas > slots_per_carrier)
+	{
+		ERROR("bad category dimensions\n");
+		return EXIT_FAILURE;
+	}
+
+	for(unsigned int step = 0; load_min + step * load_step <= load_max + 1e-9; step++)
+	{
+		loads.push_back(load_min + step * load_step);
+	}
+
+	SlottedAlohaSimuEngine engine(slots_per_carrier, carriers_number,
+	                              nb_replicas, algo);
+	std::vector<saloha_simu_point_t> points = engine.runCurve(loads, nb_frames,
+	                                                          nb_threads, seed);
+
+	printf("load,throughput,loss_ratio,sent_packets,decoded_packets\n");
+	for(auto &&point : points)
+	{
+		printf("%.3f,%.5f,%.5f,%llu,%llu\n",
+		       point.load, point.throughput, point.loss_ratio,
+		       (unsigned long long)point.sent_packets,
+		       (unsigned long long)point.decoded_packets);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,209 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+/*
+ * Slotted Aloha simulation engine test
+ *
+ * The application checks the slots drawn by the engine, the determinism of
+ * the Monte-Carlo runs and the throughput against the analytic Slotted
+ * Aloha throughput. It returns a non-zero status on failure.
+ */
+
+#include "SlottedAlohaSimuEngine.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <set>
+
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+/// The slot indexes must fit the 16 bits of the category
+static bool testDimensions()
+{
+	SlottedAlohaSimuEngine engine(1000, 1000, 2, SalohaSimuAlgo::dsa);
+	if(engine.getSlotsNumber() > UINT16_MAX)
+	{
+		ERROR("%u slots do not fit on 16 bits\n", engine.getSlotsNumber());
+		return false;
+	}
+	if(engine.getCarriersNumber() != UINT16_MAX / 1000)
+	{
+		ERROR("%u carriers instead of %u\n", engine.getCarriersNumber(), UINT16_MAX / 1000);
+		return false;
+	}
+
+	SlottedAlohaSimuEngine small(10, 3, 2, SalohaSimuAlgo::dsa);
+	if(small.getSlotsNumber() != 30)
+	{
+		ERROR("%u slots instead of 30\n", small.getSlotsNumber());
+		return false;
+	}
+	return true;
+}
+
+/// Drawn slots are ordered, in the frame and on distinct time slots
+static bool testDrawTimeSlots()
+{
+	const uint16_t slots_per_carrier = 20;
+	SlottedAlohaSimuEngine engine(slots_per_carrier, 4, 3, SalohaSimuAlgo::dsa);
+	SlottedAlohaRandom random(1);
+
+	for(unsigned int draw = 0; draw < 1000; draw++)
+	{
+		const std::vector<uint16_t> &slots = engine.drawTimeSlots(random, 5);
+		std::set<uint16_t> time_slots;
+		if(slots.size() != 5)
+		{
+			ERROR("%zu slots drawn instead of 5\n", slots.size());
+			return false;
+		}
+		for(size_t i = 0; i < slots.size(); i++)
+		{
+			if(slots[i] >= engine.getSlotsNumber())
+			{
+				ERROR("slot %u out of the frame\n", slots[i]);
+				return false;
+			}
+			if(i > 0 && slots[i - 1] >= slots[i])
+			{
+				ERROR("slots are not ordered\n");
+				return false;
+			}
+			time_slots.insert(slots[i] % slots_per_carrier);
+		}
+		if(time_slots.size() != slots.size())
+		{
+			ERROR("time slots are not distinct\n");
+			return false;
+		}
+	}
+
+	// no more slots than time slots in a carrier
+	if(engine.drawTimeSlots(random, 100).size() != slots_per_carrier)
+	{
+		ERROR("more slots drawn than time slots\n");
+		return false;
+	}
+	return true;
+}
+
+/// Results only depend on the seed and the number of threads
+static bool testDeterminism()
+{
+	SlottedAlohaSimuEngine engine(50, 2, 2, SalohaSimuAlgo::crdsa);
+	saloha_simu_point_t first = engine.run(0.6, 2000, 4, 42);
+	saloha_simu_point_t second = engine.run(0.6, 2000, 4, 42);
+
+	if(first.frames != 2000)
+	{
+		ERROR("%lu frames simulated instead of 2000\n",
+		      (unsigned long)first.frames);
+		return false;
+	}
+	if(first.decoded_packets != second.decoded_packets)
+	{
+		ERROR("runs with the same seed differ (%lu vs %lu)\n",
+		      (unsigned long)first.decoded_packets,
+		      (unsigned long)second.decoded_packets);
+		return false;
+	}
+	if(first.decoded_packets > first.sent_packets)
+	{
+		ERROR("more packets decoded than sent\n");
+		return false;
+	}
+
+	saloha_simu_point_t empty = engine.run(0.0, 100, 2, 42);
+	if(empty.sent_packets != 0 || empty.throughput != 0.0)
+	{
+		ERROR("packets decoded without load\n");
+		return false;
+	}
+	return true;
+}
+
+/// Without replicas, DSA is Slotted Aloha: S = G (1 - 1/N)^(GN - 1)
+static bool testSlottedAlohaThroughput()
+{
+	const unsigned int nb_slots = 100;
+	SlottedAlohaSimuEngine engine(nb_slots, 1, 1, SalohaSimuAlgo::dsa);
+	std::vector<double> loads = {0.25, 0.5, 1.0, 1.5};
+	std::vector<saloha_simu_point_t> points = engine.runCurve(loads, 20000, 4, 7);
+
+	for(auto &&point : points)
+	{
+		double expected = point.load * pow(1.0 - 1.0 / nb_slots,
+		                                   point.load * nb_slots - 1);
+		if(fabs(point.throughput - expected) >= 0.005)
+		{
+			ERROR("throughput %f at load %.2f, expected %f\n",
+			      point.throughput, point.load, expected);
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Successive interference cancellation decodes more than DSA
+static bool testCrdsaGain()
+{
+	SlottedAlohaSimuEngine dsa(100, 1, 2, SalohaSimuAlgo::dsa);
+	SlottedAlohaSimuEngine crdsa(100, 1, 2, SalohaSimuAlgo::crdsa);
+	saloha_simu_point_t dsa_point = dsa.run(0.5, 5000, 4, 3);
+	saloha_simu_point_t crdsa_point = crdsa.run(0.5, 5000, 4, 3);
+
+	if(crdsa_point.throughput <= dsa_point.throughput)
+	{
+		ERROR("CRDSA throughput %f is not above DSA throughput %f\n",
+		      crdsa_point.throughput, dsa_point.throughput);
+		return false;
+	}
+	return true;
+}
+
+
+int main()
+{
+	bool success = testDimensions() &&
+	               testDrawTimeSlots() &&
+	               testDeterminism() &&
+	               testSlottedAlohaThroughput() &&
+	               testCrdsaGain();
+
+	if(!success)
+	{
+		return EXIT_FAILURE;
+	}
+	printf("Slotted Aloha simulation engine tests passed\n");
+	return EXIT_SUCCESS;
+}
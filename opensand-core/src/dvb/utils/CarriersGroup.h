@@ -132,7 +132,7 @@ public:
 	 *
 	 * @return the list of MODCODs
 	 */
-	const std::list<fmt_id_t> getFmtIds() const;
+	const std::list<fmt_id_t> &getFmtIds() const;
 
 	/**
 	 * @brief Get the carriers access type
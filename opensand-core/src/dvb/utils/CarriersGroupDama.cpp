@@ -155,7 +155,7 @@ unsigned int CarriersGroupDama::getNearestFmtId(unsigned int fmt_id)
 	return this->fmt_group->getNearest(fmt_id);
 }
 
-std::vector<CarriersGroupDama *> CarriersGroupDama::getVcmCarriers()
+const std::vector<CarriersGroupDama *> &CarriersGroupDama::getVcmCarriers() const
 {
 	return this->vcm_carriers;
 }
@@ -131,7 +131,7 @@ public:
 	 *
 	 * @return the VCM carriers
 	 */
-	std::vector<CarriersGroupDama *> getVcmCarriers();
+	const std::vector<CarriersGroupDama *> &getVcmCarriers() const;
 
 protected:
 	/** The remaining capacity on the current frame */
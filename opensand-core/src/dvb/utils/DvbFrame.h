@@ -308,10 +308,7 @@ public:
 	 */
 	double getCn(void) const
 	{
-		size_t msg_length = this->getMessageLength();
-		Data phy_data = this->getData(msg_length);
-		T_DVB_PHY *phy = (T_DVB_PHY *)(phy_data.c_str());
-		return ncntoh(phy->cn_previous);
+		return ncntoh(this->phy()->cn_previous);
 	};
 
 	/**
@@ -321,20 +318,56 @@ public:
 	 */
 	void setCn(double cn)
 	{
-		T_DVB_PHY phy;
-		phy.cn_previous = hcnton(cn);
+		this->phy()->cn_previous = hcnton(cn);
+	};
+
+	/**
+	 * Get the terminal that emitted the frame
+	 *
+	 * @return the terminal ID, BROADCAST_TAL_ID if unknown
+	 */
+	tal_id_t getSourceTerminal(void) const
+	{
+		if(this->trailer_length < sizeof(T_DVB_PHY))
+		{
+			return BROADCAST_TAL_ID;
+		}
+		return ntohs(this->phy()->src_tal_id);
+	};
+
+	/**
+	 * Set the terminal that emitted the frame
+	 *
+	 * @param tal_id  The terminal ID
+	 */
+	void setSourceTerminal(tal_id_t tal_id)
+	{
+		this->phy()->src_tal_id = htons(tal_id);
+	};
+
+	/**
+	 * @brief Accessor on the physical layer trailer, added if missing
+	 */
+	T_DVB_PHY *phy(void)
+	{
 		if(this->trailer_length == 0)
 		{
+			T_DVB_PHY phy;
+			phy.cn_previous = 0;
+			phy.src_tal_id = htons(BROADCAST_TAL_ID);
 			this->data.append((unsigned char *)&phy, sizeof(T_DVB_PHY));
 			this->trailer_length = sizeof(T_DVB_PHY);
 		}
-		else
-		{
-			size_t msg_length = this->getMessageLength();
-			this->data.replace(msg_length, this->trailer_length,
-			                   (unsigned char *)(&phy), this->trailer_length);
-		}
-	};
+		return (T_DVB_PHY *)&this->data[this->getMessageLength()];
+	}
+
+	/**
+	 * @brief Accessor on the physical layer trailer
+	 */
+	const T_DVB_PHY *phy(void) const
+	{
+		return (const T_DVB_PHY *)(this->data.c_str() + this->getMessageLength());
+	}
 
 	/**
 	 * @brief Accessor on the frame data
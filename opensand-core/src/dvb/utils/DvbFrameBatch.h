@@ -0,0 +1,129 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file DvbFrameBatch.h
+ * @brief A batch of DVB frames sent between blocks in a single message
+ */
+
+#ifndef DVB_FRAME_BATCH_H
+#define DVB_FRAME_BATCH_H
+
+#include <memory>
+#include <vector>
+
+#include "OpenSandCore.h"
+#include "DvbFrame.h"
+
+
+/**
+ * @class DvbFrameBatch
+ * @brief Several DVB frames sharing the same message header
+ *
+ * A batch is carried by a single InternalMessageType::batch message so
+ * that a whole burst crosses a block boundary with one enqueue and is
+ * handled in one onEvent call. The frames are owned by the batch until
+ * they are released by the receiving block.
+ */
+class DvbFrameBatch
+{
+public:
+	using iterator = std::vector<std::unique_ptr<DvbFrame>>::iterator;
+
+	/**
+	 * @brief Build an empty batch
+	 *
+	 * @param type  the message type the frames would have if sent alone
+	 */
+	DvbFrameBatch(InternalMessageType type = InternalMessageType::unknown):
+		type{type},
+		frames{}
+	{
+	}
+
+	/**
+	 * @brief Add a frame at the end of the batch
+	 *
+	 * @param frame  the frame, the batch takes its ownership
+	 */
+	void push(DvbFrame *frame)
+	{
+		this->frames.emplace_back(frame);
+	}
+
+	/**
+	 * @brief Reserve room for the given number of frames
+	 *
+	 * @param count  the expected number of frames
+	 */
+	void reserve(std::size_t count)
+	{
+		this->frames.reserve(count);
+	}
+
+	/**
+	 * @brief Get the message type shared by the frames of the batch
+	 *
+	 * @return the message type of the frames
+	 */
+	InternalMessageType getFramesType() const
+	{
+		return this->type;
+	}
+
+	std::size_t size() const
+	{
+		return this->frames.size();
+	}
+
+	bool empty() const
+	{
+		return this->frames.empty();
+	}
+
+	iterator begin()
+	{
+		return this->frames.begin();
+	}
+
+	iterator end()
+	{
+		return this->frames.end();
+	}
+
+private:
+	/// The message type shared by the frames
+	InternalMessageType type;
+
+	/// The frames of the batch
+	std::vector<std::unique_ptr<DvbFrame>> frames;
+};
+
+
+#endif
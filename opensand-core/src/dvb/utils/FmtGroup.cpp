@@ -168,7 +168,7 @@ void FmtGroup::parse(std::string ids)
 	}
 }
 
-const std::list<fmt_id_t> FmtGroup::getFmtIds() const
+const std::list<fmt_id_t> &FmtGroup::getFmtIds() const
 {
 	return this->num_fmt_ids;
 }
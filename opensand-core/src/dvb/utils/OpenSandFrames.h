@@ -181,6 +181,7 @@ typedef struct
 typedef struct
 {
 	uint32_t cn_previous;  ///< The C/N computed on the link (* 100)
+	tal_id_t src_tal_id;   ///< The terminal that emitted the frame
 } __attribute__((__packed__)) T_DVB_PHY;
 
 /**
@@ -36,6 +36,7 @@
 
 #include <opensand_output/Output.h>
 
+#include <algorithm>
 #include <cstring>
 
 
@@ -121,20 +122,42 @@ double Sac::getCni() const
 std::vector<cr_info_t> Sac::getRequests(void) const
 {
 	std::vector<cr_info_t> requests;
+	uint8_t cr_number = this->getRequestsNumber();
 
-	for(unsigned int i = 0; i < this->frame()->sac.cr_number; i++)
+	requests.reserve(cr_number);
+	for(unsigned int i = 0; i < cr_number; i++)
 	{
-		cr_info_t req;
-
-		req.prio = this->frame()->sac.cr[i].prio;
-		req.type = this->frame()->sac.cr[i].type;
-		req.value = getDecodedCrValue(this->frame()->sac.cr[i]);
-
-		requests.push_back(req);
+		requests.push_back(this->getRequest(i));
 	}
 	return requests;
 };
 
+uint8_t Sac::getRequestsNumber(void) const
+{
+	size_t length = this->getTotalLength();
+	size_t max_cr_number;
+
+	// do not read beyond the received frame if the CR number is wrong
+	if(length < sizeof(T_DVB_SAC))
+	{
+		return 0;
+	}
+	max_cr_number = (length - sizeof(T_DVB_SAC)) / sizeof(emu_cr_t);
+	return std::min<size_t>(this->frame()->sac.cr_number, max_cr_number);
+}
+
+cr_info_t Sac::getRequest(unsigned int index) const
+{
+	const emu_cr_t &cr = this->frame()->sac.cr[index];
+	cr_info_t req;
+
+	req.prio = cr.prio;
+	req.type = cr.type;
+	req.value = getDecodedCrValue(cr);
+
+	return req;
+}
+
 
 void Sac::setAcm(double cni)
 {
@@ -200,6 +200,21 @@ public:
 	 */
 	std::vector<cr_info_t> getRequests(void) const;
 
+	/**
+	 * @brief  Get the number of requests in the SAC
+	 *
+	 * @return  the number of requests
+	 */
+	uint8_t getRequestsNumber(void) const;
+
+	/**
+	 * @brief  Decode a request in place, without copying the other ones
+	 *
+	 * @param index  The request index, lower than getRequestsNumber()
+	 * @return  the request
+	 */
+	cr_info_t getRequest(unsigned int index) const;
+
 	/**
 	 * @brief Get the C/N0 ratio
 	 *
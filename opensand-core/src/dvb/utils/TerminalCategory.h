@@ -273,7 +273,7 @@ public:
 	 *
 	 * @return  the carriers groups
 	 */
-	std::vector<T *> getCarriersGroups(void) const
+	const std::vector<T *> &getCarriersGroups(void) const
 	{
 		return this->carriers_groups;
 	};
@@ -39,6 +39,7 @@
 
 #include <opensand_output/Output.h>
 
+#include <algorithm>
 #include <cstring>
 #include <arpa/inet.h>
 
@@ -80,6 +81,9 @@ bool Ttp::addTimePlan(time_frame_t frame_id,
                       uint8_t priority)
 {
 	emu_tp_t tp;
+	emu_frame_t *emu_frame;
+	size_t frame_offset;
+	size_t end;
 
 	tp.tal_id = htons(tal_id);
 	tp.offset = htonl(offset);
@@ -87,26 +91,47 @@ bool Ttp::addTimePlan(time_frame_t frame_id,
 	tp.fmt_id = fmt_id;
 	tp.priority = priority;
 
-	// create the entry for this frame id if it does not exist
-	if(this->frames.find(frame_id) == this->frames.end())
+	if(this->data.length() + sizeof(emu_frame_t) + sizeof(emu_tp_t) > UINT16_MAX)
 	{
-		time_plans_t time_plans;
-		time_plans.push_back(tp);
-		this->frames.insert({frame_id, time_plans});
+		LOG(ttp_log, LEVEL_ERROR,
+		    "TTP is full, cannot add TP for ST%u\n", tal_id);
+		return false;
 	}
-	// add the TP to the list of TP for this frame ID
-	else
+
+	// create the entry for this frame id if it does not exist
+	frame_offset = this->findFrame(frame_id, end);
+	if(!frame_offset)
 	{
-		this->frames[frame_id].push_back(tp);
+		emu_frame_t new_frame;
+
+		if(this->frame()->ttp.ttp_info.frame_loop_count == UINT8_MAX)
+		{
+			LOG(ttp_log, LEVEL_ERROR,
+			    "Too many frames in TTP, cannot add frame %u\n", frame_id);
+			return false;
+		}
+		new_frame.frame_info.frame_number = frame_id;
+		new_frame.frame_info.tp_loop_count = 0;
+		this->data.insert(end, (unsigned char *)&new_frame, sizeof(emu_frame_t));
+		this->frame()->ttp.ttp_info.frame_loop_count++;
+		frame_offset = end;
+		end += sizeof(emu_frame_t);
 	}
-	/* not compatible with simulated STs => remove if this is ok
-	if(this->frames[frame_id].size() > BROADCAST_TAL_ID)
+	emu_frame = (emu_frame_t *)(this->data.c_str() + frame_offset);
+	if(emu_frame->frame_info.tp_loop_count == UINT16_MAX)
 	{
 		LOG(ttp_log, LEVEL_ERROR,
 		    "Too many time plans for frame id %u\n", frame_id);
-		this->frames[frame_id].pop_back();
 		return false;
-	}*/
+	}
+
+	// add the TP at the end of its frame, this is an append on the buffer
+	// unless TP are not added frame after frame
+	this->data.insert(end, (unsigned char *)&tp, sizeof(emu_tp_t));
+	emu_frame = (emu_frame_t *)(this->data.c_str() + frame_offset);
+	emu_frame->frame_info.tp_loop_count++;
+	this->setMessageLength(this->data.length());
+
 	LOG(ttp_log, LEVEL_DEBUG,
 	    "Add TP for ST%u at frame %u with offset=%u, "
 	    "assignment_count=%u, fmt=%u, priority=%u\n",
@@ -118,59 +143,47 @@ bool Ttp::addTimePlan(time_frame_t frame_id,
 
 bool Ttp::build(void)
 {
-	unsigned int frame_count = 0;
-	time_plans_t::iterator tp_it;
-	unsigned int tp_count;
-	size_t ttp_length = 0;
-
-	ttp_length = sizeof(T_DVB_TTP);
-	// get the beginning of the frame
-	for(auto&& frame_it : this->frames)
+	size_t offset = sizeof(T_DVB_TTP);
+
+	// sort the TP of each frame by terminal ID, the order of the TP of a
+	// same terminal is kept
+	for(unsigned int i = 0; i < this->frame()->ttp.ttp_info.frame_loop_count; i++)
 	{
-		std::vector<emu_tp_t> tp_list = frame_it.second;
-		emu_frame_t emu_frame;
-
-		emu_frame.frame_info.frame_number = frame_it.first;
-		ttp_length += sizeof(frame_info_t);
-		tp_count = 0;
-		this->data.append((unsigned char *)&emu_frame, sizeof(emu_frame_t));
-		// get the first TP
-		for(tp_it = tp_list.begin(); tp_it != tp_list.end(); ++tp_it)
-		{
-			this->data.append((unsigned char *)&(*tp_it), sizeof(emu_tp_t));
-			ttp_length += sizeof(emu_tp_t);
-			tp_count++;
-		}
-		this->frame()->ttp.frames[frame_count].frame_info.tp_loop_count = tp_count;
-		frame_count++;
+		emu_frame_t *emu_frame = (emu_frame_t *)(this->data.c_str() + offset);
+		uint16_t tp_count = emu_frame->frame_info.tp_loop_count;
+
+		std::stable_sort(emu_frame->tp, emu_frame->tp + tp_count,
+		                 [](const emu_tp_t &tp1, const emu_tp_t &tp2)
+		                 {
+		                     return ntohs(tp1.tal_id) < ntohs(tp2.tal_id);
+		                 });
+		offset += sizeof(emu_frame_t) + tp_count * sizeof(emu_tp_t);
 	}
-	this->frame()->ttp.ttp_info.frame_loop_count = frame_count;
 	// update message length
-	// TODO we may use getPayloadLength, this should be the same value
-	this->setMessageLength(ttp_length);
+	this->setMessageLength(this->data.length());
 
 	return true;
 }
 
 
-bool Ttp::getTp(tal_id_t tal_id, std::map<uint8_t, emu_tp_t> &tps)
+bool Ttp::getTp(tal_id_t tal_id, std::map<uint8_t, emu_tp_t> &tps) const
 {
 	size_t length = this->getMessageLength();
-	emu_ttp_t *ttp;
+	const emu_ttp_t *ttp;
 
 	// we need this unsigned char * for arithmetical operations
 	// on pointers as frame size is not constant
-	unsigned char *frame_start;
+	const unsigned char *frame_start;
 
 	/* check that data contains DVB header, superframe_count and
 	 * frame_loop_count */
-	if(length < sizeof(T_DVB_TTP))
+	if(length < sizeof(T_DVB_TTP) || this->data.length() < length)
 	{
 		LOG(ttp_log, LEVEL_ERROR,
 		    "Length is to small for a TTP\n");
 		return false;
 	}
-	length -= sizeof(T_DVB_HDR);
+	length -= sizeof(T_DVB_TTP);
 
 	ttp = &(this->frame()->ttp);
 	LOG(ttp_log, LEVEL_DEBUG,
@@ -178,57 +191,81 @@ bool Ttp::getTp(tal_id_t tal_id, std::map<uint8_t, emu_tp_t> &tps)
 	    this->getSuperframeCount(),
 	    ttp->ttp_info.frame_loop_count);
 
-	length -= sizeof(ttp_info_t);
-	frame_start = (unsigned char *)(&ttp->frames);
+	frame_start = (const unsigned char *)(&ttp->frames);
 	for(unsigned int i = 0; i < ttp->ttp_info.frame_loop_count; i++)
 	{
-		emu_tp_t *tp;
-		emu_frame_t *emu_frame = (emu_frame_t *)frame_start;
+		const emu_frame_t *emu_frame = (const emu_frame_t *)frame_start;
+		const emu_tp_t *tp;
+		const emu_tp_t *last_tp;
+		uint16_t tp_count;
 
-		if(length < sizeof(frame_info_t) + emu_frame->frame_info.tp_loop_count * sizeof(emu_tp_t))
+		if(length < sizeof(emu_frame_t))
+		{
+			LOG(ttp_log, LEVEL_ERROR,
+			    "Length is too small for the given frame number\n");
+			return false;
+		}
+		tp_count = emu_frame->frame_info.tp_loop_count;
+		if(length < sizeof(emu_frame_t) + tp_count * sizeof(emu_tp_t))
 		{
 			LOG(ttp_log, LEVEL_ERROR,
 			    "Length is too small for the given tp number\n");
 			return false;
 		}
 		// update length
-		length -= sizeof(frame_info_t);
+		length -= sizeof(emu_frame_t) + tp_count * sizeof(emu_tp_t);
 		LOG(ttp_log, LEVEL_DEBUG,
 		    "SF#%u: frame #%u tbtp_loop_count=%u\n",
-		    this->getSuperframeCount(), i,
-		    emu_frame->frame_info.tp_loop_count);
-		// get the first TP
-		// increase from 1 * sizeof(tp)
-		tp = (emu_tp_t *)(&emu_frame->tp);
-		for(unsigned int j = 0; j < emu_frame->frame_info.tp_loop_count; j++)
+		    this->getSuperframeCount(), i, tp_count);
+
+		// TP are sorted by terminal ID in each frame
+		last_tp = emu_frame->tp + tp_count;
+		tp = std::lower_bound(emu_frame->tp, last_tp, tal_id,
+		                      [](const emu_tp_t &tp, tal_id_t id)
+		                      {
+		                          return ntohs(tp.tal_id) < id;
+		                      });
+		for(; tp != last_tp && ntohs(tp->tal_id) == tal_id; ++tp)
 		{
-			length -= sizeof(emu_tp_t);
-			if(ntohs(tp->tal_id) != tal_id)
-			{
-				LOG(ttp_log, LEVEL_DEBUG,
-				    "SF#%u: TP for ST%u ignored\n",
-				    this->getSuperframeCount(),
-				    ntohs(tp->tal_id));
-				tp = tp + 1;
-				continue;
-			}
-			tp->offset = ntohl(tp->offset);
-			tp->assignment_count = ntohs(tp->assignment_count);
-			tps[emu_frame->frame_info.frame_number] = *tp;
+			emu_tp_t host_tp = *tp;
+
+			host_tp.tal_id = tal_id;
+			host_tp.offset = ntohl(tp->offset);
+			host_tp.assignment_count = ntohs(tp->assignment_count);
+			tps[emu_frame->frame_info.frame_number] = host_tp;
 			LOG(ttp_log, LEVEL_DEBUG,
-			    "SF#%u: frame#%u tbtp#%u: tal_id:%u, "
-			    "offset:%u, assignment_count:%u, "
+			    "SF#%u: frame#%u: tal_id:%u, "
+			    "offset:%d, assignment_count:%u, "
 			    "fmt_id:%u priority:%u\n",
-			    this->getSuperframeCount(), i, j,
-			    tal_id, tp->offset, tp->assignment_count,
-			    tp->fmt_id, tp->priority);
-			// increase from 1 * sizeof(tp), we do not need to
-			// use an unsigned char * for arithmetic operation here
-			tp = tp + 1;
+			    this->getSuperframeCount(), i, tal_id,
+			    int32_t(host_tp.offset), uint16_t(host_tp.assignment_count),
+			    host_tp.fmt_id, host_tp.priority);
 		}
 		// go to next frame
-		frame_start = frame_start + emu_frame->frame_info.tp_loop_count * sizeof(emu_tp_t);
+		frame_start += sizeof(emu_frame_t) + tp_count * sizeof(emu_tp_t);
 	}
 
 	return true;
 }
+
+
+size_t Ttp::findFrame(time_frame_t frame_id, size_t &end) const
+{
+	size_t offset = sizeof(T_DVB_TTP);
+
+	// there is only a few frames per TTP
+	for(unsigned int i = 0; i < this->frame()->ttp.ttp_info.frame_loop_count; i++)
+	{
+		const emu_frame_t *emu_frame = (const emu_frame_t *)(this->data.c_str() + offset);
+
+		end = offset + sizeof(emu_frame_t) +
+		      emu_frame->frame_info.tp_loop_count * sizeof(emu_tp_t);
+		if(emu_frame->frame_info.frame_number == frame_id)
+		{
+			return offset;
+		}
+		offset = end;
+	}
+	end = offset;
+	return 0;
+}
@@ -106,6 +106,18 @@ typedef struct
 } __attribute__((packed)) T_DVB_TTP;
 
 
+/**
+ * @class Ttp
+ * @brief The Terminal Burst Time Plan
+ *
+ * The time plans are directly serialized in the frame buffer when they
+ * are added, and build() sorts the time plans of each frame by terminal ID
+ * so that a terminal finds its entries with a binary search instead of
+ * walking the whole broadcast TTP.
+ *
+ * The class must not hold any member other than the DvbFrame ones as
+ * received frames are casted into Ttp.
+ */
 class Ttp: public DvbFrameTpl<T_DVB_TTP>
 {
 public:
@@ -144,11 +156,6 @@ public:
 	                 fmt_id_t fmt_id,
 	                 uint8_t priority);
 
-	/**
-	 * @brief Clean the internal frames
-	 */
-	void reset();
-
 	/**
 	 * @brief Build the TTP
 	 *
@@ -160,11 +167,11 @@ public:
 	 * @brief Get the Time Plan for a terminal
 	 *
 	 * @param tal_id The terminal ID for which we want the TP
-	 * @param tp     The Time Plans per superframe id
+	 * @param tp     The Time Plans per frame id, in host byte order
 	 *
-	 * @return true if a TP is found, false otherwise
+	 * @return true on success, false if the TTP is malformed
 	 */
-	bool getTp(tal_id_t tal_id, std::map<uint8_t, emu_tp_t> &tps);
+	bool getTp(tal_id_t tal_id, std::map<uint8_t, emu_tp_t> &tps) const;
 
 	/**
 	 * @brief  Get the group Id
@@ -190,13 +197,15 @@ public:
 	static std::shared_ptr<OutputLog> ttp_log;
 
 private:
-	/// A list of time plans
-	typedef std::vector<emu_tp_t> time_plans_t;
-	/// The list of frames and their TP
-	typedef std::map<uint8_t, time_plans_t> frames_t;
-
-	/// The frames, completed each time we add a TP
-	frames_t frames;
+	/**
+	 * @brief Get the offset of a frame in the TTP
+	 *
+	 * @param frame_id  The frame ID
+	 * @param end       The offset of the end of the frame (i.e. where a
+	 *                  new TP for this frame should be inserted)
+	 * @return the offset of the frame, 0 if it does not exist
+	 */
+	size_t findFrame(time_frame_t frame_id, size_t &end) const;
 };
 
 
@@ -44,6 +44,7 @@
 #include <opensand_rt/MessageEvent.h>
 
 #include <algorithm>
+#include <set>
 #include <stdint.h>
 #include <unistd.h>
 #include <errno.h>
@@ -79,7 +80,12 @@ BlockEncap::BlockEncap(const std::string &name, EncapConfig encap_cfg):
 
 BlockEncap::Downward::Downward(const std::string &name, EncapConfig):
 	RtDownward{name},
-	EncapChannel{}
+	EncapChannel{},
+	flush_policy{0, 0.0, 0},
+	pending{},
+	flush_timer{-1},
+	flush_timer_armed{false},
+	flush_timer_deadline{0}
 {
 }
 
@@ -99,6 +105,34 @@ void BlockEncap::generateConfiguration()
 	                                     PluginType::Encapsulation,
 	                                     "encapsulation_scheme",
 	                                     "Encapsulation Scheme");
+
+	auto Conf = OpenSandModelConf::Get();
+	auto types = Conf->getModelTypesDefinition();
+	auto conf = Conf->getOrCreateComponent("encap", "Encapsulation", "The Encapsulation Plugins Configuration");
+	conf->addParameter("flush_latency_budget",
+	                   "Flush Latency Budget",
+	                   types->getType("int"),
+	                   "Maximum time in ms a packet waits in an encapsulation "
+	                   "context before it is flushed, 0 to use the plugin "
+	                   "wait time")->setAdvanced(true);
+	conf->addParameter("flush_fill_ratio",
+	                   "Flush Fill Ratio",
+	                   types->getType("int"),
+	                   "Flush an encapsulation context as soon as this "
+	                   "percentage of it is filled, 0 to wait for a full "
+	                   "context")->setAdvanced(true);
+	conf->addParameter("flush_on_superframe",
+	                   "Flush On Superframe",
+	                   types->getType("bool"),
+	                   "Flush all the encapsulation contexts on the next "
+	                   "superframe tick")->setAdvanced(true);
+}
+
+bool BlockEncap::Downward::onInit()
+{
+	// a single timer flushes all the contexts, it is armed on demand
+	this->flush_timer = this->addTimerEvent("encap_flush", 1, false, false);
+	return this->flush_timer >= 0;
 }
 
 bool BlockEncap::Downward::onEvent(const RtEvent *const event)
@@ -160,6 +194,60 @@ void BlockEncap::Downward::setContext(const std::vector<EncapPlugin::EncapContex
 	this->ctx = encap_ctx;
 }
 
+void BlockEncap::Downward::setFlushPolicy(const EncapFlushPolicy &policy)
+{
+	this->flush_policy = policy;
+}
+
+void BlockEncap::Downward::initContextProbes(const std::vector<tal_id_t> &src_tal_ids,
+                                             const std::vector<tal_id_t> &dst_tal_ids,
+                                             const std::vector<qos_t> &qos_values)
+{
+	if(this->ctx.empty())
+	{
+		return;
+	}
+
+	// the probes are named after the flow, the flows sharing a context
+	// ID share the context, so only the first one gets the probes
+	std::map<int, std::string> flow_names;
+	auto output = Output::Get();
+	for(auto&& src_tal_id : src_tal_ids)
+	{
+		for(auto&& dst_tal_id : dst_tal_ids)
+		{
+			for(auto&& qos : qos_values)
+			{
+				// contexts that do not hold data, such as the ones of the
+				// variable length packets, are never flushed
+				int context_id = this->ctx.back()->getContextId(src_tal_id, dst_tal_id, qos);
+				if(context_id < 0)
+				{
+					continue;
+				}
+				std::string flow_name = std::to_string(src_tal_id) + "_" +
+				                        std::to_string(dst_tal_id) + "_" +
+				                        std::to_string(qos);
+				auto flow_it = flow_names.find(context_id);
+				if(flow_it != flow_names.end())
+				{
+					LOG(this->log_init, LEVEL_WARNING,
+					    "flow %s shares the encapsulation context of flow %s, "
+					    "its packets are reported by the probes of this flow\n",
+					    flow_name.c_str(), flow_it->second.c_str());
+					continue;
+				}
+				flow_names.emplace(context_id, flow_name);
+				std::string prefix = "Encap.Context_" + flow_name;
+				this->probe_fill.emplace(context_id,
+				                         output->registerProbe<int>(prefix + ".Fill", "%", true, SAMPLE_AVG));
+				this->probe_wait.emplace(context_id,
+				                         output->registerProbe<int>(prefix + ".Wait", "ms", true, SAMPLE_MAX));
+			}
+		}
+	}
+}
+
 bool BlockEncap::Upward::onEvent(const RtEvent *const event)
 {
 	switch(event->getType())
@@ -355,6 +443,13 @@ bool BlockEncap::onInit()
 	LOG(this->log_init, LEVEL_NOTICE, "host type = %s\n",
 	    getComponentName(entity_type).c_str());
 
+	EncapFlushPolicy flush_policy;
+	if(!this->getFlushPolicy(flush_policy))
+	{
+		return false;
+	}
+	static_cast<Downward *>(this->downward)->setFlushPolicy(flush_policy);
+
 	if (entity_type == Component::terminal)
 	{
 		// reorder reception context to get the deencapsulation contexts in the
@@ -376,56 +471,242 @@ bool BlockEncap::onInit()
 		static_cast<Upward *>(this->upward)->setSCPCContext(up_return_ctx_scpc);
 	}
 
+	// the probes must exist before the output configuration is finalized
+	this->initContextProbes();
+
 	return true;
 }
 
-bool BlockEncap::Downward::onTimer(event_id_t timer_id)
+void BlockEncap::initContextProbes()
 {
-	std::map<event_id_t, int>::iterator it;
-	int id;
-	NetBurst *burst;
-	bool status = false;
+	auto Conf = OpenSandModelConf::Get();
 
-	LOG(this->log_receive, LEVEL_INFO,
-	    "emission timer received, flush corresponding emission "
-	    "context\n");
+	// terminals only emit their own packets, gateways also relay the
+	// packets of the terminals
+	std::vector<tal_id_t> src_tal_ids{static_cast<tal_id_t>(this->mac_id)};
+	std::vector<tal_id_t> dst_tal_ids{BROADCAST_TAL_ID};
+	for(auto&& entity : Conf->getEntitiesType())
+	{
+		if(entity.first == this->mac_id ||
+		   (entity.second != Component::terminal &&
+		    entity.second != Component::gateway))
+		{
+			continue;
+		}
+		dst_tal_ids.push_back(entity.first);
+		if(this->entity_type == Component::gateway &&
+		   entity.second == Component::terminal)
+		{
+			src_tal_ids.push_back(entity.first);
+		}
+	}
 
-	// find encapsulation context to flush
-	it = this->timers.find(timer_id);
-	if(it == this->timers.end())
+	// the QoS of a packet is the priority of the FIFO of its class
+	std::set<std::string> fifos;
+	auto network = Conf->getProfileData()->getComponent("network");
+	for(auto& item : network->getList("qos_classes")->getItems())
+	{
+		auto category = std::dynamic_pointer_cast<OpenSANDConf::DataComponent>(item);
+		std::string fifo_name;
+		if(OpenSandModelConf::extractParameterData(category->getParameter("fifo"), fifo_name))
+		{
+			fifos.insert(fifo_name);
+		}
+	}
+	std::vector<qos_t> qos_values;
+	for(qos_t qos = 0; qos < fifos.size(); ++qos)
+	{
+		qos_values.push_back(qos);
+	}
+
+	static_cast<Downward *>(this->downward)->initContextProbes(src_tal_ids,
+	                                                           dst_tal_ids,
+	                                                           qos_values);
+}
+
+bool BlockEncap::getFlushPolicy(EncapFlushPolicy &policy)
+{
+	auto encap = OpenSandModelConf::Get()->getProfileData()->getComponent("encap");
+
+	// all the parameters are optional, the plugins decide of the wait time
+	// if none is set
+	int latency_budget;
+	if(!OpenSandModelConf::extractParameterData(encap->getParameter("flush_latency_budget"), latency_budget))
+	{
+		latency_budget = 0;
+	}
+	int fill_ratio;
+	if(!OpenSandModelConf::extractParameterData(encap->getParameter("flush_fill_ratio"), fill_ratio))
+	{
+		fill_ratio = 0;
+	}
+	bool on_superframe;
+	if(!OpenSandModelConf::extractParameterData(encap->getParameter("flush_on_superframe"), on_superframe))
+	{
+		on_superframe = false;
+	}
+
+	if(latency_budget < 0 || fill_ratio < 0 || fill_ratio > 100)
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "invalid flush policy (latency budget = %d ms, fill ratio = %d%%)\n",
+		    latency_budget, fill_ratio);
+		return false;
+	}
+
+	policy.latency_budget = latency_budget;
+	policy.fill_ratio = fill_ratio / 100.0;
+	policy.superframe = 0;
+	if(on_superframe)
+	{
+		// the emission link is the return link on terminals
+		// and the forward link on gateways
+		auto Conf = OpenSandModelConf::Get();
+		bool found = entity_type == Component::terminal ?
+		             Conf->getReturnFrameDuration(policy.superframe) :
+		             Conf->getForwardFrameDuration(policy.superframe);
+		if(!found)
+		{
+			LOG(this->log_init, LEVEL_ERROR,
+			    "cannot get the superframe duration to flush the "
+			    "encapsulation contexts on\n");
+			return false;
+		}
+	}
+
+	LOG(this->log_init, LEVEL_NOTICE,
+	    "flush encapsulation contexts with latency budget = %u ms, "
+	    "fill ratio = %d%%, superframe = %u ms\n",
+	    policy.latency_budget, fill_ratio, policy.superframe);
+	return true;
+}
+
+bool BlockEncap::Downward::onTimer(event_id_t timer_id)
+{
+	bool status = true;
+
+	if(timer_id != this->flush_timer)
 	{
 		LOG(this->log_receive, LEVEL_ERROR,
 		    "timer not found\n");
-		goto error;
+		return false;
 	}
 
-	// context found
-	id = (*it).second;
 	LOG(this->log_receive, LEVEL_INFO,
-	    "corresponding emission context found (ID = %d)\n",
-	    id);
+	    "emission timer received, flush expired emission contexts\n");
+
+	this->flush_timer_armed = false;
+	time_ms_t now = getCurrentTime();
+	auto it = this->pending.begin();
+	while(it != this->pending.end())
+	{
+		int id = it->first;
+		bool expired = static_cast<int32_t>(it->second.deadline - now) <= 0;
+		++it;
+		// flushContext removes the context from the pending ones
+		if(expired && !this->flushContext(id, now))
+		{
+			status = false;
+		}
+	}
 
-	// remove emission timer from the list
-	this->removeEvent((*it).first);
-	this->timers.erase(it);
+	this->armFlushTimer(now);
+	return status;
+}
+
+bool BlockEncap::Downward::updatePendingContexts(const std::map<int, long> &time_contexts)
+{
+	bool status = true;
+	time_ms_t now = getCurrentTime();
+
+	for(auto&& time_iter : time_contexts)
+	{
+		int id = time_iter.first;
+		long wait = time_iter.second;
+
+		// the context has been emptied by the encapsulation
+		if(wait <= 0)
+		{
+			this->pending.erase(id);
+			continue;
+		}
+
+		auto it = this->pending.find(id);
+		if(it == this->pending.end())
+		{
+			// the oldest packet in the context gives its deadline
+			time_ms_t budget = wait;
+			if(this->flush_policy.latency_budget != 0)
+			{
+				budget = std::min(budget, this->flush_policy.latency_budget);
+			}
+			time_ms_t deadline = now + budget;
+			if(this->flush_policy.superframe != 0)
+			{
+				time_ms_t superframe = this->flush_policy.superframe;
+				time_ms_t next_tick = (now / superframe + 1) * superframe;
+				if(static_cast<int32_t>(next_tick - deadline) < 0)
+				{
+					deadline = next_tick;
+				}
+			}
+			this->pending.emplace(id, PendingContext{now, deadline});
+			LOG(this->log_receive, LEVEL_INFO,
+			    "context ID %d will be flushed within %u ms\n",
+			    id, deadline - now);
+		}
+
+		if(this->flush_policy.fill_ratio > 0.0 &&
+		   this->ctx.back()->getFillRatio(id) >= this->flush_policy.fill_ratio)
+		{
+			LOG(this->log_receive, LEVEL_INFO,
+			    "context ID %d is filled enough, flush it\n", id);
+			status = this->flushContext(id, now) && status;
+		}
+	}
+
+	this->armFlushTimer(now);
+	return status;
+}
+
+bool BlockEncap::Downward::flushContext(int context_id, time_ms_t now)
+{
+	auto it = this->pending.find(context_id);
+	if(it == this->pending.end())
+	{
+		return true;
+	}
+	time_ms_t wait = now - it->second.since;
+	this->pending.erase(it);
+
+	auto fill_it = this->probe_fill.find(context_id);
+	if(fill_it != this->probe_fill.end())
+	{
+		fill_it->second->put(this->ctx.back()->getFillRatio(context_id) * 100);
+	}
+	auto wait_it = this->probe_wait.find(context_id);
+	if(wait_it != this->probe_wait.end())
+	{
+		wait_it->second->put(wait);
+	}
 
 	// flush the last encapsulation contexts
-	burst = (this->ctx.back())->flush(id);
-	if(burst == NULL)
+	NetBurst *burst = (this->ctx.back())->flush(context_id);
+	if(burst == nullptr)
 	{
 		LOG(this->log_receive, LEVEL_ERROR,
-		    "flushing context %d failed\n", id);
-		goto error;
+		    "flushing context %d failed\n", context_id);
+		return false;
 	}
 
 	LOG(this->log_receive, LEVEL_INFO,
-	    "%zu encapsulation packets flushed\n",
-	    burst->size());
+	    "%zu encapsulation packets flushed from context %d after %u ms\n",
+	    burst->size(), context_id, wait);
 
 	if(burst->size() <= 0)
 	{
-		status = true;
-		goto clean;
+		delete burst;
+		return true;
 	}
 
 	// send the message to the lower layer
@@ -433,23 +714,48 @@ bool BlockEncap::Downward::onTimer(event_id_t timer_id)
 	{
 		LOG(this->log_receive, LEVEL_ERROR,
 		    "cannot send burst to lower layer failed\n");
-		goto clean;
+		delete burst;
+		return false;
 	}
 
 	LOG(this->log_receive, LEVEL_INFO,
 	    "encapsulation burst sent to the lower layer\n");
-
 	return true;
+}
 
-clean:
-	delete burst;
-error:
-	return status;
+void BlockEncap::Downward::armFlushTimer(time_ms_t now)
+{
+	if(this->pending.empty())
+	{
+		return;
+	}
+
+	time_ms_t deadline = this->pending.begin()->second.deadline;
+	for(auto&& it : this->pending)
+	{
+		if(static_cast<int32_t>(it.second.deadline - deadline) < 0)
+		{
+			deadline = it.second.deadline;
+		}
+	}
+
+	// keep the timer if it already expires early enough
+	if(this->flush_timer_armed &&
+	   static_cast<int32_t>(this->flush_timer_deadline - deadline) <= 0)
+	{
+		return;
+	}
+
+	int32_t duration = static_cast<int32_t>(deadline - now);
+	this->setDuration(this->flush_timer, std::max(duration, 1));
+	this->startTimer(this->flush_timer);
+	this->flush_timer_armed = true;
+	this->flush_timer_deadline = deadline;
 }
 
 bool BlockEncap::Downward::onRcvBurst(NetBurst *burst)
 {
-	std::map<long, int> time_contexts;
+	std::map<int, long> time_contexts;
 	std::string name;
 	size_t size;
 
@@ -480,44 +786,6 @@ bool BlockEncap::Downward::onRcvBurst(NetBurst *burst)
 		}
 	}
 
-	// set encapsulate timers if needed
-	for(auto&& time_iter : time_contexts)
-	{
-		// check if there is already a timer armed for the context
-		bool found = false;
-		for(auto&& it : this->timers)
-		{
-			if (it.second == time_iter.second)
-			{
-				found = true;
-				break;
-			}
-		}
-
-		// set a new timer if no timer was found and timer is not null
-		if(!found && time_iter.first != 0)
-		{
-			event_id_t timer;
-			std::ostringstream name;
-
-			name << "context_" << time_iter.second;
-			timer = this->addTimerEvent(name.str(),
-			                            time_iter.first,
-			                            false);
-
-			this->timers.insert(std::make_pair(timer, time_iter.second));
-			LOG(this->log_receive, LEVEL_INFO,
-			    "timer for context ID %d armed with %ld ms\n",
-			    time_iter.second, time_iter.first);
-		}
-		else
-		{
-			LOG(this->log_receive, LEVEL_INFO,
-			    "timer already set for context ID %d\n",
-			    time_iter.second);
-		}
-	}
-
 	// check burst validity
 	if(burst == nullptr)
 	{
@@ -542,7 +810,7 @@ bool BlockEncap::Downward::onRcvBurst(NetBurst *burst)
 	if(burst->size() <= 0)
 	{
 		delete burst;
-		return true;
+		return this->updatePendingContexts(time_contexts);
 	}
 
 
@@ -552,14 +820,16 @@ bool BlockEncap::Downward::onRcvBurst(NetBurst *burst)
 		LOG(this->log_receive, LEVEL_ERROR,
 		    "failed to send burst to lower layer\n");
 		delete burst;
+		this->updatePendingContexts(time_contexts);
 		return false;
 	}
 
 	LOG(this->log_receive, LEVEL_INFO,
 	    "encapsulation burst sent to the lower layer\n");
 
-	// everything is fine
-	return true;
+	// flush the contexts now or arm the timer to flush them later, once
+	// the packets already built from them are sent
+	return this->updatePendingContexts(time_contexts);
 }
 
 void BlockEncap::Upward::setContext(const std::vector<EncapPlugin::EncapContext *> &encap_ctx)
@@ -49,6 +49,16 @@
 #include <opensand_rt/Rt.h>
 #include <opensand_rt/RtChannel.h>
 
+/**
+ * @brief The policy used to flush the emission encapsulation contexts
+ */
+struct EncapFlushPolicy
+{
+	time_ms_t latency_budget;  // maximum time a packet waits in a context, 0 to rely on the plugin
+	double fill_ratio;         // flush a context as soon as it is filled above this ratio, 0 to disable
+	time_ms_t superframe;      // flush all the contexts on superframe ticks of this duration, 0 to disable
+};
+
 struct EncapConfig
 {
 	tal_id_t entity_id;
@@ -136,16 +146,57 @@ public:
 	{
 	public:
 		Downward(const std::string &name, EncapConfig encap_cfg);
+		bool onInit();
 		bool onEvent(const RtEvent *const event);
 
 		void setContext(const std::vector<EncapPlugin::EncapContext *> &encap_ctx);
+		void setFlushPolicy(const EncapFlushPolicy &policy);
+
+		/**
+		 * @brief Register the probes of the emission contexts that may
+		 *        hold the packets of the given flows
+		 *
+		 * The probes are named Encap.Context_<src>_<dst>_<qos> after the
+		 * flow. Only the contexts holding data get probes: with GSE, the
+		 * ones of fixed length packets, variable length packets such as
+		 * Ethernet frames are never held.
+		 *
+		 * @param src_tal_ids  the sources of the flows
+		 * @param dst_tal_ids  the destinations of the flows
+		 * @param qos_values   the QoS of the flows
+		 */
+		void initContextProbes(const std::vector<tal_id_t> &src_tal_ids,
+		                       const std::vector<tal_id_t> &dst_tal_ids,
+		                       const std::vector<qos_t> &qos_values);
 
 	private:
+		/// An emission context holding data until it is flushed
+		struct PendingContext
+		{
+			time_ms_t since;
+			time_ms_t deadline;
+		};
+
 		/// the emission contexts list from lower to upper context
 		std::vector<EncapPlugin::EncapContext *> ctx;
 
-		/// Expiration timers for encapsulation contexts
-		std::map<event_id_t, int> timers;
+		/// The policy used to flush the emission contexts
+		EncapFlushPolicy flush_policy;
+
+		/// The emission contexts waiting to be flushed, per context ID
+		std::map<int, PendingContext> pending;
+
+		/// The single timer flushing the pending contexts
+		event_id_t flush_timer;
+
+		/// Whether the flush timer is armed, and the deadline it is armed for
+		bool flush_timer_armed;
+		time_ms_t flush_timer_deadline;
+
+		/// Probes on the flushed contexts, per context ID,
+		/// registered at initialization for the contexts holding data
+		std::map<int, std::shared_ptr<Probe<int>>> probe_fill;
+		std::map<int, std::shared_ptr<Probe<int>>> probe_wait;
 
 		/**
 		 * Handle a burst received from the upper-layer block
@@ -162,6 +213,31 @@ public:
 		 * @return          Whether the timer event was successfully handled or not
 		 */
 		bool onTimer(event_id_t timer_id);
+
+		/**
+		 * Record the contexts left with data after an encapsulation and
+		 * flush the ones that are filled enough
+		 *
+		 * @param time_contexts  The contexts returned by the encapsulation
+		 * @return               Whether the contexts were successfully handled or not
+		 */
+		bool updatePendingContexts(const std::map<int, long> &time_contexts);
+
+		/**
+		 * Flush an emission context and send its packets to the lower layer
+		 *
+		 * @param context_id  The ID of the context to flush
+		 * @param now         The current time
+		 * @return            Whether the context was successfully flushed or not
+		 */
+		bool flushContext(int context_id, time_ms_t now);
+
+		/**
+		 * Arm the flush timer on the earliest deadline of the pending contexts
+		 *
+		 * @param now  The current time
+		 */
+		void armFlushTimer(time_ms_t now);
 	};
 
 protected:
@@ -171,6 +247,20 @@ protected:
 
 	bool scpc_enabled;
 
+	/**
+	 * Read the flush policy of the emission contexts in configuration
+	 *
+	 * @param policy  The flush policy
+	 * @return        Whether the policy was correctly read or not
+	 */
+	bool getFlushPolicy(EncapFlushPolicy &policy);
+
+	/**
+	 * Register the probes of the emission contexts for the flows of the
+	 * configured entities
+	 */
+	void initContextProbes();
+
 	/**
 	 *
 	 * Get the Encapsulation context of the Up/Return or the Down/Forward link
@@ -34,8 +34,10 @@
 
 #include "BlockInterconnect.h"
 #include "OpenSandModelConf.h"
+#include "DvbFrameBatch.h"
 
 #include <opensand_rt/MessageEvent.h>
+#include <opensand_rt/TcpListenEvent.h>
 
 BlockInterconnectDownward::BlockInterconnectDownward(const std::string &name,
                                                      const InterconnectConfig &):
@@ -75,6 +77,35 @@ bool BlockInterconnectDownward::Downward::onEvent(const RtEvent *const event)
 			auto msg_event = static_cast<const MessageEvent*>(event);
 			rt_msg_t message = msg_event->getMessage();
 
+			if(to_enum<InternalMessageType>(message.type) == InternalMessageType::batch)
+			{
+				// Frames are serialized one by one on the interconnect
+				std::unique_ptr<DvbFrameBatch> frames{static_cast<DvbFrameBatch *>(message.data)};
+				InternalMessageType frames_type = frames->getFramesType();
+				if(frames_type != InternalMessageType::encap_data &&
+				   frames_type != InternalMessageType::sig)
+				{
+					// send() would not take the frames, they are
+					// released with the batch
+					LOG(this->log_interconnect, LEVEL_ERROR,
+					    "unsupported type of frames in batch\n");
+					return false;
+				}
+				bool status = true;
+				for(auto &&frame: *frames)
+				{
+					rt_msg_t frame_message{frame.release(), 0, to_underlying(frames->getFramesType())};
+					status = this->send(frame_message) && status;
+				}
+				if(!status)
+				{
+					LOG(this->log_interconnect, LEVEL_ERROR,
+					    "error when sending data\n");
+					return false;
+				}
+				break;
+			}
+
 			// Check if object inside
 			if(!this->send(message))
 			{
@@ -103,14 +134,13 @@ bool BlockInterconnectDownward::Downward::onEvent(const RtEvent *const event)
 
 bool BlockInterconnectDownward::Upward::onEvent(const RtEvent *const event)
 {
+	std::list<rt_msg_t> messages;
 	bool status = true;
 
 	switch(event->getType())
 	{
 		case EventType::NetSocket:
 		{
-			std::list<rt_msg_t> messages;
-
 			LOG(this->log_interconnect, LEVEL_DEBUG,
 			    "NetSocket event received\n");
 
@@ -121,17 +151,54 @@ bool BlockInterconnectDownward::Upward::onEvent(const RtEvent *const event)
 				    "error when receiving data on input channel\n");
 				status = false;
 			}
-			// Iterate over received messages
-			for(std::list<rt_msg_t>::iterator it = messages.begin();
-			    it != messages.end(); it++)
+		}
+		break;
+
+		case EventType::File:
+		{
+			std::vector<int32_t> closed_fds;
+
+			// Receive messages from a stream
+			if(!this->receive((FileEvent *)event, messages, closed_fds))
+			{
+				LOG(this->log_interconnect, LEVEL_ERROR,
+				    "error when receiving data on input stream\n");
+				status = false;
+			}
+			// removing the events closes the lost connection
+			for(int32_t fd: closed_fds)
+			{
+				this->removeEvent(fd);
+			}
+		}
+		break;
+
+		case EventType::TcpListen:
+		{
+			std::vector<int32_t> connection_fds;
+			std::vector<int32_t> replaced_fds;
+
+			if(!this->accept((TcpListenEvent *)event, connection_fds, replaced_fds))
+			{
+				LOG(this->log_interconnect, LEVEL_ERROR,
+				    "connection on unknown stream %s\n",
+				    event->getName().c_str());
+				return false;
+			}
+			// removing the events closes the replaced connection
+			for(int32_t fd: replaced_fds)
 			{
-				// Send message to the next block
-				if(!this->enqueueMessage((void **)(&it->data),
-				                          it->length, it->type))
+				this->removeEvent(fd);
+			}
+			for(int32_t fd: connection_fds)
+			{
+				if(this->addFileEvent(event->getName() + "_connection",
+				                      fd,
+				                      MAX_SOCK_SIZE) < 0)
 				{
 					LOG(this->log_interconnect, LEVEL_ERROR,
-					    "failed to send message to next block\n");
-					status = false;
+					    "cannot add stream connection event\n");
+					return false;
 				}
 			}
 		}
@@ -144,6 +211,20 @@ bool BlockInterconnectDownward::Upward::onEvent(const RtEvent *const event)
 			return false;
 	}
 
+	// Iterate over received messages
+	for(std::list<rt_msg_t>::iterator it = messages.begin();
+	    it != messages.end(); it++)
+	{
+		// Send message to the next block
+		if(!this->enqueueMessage((void **)(&it->data),
+		                          it->length, it->type))
+		{
+			LOG(this->log_interconnect, LEVEL_ERROR,
+			    "failed to send message to next block\n");
+			status = false;
+		}
+	}
+
 	return status;
 }
 
@@ -157,24 +238,39 @@ bool BlockInterconnectDownward::onInit(void)
 bool BlockInterconnectDownward::Upward::onInit(void)
 {
 	std::string name="UpwardInterconnectChannel";
-	unsigned int stack;
-	unsigned int rmem;
-	unsigned int wmem;
-	unsigned int data_port;
-	unsigned int sig_port;
-	std::string remote_addr("");
 	int32_t socket_event;
 
-	auto Conf = OpenSandModelConf::Get();
-	if(!Conf->getInterconnectCarrier(true, remote_addr, data_port, sig_port, stack, rmem, wmem, isl_index))
+	// Create channel
+	if(!this->initChannels(true, isl_index))
 	{
 		LOG(this->log_init, LEVEL_ERROR,
-		    "Entity infrastructure is missing interconnect data\n");
+		    "Cannot initialize the interconnect channels\n");
 		return false;
 	}
 
-	// Create channel
-	this->initUdpChannels(data_port, sig_port, remote_addr, stack, rmem, wmem);
+	if(this->isStream())
+	{
+		// Add TcpListenEvents, connections are added when accepted
+		socket_event = this->addTcpListenEvent(name + "_data_listen",
+		                                       this->data_stream->getListenFd(),
+		                                       MAX_SOCK_SIZE);
+		if(socket_event < 0)
+		{
+			LOG(this->log_init, LEVEL_ERROR,
+			    "Cannot add data listen event to Upward channel\n");
+			return false;
+		}
+		socket_event = this->addTcpListenEvent(name + "_sig_listen",
+		                                       this->sig_stream->getListenFd(),
+		                                       MAX_SOCK_SIZE);
+		if(socket_event < 0)
+		{
+			LOG(this->log_init, LEVEL_ERROR,
+			    "Cannot add sig listen event to Upward channel\n");
+			return false;
+		}
+		return true;
+	}
 
 	// Add NetSocketEvents
 	socket_event = this->addNetSocketEvent(name + "_data",
@@ -200,23 +296,29 @@ bool BlockInterconnectDownward::Upward::onInit(void)
 
 bool BlockInterconnectDownward::Downward::onInit()
 {
-	unsigned int stack;
-	unsigned int rmem;
-	unsigned int wmem;
-	unsigned int data_port;
-	unsigned int sig_port;
-	std::string remote_addr("");
-
-	auto Conf = OpenSandModelConf::Get();
-	if(!Conf->getInterconnectCarrier(false, remote_addr, data_port, sig_port, stack, rmem, wmem, isl_index))
+	// Create channel
+	if(!this->initChannels(false, isl_index))
 	{
 		LOG(this->log_init, LEVEL_ERROR,
-		    "Entity infrastructure is missing interconnect data\n");
+		    "Cannot initialize the interconnect channels\n");
 		return false;
 	}
 
-	// Create channel
-	this->initUdpChannels(data_port, sig_port, remote_addr, stack, rmem, wmem);
+	if(!this->initCompression(isl_index))
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "Cannot initialize the interconnect compression\n");
+		return false;
+	}
+
+	if(this->isStream() && polling_rate == 0 &&
+	   !OpenSandModelConf::Get()->getDelayTimer(polling_rate))
+	{
+		// Streams are written once per timer, even without delay
+		LOG(this->log_init, LEVEL_ERROR,
+		    "Cannot get the polling rate for the stream timer\n");
+		return false;
+	}
 
 	delay_timer = this->addTimerEvent(name + ".delay_timer", polling_rate);
 
@@ -254,14 +356,13 @@ BlockInterconnectUpward::Downward::Downward(const std::string &name, const Inter
 
 bool BlockInterconnectUpward::Downward::onEvent(const RtEvent *const event)
 {
+	std::list<rt_msg_t> messages;
 	bool status = true;
 
 	switch(event->getType())
 	{
 		case EventType::NetSocket:
 		{
-			std::list<rt_msg_t> messages;
-
 			LOG(this->log_interconnect, LEVEL_DEBUG,
 			    "NetSocket event received\n");
 
@@ -272,17 +373,54 @@ bool BlockInterconnectUpward::Downward::onEvent(const RtEvent *const event)
 				    "error when receiving data on input channel\n");
 				status = false;
 			}
-			// Iterate over received messages
-			for(std::list<rt_msg_t>::iterator it = messages.begin();
-			    it != messages.end(); it++)
+		}
+		break;
+
+		case EventType::File:
+		{
+			std::vector<int32_t> closed_fds;
+
+			// Receive messages from a stream
+			if(!this->receive((FileEvent *)event, messages, closed_fds))
+			{
+				LOG(this->log_interconnect, LEVEL_ERROR,
+				    "error when receiving data on input stream\n");
+				status = false;
+			}
+			// removing the events closes the lost connection
+			for(int32_t fd: closed_fds)
+			{
+				this->removeEvent(fd);
+			}
+		}
+		break;
+
+		case EventType::TcpListen:
+		{
+			std::vector<int32_t> connection_fds;
+			std::vector<int32_t> replaced_fds;
+
+			if(!this->accept((TcpListenEvent *)event, connection_fds, replaced_fds))
+			{
+				LOG(this->log_interconnect, LEVEL_ERROR,
+				    "connection on unknown stream %s\n",
+				    event->getName().c_str());
+				return false;
+			}
+			// removing the events closes the replaced connection
+			for(int32_t fd: replaced_fds)
+			{
+				this->removeEvent(fd);
+			}
+			for(int32_t fd: connection_fds)
 			{
-				// Send message to the next block
-				if(!this->enqueueMessage((void **)(&it->data),
-				                         it->length, it->type))
+				if(this->addFileEvent(event->getName() + "_connection",
+				                      fd,
+				                      MAX_SOCK_SIZE) < 0)
 				{
 					LOG(this->log_interconnect, LEVEL_ERROR,
-					    "failed to send message to next block\n");
-					status = false;
+					    "cannot add stream connection event\n");
+					return false;
 				}
 			}
 		}
@@ -295,6 +433,20 @@ bool BlockInterconnectUpward::Downward::onEvent(const RtEvent *const event)
 			return false;
 	}
 
+	// Iterate over received messages
+	for(std::list<rt_msg_t>::iterator it = messages.begin();
+	    it != messages.end(); it++)
+	{
+		// Send message to the next block
+		if(!this->enqueueMessage((void **)(&it->data),
+		                         it->length, it->type))
+		{
+			LOG(this->log_interconnect, LEVEL_ERROR,
+			    "failed to send message to next block\n");
+			status = false;
+		}
+	}
+
 	return status;
 }
 
@@ -342,23 +494,29 @@ bool BlockInterconnectUpward::onInit(void)
 
 bool BlockInterconnectUpward::Upward::onInit(void)
 {
-	unsigned int stack;
-	unsigned int rmem;
-	unsigned int wmem;
-	unsigned int data_port;
-	unsigned int sig_port;
-	std::string remote_addr("");
-
-	auto Conf = OpenSandModelConf::Get();
-	if(!Conf->getInterconnectCarrier(true, remote_addr, data_port, sig_port, stack, rmem, wmem, isl_index))
+	// Create channel
+	if(!this->initChannels(true, isl_index))
 	{
 		LOG(this->log_init, LEVEL_ERROR,
-		    "Entity infrastructure is missing interconnect data\n");
+		    "Cannot initialize the interconnect channels\n");
 		return false;
 	}
 
-	// Create channel
-	this->initUdpChannels(data_port, sig_port, remote_addr, stack, rmem, wmem);
+	if(!this->initCompression(isl_index))
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "Cannot initialize the interconnect compression\n");
+		return false;
+	}
+
+	if(this->isStream() && polling_rate == 0 &&
+	   !OpenSandModelConf::Get()->getDelayTimer(polling_rate))
+	{
+		// Streams are written once per timer, even without delay
+		LOG(this->log_init, LEVEL_ERROR,
+		    "Cannot get the polling rate for the stream timer\n");
+		return false;
+	}
 
 	delay_timer = this->addTimerEvent(name + ".delay_timer", polling_rate);
 
@@ -368,24 +526,39 @@ bool BlockInterconnectUpward::Upward::onInit(void)
 bool BlockInterconnectUpward::Downward::onInit()
 {
 	std::string name="DownwardInterconnectChannel";
-	unsigned int stack;
-	unsigned int rmem;
-	unsigned int wmem;
-	unsigned int data_port;
-	unsigned int sig_port;
-	std::string remote_addr("");
 	int32_t socket_event;
 
-	auto Conf = OpenSandModelConf::Get();
-	if(!Conf->getInterconnectCarrier(false, remote_addr, data_port, sig_port, stack, rmem, wmem, isl_index))
+	// Create channel
+	if(!this->initChannels(false, isl_index))
 	{
 		LOG(this->log_init, LEVEL_ERROR,
-		    "Entity infrastructure is missing interconnect data\n");
+		    "Cannot initialize the interconnect channels\n");
 		return false;
 	}
 
-	// Create channel
-	this->initUdpChannels(data_port, sig_port, remote_addr, stack, rmem, wmem);
+	if(this->isStream())
+	{
+		// Add TcpListenEvents, connections are added when accepted
+		socket_event = this->addTcpListenEvent(name + "_data_listen",
+		                                       this->data_stream->getListenFd(),
+		                                       MAX_SOCK_SIZE);
+		if(socket_event < 0)
+		{
+			LOG(this->log_init, LEVEL_ERROR,
+			    "Cannot add data listen event to Downward channel\n");
+			return false;
+		}
+		socket_event = this->addTcpListenEvent(name + "_sig_listen",
+		                                       this->sig_stream->getListenFd(),
+		                                       MAX_SOCK_SIZE);
+		if(socket_event < 0)
+		{
+			LOG(this->log_init, LEVEL_ERROR,
+			    "Cannot add sig listen event to Downward channel\n");
+			return false;
+		}
+		return true;
+	}
 
 	// Add NetSocketEvents
 	socket_event = this->addNetSocketEvent(name + "_data",
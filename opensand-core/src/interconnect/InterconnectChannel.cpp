@@ -34,15 +34,24 @@
 
 #include "BlockInterconnect.h"
 #include "InterconnectChannel.h"
+#include "InterconnectCompression.h"
 #include "NetBurst.h"
+#include "OpenSandModelConf.h"
 #include <opensand_output/Output.h>
 #include <opensand_rt/NetSocketEvent.h>
+#include <opensand_rt/TcpListenEvent.h>
+
+#include <chrono>
+#include <climits>
 
 InterconnectChannel::InterconnectChannel(std::string name, const InterconnectConfig &config):
 	name(name),
 	interconnect_addr(config.interconnect_addr),
+	transport(InterconnectTransport::udp),
 	data_channel(nullptr),
-	sig_channel(nullptr)
+	sig_channel(nullptr),
+	data_stream(nullptr),
+	sig_stream(nullptr)
 {
 	this->log_interconnect = Output::Get()->registerLog(LEVEL_WARNING, name + ".common");
 }
@@ -61,13 +70,93 @@ InterconnectChannel::~InterconnectChannel()
 	}
 }
 
+bool InterconnectChannel::initChannels(bool upward, std::size_t isl_index)
+{
+	unsigned int stack;
+	unsigned int rmem;
+	unsigned int wmem;
+	unsigned int data_port;
+	unsigned int sig_port;
+	std::string remote_addr("");
+	std::string transport_name;
+	std::string socket_dir;
+
+	auto Conf = OpenSandModelConf::Get();
+	if(!Conf->getInterconnectCarrier(upward, remote_addr, data_port, sig_port, stack, rmem, wmem, isl_index) ||
+	   !Conf->getInterconnectTransport(transport_name, socket_dir, isl_index))
+	{
+		LOG(this->log_interconnect, LEVEL_ERROR,
+		    "Entity infrastructure is missing interconnect data\n");
+		return false;
+	}
+
+	if(transport_name == "TCP")
+	{
+		this->transport = InterconnectTransport::tcp;
+	}
+	else if(transport_name == "Unix")
+	{
+		this->transport = InterconnectTransport::unix_socket;
+	}
+	else if(transport_name == "SharedMemory")
+	{
+		this->transport = InterconnectTransport::shared_memory;
+	}
+	else
+	{
+		this->transport = InterconnectTransport::udp;
+		this->initUdpChannels(data_port, sig_port, remote_addr, stack, rmem, wmem);
+		return true;
+	}
+
+	LOG(this->log_interconnect, LEVEL_INFO,
+	    "messages are carried on %s transport\n", transport_name.c_str());
+	return this->initStreams(data_port, sig_port, remote_addr, socket_dir, rmem, wmem);
+}
+
 /*
  * INTERCONNECT_CHANNEL_SENDER
  */
 InterconnectChannelSender::InterconnectChannelSender(std::string name, const InterconnectConfig &config):
 	InterconnectChannel{name, config},
-	delay{config.delay}
+	delay{config.delay},
+	send_window{0},
+	compress_headers{false},
+	compress_block{false},
+	compression_threshold{0},
+	probe_compression_ratio{nullptr},
+	probe_compression_time{nullptr}
+{
+}
+
+bool InterconnectChannelSender::initCompression(std::size_t isl_index)
 {
+	std::string compression;
+	unsigned int threshold;
+	if(!OpenSandModelConf::Get()->getInterconnectCompression(compression, threshold, isl_index))
+	{
+		LOG(this->log_interconnect, LEVEL_ERROR,
+		    "Entity infrastructure is missing interconnect data\n");
+		return false;
+	}
+
+	this->compress_headers = compression != "None";
+	this->compress_block = compression == "Headers and Payloads";
+	this->compression_threshold = threshold;
+	if(!this->compress_headers)
+	{
+		return true;
+	}
+
+	// the receiving side decodes any message flagged as coded
+	LOG(this->log_interconnect, LEVEL_INFO,
+	    "compression of the messages: %s\n", compression.c_str());
+	auto output = Output::Get();
+	this->probe_compression_ratio = output->registerProbe<float>(name + ".Compression_ratio",
+	                                                             "%", true, SAMPLE_AVG);
+	this->probe_compression_time = output->registerProbe<float>(name + ".Compression_time",
+	                                                            "us", true, SAMPLE_AVG);
+	return true;
 }
 
 void InterconnectChannelSender::initUdpChannels(unsigned int data_port, unsigned int sig_port,
@@ -101,11 +190,60 @@ void InterconnectChannelSender::initUdpChannels(unsigned int data_port, unsigned
 	                                   wmem);
 }
 
-bool InterconnectChannelSender::sendBuffer(bool is_sig, const interconnect_msg_buffer_t &msg)
+bool InterconnectChannelSender::initStreams(unsigned int data_port, unsigned int sig_port,
+                                            std::string remote_addr, std::string socket_dir,
+                                            unsigned int rmem, unsigned int wmem)
 {
-	auto buffer = reinterpret_cast<const uint8_t *>(&msg);
-	auto channel = is_sig ? this->sig_channel : this->data_channel;
-	return channel->send(buffer, msg.data_len);
+	this->data_stream = InterconnectStream::create(name + ".data_stream",
+	                                               this->transport,
+	                                               remote_addr,
+	                                               data_port,
+	                                               socket_dir,
+	                                               rmem,
+	                                               wmem);
+	this->sig_stream = InterconnectStream::create(name + ".sig_stream",
+	                                              this->transport,
+	                                              remote_addr,
+	                                              sig_port,
+	                                              socket_dir,
+	                                              rmem,
+	                                              wmem);
+	// no more than a socket buffer is kept aside the socket
+	this->send_window = wmem;
+
+	// the receiving side may not be started yet, the connection is
+	// retried on each timer
+	this->data_stream->connect();
+	this->sig_stream->connect();
+	return true;
+}
+
+bool InterconnectChannelSender::sendBuffer(std::unique_ptr<InterconnectMessage> msg)
+{
+	if (this->isStream())
+	{
+		auto &stream = msg->isSig() ? this->sig_stream : this->data_stream;
+		stream->push(std::move(msg));
+		return true;
+	}
+
+	this->iovecs.clear();
+	msg->getBuffers(this->iovecs);
+	auto channel = msg->isSig() ? this->sig_channel : this->data_channel;
+	if (this->iovecs.size() > IOV_MAX)
+	{
+		// too many small packets to be gathered by the kernel, copy them
+		Data buffer;
+		buffer.reserve(msg->getTotalLength());
+		// the first buffer is reserved for the channel
+		for (std::size_t i = 1; i < this->iovecs.size(); ++i)
+		{
+			buffer.append(static_cast<const unsigned char *>(this->iovecs[i].iov_base),
+			              this->iovecs[i].iov_len);
+		}
+		return channel->send(buffer.c_str(), buffer.length());
+	}
+	return channel->send(this->iovecs.data(), this->iovecs.size());
 }
 
 /*
@@ -115,27 +253,29 @@ bool InterconnectChannelSender::send(rt_msg_t &message)
 {
 	time_ms_t current_time = getCurrentTime();
 
-	interconnect_msg_buffer_t msg_buffer;
-	uint32_t len;
-
 	auto msg_type = to_enum<InternalMessageType>(message.type);
-	msg_buffer.msg_type = message.type;
+	std::unique_ptr<InterconnectMessage> msg{new InterconnectMessage(message.type)};
 
-	// Serialize the message
+	// Frame the message, its content is not copied
 	if (msg_type == InternalMessageType::encap_data || msg_type == InternalMessageType::sig)
 	{
-		auto frame = std::unique_ptr<DvbFrame>{static_cast<DvbFrame *>(message.data)};
-		this->serialize(frame.get(), msg_buffer.msg_data, len);
+		msg->addFrame(std::unique_ptr<DvbFrame>{static_cast<DvbFrame *>(message.data)}, false);
 	}
 	else if (msg_type == InternalMessageType::saloha)
 	{
 		auto dvb_frames = std::unique_ptr<std::list<DvbFrame *>>{static_cast<std::list<DvbFrame *> *>(message.data)};
-		this->serialize(dvb_frames.get(), msg_buffer.msg_data, len);
+		for (auto dvb_frame: *dvb_frames)
+		{
+			msg->addFrame(std::unique_ptr<DvbFrame>{dvb_frame}, true);
+		}
 	}
 	else if (msg_type == InternalMessageType::decap_data)
 	{
 		auto net_burst = std::unique_ptr<NetBurst>{static_cast<NetBurst *>(message.data)};
-		this->serialize(*net_burst, msg_buffer.msg_data, len);
+		for (auto &&packet: *net_burst)
+		{
+			msg->addPacket(std::move(packet));
+		}
 	}
 	else
 	{
@@ -144,21 +284,39 @@ bool InterconnectChannelSender::send(rt_msg_t &message)
 		return false;
 	}
 
-	// add the length of the other fields
-	msg_buffer.data_len = len + sizeof(msg_buffer.msg_type) + sizeof(msg_buffer.data_len);
+	if (msg->getTotalLength() > MAX_SOCK_SIZE)
+	{
+		LOG(this->log_interconnect, LEVEL_ERROR,
+		    "message of %zu bytes is too large for the interconnect\n",
+		    msg->getTotalLength());
+		return false;
+	}
+
+	if (this->compress_headers)
+	{
+		this->compress(*msg);
+	}
 
-	// construct a NetContainer to store it in a FifoElement
-	auto buf = reinterpret_cast<const uint8_t *>(&msg_buffer);
-	std::unique_ptr<NetContainer> container{new NetContainer(buf, msg_buffer.data_len)};
-	FifoElement *elem = new FifoElement(std::move(container), current_time, current_time + delay);
+	// store it in a FifoElement
+	FifoElement *elem = new FifoElement(std::move(msg), current_time, current_time + delay);
 
 	if (!delay_fifo.pushBack(elem)) {
 		LOG(this->log_interconnect, LEVEL_ERROR, "failed to push the message in the fifo\n");
+		delete elem;
 		return false;
 	}
 	
 	// if no delay, send directly
-	if (delay == 0)
+	if (delay == 0 && this->isStream())
+	{
+		// streams are written on the next timer, meanwhile the
+		// messages are only queued
+		bool status = this->sendElapsed();
+		this->waitSendWindow(*this->data_stream);
+		this->waitSendWindow(*this->sig_stream);
+		return status;
+	}
+	else if (delay == 0)
 	{
 		return onTimerEvent();
 	}
@@ -166,7 +324,7 @@ bool InterconnectChannelSender::send(rt_msg_t &message)
 	return true;
 }
 
-bool InterconnectChannelSender::onTimerEvent()
+bool InterconnectChannelSender::sendElapsed()
 {
 	time_ms_t current_time = getCurrentTime();
 
@@ -175,10 +333,9 @@ bool InterconnectChannelSender::onTimerEvent()
 		FifoElement *elem = delay_fifo.pop();
 		assert(elem != nullptr);
 
-		auto container = elem->getElem<NetContainer>();
-		auto msg = reinterpret_cast<const interconnect_msg_buffer_t *>(container->getRawData());
-		bool is_sig = to_enum<InternalMessageType>(msg->msg_type) == InternalMessageType::sig;
-		if (!sendBuffer(is_sig, *msg))
+		auto msg = elem->getElem<InterconnectMessage>();
+		delete elem;
+		if (!sendBuffer(std::move(msg)))
 		{
 			LOG(this->log_interconnect, LEVEL_ERROR, "failed to send buffer\n");
 			return false;
@@ -187,78 +344,229 @@ bool InterconnectChannelSender::onTimerEvent()
 	return true;
 }
 
-template <typename T>
-void serializeField(uint8_t *buf, uint32_t &pos, T *data, uint32_t length = sizeof(T))
+bool InterconnectChannelSender::onTimerEvent()
 {
-	memcpy(buf + pos, data, length);
-	pos += length;
+	if (!this->sendElapsed())
+	{
+		return false;
+	}
+	if (!this->isStream())
+	{
+		return true;
+	}
+
+	bool status = true;
+	for (auto stream: {this->data_stream.get(), this->sig_stream.get()})
+	{
+		// the messages are kept until the stream is connected
+		if (stream->connect() && !stream->flush())
+		{
+			LOG(this->log_interconnect, LEVEL_ERROR, "failed to write on stream\n");
+			status = false;
+		}
+		this->waitSendWindow(*stream);
+	}
+	return status;
 }
 
-void InterconnectChannelSender::serialize(DvbFrame *dvb_frame,
-                                          unsigned char *buf,
-                                          uint32_t &length)
+void InterconnectChannelSender::compress(InterconnectMessage &msg)
 {
-	uint32_t pos = 0;
-	spot_id_t spot = dvb_frame->getSpot();
-	uint8_t carrier_id = dvb_frame->getCarrierId();
+	constexpr std::size_t header_length = sizeof(uint32_t) + sizeof(uint8_t);
+	std::size_t length = msg.getTotalLength();
+	bool code_headers = to_enum<InternalMessageType>(msg.getMessageType()) == InternalMessageType::decap_data;
+	bool code_block = this->compress_block && length - header_length >= this->compression_threshold;
+	if (!code_headers && !code_block)
+	{
+		// only NetBursts are header coded, do not gather the others
+		return;
+	}
 
-	serializeField(buf, pos, &spot);
-	serializeField(buf, pos, &carrier_id);
-	serializeField(buf, pos, dvb_frame->getRawData(), dvb_frame->getTotalLength());
-	length = pos;
+	auto start = std::chrono::steady_clock::now();
+
+	// gather the message content, after its length and type
+	this->iovecs.clear();
+	msg.getBuffers(this->iovecs);
+	this->plain.resize(length);
+	std::size_t pos = 0;
+	for (std::size_t i = 1; i < this->iovecs.size(); ++i)
+	{
+		memcpy(this->plain.data() + pos, this->iovecs[i].iov_base, this->iovecs[i].iov_len);
+		pos += this->iovecs[i].iov_len;
+	}
+	const unsigned char *content = this->plain.data() + header_length;
+	std::size_t content_length = length - header_length;
+
+	uint8_t coding = 0;
+	if (code_headers &&
+	    InterconnectCompression::encodeHeaders(content, content_length, this->headers_coded))
+	{
+		coding |= InterconnectCompression::headers_coding;
+		content = this->headers_coded.data();
+		content_length = this->headers_coded.size();
+	}
+	if (this->compress_block && content_length >= this->compression_threshold)
+	{
+		InterconnectCompression::compressBlock(content, content_length, this->block_coded);
+		if (this->block_coded.size() < content_length)
+		{
+			coding |= InterconnectCompression::block_coding;
+			content = this->block_coded.data();
+			content_length = this->block_coded.size();
+		}
+	}
+
+	if (coding != 0 && header_length + content_length < length)
+	{
+		msg.setCodedPayload(coding, content, content_length);
+	}
+
+	auto duration = std::chrono::steady_clock::now() - start;
+	this->probe_compression_ratio->put(100.0 * msg.getTotalLength() / length);
+	this->probe_compression_time->put(
+	    std::chrono::duration_cast<std::chrono::duration<float, std::micro>>(duration).count());
 }
 
-void InterconnectChannelSender::serialize(std::list<DvbFrame *> *dvb_frame_list,
-                                          unsigned char *buf,
-                                          uint32_t &length)
+void InterconnectChannelSender::waitSendWindow(InterconnectStream &stream)
 {
-	length = 0;
-	// Iterate over dvb_frames
-	for (auto dvb_frame: *dvb_frame_list)
+	unsigned int dropped = 0;
+	while (stream.getPendingLength() > this->send_window)
+	{
+		if (!stream.isConnected())
+		{
+			stream.dropFront();
+			++dropped;
+		}
+		else if (stream.waitWritable(100))
+		{
+			// on error the connection is closed and messages are dropped
+			stream.flush();
+		}
+	}
+	if (dropped > 0)
 	{
-		uint32_t partial_len;
-		// First serialize dvb_frame
-		this->serialize(dvb_frame, buf + length + sizeof(partial_len), partial_len);
-		// Copy the size of the dvb_frame before the frame itself
-		memcpy(buf + length, &partial_len, sizeof(partial_len));
-		length += partial_len + sizeof(partial_len);
+		LOG(this->log_interconnect, LEVEL_WARNING,
+		    "stream is not connected, %u messages dropped\n", dropped);
 	}
 }
 
-void InterconnectChannelSender::serialize(const NetBurst &net_burst,
-                                          unsigned char *buf, uint32_t &length)
+/*
+ * INTERCONNECT_MESSAGE
+ */
+InterconnectMessage::InterconnectMessage(uint8_t msg_type):
+	NetContainer{},
+	msg_type{msg_type},
+	contents{},
+	header_ends{},
+	contents_length{0}
 {
-	length = 0;
-	for (auto &&packet: net_burst)
+	// the message header, its length is set when sending
+	uint32_t data_len = 0;
+	this->addField(data_len);
+	this->addField(msg_type);
+}
+
+template <typename T>
+void InterconnectMessage::addField(const T &field)
+{
+	this->data.append(reinterpret_cast<const unsigned char *>(&field), sizeof(T));
+}
+
+void InterconnectMessage::addContent(std::unique_ptr<NetContainer> content)
+{
+	this->header_ends.push_back(this->data.length());
+	this->contents_length += content->getTotalLength();
+	this->contents.push_back(std::move(content));
+}
+
+void InterconnectMessage::addFrame(std::unique_ptr<DvbFrame> frame, bool with_length)
+{
+	spot_id_t spot = frame->getSpot();
+	uint8_t carrier_id = frame->getCarrierId();
+
+	if (with_length)
 	{
-		uint32_t partial_len;
-		// First serialize the packet
-		this->serialize(*packet, buf + length + sizeof(partial_len), partial_len);
-		// Copy the size of the packet before the packet itself
-		memcpy(buf + length, &partial_len, sizeof(partial_len));
-		length += partial_len + sizeof(partial_len);
-		assert(length <= MAX_SOCK_SIZE);
+		uint32_t length = sizeof(spot) + sizeof(carrier_id) + frame->getTotalLength();
+		this->addField(length);
 	}
+	this->addField(spot);
+	this->addField(carrier_id);
+	this->addContent(std::move(frame));
 }
 
-void InterconnectChannelSender::serialize(const NetPacket &packet,
-                                          unsigned char *buf, uint32_t &length)
+void InterconnectMessage::addPacket(std::unique_ptr<NetPacket> packet)
 {
-	uint32_t pos = 0;
+	uint8_t src_id = packet->getSrcTalId();
+	uint8_t dest_id = packet->getDstTalId();
+	uint8_t qos = packet->getQos();
+	NET_PROTO type = packet->getType();
+	uint32_t header_length = packet->getHeaderLength();
+	uint32_t length = sizeof(src_id) + sizeof(dest_id) + sizeof(qos) +
+	                  sizeof(type) + sizeof(header_length) + packet->getTotalLength();
+
+	this->addField(length);
+	this->addField(src_id);
+	this->addField(dest_id);
+	this->addField(qos);
+	this->addField(type);
+	this->addField(header_length);
+	this->addContent(std::move(packet));
+}
+
+bool InterconnectMessage::isSig() const
+{
+	return to_enum<InternalMessageType>(this->msg_type) == InternalMessageType::sig;
+}
+
+uint8_t InterconnectMessage::getMessageType() const
+{
+	return this->msg_type;
+}
+
+void InterconnectMessage::setCodedPayload(uint8_t coding, const unsigned char *payload, std::size_t length)
+{
+	this->contents.clear();
+	this->header_ends.clear();
+	this->contents_length = 0;
+
+	// the content follows the message header
+	this->data.clear();
+	uint32_t data_len = 0;
+	uint8_t coded_type = this->msg_type | coding;
+	this->addField(data_len);
+	this->addField(coded_type);
+	this->data.append(payload, length);
+}
+
+std::size_t InterconnectMessage::getTotalLength() const
+{
+	return this->data.length() + this->contents_length;
+}
+
+void InterconnectMessage::getBuffers(std::vector<struct iovec> &iov)
+{
+	uint32_t data_len = this->getTotalLength();
+	this->data.replace(0, sizeof(data_len),
+	                   reinterpret_cast<const unsigned char *>(&data_len),
+	                   sizeof(data_len));
 
-	uint8_t src_id = packet.getSrcTalId();
-	uint8_t dest_id = packet.getDstTalId();
-	uint8_t qos = packet.getQos();
-	NET_PROTO type = packet.getType();
-	uint32_t header_length = packet.getHeaderLength();
+	iov.reserve(iov.size() + 1 + 2 * this->contents.size());
+	iov.push_back(iovec{nullptr, 0});
 
-	serializeField(buf, pos, &src_id);
-	serializeField(buf, pos, &dest_id);
-	serializeField(buf, pos, &qos);
-	serializeField(buf, pos, &type);
-	serializeField(buf, pos, &header_length);
-	serializeField(buf, pos, packet.getRawData(), packet.getTotalLength());
-	length = pos;
+	std::size_t header_start = 0;
+	for (std::size_t i = 0; i < this->contents.size(); ++i)
+	{
+		iov.push_back(iovec{this->getRawData() + header_start,
+		                    this->header_ends[i] - header_start});
+		iov.push_back(iovec{this->contents[i]->getRawData(),
+		                    this->contents[i]->getTotalLength()});
+		header_start = this->header_ends[i];
+	}
+	if (header_start < this->data.length())
+	{
+		// a message without content only has its header
+		iov.push_back(iovec{this->getRawData() + header_start,
+		                    this->data.length() - header_start});
+	}
 }
 
 /*
@@ -296,6 +604,115 @@ void InterconnectChannelReceiver::initUdpChannels(unsigned int data_port, unsign
 	                                   wmem);
 }
 
+bool InterconnectChannelReceiver::initStreams(unsigned int data_port, unsigned int sig_port,
+                                              std::string, std::string socket_dir,
+                                              unsigned int rmem, unsigned int wmem)
+{
+	this->data_stream = InterconnectStream::create(name + ".data_stream",
+	                                               this->transport,
+	                                               this->interconnect_addr,
+	                                               data_port,
+	                                               socket_dir,
+	                                               rmem,
+	                                               wmem);
+	this->sig_stream = InterconnectStream::create(name + ".sig_stream",
+	                                              this->transport,
+	                                              this->interconnect_addr,
+	                                              sig_port,
+	                                              socket_dir,
+	                                              rmem,
+	                                              wmem);
+	return this->data_stream->listen() && this->sig_stream->listen();
+}
+
+bool InterconnectChannelReceiver::accept(TcpListenEvent *const event,
+                                         std::vector<int32_t> &connection_fds,
+                                         std::vector<int32_t> &replaced_fds)
+{
+	for (auto stream: {this->data_stream.get(), this->sig_stream.get()})
+	{
+		if (stream != nullptr && *event == stream->getListenFd())
+		{
+			LOG(this->log_interconnect, LEVEL_NOTICE,
+			    "interconnect stream connected\n");
+			stream->getConnectionFds(replaced_fds);
+			stream->setConnection(event->getSocketClient());
+			stream->getConnectionFds(connection_fds);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool InterconnectChannelReceiver::receive(FileEvent *const event,
+                                          std::list<rt_msg_t> &messages,
+                                          std::vector<int32_t> &closed_fds)
+{
+	InterconnectStream *stream = nullptr;
+
+	// Check if the event corresponds to any of the streams
+	for (auto candidate: {this->data_stream.get(), this->sig_stream.get()})
+	{
+		std::vector<int32_t> fds;
+		if (candidate != nullptr)
+		{
+			candidate->getConnectionFds(fds);
+		}
+		for (int32_t fd: fds)
+		{
+			if (*event == fd)
+			{
+				stream = candidate;
+			}
+		}
+	}
+	if (stream == nullptr)
+	{
+		LOG(this->log_interconnect, LEVEL_DEBUG,
+		    "Event does not correspond to interconnect stream\n");
+		return true;
+	}
+
+	std::size_t length = event->getSize();
+	if (length == 0)
+	{
+		LOG(this->log_interconnect, LEVEL_NOTICE,
+		    "interconnect stream closed by the sender\n");
+		// the events own the file descriptors, they close them on removal
+		stream->getConnectionFds(closed_fds);
+		stream->releaseConnection();
+		return true;
+	}
+	unsigned char *data = event->getData();
+	stream->feed(data, length);
+	delete [] data;
+
+	// Extract the completed messages
+	bool status = true;
+	uint8_t msg_type;
+	unsigned char *payload;
+	uint32_t payload_length;
+	int ret;
+	while ((ret = stream->nextMessage(msg_type, payload, payload_length)) > 0)
+	{
+		rt_msg_t message;
+		if (!this->deserialize(msg_type, payload, payload_length, message))
+		{
+			status = false;
+			continue;
+		}
+		messages.push_back(message);
+	}
+	if (ret < 0)
+	{
+		// messages boundaries are lost, wait for a new connection
+		stream->getConnectionFds(closed_fds);
+		stream->releaseConnection();
+		return false;
+	}
+	return status;
+}
+
 int InterconnectChannelReceiver::receiveToBuffer(NetSocketEvent *const event,
                                                  interconnect_msg_buffer_t **buf)
 {
@@ -378,46 +795,77 @@ bool InterconnectChannelReceiver::receive(NetSocketEvent *const event,
 			    "%zu bytes of data received\n",
 			    buf->data_len);
 
-			message.type = buf->msg_type;
-			message.length = buf->data_len;
-
 			// Deserialize the message
-			switch(to_enum<InternalMessageType>(buf->msg_type))
+			if(this->deserialize(buf->msg_type, buf->msg_data, buf->data_len, message))
 			{
-				case InternalMessageType::encap_data:
-				case InternalMessageType::sig:
-					// Deserialize the dvb_frame
-					this->deserialize(buf->msg_data, buf->data_len,
-					                  (DvbFrame **) &message.data);
-					break;
-				case InternalMessageType::saloha:
-					// Deserialize the list of dvb_frames
-					this->deserialize(buf->msg_data, buf->data_len,
-					                  (std::list<DvbFrame *> **) &message.data);
-					break;
-				case InternalMessageType::decap_data:
-					// Deserialize the NetBurst
-					this->deserialize(buf->msg_data, buf->data_len,
-					                  (NetBurst **) &message.data);
-
-					break;
-				default:
-					LOG(this->log_interconnect, LEVEL_ERROR,
-					    "Unknown type of message received\n");
-					status = false;
-					free(buf);
-					continue;
+				// Insert the message in the list
+				messages.push_back(message);
+			}
+			else
+			{
+				status = false;
 			}
 			// Free buf
 			free(buf);
-
-			// Insert the message in the list
-			messages.push_back(message);
 		}
 	} while (ret > 0);
 	return status;
 }
 
+bool InterconnectChannelReceiver::deserialize(uint8_t msg_type, unsigned char *data, uint32_t len,
+                                              rt_msg_t &message)
+{
+	if(msg_type & InterconnectCompression::block_coding)
+	{
+		// the restored message cannot be longer than the sent one
+		if(!InterconnectCompression::decompressBlock(data, len, MAX_SOCK_SIZE, this->block_decoded))
+		{
+			LOG(this->log_interconnect, LEVEL_ERROR,
+			    "Corrupted compressed message received\n");
+			return false;
+		}
+		data = this->block_decoded.data();
+		len = this->block_decoded.size();
+	}
+	if(msg_type & InterconnectCompression::headers_coding)
+	{
+		if(!InterconnectCompression::decodeHeaders(data, len, this->headers_decoded))
+		{
+			LOG(this->log_interconnect, LEVEL_ERROR,
+			    "Corrupted packets metadata received\n");
+			return false;
+		}
+		data = this->headers_decoded.data();
+		len = this->headers_decoded.size();
+	}
+	msg_type &= ~InterconnectCompression::coding_mask;
+
+	message.type = msg_type;
+	message.length = len;
+
+	switch(to_enum<InternalMessageType>(msg_type))
+	{
+		case InternalMessageType::encap_data:
+		case InternalMessageType::sig:
+			// Deserialize the dvb_frame
+			this->deserialize(data, len, (DvbFrame **) &message.data);
+			break;
+		case InternalMessageType::saloha:
+			// Deserialize the list of dvb_frames
+			this->deserialize(data, len, (std::list<DvbFrame *> **) &message.data);
+			break;
+		case InternalMessageType::decap_data:
+			// Deserialize the NetBurst
+			this->deserialize(data, len, (NetBurst **) &message.data);
+			break;
+		default:
+			LOG(this->log_interconnect, LEVEL_ERROR,
+			    "Unknown type of message received\n");
+			return false;
+	}
+	return true;
+}
+
 template <typename T>
 void deserializeField(uint8_t *buf, uint32_t &pos, T &data, uint32_t length = sizeof(T))
 {
@@ -36,11 +36,14 @@
 #define INTERCONNECT_CHANNEL_H
 
 #include <opensand_rt/Rt.h>
+#include <opensand_output/Probe.h>
 
 #include "DelayFifo.h"
 #include "DvbFrame.h"
+#include "InterconnectStream.h"
 #include "UdpChannel.h"
 #include <list>
+#include <vector>
 
 /**
  * @brief high level channel classes that implement some functions
@@ -49,6 +52,8 @@
 
 class OutputLog;
 class InterconnectConfig;
+class FileEvent;
+class TcpListenEvent;
 class NetBurst;
 class NetPacket;
 
@@ -59,6 +64,84 @@ struct __attribute__((__packed__)) interconnect_msg_buffer_t
 	uint8_t msg_data[MAX_SOCK_SIZE];
 };
 
+/**
+ * @class InterconnectMessage
+ * @brief A message waiting to be sent on the interconnect
+ *
+ * Only the headers framing the message and its elements are written in
+ * the container data, the frames and packets are kept as is and sent
+ * from their own buffers.
+ */
+class InterconnectMessage: public NetContainer
+{
+public:
+	InterconnectMessage(uint8_t msg_type);
+
+	/**
+	 * @brief Add a DVB frame to the message
+	 *
+	 * @param frame        the frame
+	 * @param with_length  whether the frame is prefixed by its length
+	 */
+	void addFrame(std::unique_ptr<DvbFrame> frame, bool with_length);
+
+	/**
+	 * @brief Add an encapsulation packet to the message
+	 *
+	 * @param packet  the packet
+	 */
+	void addPacket(std::unique_ptr<NetPacket> packet);
+
+	/**
+	 * @brief Whether the message is sent on the signalling channel
+	 */
+	bool isSig() const;
+
+	/**
+	 * @brief Get the message type
+	 */
+	uint8_t getMessageType() const;
+
+	/**
+	 * @brief Replace the message content by a coded one
+	 *
+	 * @param coding   the codings applied, flagged in the message type
+	 * @param payload  the coded content
+	 * @param length   the coded content length
+	 */
+	void setCodedPayload(uint8_t coding, const unsigned char *payload, std::size_t length);
+
+	/**
+	 * @brief Get the buffers to send, headers and contents alternating
+	 *
+	 * @param iov  the buffers, appended after a first one left empty
+	 *             for the channel
+	 */
+	void getBuffers(std::vector<struct iovec> &iov);
+
+	std::size_t getTotalLength() const override;
+
+private:
+	/**
+	 * @brief Append a header field to the data
+	 */
+	template<typename T>
+	void addField(const T &field);
+
+	/**
+	 * @brief Add a content after the headers appended so far
+	 */
+	void addContent(std::unique_ptr<NetContainer> content);
+
+	uint8_t msg_type;
+	/// The frames or packets carried by the message
+	std::vector<std::unique_ptr<NetContainer>> contents;
+	/// The end of the headers preceding each content in data
+	std::vector<std::size_t> header_ends;
+	/// The length of all the contents
+	std::size_t contents_length;
+};
+
 class InterconnectChannel
 {
 public:
@@ -67,6 +150,16 @@ public:
 	virtual ~InterconnectChannel();
 
 protected:
+	/**
+	 * @brief Read the interconnect configuration and initialize the
+	 *        UDP channels or the streams
+	 *
+	 * @param upward     whether the upward or downward carrier is used
+	 * @param isl_index  the index of the ISL for a satellite
+	 * @return true on success, false otherwise
+	 */
+	bool initChannels(bool upward, std::size_t isl_index);
+
 	/**
 	 * @brief Initialize the UdpChannel
 	 */
@@ -76,14 +169,36 @@ protected:
 	                             unsigned int stack,
 	                             unsigned int rmem,
 	                             unsigned int wmem) = 0;
+
+	/**
+	 * @brief Initialize the streams
+	 */
+	virtual bool initStreams(unsigned int data_port,
+	                         unsigned int sig_port,
+	                         std::string remote_addr,
+	                         std::string socket_dir,
+	                         unsigned int rmem,
+	                         unsigned int wmem) = 0;
+
+	/**
+	 * @brief Whether the messages are carried on streams
+	 */
+	inline bool isStream() const { return this->transport != InterconnectTransport::udp; };
+
 	/// This blocks name
 	std::string name;
 	/// The interconnect interface IP address
 	std::string interconnect_addr;
+	/// The transport used between the interconnected blocks
+	InterconnectTransport transport;
 	/// The data channel
 	UdpChannel *data_channel;
 	/// The signalling channel
 	UdpChannel *sig_channel;
+	/// The data stream
+	std::unique_ptr<InterconnectStream> data_stream;
+	/// The signalling stream
+	std::unique_ptr<InterconnectStream> sig_stream;
 	/// Output log
 	std::shared_ptr<OutputLog> log_interconnect;
 };
@@ -93,6 +208,11 @@ class InterconnectChannelSender: public InterconnectChannel
 public:
 	InterconnectChannelSender(std::string name, const InterconnectConfig &config);
 
+	/**
+	 * @brief Send the messages whose delay elapsed, on streams they
+	 *        are all written at once
+	 * @return false on error, true elsewise.
+	 */
 	bool onTimerEvent();
 
 protected:
@@ -106,6 +226,24 @@ protected:
 	                     unsigned int rmem,
 	                     unsigned int wmem) override;
 
+	/**
+	 * @brief Initialize the streams and try to connect them
+	 */
+	bool initStreams(unsigned int data_port,
+	                 unsigned int sig_port,
+	                 std::string remote_addr,
+	                 std::string socket_dir,
+	                 unsigned int rmem,
+	                 unsigned int wmem) override;
+
+	/**
+	 * @brief Read the compression configuration and register its probes
+	 *
+	 * @param isl_index  the index of the ISL for a satellite
+	 * @return true on success, false otherwise
+	 */
+	bool initCompression(std::size_t isl_index);
+
 	/**
 	 * @brief Send a RtMessage via the interconnect channel.
 	 * @return false on error, true elsewise.
@@ -113,44 +251,56 @@ protected:
 	bool send(rt_msg_t &message);
 
 	/**
-	 * @brief Sends a message. total_length must contain the data length;
-	 * @param is_sig indicates if the message must be sent via the sig channel
+	 * @brief Sends a message on the sig or data channel, or queue it
+	 *        on the corresponding stream
 	 * @param msg the message to send
 	 * @return false on error, true elsewise.
 	 */
-	bool sendBuffer(bool is_sig, const interconnect_msg_buffer_t &msg);
+	bool sendBuffer(std::unique_ptr<InterconnectMessage> msg);
 
 private:
 	/**
-	 * @brief Serialize a Dvb Frame to be sent via the
-	 *        interconnect channel.
-	 */
-	void serialize(DvbFrame *dvb_frame,
-	               unsigned char *buf, uint32_t &length);
-
-	/**
-	 * @brief Serialize a list of Dvb Frames to be sent
-	 *        via the interconnect channel.
+	 * @brief Send the messages whose delay elapsed
+	 * @return false on error, true elsewise.
 	 */
-	void serialize(std::list<DvbFrame *> *dvb_frame_list,
-	               unsigned char *buf, uint32_t &length);
+	bool sendElapsed();
 
 	/**
-	 * @brief Serialize a NetBurst to be sent
-	 *        via the interconnect channel.
+	 * @brief Code the message content if it makes it shorter
 	 */
-	void serialize(const NetBurst &net_burst,
-	               unsigned char *buf, uint32_t &length);
+	void compress(InterconnectMessage &msg);
 
 	/**
-	 * @brief Serialize a NetPacket to be sent
-	 *        via the interconnect channel.
+	 * @brief Keep the data queued on a stream within the send window
+	 *
+	 * While connected, the channel waits for the socket to take the
+	 * data, which stops reading the block fifo and eventually blocks
+	 * the previous block. While disconnected, the oldest messages are
+	 * dropped.
 	 */
-	void serialize(const NetPacket &packet,
-	               unsigned char *buf, uint32_t &length);
+	void waitSendWindow(InterconnectStream &stream);
 
 	DelayFifo delay_fifo;
 	time_ms_t delay = 0;
+	/// The buffers of the message being sent
+	std::vector<struct iovec> iovecs;
+	/// The maximum length queued on a stream
+	std::size_t send_window;
+
+	/// Whether the packets metadata are coded
+	bool compress_headers;
+	/// Whether the messages are block coded
+	bool compress_block;
+	/// The minimum length of the messages to block code
+	std::size_t compression_threshold;
+	/// The message content and its codings
+	std::vector<unsigned char> plain;
+	std::vector<unsigned char> headers_coded;
+	std::vector<unsigned char> block_coded;
+	/// The coded length over the message length (%)
+	std::shared_ptr<Probe<float>> probe_compression_ratio;
+	/// The time spent coding a message (us)
+	std::shared_ptr<Probe<float>> probe_compression_time;
 };
 
 class InterconnectChannelReceiver: public InterconnectChannel
@@ -169,6 +319,43 @@ protected:
 	                     unsigned int rmem,
 	                     unsigned int wmem) override;
 
+	/**
+	 * @brief Initialize the streams and listen for their connection
+	 */
+	bool initStreams(unsigned int data_port,
+	                 unsigned int sig_port,
+	                 std::string remote_addr,
+	                 std::string socket_dir,
+	                 unsigned int rmem,
+	                 unsigned int wmem) override;
+
+	/**
+	 * @brief Use the connection accepted on a stream listening socket
+	 *
+	 * @param event           the listen event
+	 * @param connection_fds  OUT: the file descriptors of the new
+	 *                        connection to watch, none on error
+	 * @param replaced_fds    OUT: the ones of the previous connection,
+	 *                        whose events should be removed
+	 * @return false if the event is not for a stream, true otherwise
+	 */
+	bool accept(TcpListenEvent *const event,
+	            std::vector<int32_t> &connection_fds,
+	            std::vector<int32_t> &replaced_fds);
+
+	/**
+	 * @brief Receive RtMessages from a stream connection
+	 *
+	 * @param event       the event of the connection
+	 * @param messages    OUT: the messages completed by the data read
+	 * @param closed_fds  OUT: the file descriptors of the connection if
+	 *                    it was lost, whose events should be removed
+	 * @return false on error, true elsewise.
+	 */
+	bool receive(FileEvent *const event,
+	             std::list<rt_msg_t> &messages,
+	             std::vector<int32_t> &closed_fds);
+
 	/**
 	 * @brief Receive a message from the socket
 	 * @return -1 on error, 1 if more packets can be read, 0 if last packet.
@@ -184,6 +371,15 @@ protected:
 	             std::list<rt_msg_t> &messages);
 
 private:
+	/**
+	 * @brief Create the object carried by a message from serialized data,
+	 *        decoding it first if needed
+	 * @return false if the message type is unknown or its coding is
+	 *         corrupted, true elsewise.
+	 */
+	bool deserialize(uint8_t msg_type, unsigned char *data, uint32_t len,
+	                 rt_msg_t &message);
+
 	/**
 	 * @brief Create a DvbFrame from serialized data
 	 */
@@ -207,5 +403,9 @@ private:
 	 */
 	void deserialize(uint8_t *buf, uint32_t length,
 	                 NetPacket **packet);
+
+	/// The decodings of the coded messages
+	std::vector<unsigned char> block_decoded;
+	std::vector<unsigned char> headers_decoded;
 };
 #endif
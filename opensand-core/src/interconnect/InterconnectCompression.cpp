@@ -0,0 +1,363 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectCompression.cpp
+ * @brief Codings reducing the size of the interconnect messages
+ */
+
+#include "InterconnectCompression.h"
+#include "NetPacket.h"
+
+#include <array>
+#include <cstring>
+
+
+/// the sizes of the metadata fields preceding a serialized packet:
+/// source, destination, QoS, protocol and header length
+static const std::array<std::size_t, 5> packet_fields{1, 1, 1, sizeof(NET_PROTO), 4};
+/// the length of the metadata fields
+static constexpr std::size_t packet_fields_length = 1 + 1 + 1 + sizeof(NET_PROTO) + 4;
+
+/// the minimum length of a block copy
+static constexpr std::size_t min_match = 4;
+/// the last bytes of a block are always literals
+static constexpr std::size_t last_literals = 5;
+/// the maximum distance of a block copy
+static constexpr std::size_t max_offset = 65535;
+/// the number of bits of the hash of 4 bytes
+static constexpr unsigned int hash_bits = 12;
+
+
+static void appendVarint(std::vector<unsigned char> &out, uint64_t value)
+{
+	while(value >= 0x80)
+	{
+		out.push_back(static_cast<unsigned char>(value) | 0x80);
+		value >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(value));
+}
+
+static bool readVarint(const unsigned char *&pos, const unsigned char *end, uint64_t &value)
+{
+	value = 0;
+	for(unsigned int shift = 0; shift < 64 && pos < end; shift += 7)
+	{
+		unsigned char byte = *pos++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if(!(byte & 0x80))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static inline uint32_t read32(const unsigned char *pos)
+{
+	uint32_t value;
+	memcpy(&value, pos, sizeof(value));
+	return value;
+}
+
+
+bool InterconnectCompression::encodeHeaders(const unsigned char *data, std::size_t length,
+                                            std::vector<unsigned char> &coded)
+{
+	std::array<unsigned char, packet_fields_length> previous{};
+	std::size_t pos = 0;
+
+	coded.clear();
+	coded.reserve(length);
+	while(pos < length)
+	{
+		uint32_t packet_length;
+		if(length - pos < sizeof(packet_length))
+		{
+			return false;
+		}
+		memcpy(&packet_length, data + pos, sizeof(packet_length));
+		pos += sizeof(packet_length);
+		if(packet_length < packet_fields_length || length - pos < packet_length)
+		{
+			return false;
+		}
+
+		// flag and write the fields differing from the previous packet
+		std::size_t flags_pos = coded.size();
+		unsigned char flags = 0;
+		coded.push_back(flags);
+		std::size_t field_start = 0;
+		for(std::size_t i = 0; i < packet_fields.size(); ++i)
+		{
+			const unsigned char *field = data + pos + field_start;
+			if(memcmp(field, previous.data() + field_start, packet_fields[i]) != 0)
+			{
+				flags |= 1 << i;
+				coded.insert(coded.end(), field, field + packet_fields[i]);
+				memcpy(previous.data() + field_start, field, packet_fields[i]);
+			}
+			field_start += packet_fields[i];
+		}
+		coded[flags_pos] = flags;
+
+		std::size_t content_length = packet_length - packet_fields_length;
+		appendVarint(coded, content_length);
+		pos += packet_fields_length;
+		coded.insert(coded.end(), data + pos, data + pos + content_length);
+		pos += content_length;
+	}
+	return true;
+}
+
+
+bool InterconnectCompression::decodeHeaders(const unsigned char *data, std::size_t length,
+                                            std::vector<unsigned char> &decoded)
+{
+	std::array<unsigned char, packet_fields_length> previous{};
+	const unsigned char *pos = data;
+	const unsigned char *end = data + length;
+
+	decoded.clear();
+	while(pos < end)
+	{
+		unsigned char flags = *pos++;
+		std::size_t field_start = 0;
+		for(std::size_t i = 0; i < packet_fields.size(); ++i)
+		{
+			if(flags & (1 << i))
+			{
+				if(static_cast<std::size_t>(end - pos) < packet_fields[i])
+				{
+					return false;
+				}
+				memcpy(previous.data() + field_start, pos, packet_fields[i]);
+				pos += packet_fields[i];
+			}
+			field_start += packet_fields[i];
+		}
+
+		uint64_t content_length;
+		if(!readVarint(pos, end, content_length) ||
+		   static_cast<uint64_t>(end - pos) < content_length)
+		{
+			return false;
+		}
+		uint32_t packet_length = packet_fields_length + content_length;
+		const unsigned char *header = reinterpret_cast<const unsigned char *>(&packet_length);
+		decoded.insert(decoded.end(), header, header + sizeof(packet_length));
+		decoded.insert(decoded.end(), previous.begin(), previous.end());
+		decoded.insert(decoded.end(), pos, pos + content_length);
+		pos += content_length;
+	}
+	return true;
+}
+
+
+/**
+ * @brief Append a length exceeding its token nibble
+ */
+static void appendLength(std::vector<unsigned char> &out, std::size_t length)
+{
+	while(length >= 255)
+	{
+		out.push_back(255);
+		length -= 255;
+	}
+	out.push_back(static_cast<unsigned char>(length));
+}
+
+static bool readLength(const unsigned char *&pos, const unsigned char *end, std::size_t &length)
+{
+	unsigned char byte;
+	do
+	{
+		if(pos >= end)
+		{
+			return false;
+		}
+		byte = *pos++;
+		length += byte;
+	}
+	while(byte == 255);
+	return true;
+}
+
+/**
+ * @brief Append a sequence of literals followed by a copy, if any
+ */
+static void appendSequence(std::vector<unsigned char> &out,
+                           const unsigned char *literals, std::size_t literals_length,
+                           std::size_t offset, std::size_t match_length)
+{
+	std::size_t token_pos = out.size();
+	unsigned char token = (literals_length < 15 ? literals_length : 15) << 4;
+	out.push_back(0);
+	if(literals_length >= 15)
+	{
+		appendLength(out, literals_length - 15);
+	}
+	out.insert(out.end(), literals, literals + literals_length);
+
+	if(match_length > 0)
+	{
+		out.push_back(offset & 0xff);
+		out.push_back(offset >> 8);
+		std::size_t length = match_length - min_match;
+		token |= length < 15 ? length : 15;
+		if(length >= 15)
+		{
+			appendLength(out, length - 15);
+		}
+	}
+	out[token_pos] = token;
+}
+
+
+void InterconnectCompression::compressBlock(const unsigned char *data, std::size_t length,
+                                            std::vector<unsigned char> &coded)
+{
+	// positions of the last occurrences of 4 bytes hashes, plus one
+	std::array<uint32_t, 1 << hash_bits> table;
+	table.fill(0);
+
+	coded.clear();
+	coded.reserve(length + length / 255 + 16);
+	appendVarint(coded, length);
+
+	std::size_t anchor = 0;
+	std::size_t pos = 0;
+	std::size_t limit = length > last_literals + min_match ? length - last_literals : 0;
+	while(pos + min_match <= limit)
+	{
+		uint32_t sequence = read32(data + pos);
+		uint32_t hash = (sequence * 2654435761U) >> (32 - hash_bits);
+		std::size_t candidate = table[hash];
+		table[hash] = pos + 1;
+		if(candidate == 0 || pos - (candidate - 1) > max_offset ||
+		   read32(data + candidate - 1) != sequence)
+		{
+			++pos;
+			continue;
+		}
+
+		std::size_t match = candidate - 1;
+		std::size_t match_length = min_match;
+		while(pos + match_length < limit && data[match + match_length] == data[pos + match_length])
+		{
+			++match_length;
+		}
+		appendSequence(coded, data + anchor, pos - anchor, pos - match, match_length);
+		pos += match_length;
+		anchor = pos;
+	}
+	appendSequence(coded, data + anchor, length - anchor, 0, 0);
+}
+
+
+bool InterconnectCompression::decompressBlock(const unsigned char *data, std::size_t length,
+                                              std::size_t max_length,
+                                              std::vector<unsigned char> &decoded)
+{
+	const unsigned char *pos = data;
+	const unsigned char *end = data + length;
+	uint64_t decoded_length;
+	if(!readVarint(pos, end, decoded_length) || decoded_length > max_length)
+	{
+		return false;
+	}
+
+	decoded.resize(decoded_length);
+	std::size_t out = 0;
+	while(pos < end)
+	{
+		unsigned char token = *pos++;
+		std::size_t literals_length = token >> 4;
+		if(literals_length == 15 && !readLength(pos, end, literals_length))
+		{
+			return false;
+		}
+		if(static_cast<std::size_t>(end - pos) < literals_length ||
+		   decoded_length - out < literals_length)
+		{
+			return false;
+		}
+		if(literals_length > 0)
+		{
+			// the data of an empty block is null
+			memcpy(decoded.data() + out, pos, literals_length);
+		}
+		pos += literals_length;
+		out += literals_length;
+		if(pos == end)
+		{
+			// the last sequence has no copy
+			break;
+		}
+
+		if(end - pos < 2)
+		{
+			return false;
+		}
+		std::size_t offset = pos[0] | (pos[1] << 8);
+		pos += 2;
+		std::size_t match_length = token & 0x0f;
+		if(match_length == 15 && !readLength(pos, end, match_length))
+		{
+			return false;
+		}
+		match_length += min_match;
+		if(offset == 0 || offset > out || decoded_length - out < match_length)
+		{
+			return false;
+		}
+		unsigned char *dest = decoded.data() + out;
+		const unsigned char *src = dest - offset;
+		if(offset >= match_length)
+		{
+			memcpy(dest, src, match_length);
+		}
+		else if(offset == 1)
+		{
+			// a run of a single byte, such as a padding
+			memset(dest, *src, match_length);
+		}
+		else
+		{
+			// the copy overlaps its own output
+			for(std::size_t i = 0; i < match_length; ++i)
+			{
+				dest[i] = src[i];
+			}
+		}
+		out += match_length;
+	}
+	return out == decoded_length;
+}
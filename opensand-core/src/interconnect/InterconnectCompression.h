@@ -0,0 +1,112 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectCompression.h
+ * @brief Codings reducing the size of the interconnect messages
+ */
+
+#ifndef INTERCONNECT_COMPRESSION_H
+#define INTERCONNECT_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * @class InterconnectCompression
+ * @brief Codings reducing the size of the interconnect messages
+ *
+ * The codings applied to a message are flagged in the high bits of its
+ * type, so the receiving side decodes whatever the sending side chose:
+ *  - the header coding only writes the metadata fields of a packet of
+ *    a NetBurst that differ from the previous packet,
+ *  - the block coding is a byte oriented LZ77 codec in the spirit of
+ *    LZ4: sequences of literals followed by a copy of at least 4 bytes
+ *    from the last 64 kB, fast enough to run on every message.
+ */
+class InterconnectCompression
+{
+public:
+	/// The message payload is header coded
+	static constexpr uint8_t headers_coding = 0x40;
+	/// The message payload is block coded, after the header coding
+	static constexpr uint8_t block_coding = 0x80;
+	/// The bits of the message type flagging the codings
+	static constexpr uint8_t coding_mask = headers_coding | block_coding;
+
+	/**
+	 * @brief Code the packets metadata of a serialized NetBurst
+	 *
+	 * @param data    the serialized NetBurst
+	 * @param length  the data length
+	 * @param coded   OUT: the coded NetBurst
+	 * @return false if the data is not a serialized NetBurst, true otherwise
+	 */
+	static bool encodeHeaders(const unsigned char *data, std::size_t length,
+	                          std::vector<unsigned char> &coded);
+
+	/**
+	 * @brief Restore a serialized NetBurst from its header coding
+	 *
+	 * @param data     the coded NetBurst
+	 * @param length   the data length
+	 * @param decoded  OUT: the serialized NetBurst
+	 * @return false if the data is corrupted, true otherwise
+	 */
+	static bool decodeHeaders(const unsigned char *data, std::size_t length,
+	                          std::vector<unsigned char> &decoded);
+
+	/**
+	 * @brief Block code some data
+	 *
+	 * @param data    the data
+	 * @param length  the data length
+	 * @param coded   OUT: the coded data, prefixed by the data length
+	 */
+	static void compressBlock(const unsigned char *data, std::size_t length,
+	                          std::vector<unsigned char> &coded);
+
+	/**
+	 * @brief Restore block coded data
+	 *
+	 * @param data        the coded data
+	 * @param length      the coded data length
+	 * @param max_length  the maximum length of the restored data
+	 * @param decoded     OUT: the restored data
+	 * @return false if the data is corrupted, true otherwise
+	 */
+	static bool decompressBlock(const unsigned char *data, std::size_t length,
+	                            std::size_t max_length,
+	                            std::vector<unsigned char> &decoded);
+};
+
+
+#endif
@@ -0,0 +1,497 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectSharedMemory.cpp
+ * @brief A shared memory ring carrying interconnect messages
+ */
+
+#include "InterconnectSharedMemory.h"
+#include "InterconnectChannel.h"
+
+#include <opensand_output/Output.h>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+
+/**
+ * @brief The header of the ring, the messages are written at increasing
+ *        positions taken modulo the capacity
+ */
+struct interconnect_ring_t
+{
+	/// the position following the last message written by the sending side
+	alignas(64) std::atomic<uint64_t> head;
+	/// the position following the last message released by the receiving side
+	alignas(64) std::atomic<uint64_t> tail;
+	/// the capacity of the data following the header
+	alignas(64) uint64_t capacity;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the ring positions are shared between processes");
+
+/// the offset of the ring data in the shared memory
+constexpr std::size_t ring_data_offset = 4096;
+static_assert(sizeof(interconnect_ring_t) <= ring_data_offset,
+              "the ring header does not fit before the data");
+
+/// the messages are aligned in the ring
+constexpr uint64_t ring_alignment = 8;
+
+/// the length and type fields starting each message
+constexpr uint32_t message_header_length = sizeof(uint32_t) + sizeof(uint8_t);
+
+
+/**
+ * @brief Get the length of a message in the ring
+ */
+static inline uint64_t recordLength(uint64_t length)
+{
+	return (length + ring_alignment - 1) & ~(ring_alignment - 1);
+}
+
+
+InterconnectSharedMemory::InterconnectSharedMemory(const std::string &name,
+                                                   unsigned short port,
+                                                   const std::string &socket_dir,
+                                                   unsigned int rmem,
+                                                   unsigned int wmem):
+	InterconnectStream{name, InterconnectTransport::shared_memory, "", port, socket_dir, rmem, wmem},
+	ring{nullptr},
+	ring_length{0},
+	ring_data{nullptr},
+	capacity{0},
+	event_fd{-1},
+	read_pos{0}
+{
+}
+
+
+InterconnectSharedMemory::~InterconnectSharedMemory()
+{
+	if(this->listen_fd >= 0)
+	{
+		this->releaseConnection();
+	}
+	else
+	{
+		this->closeConnection();
+	}
+}
+
+
+bool InterconnectSharedMemory::createRing(int32_t &memory_fd)
+{
+	// the ring should at least hold a few messages of maximum size
+	uint64_t page_size = sysconf(_SC_PAGESIZE);
+	uint64_t capacity = std::max<uint64_t>(this->rmem, 4 * (MAX_SOCK_SIZE + ring_alignment));
+	capacity = (capacity + page_size - 1) / page_size * page_size;
+
+	memory_fd = memfd_create(this->name.c_str(), MFD_CLOEXEC);
+	if(memory_fd < 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to create shared memory: %s (%d)\n",
+		    strerror(errno), errno);
+		return false;
+	}
+	if(ftruncate(memory_fd, ring_data_offset + capacity) != 0 ||
+	   !this->mapRing(memory_fd, ring_data_offset + capacity))
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to allocate %lu bytes of shared memory: %s (%d)\n",
+		    ring_data_offset + capacity, strerror(errno), errno);
+		close(memory_fd);
+		return false;
+	}
+	new (this->ring) interconnect_ring_t{};
+	this->ring->capacity = capacity;
+	this->capacity = capacity;
+	this->read_pos = 0;
+
+	this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(this->event_fd < 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to create eventfd: %s (%d)\n",
+		    strerror(errno), errno);
+		close(memory_fd);
+		return false;
+	}
+	return true;
+}
+
+
+bool InterconnectSharedMemory::mapRing(int32_t memory_fd, std::size_t length)
+{
+	void *memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+	if(memory == MAP_FAILED)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to map shared memory: %s (%d)\n",
+		    strerror(errno), errno);
+		return false;
+	}
+	this->ring = static_cast<interconnect_ring_t *>(memory);
+	this->ring_length = length;
+	this->ring_data = static_cast<unsigned char *>(memory) + ring_data_offset;
+	return true;
+}
+
+
+void InterconnectSharedMemory::setConnection(int32_t fd)
+{
+	InterconnectStream::setConnection(fd);
+
+	// the new connection is not watched yet, it is closed on error
+	int32_t memory_fd;
+	if(!this->createRing(memory_fd))
+	{
+		this->closeConnection();
+		return;
+	}
+
+	// pass the memory file and the eventfd to the sending side
+	unsigned char byte = 0;
+	struct iovec iov = {&byte, sizeof(byte)};
+	union
+	{
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+	int fds[2] = {memory_fd, this->event_fd};
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	if(sendmsg(this->fd, &msg, MSG_NOSIGNAL) < 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to pass the shared memory: %s (%d)\n",
+		    strerror(errno), errno);
+		this->closeConnection();
+	}
+	close(memory_fd);
+}
+
+
+void InterconnectSharedMemory::getConnectionFds(std::vector<int32_t> &fds) const
+{
+	if(this->event_fd >= 0)
+	{
+		fds.push_back(this->event_fd);
+	}
+	InterconnectStream::getConnectionFds(fds);
+}
+
+
+void InterconnectSharedMemory::closeConnection()
+{
+	if(this->event_fd >= 0)
+	{
+		close(this->event_fd);
+	}
+	this->event_fd = -1;
+	InterconnectStream::closeConnection();
+}
+
+
+void InterconnectSharedMemory::releaseConnection()
+{
+	if(this->ring != nullptr)
+	{
+		munmap(this->ring, this->ring_length);
+	}
+	this->ring = nullptr;
+	this->ring_data = nullptr;
+	this->capacity = 0;
+	this->event_fd = -1;
+	this->read_pos = 0;
+	InterconnectStream::releaseConnection();
+}
+
+
+void InterconnectSharedMemory::feed(const unsigned char *, std::size_t)
+{
+}
+
+
+int InterconnectSharedMemory::nextMessage(uint8_t &msg_type, unsigned char *&payload, uint32_t &length)
+{
+	if(this->ring == nullptr)
+	{
+		return 0;
+	}
+
+	// release the previous message
+	this->ring->tail.store(this->read_pos, std::memory_order_release);
+	uint64_t head = this->ring->head.load(std::memory_order_acquire);
+
+	while(this->read_pos != head)
+	{
+		uint64_t offset = this->read_pos % this->capacity;
+		uint32_t data_len;
+		memcpy(&data_len, this->ring_data + offset, sizeof(data_len));
+		if(data_len == 0)
+		{
+			// the next message starts at the beginning of the ring
+			this->read_pos += this->capacity - offset;
+			continue;
+		}
+		if(data_len < message_header_length ||
+		   data_len > message_header_length + MAX_SOCK_SIZE ||
+		   offset + data_len > this->capacity)
+		{
+			LOG(this->log, LEVEL_ERROR,
+			    "invalid message length %u in the ring\n", data_len);
+			return -1;
+		}
+
+		msg_type = this->ring_data[offset + sizeof(data_len)];
+		payload = this->ring_data + offset + message_header_length;
+		length = data_len - message_header_length;
+		this->read_pos += recordLength(data_len);
+		return 1;
+	}
+
+	this->ring->tail.store(this->read_pos, std::memory_order_release);
+	return 0;
+}
+
+
+bool InterconnectSharedMemory::connect()
+{
+	if(this->ring != nullptr)
+	{
+		return true;
+	}
+	return InterconnectStream::connect() && this->receiveRing();
+}
+
+
+bool InterconnectSharedMemory::receiveRing()
+{
+	unsigned char byte;
+	struct iovec iov = {&byte, sizeof(byte)};
+	union
+	{
+		struct cmsghdr header;
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	ssize_t ret = recvmsg(this->fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+	if(ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		// the ring is not passed yet
+		return false;
+	}
+
+	struct cmsghdr *cmsg = ret > 0 ? CMSG_FIRSTHDR(&msg) : nullptr;
+	if(cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+	   cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "shared memory not received from the receiving side\n");
+		this->closeConnection();
+		return false;
+	}
+	int fds[2];
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+	this->event_fd = fds[1];
+
+	struct stat memory_stat;
+	bool mapped = fstat(fds[0], &memory_stat) == 0 &&
+	              static_cast<std::size_t>(memory_stat.st_size) > ring_data_offset &&
+	              this->mapRing(fds[0], memory_stat.st_size);
+	close(fds[0]);
+	if(!mapped || this->ring->capacity + ring_data_offset != this->ring_length ||
+	   this->ring->capacity % ring_alignment != 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "invalid shared memory received from the receiving side\n");
+		this->closeConnection();
+		return false;
+	}
+	this->capacity = this->ring->capacity;
+
+	LOG(this->log, LEVEL_NOTICE,
+	    "%lu bytes of shared memory received\n", this->capacity);
+	return true;
+}
+
+
+bool InterconnectSharedMemory::isConnected() const
+{
+	return this->ring != nullptr;
+}
+
+
+bool InterconnectSharedMemory::fits() const
+{
+	if(this->pending.empty())
+	{
+		return true;
+	}
+
+	uint64_t head = this->ring->head.load(std::memory_order_relaxed);
+	uint64_t tail = this->ring->tail.load(std::memory_order_acquire);
+	uint64_t record = recordLength(this->pending.front()->getTotalLength());
+	uint64_t offset = head % this->capacity;
+	uint64_t padding = this->capacity - offset < record ? this->capacity - offset : 0;
+	return head + padding + record - tail <= this->capacity;
+}
+
+
+bool InterconnectSharedMemory::checkPeer()
+{
+	if(!this->isConnected())
+	{
+		return false;
+	}
+
+	// nothing is sent on the connection once the ring is passed
+	struct pollfd pfd = {this->fd, POLLIN | POLLRDHUP, 0};
+	unsigned char byte;
+	if(poll(&pfd, 1, 0) > 0 &&
+	   ((pfd.revents & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)) ||
+	    recv(this->fd, &byte, sizeof(byte), MSG_PEEK | MSG_DONTWAIT) == 0))
+	{
+		LOG(this->log, LEVEL_NOTICE,
+		    "shared memory released by the receiving side\n");
+		this->closeConnection();
+		return false;
+	}
+	return true;
+}
+
+
+bool InterconnectSharedMemory::flush()
+{
+	if(!this->checkPeer() || this->pending.empty())
+	{
+		return true;
+	}
+
+	uint64_t head = this->ring->head.load(std::memory_order_relaxed);
+	bool written = false;
+	while(!this->pending.empty() && this->fits())
+	{
+		auto &msg = this->pending.front();
+		std::size_t length = msg->getTotalLength();
+		uint64_t offset = head % this->capacity;
+		if(this->capacity - offset < recordLength(length))
+		{
+			// mark the end of the ring as unused
+			uint32_t wrap = 0;
+			memcpy(this->ring_data + offset, &wrap, sizeof(wrap));
+			head += this->capacity - offset;
+			offset = 0;
+		}
+
+		// copy the message as it would be written on a stream
+		this->message_iovecs.clear();
+		msg->getBuffers(this->message_iovecs);
+		unsigned char *dest = this->ring_data + offset;
+		for(std::size_t i = 1; i < this->message_iovecs.size(); ++i)
+		{
+			memcpy(dest, this->message_iovecs[i].iov_base, this->message_iovecs[i].iov_len);
+			dest += this->message_iovecs[i].iov_len;
+		}
+		head += recordLength(length);
+		// the following messages check the space against this head
+		this->ring->head.store(head, std::memory_order_release);
+
+		this->pending_length -= length;
+		this->pending.pop_front();
+		written = true;
+	}
+
+	if(written)
+	{
+		// a single notification for all the messages of the flush
+		uint64_t count = 1;
+		if(write(this->event_fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+		{
+			LOG(this->log, LEVEL_ERROR,
+			    "failed to signal the receiving side: %s (%d)\n",
+			    strerror(errno), errno);
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool InterconnectSharedMemory::waitWritable(time_ms_t timeout)
+{
+	// the receiving side does not signal the space it releases
+	constexpr useconds_t poll_period = 50;
+	for(uint64_t waited = 0; waited <= timeout * 1000; waited += poll_period)
+	{
+		if(!this->checkPeer())
+		{
+			return false;
+		}
+		if(this->fits())
+		{
+			return true;
+		}
+		usleep(poll_period);
+	}
+	return false;
+}
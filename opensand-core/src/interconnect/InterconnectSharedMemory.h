@@ -0,0 +1,177 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectSharedMemory.h
+ * @brief A shared memory ring carrying interconnect messages
+ */
+
+#ifndef INTERCONNECT_SHARED_MEMORY_H
+#define INTERCONNECT_SHARED_MEMORY_H
+
+#include "InterconnectStream.h"
+
+
+struct interconnect_ring_t;
+
+
+/**
+ * @class InterconnectSharedMemory
+ * @brief A single producer, single consumer ring in memory shared by
+ *        two co-located processes
+ *
+ * The receiving side creates the ring in an anonymous memory file and
+ * an eventfd, and passes them to the sending side connected on the
+ * Unix socket of the stream. The messages are then copied in the ring
+ * as they would be written on the stream, the eventfd is signalled
+ * once per flush, and the receiving side deserializes the messages
+ * directly from the ring.
+ */
+class InterconnectSharedMemory: public InterconnectStream
+{
+public:
+	/**
+	 * @brief Create a shared memory, the ring is created on connection
+	 *
+	 * @param name        the shared memory name
+	 * @param port        the port naming the Unix socket
+	 * @param socket_dir  the directory containing the Unix sockets
+	 * @param rmem        the ring size requested by the receiving side
+	 * @param wmem        the socket send buffer size
+	 */
+	InterconnectSharedMemory(const std::string &name,
+	                         unsigned short port,
+	                         const std::string &socket_dir,
+	                         unsigned int rmem,
+	                         unsigned int wmem);
+
+	~InterconnectSharedMemory();
+
+	/**
+	 * @brief Create the ring and pass it on the accepted connection
+	 */
+	void setConnection(int32_t fd) override;
+
+	/**
+	 * @brief Get the eventfd signalling messages in the ring and the
+	 *        connection, whose end of file signals the sender is gone
+	 */
+	void getConnectionFds(std::vector<int32_t> &fds) const override;
+
+	void closeConnection() override;
+
+	/**
+	 * @brief Unmap the ring, the eventfd and the connection are left
+	 *        to their events
+	 */
+	void releaseConnection() override;
+
+	/**
+	 * @brief Nothing to reassemble, the data read is the eventfd counter
+	 */
+	void feed(const unsigned char *data, std::size_t length) override;
+
+	/**
+	 * @brief Get the next message of the ring, it is released on the
+	 *        next call
+	 */
+	int nextMessage(uint8_t &msg_type, unsigned char *&payload, uint32_t &length) override;
+
+	/**
+	 * @brief Connect and receive the ring from the receiving side
+	 */
+	bool connect() override;
+
+	bool isConnected() const override;
+
+	/**
+	 * @brief Copy the queued messages that fit in the ring and signal
+	 *        the receiving side
+	 */
+	bool flush() override;
+
+	/**
+	 * @brief Wait until the next queued message fits in the ring
+	 */
+	bool waitWritable(time_ms_t timeout) override;
+
+private:
+	/**
+	 * @brief Create the ring and its eventfd
+	 *
+	 * @param memory_fd  OUT: the memory file containing the ring
+	 * @return true on success, false otherwise
+	 */
+	bool createRing(int32_t &memory_fd);
+
+	/**
+	 * @brief Receive the ring and its eventfd on the connection
+	 *
+	 * @return true when received, false otherwise
+	 */
+	bool receiveRing();
+
+	/**
+	 * @brief Map the memory file containing the ring
+	 *
+	 * @param memory_fd  the memory file
+	 * @param length     the memory file length
+	 * @return true on success, false otherwise
+	 */
+	bool mapRing(int32_t memory_fd, std::size_t length);
+
+	/**
+	 * @brief Whether the next queued message fits in the ring
+	 */
+	bool fits() const;
+
+	/**
+	 * @brief Check that the receiving side still holds the connection,
+	 *        close it otherwise as the ring does not tell
+	 *
+	 * @return true if still connected, false otherwise
+	 */
+	bool checkPeer();
+
+	/// the ring header, followed by its data
+	interconnect_ring_t *ring;
+	/// the length of the mapped memory
+	std::size_t ring_length;
+	/// the ring data
+	unsigned char *ring_data;
+	/// the ring data capacity
+	uint64_t capacity;
+	/// the eventfd signalling messages in the ring
+	int32_t event_fd;
+	/// the position following the last message read
+	uint64_t read_pos;
+};
+
+
+#endif
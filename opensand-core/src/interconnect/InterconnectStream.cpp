@@ -0,0 +1,520 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectStream.cpp
+ * @brief A stream socket carrying interconnect messages
+ */
+
+#include "InterconnectStream.h"
+#include "InterconnectChannel.h"
+#include "InterconnectSharedMemory.h"
+
+#include <opensand_output/Output.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+
+/// the length and type fields starting each message
+constexpr std::size_t message_header_length = sizeof(uint32_t) + sizeof(uint8_t);
+
+
+InterconnectStream::InterconnectStream(const std::string &name,
+                                       InterconnectTransport transport,
+                                       const std::string &address,
+                                       unsigned short port,
+                                       const std::string &socket_dir,
+                                       unsigned int rmem,
+                                       unsigned int wmem):
+	name{name},
+	transport{transport},
+	address{address},
+	port{port},
+	socket_path{socket_dir + "/opensand_interconnect_" + std::to_string(port) + ".sock"},
+	rmem{rmem},
+	wmem{wmem},
+	listen_fd{-1},
+	fd{-1},
+	connecting{false},
+	pending{},
+	pending_offset{0},
+	pending_length{0},
+	iovecs{},
+	message_iovecs{},
+	received{},
+	received_offset{0}
+{
+	this->log = Output::Get()->registerLog(LEVEL_WARNING, name);
+}
+
+
+InterconnectStream::~InterconnectStream()
+{
+	// on the receiving side, the sockets are closed by the events watching them
+	if(this->listen_fd >= 0)
+	{
+		if(this->transport != InterconnectTransport::tcp)
+		{
+			unlink(this->socket_path.c_str());
+		}
+	}
+	else if(this->fd >= 0)
+	{
+		close(this->fd);
+	}
+}
+
+
+std::unique_ptr<InterconnectStream> InterconnectStream::create(const std::string &name,
+                                                               InterconnectTransport transport,
+                                                               const std::string &address,
+                                                               unsigned short port,
+                                                               const std::string &socket_dir,
+                                                               unsigned int rmem,
+                                                               unsigned int wmem)
+{
+	if(transport == InterconnectTransport::shared_memory)
+	{
+		return std::unique_ptr<InterconnectStream>{
+			new InterconnectSharedMemory(name, port, socket_dir, rmem, wmem)};
+	}
+	return std::unique_ptr<InterconnectStream>{
+		new InterconnectStream(name, transport, address, port, socket_dir, rmem, wmem)};
+}
+
+
+int32_t InterconnectStream::createSocket()
+{
+	int32_t sock;
+	if(this->transport != InterconnectTransport::tcp)
+	{
+		sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	}
+	else
+	{
+		sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	}
+	if(sock < 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to create socket: %s (%d)\n",
+		    strerror(errno), errno);
+		return -1;
+	}
+
+	int one = 1;
+	if(this->transport == InterconnectTransport::tcp &&
+	   setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) < 0)
+	{
+		// messages are already gathered before being written
+		LOG(this->log, LEVEL_WARNING,
+		    "failed to disable Nagle algorithm: %s (%d)\n",
+		    strerror(errno), errno);
+	}
+	if(setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &this->rmem, sizeof(this->rmem)) < 0 ||
+	   setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &this->wmem, sizeof(this->wmem)) < 0)
+	{
+		LOG(this->log, LEVEL_WARNING,
+		    "failed to set the socket buffers size: %s (%d)\n",
+		    strerror(errno), errno);
+	}
+	if(fcntl(sock, F_SETFL, O_NONBLOCK) != 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to set the socket in non blocking mode: %s (%d)\n",
+		    strerror(errno), errno);
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+
+bool InterconnectStream::getAddress(struct sockaddr_storage &addr, socklen_t &length) const
+{
+	memset(&addr, 0, sizeof(addr));
+	if(this->transport != InterconnectTransport::tcp)
+	{
+		auto unix_addr = reinterpret_cast<struct sockaddr_un *>(&addr);
+		if(this->socket_path.length() >= sizeof(unix_addr->sun_path))
+		{
+			LOG(this->log, LEVEL_ERROR,
+			    "Unix socket path %s is too long\n",
+			    this->socket_path.c_str());
+			return false;
+		}
+		unix_addr->sun_family = AF_UNIX;
+		strncpy(unix_addr->sun_path, this->socket_path.c_str(),
+		        sizeof(unix_addr->sun_path) - 1);
+		length = sizeof(struct sockaddr_un);
+		return true;
+	}
+
+	auto inet_addr = reinterpret_cast<struct sockaddr_in *>(&addr);
+	inet_addr->sin_family = AF_INET;
+	inet_addr->sin_port = htons(this->port);
+	if(inet_pton(AF_INET, this->address.c_str(), &inet_addr->sin_addr) != 1)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "invalid IP address %s\n", this->address.c_str());
+		return false;
+	}
+	length = sizeof(struct sockaddr_in);
+	return true;
+}
+
+
+bool InterconnectStream::listen()
+{
+	struct sockaddr_storage addr;
+	socklen_t length;
+	int one = 1;
+
+	if(!this->getAddress(addr, length))
+	{
+		return false;
+	}
+
+	this->listen_fd = this->createSocket();
+	if(this->listen_fd < 0)
+	{
+		return false;
+	}
+
+	if(this->transport != InterconnectTransport::tcp)
+	{
+		// remove the socket left by a previous run
+		unlink(this->socket_path.c_str());
+	}
+	else if(setsockopt(this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0)
+	{
+		LOG(this->log, LEVEL_WARNING,
+		    "failed to reuse address: %s (%d)\n",
+		    strerror(errno), errno);
+	}
+
+	if(bind(this->listen_fd, reinterpret_cast<struct sockaddr *>(&addr), length) != 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to bind socket on port %u: %s (%d)\n",
+		    this->port, strerror(errno), errno);
+		goto close_socket;
+	}
+
+	// a single sender is connected at a time
+	if(::listen(this->listen_fd, 1) != 0)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to listen on socket: %s (%d)\n",
+		    strerror(errno), errno);
+		goto close_socket;
+	}
+
+	return true;
+
+close_socket:
+	close(this->listen_fd);
+	this->listen_fd = -1;
+	return false;
+}
+
+
+int32_t InterconnectStream::getListenFd() const
+{
+	return this->listen_fd;
+}
+
+
+void InterconnectStream::setConnection(int32_t fd)
+{
+	if(this->fd >= 0)
+	{
+		LOG(this->log, LEVEL_NOTICE,
+		    "new connection, the previous one is released\n");
+		this->releaseConnection();
+	}
+	this->fd = fd;
+}
+
+
+void InterconnectStream::getConnectionFds(std::vector<int32_t> &fds) const
+{
+	if(this->fd >= 0)
+	{
+		fds.push_back(this->fd);
+	}
+}
+
+
+void InterconnectStream::closeConnection()
+{
+	if(this->fd >= 0)
+	{
+		close(this->fd);
+	}
+	this->fd = -1;
+	this->releaseConnection();
+}
+
+
+void InterconnectStream::releaseConnection()
+{
+	this->fd = -1;
+	this->connecting = false;
+
+	// the receiving side discards the partial message
+	this->pending_length += this->pending_offset;
+	this->pending_offset = 0;
+	this->received.clear();
+	this->received_offset = 0;
+}
+
+
+void InterconnectStream::feed(const unsigned char *data, std::size_t length)
+{
+	if(this->received_offset > 0)
+	{
+		this->received.erase(this->received.begin(),
+		                     this->received.begin() + this->received_offset);
+		this->received_offset = 0;
+	}
+	this->received.insert(this->received.end(), data, data + length);
+}
+
+
+int InterconnectStream::nextMessage(uint8_t &msg_type, unsigned char *&payload, uint32_t &length)
+{
+	std::size_t available = this->received.size() - this->received_offset;
+	if(available < message_header_length)
+	{
+		return 0;
+	}
+
+	unsigned char *message = this->received.data() + this->received_offset;
+	uint32_t data_len;
+	memcpy(&data_len, message, sizeof(data_len));
+	if(data_len < message_header_length || data_len > message_header_length + MAX_SOCK_SIZE)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "invalid message length %u in the stream\n", data_len);
+		return -1;
+	}
+	if(available < data_len)
+	{
+		return 0;
+	}
+
+	msg_type = message[sizeof(data_len)];
+	payload = message + message_header_length;
+	length = data_len - message_header_length;
+	this->received_offset += data_len;
+	return 1;
+}
+
+
+bool InterconnectStream::connect()
+{
+	if(this->fd < 0)
+	{
+		struct sockaddr_storage addr;
+		socklen_t length;
+		if(!this->getAddress(addr, length))
+		{
+			return false;
+		}
+
+		this->fd = this->createSocket();
+		if(this->fd < 0)
+		{
+			return false;
+		}
+		if(::connect(this->fd, reinterpret_cast<struct sockaddr *>(&addr), length) == 0)
+		{
+			LOG(this->log, LEVEL_NOTICE, "connected\n");
+			return true;
+		}
+		if(errno != EINPROGRESS)
+		{
+			// the receiving side may not be started yet, retry later
+			LOG(this->log, LEVEL_DEBUG,
+			    "cannot connect: %s (%d)\n", strerror(errno), errno);
+			this->closeConnection();
+			return false;
+		}
+		this->connecting = true;
+	}
+
+	if(!this->connecting)
+	{
+		return true;
+	}
+
+	struct pollfd poll_fd = {this->fd, POLLOUT, 0};
+	if(poll(&poll_fd, 1, 0) <= 0)
+	{
+		return false;
+	}
+
+	int error = 0;
+	socklen_t error_length = sizeof(error);
+	if(getsockopt(this->fd, SOL_SOCKET, SO_ERROR, &error, &error_length) < 0 || error != 0)
+	{
+		LOG(this->log, LEVEL_DEBUG,
+		    "cannot connect: %s (%d)\n", strerror(error), error);
+		this->closeConnection();
+		return false;
+	}
+
+	this->connecting = false;
+	LOG(this->log, LEVEL_NOTICE, "connected\n");
+	return true;
+}
+
+
+bool InterconnectStream::isConnected() const
+{
+	return this->fd >= 0 && !this->connecting;
+}
+
+
+void InterconnectStream::push(std::unique_ptr<InterconnectMessage> msg)
+{
+	this->pending_length += msg->getTotalLength();
+	this->pending.push_back(std::move(msg));
+}
+
+
+bool InterconnectStream::flush()
+{
+	if(!this->isConnected() || this->pending.empty())
+	{
+		return true;
+	}
+
+	// gather the queued messages, skipping what was already written
+	this->iovecs.clear();
+	std::size_t skip = this->pending_offset;
+	for(auto &&msg: this->pending)
+	{
+		this->message_iovecs.clear();
+		msg->getBuffers(this->message_iovecs);
+		// the first buffer is reserved for datagram channels
+		for(std::size_t i = 1; i < this->message_iovecs.size(); ++i)
+		{
+			struct iovec iov = this->message_iovecs[i];
+			if(skip >= iov.iov_len)
+			{
+				skip -= iov.iov_len;
+				continue;
+			}
+			iov.iov_base = static_cast<unsigned char *>(iov.iov_base) + skip;
+			iov.iov_len -= skip;
+			skip = 0;
+			this->iovecs.push_back(iov);
+		}
+		if(this->iovecs.size() >= IOV_MAX)
+		{
+			break;
+		}
+	}
+
+	struct msghdr header;
+	memset(&header, 0, sizeof(header));
+	header.msg_iov = this->iovecs.data();
+	header.msg_iovlen = std::min<std::size_t>(this->iovecs.size(), IOV_MAX);
+	ssize_t ret = sendmsg(this->fd, &header, MSG_NOSIGNAL);
+	if(ret < 0)
+	{
+		if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+		{
+			return true;
+		}
+		LOG(this->log, LEVEL_ERROR,
+		    "connection lost: %s (%d)\n", strerror(errno), errno);
+		this->closeConnection();
+		return false;
+	}
+
+	// release the messages written entirely
+	std::size_t written = ret;
+	this->pending_length -= written;
+	while(written > 0)
+	{
+		std::size_t remaining = this->pending.front()->getTotalLength() - this->pending_offset;
+		if(written < remaining)
+		{
+			this->pending_offset += written;
+			break;
+		}
+		written -= remaining;
+		this->pending.pop_front();
+		this->pending_offset = 0;
+	}
+	return true;
+}
+
+
+bool InterconnectStream::waitWritable(time_ms_t timeout)
+{
+	if(!this->isConnected())
+	{
+		return false;
+	}
+
+	struct pollfd poll_fd = {this->fd, POLLOUT, 0};
+	return poll(&poll_fd, 1, timeout) > 0 && (poll_fd.revents & POLLOUT);
+}
+
+
+void InterconnectStream::dropFront()
+{
+	if(this->pending.empty())
+	{
+		return;
+	}
+	this->pending_length -= this->pending.front()->getTotalLength() - this->pending_offset;
+	this->pending.pop_front();
+	this->pending_offset = 0;
+}
+
+
+std::size_t InterconnectStream::getPendingLength() const
+{
+	return this->pending_length;
+}
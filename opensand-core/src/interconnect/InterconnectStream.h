@@ -0,0 +1,280 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file InterconnectStream.h
+ * @brief A stream socket carrying interconnect messages
+ */
+
+#ifndef INTERCONNECT_STREAM_H
+#define INTERCONNECT_STREAM_H
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opensand_rt/Types.h>
+
+#include "OpenSandCore.h"
+
+
+class OutputLog;
+class InterconnectMessage;
+
+
+/**
+ * @brief The transport used between two interconnected blocks
+ */
+enum class InterconnectTransport
+{
+	udp,
+	tcp,
+	unix_socket,
+	shared_memory,
+};
+
+
+/**
+ * @class InterconnectStream
+ * @brief A TCP or Unix stream socket carrying interconnect messages
+ *
+ * The messages already start with their length so they are written
+ * back to back on the stream. On the sending side, the messages are
+ * queued and all the queued messages are gathered in a single write
+ * when flushing; the bytes the socket could not take stay queued for
+ * the next flush. On the receiving side, the read chunks are
+ * reassembled into messages.
+ *
+ * The methods are virtual so other transports can reuse the
+ * connection of the stream and its queue of messages.
+ */
+class InterconnectStream
+{
+public:
+	/**
+	 * @brief Create a stream, the socket is opened by listen or connect
+	 *
+	 * @param name        the stream name
+	 * @param transport   TCP or Unix socket
+	 * @param address     the IP address to listen on or to connect to
+	 * @param port        the TCP port, also used to name the Unix socket
+	 * @param socket_dir  the directory containing the Unix sockets
+	 * @param rmem        the socket receive buffer size
+	 * @param wmem        the socket send buffer size
+	 */
+	InterconnectStream(const std::string &name,
+	                   InterconnectTransport transport,
+	                   const std::string &address,
+	                   unsigned short port,
+	                   const std::string &socket_dir,
+	                   unsigned int rmem,
+	                   unsigned int wmem);
+
+	virtual ~InterconnectStream();
+
+	/**
+	 * @brief Create the stream or the shared memory for a transport
+	 *
+	 * @return the stream, the parameters are the constructor ones
+	 */
+	static std::unique_ptr<InterconnectStream> create(const std::string &name,
+	                                                  InterconnectTransport transport,
+	                                                  const std::string &address,
+	                                                  unsigned short port,
+	                                                  const std::string &socket_dir,
+	                                                  unsigned int rmem,
+	                                                  unsigned int wmem);
+
+	/**
+	 * @brief Listen for the connection of the sending side
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool listen();
+
+	/**
+	 * @brief Get the listening socket
+	 */
+	int32_t getListenFd() const;
+
+	/**
+	 * @brief Use a connection accepted on the listening socket
+	 *
+	 * The previous connection is released: the events watching its
+	 * file descriptors should be removed to close them.
+	 *
+	 * @param fd  the accepted socket
+	 */
+	virtual void setConnection(int32_t fd);
+
+	/**
+	 * @brief Get the file descriptors to watch on the receiving side,
+	 *        none if not connected
+	 *
+	 * @param fds  OUT: the file descriptors, appended to the vector
+	 */
+	virtual void getConnectionFds(std::vector<int32_t> &fds) const;
+
+	/**
+	 * @brief Close the connection, queued messages are kept and
+	 *        sent again from their beginning on the next connection
+	 */
+	virtual void closeConnection();
+
+	/**
+	 * @brief Forget the connection without closing it, on the receiving
+	 *        side its file descriptors belong to the events watching them
+	 */
+	virtual void releaseConnection();
+
+	/**
+	 * @brief Append data read on the connection to the reassembly buffer
+	 *
+	 * @param data    the data read
+	 * @param length  the data length
+	 */
+	virtual void feed(const unsigned char *data, std::size_t length);
+
+	/**
+	 * @brief Get the next complete message of the reassembly buffer
+	 *
+	 * @param msg_type  OUT: the message type
+	 * @param payload   OUT: the message payload, valid until the next feed
+	 * @param length    OUT: the payload length
+	 * @return 1 if a message is returned, 0 if more data is needed,
+	 *         -1 if the stream is corrupted
+	 */
+	virtual int nextMessage(uint8_t &msg_type, unsigned char *&payload, uint32_t &length);
+
+	/**
+	 * @brief Try to connect to the receiving side, without blocking
+	 *
+	 * @return true if connected, false otherwise
+	 */
+	virtual bool connect();
+
+	/**
+	 * @brief Whether the stream is connected
+	 */
+	virtual bool isConnected() const;
+
+	/**
+	 * @brief Queue a message, it is sent on the next flush
+	 *
+	 * @param msg  the message
+	 */
+	void push(std::unique_ptr<InterconnectMessage> msg);
+
+	/**
+	 * @brief Write as much queued data as possible in a single call
+	 *
+	 * @return false if the connection was lost, true otherwise
+	 */
+	virtual bool flush();
+
+	/**
+	 * @brief Wait until the socket can take more data
+	 *
+	 * @param timeout  the maximum wait
+	 * @return true if data can be written, false otherwise
+	 */
+	virtual bool waitWritable(time_ms_t timeout);
+
+	/**
+	 * @brief Drop the oldest queued message, while disconnected
+	 */
+	void dropFront();
+
+	/**
+	 * @brief Get the length of the data waiting to be written
+	 */
+	std::size_t getPendingLength() const;
+
+protected:
+	/**
+	 * @brief Create a non blocking socket with the configured buffers
+	 *
+	 * @return the socket, -1 on error
+	 */
+	int32_t createSocket();
+
+	/**
+	 * @brief Get the address to listen on or to connect to
+	 *
+	 * @param addr    OUT: the address
+	 * @param length  OUT: the address length
+	 * @return true on success, false otherwise
+	 */
+	bool getAddress(struct sockaddr_storage &addr, socklen_t &length) const;
+
+	/// the stream name
+	std::string name;
+	/// TCP or Unix socket
+	InterconnectTransport transport;
+	/// the IP address to listen on or to connect to
+	std::string address;
+	/// the TCP port
+	unsigned short port;
+	/// the Unix socket path
+	std::string socket_path;
+	/// the socket buffers sizes
+	unsigned int rmem;
+	unsigned int wmem;
+
+	/// the listening socket of the receiving side
+	int32_t listen_fd;
+	/// the connected socket
+	int32_t fd;
+	/// whether a connection is in progress on the sending side
+	bool connecting;
+
+	/// the messages waiting to be written
+	std::deque<std::unique_ptr<InterconnectMessage>> pending;
+	/// the length already written of the first pending message
+	std::size_t pending_offset;
+	/// the length of the data waiting to be written
+	std::size_t pending_length;
+	/// the buffers of the flushed messages
+	std::vector<struct iovec> iovecs;
+	std::vector<struct iovec> message_iovecs;
+
+	/// the data read and not yet returned as messages
+	std::vector<unsigned char> received;
+	/// the start of the next message in the received data
+	std::size_t received_offset;
+
+	std::shared_ptr<OutputLog> log;
+};
+
+
+#endif
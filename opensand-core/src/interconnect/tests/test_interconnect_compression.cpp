@@ -0,0 +1,280 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+/*
+ * Interconnect compression test
+ *
+ * The application codes and decodes data of various lengths and contents
+ * with the block coding, and serialized NetBursts with the header coding,
+ * and checks that the data is restored. It also decodes corrupted and
+ * truncated coded data, which must be rejected or restored within the
+ * maximum length without crashing. It returns a non-zero status on failure.
+ */
+
+#include "InterconnectCompression.h"
+#include "NetPacket.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+/// the maximum length of the restored data
+constexpr std::size_t MAX_LENGTH = 16384;
+/// source, destination, QoS, protocol and header length of a packet
+constexpr std::size_t PACKET_FIELDS_LENGTH = 1 + 1 + 1 + sizeof(NET_PROTO) + 4;
+
+
+/// Build block data: random, zeros, periodic or mostly zeros
+static std::vector<unsigned char> buildBlock(std::mt19937 &random,
+                                             std::size_t length,
+                                             unsigned int kind)
+{
+	std::vector<unsigned char> data(length);
+	for(std::size_t i = 0; i < length; i++)
+	{
+		switch(kind % 4)
+		{
+			case 0:
+				data[i] = random();
+				break;
+			case 1:
+				data[i] = 0;
+				break;
+			case 2:
+				data[i] = i % 37;
+				break;
+			default:
+				data[i] = (random() % 4) ? 0 : random();
+				break;
+		}
+	}
+	return data;
+}
+
+/// Build a serialized NetBurst of packets sharing most of their metadata
+static std::vector<unsigned char> buildBurst(std::mt19937 &random,
+                                             unsigned int packets)
+{
+	std::vector<unsigned char> burst;
+	for(unsigned int i = 0; i < packets; i++)
+	{
+		std::size_t content_length = (i * 131) % 1500;
+		uint32_t packet_length = PACKET_FIELDS_LENGTH + content_length;
+		const unsigned char *header = reinterpret_cast<const unsigned char *>(&packet_length);
+		burst.insert(burst.end(), header, header + sizeof(packet_length));
+
+		unsigned char fields[PACKET_FIELDS_LENGTH] = {1, 2, static_cast<unsigned char>(i % 2)};
+		fields[3] = 0x08;
+		fields[PACKET_FIELDS_LENGTH - 4] = 20;
+		burst.insert(burst.end(), fields, fields + PACKET_FIELDS_LENGTH);
+		for(std::size_t j = 0; j < content_length; j++)
+		{
+			burst.push_back(j < 40 ? 0x45 + j : random());
+		}
+	}
+	return burst;
+}
+
+
+/// Block coded data of any length and content is restored
+static bool testBlockRoundTrip()
+{
+	std::mt19937 random(1);
+	std::vector<unsigned char> coded;
+	std::vector<unsigned char> decoded;
+
+	for(unsigned int iteration = 0; iteration < 4000; iteration++)
+	{
+		std::size_t length = iteration < 64 ? iteration : random() % 9000;
+		std::vector<unsigned char> data = buildBlock(random, length, iteration);
+
+		InterconnectCompression::compressBlock(data.data(), length, coded);
+		if(!InterconnectCompression::decompressBlock(coded.data(), coded.size(),
+		                                             MAX_LENGTH, decoded))
+		{
+			ERROR("block of %zu bytes (kind %u) not decoded\n", length, iteration % 4);
+			return false;
+		}
+		if(decoded != data)
+		{
+			ERROR("block of %zu bytes (kind %u) not restored\n", length, iteration % 4);
+			return false;
+		}
+		if(iteration % 4 != 0 && length > 64)
+		{
+			if(coded.size() >= length)
+			{
+				ERROR("redundant block of %zu bytes coded on %zu bytes\n",
+				      length, coded.size());
+				return false;
+			}
+		}
+	}
+
+	// a block longer than the maximum length is rejected
+	std::vector<unsigned char> data(MAX_LENGTH + 1, 0);
+	InterconnectCompression::compressBlock(data.data(), data.size(), coded);
+	if(InterconnectCompression::decompressBlock(coded.data(), coded.size(),
+	                                            MAX_LENGTH, decoded))
+	{
+		ERROR("block longer than the maximum length decoded\n");
+		return false;
+	}
+	return true;
+}
+
+/// Corrupted or truncated block coded data does not overflow
+static bool testBlockCorrupted()
+{
+	std::mt19937 random(2);
+	std::vector<unsigned char> coded;
+	std::vector<unsigned char> decoded;
+
+	for(unsigned int iteration = 0; iteration < 4000; iteration++)
+	{
+		std::size_t length = random() % 4000;
+		std::vector<unsigned char> data = buildBlock(random, length, iteration);
+		InterconnectCompression::compressBlock(data.data(), length, coded);
+
+		std::vector<unsigned char> corrupted = coded;
+		unsigned int errors = 1 + random() % 4;
+		for(unsigned int i = 0; i < errors; i++)
+		{
+			corrupted[random() % corrupted.size()] ^= 1 + random() % 255;
+		}
+		if(InterconnectCompression::decompressBlock(corrupted.data(), corrupted.size(),
+		                                            MAX_LENGTH, decoded))
+		{
+			if(decoded.size() > MAX_LENGTH)
+			{
+				ERROR("corrupted block decoded on %zu bytes\n", decoded.size());
+				return false;
+			}
+		}
+
+		std::size_t truncated = random() % coded.size();
+		if(InterconnectCompression::decompressBlock(coded.data(), truncated,
+		                                            MAX_LENGTH, decoded))
+		{
+			if(decoded.size() > MAX_LENGTH)
+			{
+				ERROR("truncated block decoded on %zu bytes\n", decoded.size());
+				return false;
+			}
+		}
+	}
+
+	// random data is not a valid block in general, but must not crash
+	for(unsigned int iteration = 0; iteration < 4000; iteration++)
+	{
+		std::vector<unsigned char> garbage = buildBlock(random, random() % 256, 0);
+		InterconnectCompression::decompressBlock(garbage.data(), garbage.size(),
+		                                         MAX_LENGTH, decoded);
+	}
+	return true;
+}
+
+/// Header coded NetBursts are restored, other data is rejected
+static bool testHeaders()
+{
+	std::mt19937 random(3);
+	std::vector<unsigned char> coded;
+	std::vector<unsigned char> decoded;
+
+	for(unsigned int packets = 0; packets < 32; packets++)
+	{
+		std::vector<unsigned char> burst = buildBurst(random, packets);
+
+		if(!InterconnectCompression::encodeHeaders(burst.data(), burst.size(), coded))
+		{
+			ERROR("NetBurst of %u packets not coded\n", packets);
+			return false;
+		}
+		if(packets >= 2 && coded.size() >= burst.size())
+		{
+			ERROR("NetBurst of %u packets coded on %zu bytes instead of %zu\n",
+			      packets, coded.size(), burst.size());
+			return false;
+		}
+		if(!InterconnectCompression::decodeHeaders(coded.data(), coded.size(), decoded))
+		{
+			ERROR("NetBurst of %u packets not decoded\n", packets);
+			return false;
+		}
+		if(decoded != burst)
+		{
+			ERROR("NetBurst of %u packets not restored\n", packets);
+			return false;
+		}
+
+		if(!coded.empty())
+		{
+			// a truncated NetBurst is rejected
+			if(InterconnectCompression::decodeHeaders(coded.data(), coded.size() - 1, decoded))
+			{
+				ERROR("truncated NetBurst of %u packets decoded\n", packets);
+				return false;
+			}
+			// a corrupted one may be decoded, but must not crash
+			coded[random() % coded.size()] ^= 0x5a;
+			InterconnectCompression::decodeHeaders(coded.data(), coded.size(), decoded);
+		}
+	}
+
+	// data that is not a serialized NetBurst is not coded
+	std::vector<unsigned char> frame = buildBlock(random, 100, 0);
+	uint32_t packet_length = 1000;
+	memcpy(frame.data(), &packet_length, sizeof(packet_length));
+	if(InterconnectCompression::encodeHeaders(frame.data(), frame.size(), coded))
+	{
+		ERROR("data that is not a NetBurst coded\n");
+		return false;
+	}
+	return true;
+}
+
+
+int main()
+{
+	if(!testBlockRoundTrip() ||
+	   !testBlockCorrupted() ||
+	   !testHeaders())
+	{
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS\n");
+	return EXIT_SUCCESS;
+}
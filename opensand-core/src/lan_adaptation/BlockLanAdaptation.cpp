@@ -48,6 +48,7 @@
 #include <cstdio>
 #include <cstring>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
@@ -80,7 +81,16 @@ BlockLanAdaptation::Downward::Downward(const std::string &name, struct la_specif
 	contexts{},
 	tal_id{specific.connected_satellite},
 	state{specific.is_used_for_isl ? SatelliteLinkState::UP : SatelliteLinkState::DOWN},
-	packet_switch{specific.packet_switch}
+	packet_switch{specific.packet_switch},
+	fd{-1},
+	tap_batch_size{1},
+	read_buffer{},
+	lanes{},
+	lane_size{0},
+	lane_burst_size{1},
+	weighted_lanes{false},
+	lanes_timer{-1},
+	probe_lane_drops{nullptr}
 {
 }
  
@@ -103,6 +113,34 @@ BlockLanAdaptation::Upward::Upward(const std::string &name, struct la_specific s
 void BlockLanAdaptation::generateConfiguration()
 {
 	Ethernet::generateConfiguration();
+
+	auto Conf = OpenSandModelConf::Get();
+	auto types = Conf->getModelTypesDefinition();
+	types->addEnumType("lane_scheduling", "Lane Scheduling", {"Strict Priority", "Weighted"});
+	auto conf = Conf->getOrCreateComponent("network", "Network", "The DVB layer configuration");
+	conf->addParameter("tap_batch_size",
+	                   "TAP Batch Size",
+	                   types->getType("int"),
+	                   "Maximum number of frames read on the TAP interface "
+	                   "on each wakeup and sent as a single burst, "
+	                   "0 or 1 to handle them one by one")->setAdvanced(true);
+	conf->addParameter("lane_size",
+	                   "QoS Lane Size",
+	                   types->getType("int"),
+	                   "Maximum number of frames of a QoS class waiting to be "
+	                   "sent to the encapsulation, extra frames are dropped, "
+	                   "0 to send the frames in arrival order")->setAdvanced(true);
+	conf->addParameter("lane_burst_size",
+	                   "QoS Lane Burst Size",
+	                   types->getType("int"),
+	                   "Maximum number of frames sent to the encapsulation "
+	                   "at once from the QoS lanes, 0 for the TAP batch "
+	                   "size")->setAdvanced(true);
+	conf->addParameter("lane_scheduling",
+	                   "QoS Lane Scheduling",
+	                   types->getType("lane_scheduling"),
+	                   "How the QoS lanes are drained, the QoS classes with "
+	                   "the lowest FIFO priority value first")->setAdvanced(true);
 }
 
 bool BlockLanAdaptation::onInit(void)
@@ -120,9 +158,54 @@ bool BlockLanAdaptation::onInit(void)
 	    "add lan adaptation: %s\n",
 	    plugin->getName().c_str());
 
-	// create TAP virtual interface
+	// optional, read frames one by one if not set
+	int batch_size;
+	auto network = OpenSandModelConf::Get()->getProfileData()->getComponent("network");
+	if(!OpenSandModelConf::extractParameterData(network->getParameter("tap_batch_size"), batch_size))
+	{
+		batch_size = 1;
+	}
+	if(batch_size < 0)
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "invalid TAP batch size %d\n", batch_size);
+		return false;
+	}
+	unsigned int tap_batch_size = std::max(batch_size, 1);
+
+	// optional too, no lanes if not set
+	int lane_size;
+	if(!OpenSandModelConf::extractParameterData(network->getParameter("lane_size"), lane_size))
+	{
+		lane_size = 0;
+	}
+	int lane_burst_size;
+	if(!OpenSandModelConf::extractParameterData(network->getParameter("lane_burst_size"), lane_burst_size))
+	{
+		lane_burst_size = 0;
+	}
+	std::string lane_scheduling;
+	if(!OpenSandModelConf::extractParameterData(network->getParameter("lane_scheduling"), lane_scheduling))
+	{
+		lane_scheduling = "Strict Priority";
+	}
+	if(lane_size < 0 || lane_burst_size < 0 ||
+	   (lane_scheduling != "Strict Priority" && lane_scheduling != "Weighted"))
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "invalid QoS lanes (size = %d, burst size = %d, scheduling = %s)\n",
+		    lane_size, lane_burst_size, lane_scheduling.c_str());
+		return false;
+	}
+	if(lane_burst_size == 0)
+	{
+		lane_burst_size = tap_batch_size;
+	}
+
+	// create TAP virtual interface, it should not block when
+	// draining it by batch
 	int fd = -1;
-	if(!this->allocTap(fd))
+	if(!this->allocTap(fd, tap_batch_size > 1))
 	{
 		return false;
 	}
@@ -134,6 +217,19 @@ bool BlockLanAdaptation::onInit(void)
 	// we can share FD as one thread will write, the second will read
 	((Upward *)this->upward)->setFd(fd);
 	((Downward *)this->downward)->setFd(fd);
+	((Downward *)this->downward)->setBatchSize(tap_batch_size);
+	((Downward *)this->downward)->setLanes(lane_size, lane_burst_size,
+	                                       lane_scheduling == "Weighted");
+	LOG(this->log_init, LEVEL_NOTICE,
+	    "read up to %u frames on the TAP interface per wakeup\n",
+	    tap_batch_size);
+	if(lane_size > 0)
+	{
+		LOG(this->log_init, LEVEL_NOTICE,
+		    "queue up to %d frames per QoS lane, drained by %d frames "
+		    "with %s scheduling\n",
+		    lane_size, lane_burst_size, lane_scheduling.c_str());
+	}
 
 	return true;
 }
@@ -152,6 +248,8 @@ bool BlockLanAdaptation::Downward::onInit(void)
 	    this->stats_period_ms);
 	this->stats_timer = this->addTimerEvent("LanAdaptationStats",
 	                                        this->stats_period_ms);
+	// raised while the QoS lanes hold packets
+	this->lanes_timer = this->addTimerEvent("LanAdaptationLanes", 1, false, false);
 	return true;
 }
 
@@ -189,10 +287,35 @@ void BlockLanAdaptation::Upward::setFd(int fd)
 
 void BlockLanAdaptation::Downward::setFd(int fd)
 {
+	this->fd = fd;
 	// add file descriptor for TAP interface
 	this->addFileEvent("tap", fd, TUNTAP_BUFSIZE + 4);
 }
 
+void BlockLanAdaptation::Downward::setBatchSize(unsigned int batch_size)
+{
+	this->tap_batch_size = batch_size;
+	if(this->tap_batch_size > 1)
+	{
+		// reused for every frame drained after the one read by the event
+		this->read_buffer.resize(TUNTAP_BUFSIZE + 4);
+	}
+}
+
+void BlockLanAdaptation::Downward::setLanes(std::size_t lane_size,
+                                            std::size_t burst_size,
+                                            bool weighted)
+{
+	this->lane_size = lane_size;
+	this->lane_burst_size = std::max<std::size_t>(burst_size, 1);
+	this->weighted_lanes = weighted;
+	if(lane_size > 0)
+	{
+		this->probe_lane_drops = Output::Get()->registerProbe<int>("Lan_Adaptation.Lane_Drops",
+		                                                           "packets", true, SAMPLE_SUM);
+	}
+}
+
 
 /**
  * destructor : Free all resources
@@ -224,11 +347,10 @@ bool BlockLanAdaptation::Downward::onEvent(const RtEvent *const event)
 			LOG(this->log_receive, LEVEL_DEBUG,
 			    "Get a forward burst from opposite channel\n");
 			NetBurst *forward_burst = static_cast<NetBurst *>(msg_event->getData());
-			if (!this->enqueueMessage((void **)&forward_burst, 0, to_underlying(InternalMessageType::decap_data)))
+			if (!this->sendBurst(forward_burst))
 			{
 				LOG(this->log_receive, LEVEL_ERROR,
 				    "failed to forward burst to lower layer\n");
-				delete forward_burst;
 				return false;
 			}
 		}
@@ -248,6 +370,10 @@ bool BlockLanAdaptation::Downward::onEvent(const RtEvent *const event)
 					(*it)->updateStats(this->stats_period_ms);
 				}
 			}
+			else if(*event == this->lanes_timer)
+			{
+				return this->drainLanes();
+			}
 			else
 			{
 				LOG(this->log_receive, LEVEL_ERROR,
@@ -439,10 +565,9 @@ bool BlockLanAdaptation::Upward::onMsgFromDown(NetBurst *burst)
 				    head[i], i);
 			}
 
-			packet.insert(0, head, TUNTAP_FLAGS_LEN);
 			if (delay == 0)
 			{
-				if(!this->writePacket(packet))
+				if(!this->writePacket(packet, head))
 				{
 					success = false;
 					++burst_it;
@@ -451,6 +576,7 @@ bool BlockLanAdaptation::Upward::onMsgFromDown(NetBurst *burst)
 			}
 			else
 			{
+				packet.insert(0, head, TUNTAP_FLAGS_LEN);
 				std::unique_ptr<NetPacket> packet_ptr{new NetPacket(packet)};
 				FifoElement *elem = new FifoElement(std::move(packet_ptr), current_time, current_time + delay);
 				if (!delay_fifo.pushBack(elem))
@@ -536,10 +662,24 @@ bool BlockLanAdaptation::Upward::onMsgFromDown(NetBurst *burst)
 	return success;
 }
 
-bool BlockLanAdaptation::Upward::writePacket(const Data& packet)
+bool BlockLanAdaptation::Upward::writePacket(const Data& packet, const unsigned char *head)
 {
+	// the TAP header and the packet are gathered by the kernel into a single
+	// frame, this avoids moving the whole packet to prepend the header
+	struct iovec iov[2];
+	int iovcnt = 0;
+	if(head != nullptr)
+	{
+		iov[iovcnt].iov_base = const_cast<unsigned char *>(head);
+		iov[iovcnt].iov_len = TUNTAP_FLAGS_LEN;
+		++iovcnt;
+	}
+	iov[iovcnt].iov_base = const_cast<unsigned char *>(packet.data());
+	iov[iovcnt].iov_len = packet.length();
+	++iovcnt;
+
 	// TODO move into its own function for delay...
-	if(write(this->fd, packet.data(), packet.length()) < 0)
+	if(writev(this->fd, iov, iovcnt) < 0)
 	{
 		LOG(this->log_receive, LEVEL_ERROR,
 			"Unable to write data on tap "
@@ -549,16 +689,36 @@ bool BlockLanAdaptation::Upward::writePacket(const Data& packet)
 	return true;
 }
 
+bool BlockLanAdaptation::Downward::addTapFrame(NetBurst *burst,
+                                               const unsigned char *frame,
+                                               std::size_t size)
+{
+	if(size <= TUNTAP_FLAGS_LEN)
+	{
+		LOG(this->log_receive, LEVEL_WARNING,
+		    "too short frame (%zu bytes) received on TAP interface\n",
+		    size);
+		return false;
+	}
+
+	// skip the TAP header
+	unsigned int length = size - TUNTAP_FLAGS_LEN;
+	LOG(this->log_receive, LEVEL_INFO,
+	    "new %u-bytes packet received from network\n", length);
+	auto packet = std::unique_ptr<NetPacket>(new NetPacket(frame + TUNTAP_FLAGS_LEN, length));
+	// Learn source_mac address
+	tal_id_t pkt_tal_id_src = packet->getSrcTalId();
+	packet_switch->learn(packet->getData(), pkt_tal_id_src);
+
+	return burst->add(std::move(packet));
+}
+
 bool BlockLanAdaptation::Downward::onMsgFromUp(const NetSocketEvent *const event)
 {
 	unsigned char *read_data;
-	const unsigned char *data;
-	unsigned int length;
 
 	// read  data received on tap interface
-	length = event->getSize() - TUNTAP_FLAGS_LEN;
 	read_data = event->getData();
-	data = read_data + TUNTAP_FLAGS_LEN;
 
 	if(this->state != SatelliteLinkState::UP)
 	{
@@ -569,17 +729,39 @@ bool BlockLanAdaptation::Downward::onMsgFromUp(const NetSocketEvent *const event
 		return false;
 	}
 
-	LOG(this->log_receive, LEVEL_INFO,
-	    "new %u-bytes packet received from network\n", length);
-	auto packet = std::unique_ptr<NetPacket>(new NetPacket(data, length));
-	// Learn source_mac address
-	tal_id_t pkt_tal_id_src = packet->getSrcTalId();
-	packet_switch->learn(packet->getData(), pkt_tal_id_src);
-
 	NetBurst *burst = new NetBurst();
-	burst->add(std::move(packet));
+	this->addTapFrame(burst, read_data, event->getSize());
 	delete [] read_data;
 
+	// drain the frames already queued on the TAP interface so they
+	// are encapsulated and sent to lower layer as a single burst, the
+	// rejected frames count in the batch too
+	for(unsigned int frames_read = 1; frames_read < this->tap_batch_size; ++frames_read)
+	{
+		ssize_t ret = read(this->fd, this->read_buffer.data(), this->read_buffer.size());
+		if(ret < 0)
+		{
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			{
+				LOG(this->log_receive, LEVEL_ERROR,
+				    "unable to read on TAP interface: %s\n",
+				    strerror(errno));
+			}
+			break;
+		}
+		if(ret == 0)
+		{
+			break;
+		}
+		this->addTapFrame(burst, this->read_buffer.data(), ret);
+	}
+
+	if(burst->length() == 0)
+	{
+		delete burst;
+		return true;
+	}
+
 	for(auto &&context : this->contexts)
 	{
 		burst = context->encapsulate(burst);
@@ -592,6 +774,109 @@ bool BlockLanAdaptation::Downward::onMsgFromUp(const NetSocketEvent *const event
 		}
 	}
 
+	return this->sendBurst(burst);
+}
+
+bool BlockLanAdaptation::Downward::sendBurst(NetBurst *burst)
+{
+	if(this->lane_size == 0)
+	{
+		if (!this->enqueueMessage((void **)&burst, 0, to_underlying(InternalMessageType::decap_data)))
+		{
+			LOG(this->log_receive, LEVEL_ERROR,
+			    "failed to send burst to lower layer\n");
+			delete burst;
+			return false;
+		}
+		return true;
+	}
+
+	// classify the packets, so that a bulk of low priority packets
+	// does not delay the high priority ones
+	int drops = 0;
+	for(auto &&packet : *burst)
+	{
+		IngressLane &lane = this->lanes[packet->getQos()];
+		if(lane.packets.size() >= this->lane_size)
+		{
+			lane.drops++;
+			drops++;
+			LOG(this->log_receive, LEVEL_DEBUG,
+			    "QoS %u lane is full, drop packet (%lu drops)\n",
+			    packet->getQos(), lane.drops);
+			continue;
+		}
+		lane.packets.push_back(std::move(packet));
+	}
+	delete burst;
+	if(drops > 0)
+	{
+		this->probe_lane_drops->put(drops);
+	}
+
+	return this->drainLanes();
+}
+
+bool BlockLanAdaptation::Downward::drainLanes()
+{
+	NetBurst *burst = new NetBurst();
+	std::size_t remaining = 0;
+
+	if(!this->weighted_lanes)
+	{
+		// strict priority, the lanes are sorted by QoS
+		for(auto &&it : this->lanes)
+		{
+			auto &packets = it.second.packets;
+			while(!packets.empty() && burst->size() < this->lane_burst_size)
+			{
+				burst->push_back(std::move(packets.front()));
+				packets.pop_front();
+			}
+			remaining += packets.size();
+		}
+	}
+	else
+	{
+		// weighted round robin, the lane at rank r among n lanes
+		// sends up to n - r packets per round
+		bool sent = true;
+		while(sent && burst->size() < this->lane_burst_size)
+		{
+			std::size_t weight = this->lanes.size();
+			sent = false;
+			for(auto &&it : this->lanes)
+			{
+				auto &packets = it.second.packets;
+				for(std::size_t i = 0;
+				    i < weight && !packets.empty() && burst->size() < this->lane_burst_size;
+				    ++i)
+				{
+					burst->push_back(std::move(packets.front()));
+					packets.pop_front();
+					sent = true;
+				}
+				weight--;
+			}
+		}
+		for(auto &&it : this->lanes)
+		{
+			remaining += it.second.packets.size();
+		}
+	}
+
+	// let the other events be handled before sending the next burst
+	if(remaining > 0)
+	{
+		this->raiseTimer(this->lanes_timer);
+	}
+
+	if(burst->empty())
+	{
+		delete burst;
+		return true;
+	}
+
 	if (!this->enqueueMessage((void **)&burst, 0, to_underlying(InternalMessageType::decap_data)))
 	{
 		LOG(this->log_receive, LEVEL_ERROR,
@@ -599,11 +884,10 @@ bool BlockLanAdaptation::Downward::onMsgFromUp(const NetSocketEvent *const event
 		delete burst;
 		return false;
 	}
-
 	return true;
 }
 
-bool BlockLanAdaptation::allocTap(int &fd)
+bool BlockLanAdaptation::allocTap(int &fd, bool non_blocking)
 {
 	struct ifreq ifr;
 	int err;
@@ -641,6 +925,15 @@ bool BlockLanAdaptation::allocTap(int &fd)
 		return false;
 	}
 
+	if(non_blocking && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0)
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "cannot set TAP interface in non blocking mode: %s\n",
+		    strerror(errno));
+		close(fd);
+		return false;
+	}
+
 	LOG(this->log_init, LEVEL_NOTICE,
 	    "TAP handle with fd %d initialized\n", fd);
 
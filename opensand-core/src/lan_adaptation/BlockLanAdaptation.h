@@ -51,6 +51,10 @@
 #include <opensand_rt/RtChannel.h>
 #include <opensand_output/Output.h>
 
+#include <deque>
+#include <map>
+#include <vector>
+
 
 class NetSocketEvent;
 
@@ -116,9 +120,11 @@ public:
 		 * @brief Actually write the TAP header + packet to TAP interface
 		 *
 		 * @param packet  Data to write on the TAP interface
+		 * @param head    The TAP header to prepend to packet, nullptr if
+		 *                packet already contains it
 		 * @return true on success, false otherwise
 		 */
-		bool writePacket(const Data& packet);
+		bool writePacket(const Data& packet, const unsigned char *head = nullptr);
 
 		/// SARP table
 		SarpTable sarp_table;
@@ -170,17 +176,75 @@ public:
 		 */
 		void setFd(int fd);
 
+		/**
+		 * @brief Set the maximum number of frames read on the TAP
+		 *        interface on each wakeup
+		 *
+		 * @param batch_size  The maximum number of frames per burst
+		 */
+		void setBatchSize(unsigned int batch_size);
+
+		/**
+		 * @brief Queue the packets sent to the lower block in one lane
+		 *        per QoS, drained by priority
+		 *
+		 * @param lane_size   The maximum number of packets in a lane,
+		 *                    0 to send the packets in arrival order
+		 * @param burst_size  The maximum number of packets per burst
+		 * @param weighted    Whether the lanes are drained with weighted
+		 *                    round robin instead of strict priority
+		 */
+		void setLanes(std::size_t lane_size, std::size_t burst_size, bool weighted);
+
 	private:
+		/**
+		 * @brief The packets of one QoS waiting to be sent to the lower block
+		 */
+		struct IngressLane
+		{
+			std::deque<std::unique_ptr<NetPacket>> packets;
+			unsigned long drops;
+		};
+
+		/**
+		 * @brief Send a burst to the lower block, through the lanes
+		 *        if they are enabled
+		 *
+		 * @param burst  The burst to send
+		 * @return true on success, false otherwise
+		 */
+		bool sendBurst(NetBurst *burst);
+
+		/**
+		 * @brief Send one burst built from the lanes to the lower block,
+		 *        and schedule the next one if packets remain
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool drainLanes();
+
 		/**
 		 * @brief Handle a message from upper block
-		 *  - read data from TAP interface
-		 *  - create a packet with data
+		 *  - read data from TAP interface, then drain the frames
+		 *    already queued on it up to the batch size
+		 *  - create a burst with all the packets
 		 *
 		 * @param event  The event on TAP interface, containing th message
 		 * @return true on success, false otherwise
 		 */
 		bool onMsgFromUp(const NetSocketEvent *const event);
 
+		/**
+		 * @brief Create a packet from a frame read on the TAP interface
+		 *        and add it to the burst
+		 *
+		 * @param burst  The burst to fill
+		 * @param frame  The TAP header + packet
+		 * @param size   The frame size
+		 * @return true on success, false otherwise
+		 */
+		bool addTapFrame(NetBurst *burst, const unsigned char *frame, std::size_t size);
+
 		/// statistic timer
 		event_id_t stats_timer;
 
@@ -198,6 +262,34 @@ public:
 
 		// The Packet Switch including packet forwarding logic and SARP
 		PacketSwitch *packet_switch;
+
+		/// TAP file descriptor, shared with the upward channel
+		int fd;
+
+		/// The maximum number of frames read on the TAP per wakeup
+		unsigned int tap_batch_size;
+
+		/// The buffer reused to drain the TAP interface
+		std::vector<unsigned char> read_buffer;
+
+		/// The lanes of the packets sent to the lower block, per QoS,
+		/// the lowest QoS value having the highest priority
+		std::map<qos_t, IngressLane> lanes;
+
+		/// The maximum number of packets in a lane, 0 if lanes are disabled
+		std::size_t lane_size;
+
+		/// The maximum number of packets sent per burst from the lanes
+		std::size_t lane_burst_size;
+
+		/// Whether lanes are drained with weighted round robin
+		bool weighted_lanes;
+
+		/// The timer draining the lanes while they hold packets
+		event_id_t lanes_timer;
+
+		/// The packets dropped by the full lanes
+		std::shared_ptr<Probe<int>> probe_lane_drops;
 	};
 
 private:
@@ -210,10 +302,11 @@ private:
 	/**
 	 * Create or connect to an existing TAP interface
 	 *
-	 * @param fd  OUT: the file descriptor
+	 * @param fd            OUT: the file descriptor
+	 * @param non_blocking  Whether reads on the interface should not block
 	 * @return  true on success, false otherwise
 	 */
-	bool allocTap(int &fd);
+	bool allocTap(int &fd, bool non_blocking);
 };
 
 
@@ -47,6 +47,8 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <cinttypes>
 #include <arpa/inet.h>
 
 
@@ -140,7 +142,10 @@ bool Ethernet::init()
 }
 
 Ethernet::Context::Context(LanAdaptationPlugin &plugin):
-	LanAdaptationContext(plugin)
+	LanAdaptationContext(plugin),
+	evc_table{},
+	default_category{nullptr},
+	pcp_categories{}
 {
 }
 
@@ -249,6 +254,7 @@ Ethernet::Context::~Context()
 		delete (*evc_it).second;
 	}
 	this->evc_map.clear();
+	this->evc_table.clear();
 	
 	for(cat_it = this->category_map.begin(); cat_it != this->category_map.end(); ++cat_it)
 	{
@@ -341,6 +347,12 @@ bool Ethernet::Context::initEvc()
 		Evc *evc = new Evc(mac_src, mac_dst, q_tci, ad_tci, to_enum<NET_PROTO>(pt));
 		this->evc_map[id] = evc;
 	}
+	// the EVC are matched in ID order
+	for(auto &&evc : this->evc_map)
+	{
+		this->evc_table.emplace_back(evc.first, evc.second);
+	}
+
 	// initialize the statistics on EVC
 	this->initStats();
 
@@ -422,6 +434,14 @@ bool Ethernet::Context::initTrafficCategories()
 		return false;
 	}
 	this->default_category = found_default_category->second;
+
+	// index the categories by PCP, the default one for unknown values
+	for(std::size_t pcp = 0; pcp < this->pcp_categories.size(); ++pcp)
+	{
+		auto found_category = this->category_map.find(pcp);
+		this->pcp_categories[pcp] = (found_category != this->category_map.end()) ?
+		                            found_category->second : this->default_category;
+	}
 	
 	return true;
 }
@@ -434,7 +454,7 @@ bool Ethernet::Context::initLanAdaptationContext(tal_id_t tal_id, PacketSwitch *
 
 
 NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
-                                         std::map<long, int> &UNUSED(time_contexts))
+                                         std::map<int, long> &UNUSED(time_contexts))
 {
 	NetBurst::iterator packet;
 
@@ -481,19 +501,13 @@ NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
 		}
 		else
 		{
-			size_t header_length;
-			NET_PROTO ether_type = Ethernet::getPayloadEtherType(packet->getData());
-			NET_PROTO frame_type = Ethernet::getFrameType(packet->getData());
-			MacAddress src_mac = Ethernet::getSrcMac(packet->getData());
-			MacAddress dst_mac = Ethernet::getDstMac(packet->getData());
+			const eth_header_desc_t &header = Ethernet::getHeader(*packet);
 			tal_id_t src = 255 ;
 			tal_id_t dst = 255;
-			uint16_t q_tci = Ethernet::getQTci(packet->getData());
-			uint16_t ad_tci = Ethernet::getAdTci(packet->getData());
-			qos_t pcp = (q_tci & 0xe000) >> 13;
+			uint16_t q_tci = header.q_tci;
+			uint16_t ad_tci = header.ad_tci;
 			qos_t qos = 0;
-			Evc *evc;
-			SarpTable *sarp_table = packet_switch->getSarpTable();
+			const Evc *evc;
 
 			// Do not print errors here because we may want to reject trafic as spanning
 			// tree coming from miscellaneous host
@@ -503,8 +517,8 @@ NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
 				if(dst > BROADCAST_TAL_ID)
 				{
 					LOG(this->log, LEVEL_WARNING,
-					    "cannot find destination MAC address %s in sarp table\n",
-					    dst_mac.str().c_str());
+					    "cannot find destination MAC address %012" PRIx64 " in sarp table\n",
+					    header.dst_mac);
 					continue;
 				}
 				else
@@ -515,33 +529,30 @@ NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
 				}
 			}
 			LOG(this->log, LEVEL_INFO,
-			    "build Ethernet frame with source MAC %s corresponding "
-			    " to terminal ID %d and destination MAC %s corresponding "
+			    "build Ethernet frame with source MAC %012" PRIx64 " corresponding "
+			    " to terminal ID %d and destination MAC %012" PRIx64 " corresponding "
 			    "to terminal ID %d\n",
-			    src_mac.str().c_str(), src, dst_mac.str().c_str(), dst);
+			    header.src_mac, src, header.dst_mac, dst);
 
-			switch(frame_type)
+			switch(header.frame_type)
 			{
 				case NET_PROTO::ETH:
-					header_length = ETHERNET_2_HEADSIZE;
-					evc = this->getEvc(src_mac, dst_mac, ether_type, evc_id);
+					evc = this->getEvc(header, evc_id);
 					qos = this->default_category->getId();
 					break;
 				case NET_PROTO::IEEE_802_1Q:
-					header_length = ETHERNET_802_1Q_HEADSIZE;
-					evc = this->getEvc(src_mac, dst_mac, q_tci, ether_type, evc_id);
+					evc = this->getEvc(header, evc_id);
 					LOG(this->log, LEVEL_INFO,
 					    "TCI = %u\n", q_tci);
 					break;
 				case NET_PROTO::IEEE_802_1AD:
-					header_length = ETHERNET_802_1AD_HEADSIZE;
-					evc = this->getEvc(src_mac, dst_mac, q_tci, ad_tci, ether_type, evc_id);
+					evc = this->getEvc(header, evc_id);
 					LOG(this->log, LEVEL_INFO,
 					    "Outer TCI = %u, Inner TCI = %u\n", ad_tci, q_tci);
 					break;
 				default:
 					LOG(this->log, LEVEL_ERROR,
-					    "wrong Ethernet frame type 0x%.4x\n", frame_type);
+					    "wrong Ethernet frame type 0x%.4x\n", header.frame_type);
 					continue;
 			}
 			if(!evc)
@@ -550,24 +561,16 @@ NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
 				    "cannot find EVC for this flow, use the default values\n");
 			}
 
-			if(frame_type != NET_PROTO::ETH)
+			if(header.frame_type != NET_PROTO::ETH)
 			{
 				// get the QoS from the PCP if there is a PCP
-				auto found_category = this->category_map.find(pcp);
-				if (found_category == this->category_map.end())
-				{
-					qos = this->default_category->getId();
-				}
-				else
-				{
-					qos = found_category->second->getId();
-				}
+				qos = this->getPcpQos(header.pcp);
 				LOG(this->log, LEVEL_INFO,
-				    "PCP = %u corresponding to queue %s (%u)\n", pcp,
-				    found_category->second->getName().c_str(), qos);
+				    "PCP = %u corresponding to queue %u\n",
+				    header.pcp, qos);
 			}
 
-			if(frame_type != this->sat_frame_type)
+			if(header.frame_type != this->sat_frame_type)
 			{
 				if(evc)
 				{
@@ -575,24 +578,17 @@ NetBurst *Ethernet::Context::encapsulate(NetBurst *burst,
 					// handle every condition if we do that
 					q_tci = (evc->getQTci() & 0xffff);
 					ad_tci = (evc->getAdTci() & 0xffff);
-					qos_t pcp = (evc->getQTci() & 0xe000) > 13;
-					auto found_category = this->category_map.find(pcp);
-					if (found_category == this->category_map.end())
-					{
-						qos = this->default_category->getId();
-					}
-					else
-					{
-						qos = found_category->second->getId();
-					}
+					qos_t pcp = (q_tci & 0xe000) >> 13;
+					qos = this->getPcpQos(pcp);
 					LOG(this->log, LEVEL_INFO,
 					    "PCP in EVC is %u corresponding to QoS %u for DVB layer\n",
 					    pcp, qos);
 				}
 				// TODO we should cast to an EthernetPacket and use getPayload instead
-				eth_frame = this->createEthFrameData(packet->getData().substr(header_length),
-				                                     src_mac, dst_mac,
-				                                     ether_type,
+				eth_frame = this->createEthFrameData(packet->getData().substr(header.header_length),
+				                                     Ethernet::getMac(header.src_mac),
+				                                     Ethernet::getMac(header.dst_mac),
+				                                     header.ether_type,
 				                                     q_tci, ad_tci,
 				                                     qos, src, dst,
 				                                     this->sat_frame_type);
@@ -668,30 +664,20 @@ NetBurst *Ethernet::Context::deencapsulate(NetBurst *burst)
 	{
 		std::unique_ptr<NetPacket> deenc_packet;
 		size_t data_length = packet->getTotalLength();
-		MacAddress dst_mac = Ethernet::getDstMac(packet->getData());
-		MacAddress src_mac = Ethernet::getSrcMac(packet->getData());
-		uint16_t q_tci = Ethernet::getQTci(packet->getData());
-		uint16_t ad_tci = Ethernet::getAdTci(packet->getData());
-		NET_PROTO ether_type = Ethernet::getPayloadEtherType(packet->getData());
-		NET_PROTO frame_type = Ethernet::getFrameType(packet->getData());
-		Evc *evc;
-		size_t header_length;
+		const eth_header_desc_t &header = Ethernet::getHeader(*packet);
+		uint16_t q_tci = header.q_tci;
+		uint16_t ad_tci = header.ad_tci;
+		NET_PROTO ether_type = header.ether_type;
+		NET_PROTO frame_type = header.frame_type;
+		const Evc *evc;
 		uint8_t evc_id = 0;
-		SarpTable *sarp_table = packet_switch->getSarpTable();
 
 		switch(frame_type)
 		{
 			case NET_PROTO::ETH:
-				header_length = ETHERNET_2_HEADSIZE;
-				evc = this->getEvc(src_mac, dst_mac, ether_type, evc_id);
-				break;
 			case NET_PROTO::IEEE_802_1Q:
-				header_length = ETHERNET_802_1Q_HEADSIZE;
-				evc = this->getEvc(src_mac, dst_mac, q_tci, ether_type, evc_id);
-				break;
 			case NET_PROTO::IEEE_802_1AD:
-				header_length = ETHERNET_802_1AD_HEADSIZE;
-				evc = this->getEvc(src_mac, dst_mac, q_tci, ad_tci, ether_type, evc_id);
+				evc = this->getEvc(header, evc_id);
 				break;
 			default:
 				LOG(this->log, LEVEL_ERROR,
@@ -707,9 +693,9 @@ NetBurst *Ethernet::Context::deencapsulate(NetBurst *burst)
 		this->evc_data_size[evc_id] += data_length;
 
 		LOG(this->log, LEVEL_INFO,
-		    "Ethernet frame received: src: %s, dst %s, Q-tag: %u, "
-		    "ad-tag: %u, EtherType: 0x%.4x\n",
-		    src_mac.str().c_str(), dst_mac.str().c_str(),
+		    "Ethernet frame received: src: %012" PRIx64 ", dst %012" PRIx64 ", "
+		    "Q-tag: %u, ad-tag: %u, EtherType: 0x%.4x\n",
+		    header.src_mac, header.dst_mac,
 		    q_tci, ad_tci, ether_type);
 
 		if(this->current_upper)
@@ -762,8 +748,9 @@ NetBurst *Ethernet::Context::deencapsulate(NetBurst *burst)
 					ad_tci = (evc->getAdTci() & 0xffff);
 				}
 				// TODO we should cast to an EthernetPacket and use getPayload instead
-				deenc_packet = this->createEthFrameData(packet->getData().substr(header_length),
-				                                        src_mac, dst_mac,
+				deenc_packet = this->createEthFrameData(packet->getData().substr(header.header_length),
+				                                        Ethernet::getMac(header.src_mac),
+				                                        Ethernet::getMac(header.dst_mac),
 				                                        ether_type,
 				                                        q_tci, ad_tci,
 				                                        packet->getQos(),
@@ -1039,40 +1026,46 @@ std::unique_ptr<NetPacket> Ethernet::PacketHandler::build(const Data &data,
                                                           uint8_t src_tal_id,
                                                           uint8_t dst_tal_id) const
 {
-	size_t head_length = 0;
-	NET_PROTO frame_type = Ethernet::getFrameType(data);
-	switch(frame_type)
+	return this->build(data.data(), std::min(data.length(), data_length),
+	                   qos, src_tal_id, dst_tal_id);
+}
+
+std::unique_ptr<NetPacket> Ethernet::PacketHandler::build(const unsigned char *data,
+                                                          std::size_t data_length,
+                                                          uint8_t qos,
+                                                          uint8_t src_tal_id,
+                                                          uint8_t dst_tal_id) const
+{
+	eth_header_desc_t header;
+	size_t head_length = ETHERNET_2_HEADSIZE;
+	// parse the header once for all the processing of the frame
+	if(Ethernet::parseHeader(data, data_length, header))
 	{
-		case NET_PROTO::IEEE_802_1Q:
-			head_length = ETHERNET_802_1Q_HEADSIZE;
-			break;
-		case NET_PROTO::IEEE_802_1AD:
-			head_length = ETHERNET_802_1AD_HEADSIZE;
-			break;
-		// Ethernet packet, this is the ethertype of the payload
-		default:
-			head_length = ETHERNET_2_HEADSIZE;
-			break;
+		head_length = header.header_length;
 	}
 
-	return std::unique_ptr<NetPacket>(new NetPacket(data, data_length,
-	                                                this->getName(),
-	                                                frame_type,
-	                                                qos,
-	                                                src_tal_id,
-	                                                dst_tal_id,
-	                                                head_length));
+	auto packet = std::unique_ptr<NetPacket>(new NetPacket(data, data_length,
+	                                                       this->getName(),
+	                                                       header.frame_type,
+	                                                       qos,
+	                                                       src_tal_id,
+	                                                       dst_tal_id,
+	                                                       head_length));
+	packet->setEthHeader(header);
+	return packet;
 }
 
 Evc *Ethernet::Context::getEvc(const MacAddress src_mac,
                                const MacAddress dst_mac,
+                               uint16_t q_tci,
+                               uint16_t ad_tci,
                                NET_PROTO ether_type,
                                uint8_t &evc_id) const
 {
 	for(std::map<uint8_t, Evc *>::const_iterator it = this->evc_map.begin();
 	    it != this->evc_map.end(); ++it)
 	{
-		if((*it).second->matches(&src_mac, &dst_mac, ether_type))
+		if((*it).second->matches(&src_mac, &dst_mac, q_tci, ad_tci, ether_type))
 		{
 			evc_id = (*it).first;
 			return (*it).second;
@@ -1082,44 +1075,115 @@ Evc *Ethernet::Context::getEvc(const MacAddress src_mac,
 }
 
 
-Evc *Ethernet::Context::getEvc(const MacAddress src_mac,
-                               const MacAddress dst_mac,
-                               uint16_t q_tci,
-                               NET_PROTO ether_type,
-                               uint8_t &evc_id) const
+const Evc *Ethernet::Context::getEvc(const eth_header_desc_t &header,
+                                     uint8_t &evc_id) const
 {
-	for(std::map<uint8_t, Evc *>::const_iterator it = this->evc_map.begin();
-	    it != this->evc_map.end(); ++it)
+	for(auto &&evc : this->evc_table)
 	{
-		if((*it).second->matches(&src_mac, &dst_mac, q_tci, ether_type))
+		if(evc.second->matches(header))
 		{
-			evc_id = (*it).first;
-			return (*it).second;
+			evc_id = evc.first;
+			return evc.second;
 		}
 	}
-	return NULL;
+	return nullptr;
 }
 
 
-Evc *Ethernet::Context::getEvc(const MacAddress src_mac,
-                               const MacAddress dst_mac,
-                               uint16_t q_tci,
-                               uint16_t ad_tci,
-                               NET_PROTO ether_type,
-                               uint8_t &evc_id) const
+qos_t Ethernet::Context::getPcpQos(uint8_t pcp) const
 {
-	for(std::map<uint8_t, Evc *>::const_iterator it = this->evc_map.begin();
-	    it != this->evc_map.end(); ++it)
+	return this->pcp_categories[pcp & 0x07]->getId();
+}
+
+
+static inline uint16_t readUint16(const uint8_t *data)
+{
+	return (data[0] << 8) | data[1];
+}
+
+static inline uint64_t readMac(const uint8_t *data)
+{
+	return (uint64_t(readUint16(data)) << 32) |
+	       (uint64_t(readUint16(data + 2)) << 16) |
+	       uint64_t(readUint16(data + 4));
+}
+
+bool Ethernet::parseHeader(const uint8_t *data, std::size_t length,
+                           eth_header_desc_t &header)
+{
+	header = eth_header_desc_t{};
+	if(length < ETHERNET_2_HEADSIZE)
 	{
-		if((*it).second->matches(&src_mac, &dst_mac, q_tci, ad_tci, ether_type))
+		return false;
+	}
+	header.dst_mac = readMac(data);
+	header.src_mac = readMac(data + ETH_ALEN);
+
+	NET_PROTO ether_type = to_enum<NET_PROTO>(readUint16(data + 12));
+	switch(ether_type)
+	{
+		case NET_PROTO::IEEE_802_1Q:
+			if(length < ETHERNET_802_1Q_HEADSIZE)
+			{
+				return false;
+			}
+			header.ether_type = to_enum<NET_PROTO>(readUint16(data + 16));
+			// TODO: we need the following part because we use two 802.1Q
+			//       tags for kernel support
+			if(header.ether_type != NET_PROTO::IEEE_802_1Q)
+			{
+				header.frame_type = NET_PROTO::IEEE_802_1Q;
+				header.q_tci = readUint16(data + 14);
+				header.header_length = ETHERNET_802_1Q_HEADSIZE;
+				break;
+			}
+			// fall through
+		case NET_PROTO::IEEE_802_1AD:
+			if(length < ETHERNET_802_1AD_HEADSIZE)
+			{
+				header.ether_type = NET_PROTO::ERROR;
+				return false;
+			}
+			header.frame_type = NET_PROTO::IEEE_802_1AD;
+			header.ad_tci = readUint16(data + 14);
+			header.q_tci = readUint16(data + 18);
+			header.ether_type = to_enum<NET_PROTO>(readUint16(data + 20));
+			header.header_length = ETHERNET_802_1AD_HEADSIZE;
+			break;
+		default:
+			header.frame_type = NET_PROTO::ETH;
+			header.ether_type = ether_type;
+			header.header_length = ETHERNET_2_HEADSIZE;
+			break;
+	}
+	header.pcp = (header.q_tci & 0xe000) >> 13;
+
+	return true;
+}
+
+const eth_header_desc_t &Ethernet::getHeader(NetPacket &packet)
+{
+	const eth_header_desc_t *header = packet.getEthHeader();
+	if(header == nullptr)
+	{
+		eth_header_desc_t parsed;
+		if(!Ethernet::parseHeader(packet.getRawData(), packet.getTotalLength(), parsed))
 		{
-			evc_id = (*it).first;
-			return (*it).second;
+			DFLTLOG(LEVEL_ERROR,
+			        "cannot parse Ethernet header\n");
 		}
+		packet.setEthHeader(parsed);
+		header = packet.getEthHeader();
 	}
-	return NULL;
+	return *header;
 }
 
+MacAddress Ethernet::getMac(uint64_t key)
+{
+	return MacAddress((key >> 40) & 0xff, (key >> 32) & 0xff,
+	                  (key >> 24) & 0xff, (key >> 16) & 0xff,
+	                  (key >> 8) & 0xff, key & 0xff);
+}
 
 // TODO ENDIANESS !
 NET_PROTO Ethernet::getFrameType(const Data &data)
@@ -55,7 +55,9 @@
 #include <TrafficCategory.h>
 #include <opensand_output/Output.h>
 
+#include <array>
 #include <map>
+#include <vector>
 
 /**
  * @class Ethernet
@@ -92,7 +94,7 @@ public:
 		~Context();
 
 		bool init();
-		NetBurst *encapsulate(NetBurst *burst, std::map<long, int> &(time_contexts));
+		NetBurst *encapsulate(NetBurst *burst, std::map<int, long> &(time_contexts));
 		NetBurst *deencapsulate(NetBurst *burst);
 		char getLanHeader(unsigned int pos, const std::unique_ptr<NetPacket>& packet);
 		bool handleTap();
@@ -140,48 +142,36 @@ public:
 		 *
 		 * @param src_mac    The source MAC address
 		 * @param dst_mac    The destination MAC address
+		 * @param q_tci      The Q TCI
+		 * @param ad_tci     The ad TCI
 		 * @param ether_type The EtherType
 		 * @param evc_id     The id of the EVC if found
 		 * @return the EVC if found, NULL otherwise
 		 */
 		Evc *getEvc(const MacAddress src_mac,
 		            const MacAddress dst_mac,
+		            uint16_t q_tci,
+		            uint16_t ad_tci,
 		            NET_PROTO ether_type,
 		            uint8_t &evc_id) const;
 
 		/**
-		 * @brief Get the EVC corresponding to Ethernet flow
+		 * @brief Get the EVC corresponding to a parsed Ethernet header
 		 *
-		 * @param src_mac    The source MAC address
-		 * @param dst_mac    The destination MAC address
-		 * @param q_tci      The Q TCI
-		 * @param ether_type The EtherType
+		 * @param header     The parsed Ethernet header
 		 * @param evc_id     The id of the EVC if found
 		 * @return the EVC if found, NULL otherwise
 		 */
-		Evc *getEvc(const MacAddress src_mac,
-		            const MacAddress dst_mac,
-		            uint16_t q_tci,
-		            NET_PROTO ether_type,
-		            uint8_t &evc_id) const;
+		const Evc *getEvc(const eth_header_desc_t &header,
+		                  uint8_t &evc_id) const;
 
 		/**
-		 * @brief Get the EVC corresponding to Ethernet flow
+		 * @brief Get the QoS of the traffic category associated to a PCP
 		 *
-		 * @param src_mac    The source MAC address
-		 * @param dst_mac    The destination MAC address
-		 * @param q_tci      The Q TCI
-		 * @param ad_tci     The ad TCI
-		 * @param ether_type The EtherType
-		 * @param evc_id     The id of the EVC if found
-		 * @return the EVC if found, NULL otherwise
+		 * @param pcp  The PCP
+		 * @return the QoS of the category, the default one if none
 		 */
-		Evc *getEvc(const MacAddress src_mac,
-		            const MacAddress dst_mac,
-		            uint16_t q_tci,
-		            uint16_t ad_tci,
-		            NET_PROTO ether_type,
-		            uint8_t &evc_id) const;
+		qos_t getPcpQos(uint8_t pcp) const;
 
 		/**
 		 * @brief Initialize the statistics
@@ -208,6 +198,8 @@ public:
 
 		/// The Ethernet Virtual Connections
 		std::map<uint8_t, Evc *> evc_map;
+		/// The Ethernet Virtual Connections ordered by ID, for matching
+		std::vector<std::pair<uint8_t, const Evc *>> evc_table;
 		/// The amount of data sent per EVC between two updates
 		std::map<uint8_t, size_t> evc_data_size;
 		/// The throughput per EVC
@@ -223,6 +215,9 @@ public:
 
 		/// The default traffic category
 		TrafficCategory *default_category;
+
+		/// The traffic category for each of the 8 PCP values
+		std::array<TrafficCategory *, 8> pcp_categories;
 	};
 
 	/**
@@ -255,9 +250,43 @@ public:
 		                                 uint8_t src_tal_id,
 		                                 uint8_t dst_tal_id) const override;
 
+		std::unique_ptr<NetPacket> build(const unsigned char *data,
+		                                 std::size_t data_length,
+		                                 uint8_t qos,
+		                                 uint8_t src_tal_id,
+		                                 uint8_t dst_tal_id) const override;
+
 	};
 
 public:
+	/**
+	 * @brief Parse the Ethernet header in a single pass over the frame
+	 *
+	 * @param data    the Ethernet frame data
+	 * @param length  the Ethernet frame length
+	 * @param header  OUT: the parsed header
+	 * @return true on success, false if the frame is too short
+	 */
+	static bool parseHeader(const uint8_t *data, std::size_t length,
+	                        eth_header_desc_t &header);
+
+	/**
+	 * @brief Get the Ethernet header of a packet, it is parsed
+	 *        on first access then cached on the packet
+	 *
+	 * @param packet  the Ethernet frame
+	 * @return the parsed header, its frame type is ERROR on failure
+	 */
+	static const eth_header_desc_t &getHeader(NetPacket &packet);
+
+	/**
+	 * @brief Build a MAC address from its integer value
+	 *
+	 * @param key  the 48-bits integer value of the address
+	 * @return the MAC address
+	 */
+	static MacAddress getMac(uint64_t key);
+
 	/**
 	 * @brief Retrieve the type of frame
 	 *
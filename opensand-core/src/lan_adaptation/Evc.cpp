@@ -47,7 +47,11 @@ Evc::Evc(const MacAddress *mac_src,
 	mac_dst(mac_dst),
 	q_tci(q_tci & 0x0000FFFF),
 	ad_tci(ad_tci & 0x0000FFFF),
-	ether_type(ether_type)
+	ether_type(ether_type),
+	src_key(mac_src->getKey()),
+	src_mask(mac_src->getMatchMask()),
+	dst_key(mac_dst->getKey()),
+	dst_mask(mac_dst->getMatchMask())
 {
 }
 
@@ -132,3 +136,22 @@ bool Evc::matches(const MacAddress *mac_src,
 	}
 	return true;
 }
+
+bool Evc::matches(const eth_header_desc_t &header) const
+{
+	if(((header.src_mac & this->src_mask) != this->src_key) ||
+	   ((header.dst_mac & this->dst_mask) != this->dst_key) ||
+	   this->ether_type != header.ether_type)
+	{
+		return false;
+	}
+	switch(header.frame_type)
+	{
+		case NET_PROTO::IEEE_802_1Q:
+			return this->q_tci == header.q_tci;
+		case NET_PROTO::IEEE_802_1AD:
+			return this->q_tci == header.q_tci && this->ad_tci == header.ad_tci;
+		default:
+			return true;
+	}
+}
@@ -57,6 +57,14 @@ private:
 	uint32_t ad_tci;
 	/// The EtherType of the packet carried by the Ethernet payload
 	NET_PROTO ether_type;
+	/// The source MAC address as an integer, generic bytes cleared
+	uint64_t src_key;
+	/// The mask of the source MAC address bits to compare
+	uint64_t src_mask;
+	/// The destination MAC address as an integer, generic bytes cleared
+	uint64_t dst_key;
+	/// The mask of the destination MAC address bits to compare
+	uint64_t dst_mask;
 
 public:
 	/**
@@ -157,6 +165,15 @@ public:
 	             const MacAddress *mac_dst,
 	             uint16_t q_tci,
 	             NET_PROTO ether_type) const;
+
+	/**
+	 * @brief check if a parsed Ethernet header match the EVC ones,
+	 *        the tags compared depend on the frame type
+	 *
+	 * @param header  The parsed Ethernet header
+	 * @return true if it matches, false otherwise
+	 */
+	bool matches(const eth_header_desc_t &header) const;
 };
 
 
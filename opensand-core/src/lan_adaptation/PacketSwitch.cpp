@@ -44,8 +44,13 @@
 #include <memory>
 
 
+/// The offset of the destination and source MAC addresses in Ethernet frames
+constexpr std::size_t ETH_DST_MAC_OFFSET = 0;
+constexpr std::size_t ETH_SRC_MAC_OFFSET = 6;
+constexpr std::size_t ETH_MACS_LENGTH = 12;
+
+
 PacketSwitch::PacketSwitch(tal_id_t tal_id):
-	mutex(),
 	tal_id(tal_id),
 	sarp_table()
 {
@@ -59,21 +64,18 @@ SarpTable *PacketSwitch::getSarpTable()
 
 bool PacketSwitch::learn(const Data &packet, tal_id_t src_id)
 {
-	MacAddress src_mac = Ethernet::getSrcMac(packet);
-	RtLock(this->mutex);
-	if (!this->sarp_table.add(std::unique_ptr<MacAddress>{new MacAddress{src_mac.str()}}, src_id))
+	if(packet.length() < ETH_MACS_LENGTH)
 	{
 		return false;
 	}
-	return true;
+	return this->sarp_table.learn(packet.data() + ETH_SRC_MAC_OFFSET, src_id);
 }
 
 bool TerminalPacketSwitch::getPacketDestination(const Data &packet, tal_id_t &src_id, tal_id_t &dst_id)
 {
-	MacAddress dst_mac = Ethernet::getDstMac(packet);
-	RtLock(this->mutex);
 	src_id = this->tal_id;
-	if (!this->sarp_table.getTalByMac(dst_mac, dst_id))
+	if(packet.length() < ETH_MACS_LENGTH ||
+	   !this->sarp_table.getTalByMac(packet.data() + ETH_DST_MAC_OFFSET, dst_id))
 	{
 		dst_id = this->gw_id;
 	}
@@ -88,12 +90,13 @@ bool TerminalPacketSwitch::isPacketForMe(const Data &UNUSED(packet), tal_id_t UN
 
 bool GatewayPacketSwitch::getPacketDestination(const Data &packet, tal_id_t &src_id, tal_id_t &dst_id)
 {
-	MacAddress dst_mac = Ethernet::getDstMac(packet);
-	MacAddress src_mac = Ethernet::getSrcMac(packet);
-	RtLock(this->mutex);
 	src_id = this->tal_id;	
 
-	if(!this->sarp_table.getTalByMac(dst_mac, dst_id))
+	if(packet.length() < ETH_MACS_LENGTH)
+	{
+		return false;
+	}
+	if(!this->sarp_table.getTalByMac(packet.data() + ETH_DST_MAC_OFFSET, dst_id))
 	{
 		return false;
 	}
@@ -103,10 +106,11 @@ bool GatewayPacketSwitch::getPacketDestination(const Data &packet, tal_id_t &src
 bool GatewayPacketSwitch::isPacketForMe(const Data &packet, tal_id_t src_id, bool &forward)
 {
 	tal_id_t dst_id;
-	MacAddress dst_mac = Ethernet::getDstMac(packet);
-	MacAddress src_mac = Ethernet::getSrcMac(packet);
-	RtLock(this->mutex);
-	if(!this->sarp_table.getTalByMac(dst_mac, dst_id))
+	if(packet.length() < ETH_MACS_LENGTH)
+	{
+		return false;
+	}
+	if(!this->sarp_table.getTalByMac(packet.data() + ETH_DST_MAC_OFFSET, dst_id))
 	{
 		return false;
 	}
@@ -137,14 +141,15 @@ SatellitePacketSwitch::SatellitePacketSwitch(tal_id_t tal_id,
 
 bool SatellitePacketSwitch::getPacketDestination(const Data &packet, tal_id_t &src_id, tal_id_t &dst_id)
 {
-	MacAddress dst_mac = Ethernet::getDstMac(packet);
-	MacAddress src_mac = Ethernet::getSrcMac(packet);
-	RtLock(this->mutex);
-	if (!this->sarp_table.getTalByMac(dst_mac, dst_id))
+	if (packet.length() < ETH_MACS_LENGTH)
+	{
+		return false;
+	}
+	if (!this->sarp_table.getTalByMac(packet.data() + ETH_DST_MAC_OFFSET, dst_id))
 	{
 		return false;
 	}
-	if (!this->sarp_table.getTalByMac(src_mac, src_id))
+	if (!this->sarp_table.getTalByMac(packet.data() + ETH_SRC_MAC_OFFSET, src_id))
 	{
 		return false;
 	}
@@ -161,9 +166,8 @@ bool SatellitePacketSwitch::isPacketForMe(const Data &packet, tal_id_t, bool &fo
 	}
 
 	tal_id_t dst_id;
-	MacAddress dst_mac = Ethernet::getDstMac(packet);
-	RtLock(this->mutex);
-	if (!this->sarp_table.getTalByMac(dst_mac, dst_id))
+	if (packet.length() < ETH_MACS_LENGTH ||
+	    !this->sarp_table.getTalByMac(packet.data() + ETH_DST_MAC_OFFSET, dst_id))
 	{
 		return false;
 	}
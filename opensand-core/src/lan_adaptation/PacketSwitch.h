@@ -39,7 +39,6 @@
 #include "OpenSandModelConf.h"
 #include "SarpTable.h"
 #include "Data.h"
-#include <opensand_rt/RtMutex.h>
 
 #include <opensand_output/OutputLog.h>
 
@@ -78,7 +77,8 @@ public:
 	virtual bool isPacketForMe(const Data &packet, tal_id_t src_id, bool &forward) = 0;
 
 	/**
-	 * @brief Learn the source MAC address of the specified packet
+	 * @brief Learn the source MAC address of the specified packet,
+	 *        it can be called from both channels
 	 *
 	 * @param packet  The packet
 	 * @param src_id  The ID of the corresponding terminal
@@ -90,9 +90,6 @@ public:
 	SarpTable *getSarpTable();
 
 protected:
-	/// The mutex
-	RtMutex mutex;
-
 	/// The terminal id of the entity
 	tal_id_t tal_id;
 
@@ -145,7 +145,8 @@ bool AttenuationHandler::process(DvbFrame *dvb_frame, double cn_total)
 {
 	fmt_id_t modcod_id = 0;
 	double min_cn;
-	Data payload;
+	uint8_t *payload = nullptr;
+	std::size_t payload_length = 0;
 
 	// Consider that the packet is not dropped  (if its dropped, the probe
 	// will be updated later), so that the probe emits a 0 value if necessary.
@@ -160,7 +161,6 @@ bool AttenuationHandler::process(DvbFrame *dvb_frame, double cn_total)
 			// TODO BBFrame *bbframe = dynamic_cast<BBFrame *>(dvb_frame);
 			BBFrame *bbframe = (BBFrame *)dvb_frame;
 			modcod_id = bbframe->getModcodId();
-			payload = bbframe->getPayload();
 		}
 		break;
 
@@ -169,7 +169,6 @@ bool AttenuationHandler::process(DvbFrame *dvb_frame, double cn_total)
 			// TODO DvbRcsFrame *dvb_rcs_frame = dynamic_cast<DvbRcsFrame *>(dvb_frame);
 			DvbRcsFrame *dvb_rcs_frame = (DvbRcsFrame *)dvb_frame;
 			modcod_id = dvb_rcs_frame->getModcodId();
-			payload = dvb_rcs_frame->getPayload();
 		}
 		break;
 
@@ -192,13 +191,11 @@ bool AttenuationHandler::process(DvbFrame *dvb_frame, double cn_total)
 		return false;
 	}
 
-	// TODO this would be better to get minimal condition per source terminal
-	//      if we are on regenerative satellite or GW
-	//      On terminals,  here we receive all BBFrame on the spot,
-	//      some may not contain packets for us but we will still count them in stats
-	//      We would have to parse frames in order to remove them from
-	//      statistics, this is not efficient 
-	//      With physcal layer ACM loop, these frame would be mark as corrupted
+	// On terminals,  here we receive all BBFrame on the spot,
+	// some may not contain packets for us but we will still count them in stats
+	// We would have to parse frames in order to remove them from
+	// statistics, this is not efficient 
+	// With physcal layer ACM loop, these frame would be mark as corrupted
 	min_cn = this->minimal_condition_model->getMinimalCN();
 	this->probe_minimal_condition->put(min_cn);
 	LOG(this->log_channel, LEVEL_INFO,
@@ -212,7 +209,13 @@ bool AttenuationHandler::process(DvbFrame *dvb_frame, double cn_total)
 	LOG(this->log_channel, LEVEL_DEBUG,
 	    "Error insertion is required");
 
-	if(!this->error_insertion_model->modifyPacket(payload))
+	// give the plugin a view on the frame itself, without copy
+	if(this->error_insertion_model->accessesPayload())
+	{
+		payload = dvb_frame->getRawData() + dvb_frame->getHeaderLength();
+		payload_length = dvb_frame->getPayloadLength();
+	}
+	if(!this->error_insertion_model->modifyPacket(payload, payload_length))
 	{
 		LOG(this->log_channel, LEVEL_ERROR,
 		    "Error insertion failed");
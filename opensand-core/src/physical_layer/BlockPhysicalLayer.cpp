@@ -43,6 +43,7 @@
 #include "OpenSandPlugin.h"
 #include "OpenSandModelConf.h"
 #include "NetContainer.h"
+#include "DbMath.h"
 
 #include <opensand_output/Output.h>
 #include <opensand_rt/MessageEvent.h>
@@ -150,6 +151,15 @@ bool BlockPhysicalLayer::Upward::onInit()
 		return false;
 	}
 
+	// The gateway receives frames from all the terminals of its spot
+	if(OpenSandModelConf::Get()->isGw(this->mac_id) &&
+	   !this->initTerminalChannels(this, true, this->log_init))
+	{
+		LOG(this->log_init, LEVEL_ERROR,
+		    "Unable to initialize the terminals channels");
+		return false;
+	}
+
 	return true;
 }
 
@@ -224,6 +234,18 @@ bool BlockPhysicalLayer::Upward::onEvent(const RtEvent *const event)
 					return false;
 				}
 			}
+			else if(*event == this->terminal_delay_timer)
+			{
+				// Event handler for the terminals delay update
+				LOG(this->log_event, LEVEL_DEBUG,
+				    "Terminals delay update timer expired");
+				if(!this->updateTerminalDelays())
+				{
+					LOG(this->log_event, LEVEL_ERROR,
+					    "Terminals delay update failed");
+					return false;
+				}
+			}
 			else
 			{
 				LOG(this->log_event, LEVEL_ERROR,
@@ -250,12 +272,54 @@ bool BlockPhysicalLayer::Upward::forwardPacket(DvbFrame *dvb_frame)
 		// Set C/N to Dvb frame
 		dvb_frame->setCn(this->getCn(dvb_frame));
 		LOG(this->log_event, LEVEL_DEBUG,
-		    "Set C/N to the DVB frame forwardPacket %f. Message type %d\n", this->getCn(dvb_frame), dvb_frame->getMessageType());
+		    "Set C/N to the DVB frame forwardPacket %f. Message type %d\n", dvb_frame->getCn(), dvb_frame->getMessageType());
 
 		// Update probe
 		this->probe_total_cn->put(dvb_frame->getCn());
 	}
 
+	return this->sendPacket(dvb_frame);
+}
+
+bool BlockPhysicalLayer::Upward::forwardPackets(std::unique_ptr<DvbFrameBatch> frames)
+{
+	bool status = true;
+
+	// Gather the C/N of both links for every frame of the batch
+	this->batch_up_cn.clear();
+	this->batch_down_cn.clear();
+	for(auto &&frame: *frames)
+	{
+		if(IsCnCapableFrame(frame->getMessageType()))
+		{
+			this->batch_up_cn.push_back(frame->getCn());
+			this->batch_down_cn.push_back(this->getCurrentCn(frame->getSourceTerminal()));
+		}
+	}
+
+	// Compute all the total C/N at once
+	DbMath::combineCn(this->batch_up_cn.data(), this->batch_down_cn.data(),
+	                  this->batch_up_cn.data(), this->batch_up_cn.size());
+
+	std::size_t index = 0;
+	for(auto &&frame: *frames)
+	{
+		if(IsCnCapableFrame(frame->getMessageType()))
+		{
+			double total_cn = this->batch_up_cn[index++];
+			frame->setCn(total_cn);
+			this->probe_total_cn->put(total_cn);
+		}
+		status = this->sendPacket(frame.release()) && status;
+	}
+	LOG(this->log_event, LEVEL_DEBUG,
+	    "Set C/N to a batch of %zu DVB frames", frames->size());
+
+	return status;
+}
+
+bool BlockPhysicalLayer::Upward::sendPacket(DvbFrame *dvb_frame)
+{
 	if(IsAttenuatedFrame(dvb_frame->getMessageType()))
 	{
 		// Process Attenuation
@@ -281,7 +345,8 @@ bool BlockPhysicalLayer::Upward::forwardPacket(DvbFrame *dvb_frame)
 
 double BlockPhysicalLayer::Upward::getCn(DvbFrame *dvb_frame) const
 {
-	return GroundPhysicalChannel::computeTotalCn(dvb_frame->getCn(), this->getCurrentCn());
+	return GroundPhysicalChannel::computeTotalCn(dvb_frame->getCn(),
+	                                             this->getCurrentCn(dvb_frame->getSourceTerminal()));
 }
 
 BlockPhysicalLayer::Downward::Downward(const std::string &name, PhyLayerConfig config):
@@ -319,9 +384,18 @@ bool BlockPhysicalLayer::Downward::onEvent(const RtEvent *const event)
 	{
 		case EventType::Message:
 		{
+			auto msg_event = static_cast<const MessageEvent *>(event);
+			if(to_enum<InternalMessageType>(msg_event->getMessageType()) == InternalMessageType::batch)
+			{
+				std::unique_ptr<DvbFrameBatch> frames{static_cast<DvbFrameBatch *>(msg_event->getData())};
+				LOG(this->log_event, LEVEL_DEBUG,
+				    "Incoming batch of %zu DVB frames", frames->size());
+				return this->handleBatch(std::move(frames));
+			}
+
 			LOG(this->log_event, LEVEL_DEBUG,
 			    "Incoming DVB frame");
-			DvbFrame *dvb_frame = (DvbFrame *)((MessageEvent *)event)->getData();
+			DvbFrame *dvb_frame = (DvbFrame *)msg_event->getData();
 
 			// Prepare packet
 			this->preparePacket(dvb_frame);
@@ -415,6 +489,7 @@ void BlockPhysicalLayer::Downward::preparePacket(DvbFrame *dvb_frame)
 		LOG(this->log_event, LEVEL_DEBUG,
 		    "Set C/N to the DVB frame preparePacket %f. Message type %d\n", this->getCurrentCn(), dvb_frame->getMessageType());
 		dvb_frame->setCn(this->getCurrentCn());
+		dvb_frame->setSourceTerminal(this->mac_id);
 	}
 }
 
@@ -439,6 +514,37 @@ bool BlockPhysicalLayer::Downward::updateDelay()
 	return true;
 }
 
+bool BlockPhysicalLayer::Downward::handleBatch(std::unique_ptr<DvbFrameBatch> frames)
+{
+	bool status = true;
+	std::unique_ptr<DvbFrameBatch> ready = nullptr;
+
+	for(auto &&frame: *frames)
+	{
+		this->preparePacket(frame.get());
+		if(IsDelayedFrame(frame->getMessageType()))
+		{
+			status = this->pushPacket(frame.release()) && status;
+			continue;
+		}
+
+		if(ready == nullptr)
+		{
+			ready = std::make_unique<DvbFrameBatch>(frames->getFramesType());
+			ready->reserve(frames->size());
+		}
+		ready->push(frame.release());
+	}
+
+	if(ready != nullptr && !this->forwardPackets(std::move(ready)))
+	{
+		LOG(this->log_event, LEVEL_ERROR,
+		    "The DVB frames forwarding failed");
+		return false;
+	}
+	return status;
+}
+
 bool BlockPhysicalLayer::Downward::forwardPacket(DvbFrame *dvb_frame)
 {
 	// Send frame to upper layer
@@ -452,3 +558,22 @@ bool BlockPhysicalLayer::Downward::forwardPacket(DvbFrame *dvb_frame)
 	return true;	
 
 }
+
+bool BlockPhysicalLayer::Downward::forwardPackets(std::unique_ptr<DvbFrameBatch> frames)
+{
+	if(frames->size() == 1)
+	{
+		return this->forwardPacket(frames->begin()->release());
+	}
+
+	// Send the whole batch to lower layer at once
+	DvbFrameBatch *batch = frames.release();
+	if(!this->enqueueMessage((void **)&batch, 0, to_underlying(InternalMessageType::batch)))
+	{
+		LOG(this->log_send, LEVEL_ERROR,
+		    "Failed to send batch of DVB frames to lower layer");
+		delete batch;
+		return false;
+	}
+	return true;
+}
@@ -50,6 +50,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 
 class AttenuationHandler;
@@ -72,6 +73,10 @@ public:
 		/// Probes
 		std::shared_ptr<Probe<float>> probe_total_cn = nullptr;
 
+		/// The C/N values of a batch of frames, kept to avoid reallocations
+		std::vector<double> batch_up_cn;
+		std::vector<double> batch_down_cn;
+
 	protected:
 		/// The attenuation process
 		AttenuationHandler *attenuation_hdl;
@@ -85,6 +90,26 @@ public:
 		 */
 		bool forwardPacket(DvbFrame *dvb_frame);
 
+		/**
+		 * @brief Compute the C/N of all the frames of the batch at once,
+		 *        then forward them to the next channel
+		 *
+		 * @param frames  the DVB frames to forward
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool forwardPackets(std::unique_ptr<DvbFrameBatch> frames) override;
+
+		/**
+		 * @brief Process the attenuation on a frame whose C/N is set,
+		 *        then send it to the upper layer
+		 *
+		 * @param dvb_frame  the DVB frame to send
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool sendPacket(DvbFrame *dvb_frame);
+
 		/**
 		 * @brief Get the C/N fot the current DVB frame
 		 *
@@ -155,6 +180,24 @@ public:
 		 */
 		bool forwardPacket(DvbFrame *dvb_frame);
 
+		/**
+		 * @brief Forward a batch of frames to the next channel in one message
+		 *
+		 * @param frames  the DVB frames to forward
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool forwardPackets(std::unique_ptr<DvbFrameBatch> frames) override;
+
+		/**
+		 * @brief Prepare, delay or forward each frame of a batch
+		 *
+		 * @param frames  the DVB frames received from the upper layer
+		 *
+		 * @return true on success, false otherwise
+		 */
+		bool handleBatch(std::unique_ptr<DvbFrameBatch> frames);
+
 		/**
 		 * @brief Prepare the frame
 		 *
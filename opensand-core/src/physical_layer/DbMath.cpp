@@ -0,0 +1,91 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file DbMath.cpp
+ * @brief Table-driven arithmetic on C/N values expressed in dB
+ */
+
+#include "DbMath.h"
+
+#include <cmath>
+#include <vector>
+
+
+/// The resolution of the penalty table (dB)
+constexpr const double penalty_step = 0.01;
+
+/// Above this C/N difference (dB) the penalty is below 2e-6 dB and ignored
+constexpr const double penalty_range = 64.0;
+
+/// The penalty 10 log10(1 + 10^(-d/10)) for d = i * penalty_step
+static const std::vector<double> penalty_table = []()
+{
+	std::size_t size = std::size_t(penalty_range / penalty_step) + 2;
+	std::vector<double> table(size);
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		table[i] = 10 * log10(1 + pow(10, -(i * penalty_step) / 10));
+	}
+	return table;
+}();
+
+
+static inline double getPenalty(double diff)
+{
+	if(!(diff < penalty_range))
+	{
+		return 0;
+	}
+	double position = diff * (1 / penalty_step);
+	std::size_t index = std::size_t(position);
+	double ratio = position - index;
+	return penalty_table[index] +
+	       ratio * (penalty_table[index + 1] - penalty_table[index]);
+}
+
+
+double DbMath::combineCn(double up_cn, double down_cn)
+{
+	if(up_cn < down_cn)
+	{
+		return up_cn - getPenalty(down_cn - up_cn);
+	}
+	return down_cn - getPenalty(up_cn - down_cn);
+}
+
+
+void DbMath::combineCn(const double *up_cn, const double *down_cn,
+                       double *total_cn, std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i)
+	{
+		total_cn[i] = DbMath::combineCn(up_cn[i], down_cn[i]);
+	}
+}
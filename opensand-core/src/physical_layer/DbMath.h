@@ -0,0 +1,78 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file DbMath.h
+ * @brief Table-driven arithmetic on C/N values expressed in dB
+ */
+
+#ifndef DB_MATH_H
+#define DB_MATH_H
+
+#include <cstddef>
+
+
+/**
+ * @class DbMath
+ * @brief Table-driven arithmetic on C/N values expressed in dB
+ *
+ * The total C/N of two links in dB is
+ *   -10 log10(10^(-up/10) + 10^(-down/10))
+ *   = min(up, down) - 10 log10(1 + 10^(-|up - down|/10))
+ * so it only depends on libm through a penalty function of the
+ * difference between both links, which is tabulated once and
+ * linearly interpolated (error below 1e-5 dB).
+ */
+class DbMath
+{
+public:
+	/**
+	 * @brief Compute the total C/N of two links
+	 *
+	 * @param up_cn    the uplink C/N (dB)
+	 * @param down_cn  the downlink C/N (dB)
+	 *
+	 * @return the total C/N (dB)
+	 */
+	static double combineCn(double up_cn, double down_cn);
+
+	/**
+	 * @brief Compute the total C/N of several pairs of links
+	 *
+	 * @param up_cn     the uplink C/N values (dB)
+	 * @param down_cn   the downlink C/N values (dB)
+	 * @param total_cn  the total C/N values (dB), may alias an input
+	 * @param count     the number of values
+	 */
+	static void combineCn(const double *up_cn, const double *down_cn,
+	                      double *total_cn, std::size_t count);
+};
+
+
+#endif
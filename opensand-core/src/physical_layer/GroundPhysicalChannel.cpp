@@ -39,6 +39,7 @@
 #include "OpenSandCore.h"
 #include "OpenSandModelConf.h"
 #include "NetContainer.h"
+#include "DbMath.h"
 
 #include <math.h>
 #include <algorithm>
@@ -49,12 +50,17 @@
 
 GroundPhysicalChannel::GroundPhysicalChannel(PhyLayerConfig config):
 	clear_sky_condition{0},
+	attenuation_type{},
+	attenuation_path{},
+	attenuation_refresh_period{0},
 	delay_fifo{},
 	mac_id{config.mac_id},
 	entity_type{config.entity_type},
 	spot_id{config.spot_id},
+	terminal_channels{nullptr},
 	attenuation_update_timer{-1},
-	fifo_timer{-1}
+	fifo_timer{-1},
+	terminal_delay_timer{-1}
 {
 	// Initialize logs
 	this->log_channel = Output::Get()->registerLog(LEVEL_WARNING, "PhysicalLayer.Channel");
@@ -66,6 +72,9 @@ void GroundPhysicalChannel::generateConfiguration()
 	auto types = Conf->getModelTypesDefinition();
 
 	auto conf = Conf->getOrCreateComponent("physical_layer", "Physical Layer", "The Physical layer configuration");
+	conf->addParameter("per_terminal_channels", "Per-terminal Channels", types->getType("bool"),
+	                   "Emulate one attenuation and delay model per source terminal on the gateway "
+	                   "and the regenerative satellite")->setAdvanced(true);
 	auto uplink = Conf->getOrCreateComponent("uplink_attenuation", "UpLink Attenuation", conf);
 	uplink->addParameter("clear_sky", "Clear Sky Condition", types->getType("double"))->setUnit("dB");
 
@@ -176,6 +185,10 @@ bool GroundPhysicalChannel::initGround(bool upward_channel, RtChannelBase *chann
 		return false;
 	}
 
+	this->attenuation_type = attenuation_type;
+	this->attenuation_path = component_path;
+	this->attenuation_refresh_period = refresh_period_ms;
+
 	// Initialize the attenuation event
 	std::ostringstream name;
 	name << "attenuation_" << link;
@@ -193,6 +206,63 @@ bool GroundPhysicalChannel::initGround(bool upward_channel, RtChannelBase *chann
 	return true;
 }
 
+bool GroundPhysicalChannel::initTerminalChannels(RtChannelBase *channel, bool with_delay,
+                                                 std::shared_ptr<OutputLog> log_init)
+{
+	auto Conf = OpenSandModelConf::Get();
+	auto phy_layer = Conf->getProfileData()->getComponent("physical_layer");
+
+	bool enabled = false;
+	OpenSandModelConf::extractParameterData(phy_layer->getParameter("per_terminal_channels"), enabled);
+	if(!enabled)
+	{
+		return true;
+	}
+
+	std::string delay_type;
+	if(with_delay &&
+	   !OpenSandModelConf::extractParameterData(phy_layer->getComponent("delay")->getParameter("delay_type"), delay_type))
+	{
+		LOG(log_init, LEVEL_ERROR,
+		    "section 'physical_layer', missing parameter 'delay_type'");
+		return false;
+	}
+
+	auto &topology = Conf->getSpotsTopology();
+	auto spot = topology.find(this->spot_id);
+	if(spot == topology.end())
+	{
+		LOG(log_init, LEVEL_ERROR,
+		    "cannot find the terminals of spot %u", this->spot_id);
+		return false;
+	}
+
+	this->terminal_channels = std::make_unique<TerminalChannels>(this->log_channel);
+	if(!this->terminal_channels->initialize(spot->second.st_ids,
+	                                        this->attenuation_type,
+	                                        this->attenuation_path,
+	                                        this->attenuation_refresh_period,
+	                                        delay_type,
+	                                        log_init))
+	{
+		return false;
+	}
+
+	time_ms_t delay_period = this->terminal_channels->getDelayRefreshPeriod();
+	if(delay_period > 0)
+	{
+		this->terminal_delay_timer = channel->addTimerEvent("terminal_delay_timer", delay_period);
+	}
+	return true;
+}
+
+bool GroundPhysicalChannel::updateTerminalDelays()
+{
+	LOG(this->log_channel, LEVEL_DEBUG,
+		"Update terminals delay");
+	return this->terminal_channels->updateDelays();
+}
+
 bool GroundPhysicalChannel::updateAttenuation()
 {
 	LOG(this->log_channel, LEVEL_DEBUG,
@@ -213,6 +283,14 @@ bool GroundPhysicalChannel::updateAttenuation()
 	this->probe_attenuation->put(attenuation);
 	this->probe_clear_sky_condition->put(this->clear_sky_condition);
 
+	if(this->terminal_channels != nullptr &&
+	   !this->terminal_channels->updateAttenuations())
+	{
+		LOG(this->log_channel, LEVEL_ERROR,
+		    "Terminals attenuation update failed");
+		return false;
+	}
+
 	return true;
 }
 
@@ -222,19 +300,22 @@ double GroundPhysicalChannel::getCurrentCn() const
 	return this->clear_sky_condition - this->attenuation_model->getAttenuation();
 }
 
-double GroundPhysicalChannel::computeTotalCn(double up_cn, double down_cn)
+double GroundPhysicalChannel::getCurrentCn(tal_id_t tal_id) const
 {
-	double total_cn; 
-	double down_num, up_num, total_num; 
-
-	// Calculation of the sub total C/N ratio
-	down_num = pow(10, down_cn / 10);
-	up_num = pow(10, up_cn / 10);
-
-	total_num = 1 / ((1 / down_num) + (1 / up_num)); 
-	total_cn = 10 * log10(total_num);
+	if(this->terminal_channels != nullptr)
+	{
+		auto state = this->terminal_channels->getState(tal_id);
+		if(state != nullptr)
+		{
+			return this->clear_sky_condition - state->attenuation;
+		}
+	}
+	return this->getCurrentCn();
+}
 
-	return total_cn;
+double GroundPhysicalChannel::computeTotalCn(double up_cn, double down_cn)
+{
+	return DbMath::combineCn(up_cn, down_cn);
 }
 
 bool GroundPhysicalChannel::pushPacket(NetContainer *pkt)
@@ -243,6 +324,17 @@ bool GroundPhysicalChannel::pushPacket(NetContainer *pkt)
 	time_ms_t current_time = getCurrentTime();
 	time_ms_t delay = this->satdelay_model->getSatDelay();
 
+	// the source terminal may have its own delay
+	if(this->terminal_delay_timer >= 0)
+	{
+		auto frame = static_cast<DvbFrame *>(pkt);
+		auto state = this->terminal_channels->getState(frame->getSourceTerminal());
+		if(state != nullptr)
+		{
+			delay = state->delay;
+		}
+	}
+
 	// create a new FIFO element to store the packet
 	try
 	{
@@ -280,6 +372,8 @@ bool GroundPhysicalChannel::forwardReadyPackets()
 	LOG(this->log_channel, LEVEL_DEBUG,
 		"Forward ready packets");
 
+	std::unique_ptr<DvbFrameBatch> ready = nullptr;
+
 	while (this->delay_fifo.getCurrentSize() > 0 &&
 	       ((unsigned long)this->delay_fifo.getTickOut()) <= current_time)
 	{
@@ -288,7 +382,26 @@ bool GroundPhysicalChannel::forwardReadyPackets()
 
 		std::unique_ptr<NetContainer> pkt = elem->getElem();
 		delete elem;
-		this->forwardPacket(reinterpret_cast<DvbFrame *>(pkt.release()));
+		if(ready == nullptr)
+		{
+			ready = std::make_unique<DvbFrameBatch>();
+		}
+		ready->push(reinterpret_cast<DvbFrame *>(pkt.release()));
+	}
+
+	if(ready != nullptr)
+	{
+		this->forwardPackets(std::move(ready));
 	}
 	return true;
 }
+
+bool GroundPhysicalChannel::forwardPackets(std::unique_ptr<DvbFrameBatch> frames)
+{
+	bool status = true;
+	for(auto &&frame: *frames)
+	{
+		status = this->forwardPacket(frame.release()) && status;
+	}
+	return status;
+}
@@ -39,6 +39,8 @@
 #include "PhysicalLayerPlugin.h"
 #include "DelayFifo.h"
 #include "DvbFrame.h"
+#include "DvbFrameBatch.h"
+#include "TerminalChannels.h"
 
 #include <opensand_output/Output.h>
 #include <opensand_rt/Rt.h>
@@ -68,6 +70,11 @@ private:
 	/// Clear Sky Conditions (best C/N in clear-sky conditions)
 	double clear_sky_condition;
 
+	/// The attenuation plugin, configuration path and refresh period
+	std::string attenuation_type;
+	std::string attenuation_path;
+	time_ms_t attenuation_refresh_period;
+
 	/// The FIFO that implements the delay
 	DelayFifo delay_fifo;
 
@@ -89,9 +96,13 @@ protected:
 	/// The satellite delay model
 	SatDelayPlugin *satdelay_model = nullptr;
 
+	/// The channel models of each source terminal, if enabled
+	std::unique_ptr<TerminalChannels> terminal_channels;
+
 	/// Events
 	event_id_t attenuation_update_timer;
 	event_id_t fifo_timer;
+	event_id_t terminal_delay_timer;
 
 	/**
 	 * @brief Constructor of the ground physical channel
@@ -109,6 +120,26 @@ protected:
 	 */
 	bool initGround(bool upward_channel, RtChannelBase *channel, std::shared_ptr<OutputLog> log_init);
 
+	/**
+	 * @brief Create one attenuation model, and optionally one delay model,
+	 *        per terminal of the spot if enabled in configuration
+	 *
+	 * @param channel     the channel the update timers belong to
+	 * @param with_delay  whether the terminals also get their own delay
+	 * @param log_init    the log output to use during initialization
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool initTerminalChannels(RtChannelBase *channel, bool with_delay,
+	                          std::shared_ptr<OutputLog> log_init);
+
+	/**
+	 * @brief Update the delay of each terminal
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool updateTerminalDelays();
+
 	/**
 	 * @brief Update the attenuation
 	 *
@@ -123,6 +154,16 @@ protected:
 	 */
 	double getCurrentCn() const;
 
+	/**
+	 * @brief Get the current C/N value of the link with a terminal
+	 *
+	 * @param tal_id  the terminal that emitted the frame
+	 *
+	 * @return the C/N value of the terminal if it has its own
+	 *         attenuation model, the one of the link otherwise
+	 */
+	double getCurrentCn(tal_id_t tal_id) const;
+
 	/**
 	 * @brief Push a packet in the FIFO to be delayed
 	 *
@@ -149,6 +190,18 @@ protected:
 	 */
 	virtual bool forwardPacket(DvbFrame *dvb_frame) = 0;
 
+	/**
+	 * @brief Forward a batch of frames to the next channel
+	 *
+	 * The frames are forwarded one by one with forwardPacket unless
+	 * the channel is able to send the whole batch in a single message.
+	 *
+	 * @param frames  the DVB frames to forward
+	 *
+	 * @return true on success, false otherwise
+	 */
+	virtual bool forwardPackets(std::unique_ptr<DvbFrameBatch> frames);
+
 public:
 	virtual ~GroundPhysicalChannel() = default;
 
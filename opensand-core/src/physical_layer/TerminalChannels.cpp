@@ -0,0 +1,172 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file TerminalChannels.cpp
+ * @brief The channel state of each source terminal, seen from the
+ *        gateway or the regenerative satellite
+ */
+
+#include "TerminalChannels.h"
+#include "Plugin.h"
+#include "PhysicalLayerPlugin.h"
+
+#include <opensand_output/Output.h>
+
+#include <algorithm>
+
+
+TerminalChannels::TerminalChannels(std::shared_ptr<OutputLog> log_channel):
+	states{},
+	models{},
+	log_channel{log_channel}
+{
+}
+
+
+bool TerminalChannels::initialize(const std::unordered_set<tal_id_t> &terminals,
+                                  const std::string &attenuation_type,
+                                  const std::string &attenuation_path,
+                                  time_ms_t refresh_period_ms,
+                                  const std::string &delay_type,
+                                  std::shared_ptr<OutputLog> log_init)
+{
+	if(terminals.empty())
+	{
+		return true;
+	}
+
+	tal_id_t max_id = *std::max_element(terminals.begin(), terminals.end());
+	this->states.assign(max_id + 1, TerminalChannelState{false, 0, 0});
+	this->models.reserve(terminals.size());
+
+	for(tal_id_t tal_id : terminals)
+	{
+		TerminalModels terminal{tal_id, nullptr, nullptr};
+
+		if(!Plugin::getAttenuationPlugin(attenuation_type, &terminal.attenuation) ||
+		   terminal.attenuation == nullptr)
+		{
+			LOG(log_init, LEVEL_ERROR,
+			    "Unable to get the attenuation plugin %s for terminal %u",
+			    attenuation_type.c_str(), tal_id);
+			return false;
+		}
+		terminal.attenuation->setTerminalId(tal_id);
+		if(!terminal.attenuation->init(refresh_period_ms, attenuation_path))
+		{
+			LOG(log_init, LEVEL_ERROR,
+			    "Unable to initialize the attenuation plugin %s for terminal %u",
+			    attenuation_type.c_str(), tal_id);
+			return false;
+		}
+
+		if(!delay_type.empty())
+		{
+			if(!Plugin::getSatDelayPlugin(delay_type, &terminal.delay) ||
+			   terminal.delay == nullptr)
+			{
+				LOG(log_init, LEVEL_ERROR,
+				    "Unable to get the sat delay plugin %s for terminal %u",
+				    delay_type.c_str(), tal_id);
+				return false;
+			}
+			terminal.delay->setTerminalId(tal_id);
+			if(!terminal.delay->init())
+			{
+				LOG(log_init, LEVEL_ERROR,
+				    "Unable to initialize the sat delay plugin %s for terminal %u",
+				    delay_type.c_str(), tal_id);
+				return false;
+			}
+		}
+
+		TerminalChannelState &state = this->states[tal_id];
+		state.active = true;
+		state.attenuation = terminal.attenuation->getAttenuation();
+		state.delay = terminal.delay ? terminal.delay->getSatDelay() : 0;
+		this->models.push_back(terminal);
+	}
+
+	LOG(log_init, LEVEL_NOTICE,
+	    "%zu terminals have their own channel models", this->models.size());
+	return true;
+}
+
+
+bool TerminalChannels::updateAttenuations()
+{
+	bool status = true;
+	for(auto &&terminal : this->models)
+	{
+		if(!terminal.attenuation->updateAttenuationModel())
+		{
+			LOG(this->log_channel, LEVEL_ERROR,
+			    "Attenuation update failed for terminal %u",
+			    terminal.tal_id);
+			status = false;
+			continue;
+		}
+		this->states[terminal.tal_id].attenuation = terminal.attenuation->getAttenuation();
+	}
+	return status;
+}
+
+
+bool TerminalChannels::updateDelays()
+{
+	bool status = true;
+	for(auto &&terminal : this->models)
+	{
+		if(terminal.delay == nullptr)
+		{
+			continue;
+		}
+		if(!terminal.delay->updateSatDelay())
+		{
+			LOG(this->log_channel, LEVEL_ERROR,
+			    "Satellite delay update failed for terminal %u",
+			    terminal.tal_id);
+			status = false;
+			continue;
+		}
+		this->states[terminal.tal_id].delay = terminal.delay->getSatDelay();
+	}
+	return status;
+}
+
+
+time_ms_t TerminalChannels::getDelayRefreshPeriod() const
+{
+	if(this->models.empty() || this->models.front().delay == nullptr)
+	{
+		return 0;
+	}
+	return this->models.front().delay->getRefreshPeriod();
+}
@@ -0,0 +1,159 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+
+
+/**
+ * @file TerminalChannels.h
+ * @brief The channel state of each source terminal, seen from the
+ *        gateway or the regenerative satellite
+ */
+
+#ifndef TERMINAL_CHANNELS_H
+#define TERMINAL_CHANNELS_H
+
+#include "OpenSandCore.h"
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+
+class AttenuationModelPlugin;
+class SatDelayPlugin;
+class OutputLog;
+
+
+/**
+ * @brief The channel state of a terminal, refreshed on timers
+ */
+struct TerminalChannelState
+{
+	bool active;        ///< Whether the terminal has its own models
+	double attenuation; ///< The current attenuation (dB)
+	time_ms_t delay;    ///< The current satellite delay
+};
+
+
+/**
+ * @class TerminalChannels
+ * @brief One attenuation and delay model per source terminal
+ *
+ * The states are stored in an array indexed by terminal ID, so that
+ * the per-frame lookup neither searches nor locks. The models are
+ * refreshed all at once when the update timers expire.
+ */
+class TerminalChannels
+{
+private:
+	/**
+	 * @brief The models of a terminal
+	 */
+	struct TerminalModels
+	{
+		tal_id_t tal_id;
+		AttenuationModelPlugin *attenuation;
+		SatDelayPlugin *delay;
+	};
+
+	/// The channel states, indexed by terminal ID
+	std::vector<TerminalChannelState> states;
+
+	/// The models of the terminals, in the order they are refreshed
+	std::vector<TerminalModels> models;
+
+	/// Log
+	std::shared_ptr<OutputLog> log_channel;
+
+public:
+	/**
+	 * @brief Build the terminal channels
+	 *
+	 * @param log_channel  the log output to use during updates
+	 */
+	TerminalChannels(std::shared_ptr<OutputLog> log_channel);
+
+	/**
+	 * @brief Create and initialize the models of each terminal
+	 *
+	 * @param terminals          the terminals to emulate
+	 * @param attenuation_type   the attenuation plugin name
+	 * @param attenuation_path   the path of the attenuation configuration
+	 * @param refresh_period_ms  the attenuation refresh period
+	 * @param delay_type         the delay plugin name, empty for no delay model
+	 * @param log_init           the log output to use during initialization
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool initialize(const std::unordered_set<tal_id_t> &terminals,
+	                const std::string &attenuation_type,
+	                const std::string &attenuation_path,
+	                time_ms_t refresh_period_ms,
+	                const std::string &delay_type,
+	                std::shared_ptr<OutputLog> log_init);
+
+	/**
+	 * @brief Refresh the attenuation of every terminal
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool updateAttenuations();
+
+	/**
+	 * @brief Refresh the delay of every terminal
+	 *
+	 * @return true on success, false otherwise
+	 */
+	bool updateDelays();
+
+	/**
+	 * @brief Get the refresh period of the delay models
+	 *
+	 * @return the refresh period, 0 if there is no delay model
+	 */
+	time_ms_t getDelayRefreshPeriod() const;
+
+	/**
+	 * @brief Get the channel state of a terminal
+	 *
+	 * @param tal_id  the terminal ID
+	 *
+	 * @return the state, nullptr if the terminal has no model
+	 */
+	inline TerminalChannelState *getState(tal_id_t tal_id)
+	{
+		if(tal_id >= this->states.size() || !this->states[tal_id].active)
+		{
+			return nullptr;
+		}
+		return &this->states[tal_id];
+	};
+};
+
+
+#endif
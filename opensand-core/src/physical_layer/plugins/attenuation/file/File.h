@@ -37,8 +37,8 @@
 
 
 #include "PhysicalLayerPlugin.h"
+#include "TimeSeriesTrace.h"
 
-#include <map>
 #include <string>
 
 
@@ -53,7 +53,7 @@ private:
 	unsigned int current_time;
 
 	/// The attenuation values we will interpolate
-	std::map<unsigned int, double> attenuation;
+	TraceCursor attenuation;
 
 	/// Reading mode
 	bool loop;
@@ -83,7 +83,13 @@ bool Gate::isToBeModifiedPacket(double cn_total,
 }
 
 
-bool Gate::modifyPacket(const Data &)
+bool Gate::accessesPayload() const
+{
+	return false;
+}
+
+
+bool Gate::modifyPacket(uint8_t *, std::size_t)
 {
 	LOG(this->log_error, LEVEL_INFO,
 	    "Payload is modified\n");
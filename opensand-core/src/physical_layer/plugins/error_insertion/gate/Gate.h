@@ -68,14 +68,22 @@ public:
 
 	bool init();
 
+	/**
+	 * @brief The gate only marks frames as corrupted
+	 *
+	 * @return false, the payload is never accessed
+	 */
+	bool accessesPayload() const;
+
 	/**
 	 * @brief Corrupt a package with error bits 
 	 *
-	 * @param payload the payload to the frame that should be modified 
+	 * @param payload  the payload to the frame that should be modified 
+	 * @param length   the payload length
 	 * @return true if DVB header should be tagged as corrupted,
 	 *         false otherwise
 	 */
-	bool modifyPacket(const Data &payload);
+	bool modifyPacket(uint8_t *payload, std::size_t length);
 
 	/**
 	 * @brief Determine if a Packet shall be corrupted or not depending on
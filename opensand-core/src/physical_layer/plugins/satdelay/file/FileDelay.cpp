@@ -37,10 +37,6 @@
 
 #include <opensand_output/Output.h>
 
-#include <algorithm>
-#include <sstream>
-#include <fstream>
-
 
 std::string FileDelay::config_path = "";
 
@@ -57,7 +53,6 @@ FileDelay::FileDelay():
 
 FileDelay::~FileDelay()
 {
-	this->delays.clear();
 }
 
 
@@ -132,81 +127,31 @@ bool FileDelay::init()
 
 bool FileDelay::load(std::string filename)
 {
-	std::string line;
-	std::istringstream line_stream;
-	unsigned int line_number = 0;
-
-	std::ifstream file(filename.c_str());
-
-	if(!file)
+	// binary traces may hold one series per entity
+	tal_id_t entity_id = this->terminal_id;
+	if(entity_id == BROADCAST_TAL_ID)
 	{
-		LOG(this->log_delay, LEVEL_ERROR,
-		    "Cannot open file %s\n", filename.c_str());
-		goto error;
+		std::string type;
+		OpenSandModelConf::Get()->getComponentType(type, entity_id);
 	}
 
-	while(std::getline(file, line))
+	if(!this->delays.open(filename, entity_id))
 	{
-		unsigned int time;
-		time_ms_t delay;
-		
-		line_number++;
-		
-		if(line == "" || line[0] == '#')
-		{
-			continue;
-		}
-
-		// Clear previous flags (if any)
-		line_stream.clear();
-		line_stream.str(line);
-
-		line_stream >> time;
-		if(line_stream.bad() || line_stream.fail())
-		{
-			LOG(this->log_delay, LEVEL_ERROR,
-					"Bad syntax in file '%s', line %u: "
-					"there should be a timestamp (integer) "
-					"instead of '%s'\n",
-					filename.c_str(), line_number,
-					line.c_str());
-			goto malformed;
-		}
-
-		// get delay
-		line_stream >> delay;
-		if(line_stream.bad() || line_stream.fail())
-		{
-			LOG(this->log_delay, LEVEL_ERROR,
-			    "Error while parsing delay line %u\n",
-			    line_number);
-			goto malformed;
-		}
-
-		this->delays[time] = delay;
-
-		LOG(this->log_delay, LEVEL_DEBUG,
-		    "Entry: time: %u, delay: %d ms\n", time, delay);
+		LOG(this->log_delay, LEVEL_ERROR,
+		    "Malformed sat delay configuration file '%s'\n",
+		    filename.c_str());
+		return false;
 	}
 
-	file.close();
 	// TODO: should is_init use a mutex??
 	this->is_init = true;
 	return true;
-
-malformed:
-	LOG(this->log_delay, LEVEL_ERROR,
-	    "Malformed sat delay configuration file '%s'\n",
-	    filename.c_str());
-	file.close();
-error:
-	return false;
 }
 
 bool FileDelay::updateSatDelay()
 {
-	unsigned int old_time, new_time;
-	time_ms_t old_delay, new_delay, next_delay;
+	double value;
+	time_ms_t next_delay;
 
 	this->current_time++;
 
@@ -215,67 +160,24 @@ bool FileDelay::updateSatDelay()
 	    "(step: %u ms)\n", this->current_time,
 	    this->refresh_period_ms);
 
-	// Look for the next entry whose key is equal or greater than 'current_time'
-	auto delay_it = this->delays.lower_bound(this->current_time);
-
-	// Delay found
-	if(delay_it != this->delays.end())
+	// Interpolate between the entries around 'current_time'
+	if(this->delays.getValue(this->current_time, value))
 	{
-		// Next entry in the configuration file
-		new_time = delay_it->first;
-		new_delay = delay_it->second;
-
-		LOG(this->log_delay, LEVEL_DEBUG,
-		    "New entry found: time: %u, value: %d\n",
-		    new_time, new_delay);
-
-		if(delay_it != this->delays.begin())
-		{
-			// Get previous entry in the configuration file
-			double coef;
-			delay_it--;
-
-			old_time = delay_it->first;
-			old_delay = delay_it->second;
-
-			LOG(this->log_delay, LEVEL_DEBUG,
-			    "Old time: %u, old delay: %d\n",
-			    old_time, old_delay);
-
-			// Linear interpolation
-			coef = (double(new_delay) - old_delay) /
-			       (double(new_time) - old_time);
-
-
-			next_delay = old_delay + time_ms_t(coef * (this->current_time - old_time));
-
-			LOG(this->log_delay, LEVEL_DEBUG,
-			    "Linear coef: %f, old step: %u\n",
-			    coef, old_time);
-		}
-		else
-		{
-			// First (and potentially only) entry, use it
-			LOG(this->log_delay, LEVEL_DEBUG,
-			    "It is the first entry\n");
-			next_delay = new_delay;
-		}
+		next_delay = time_ms_t(value);
 	}
 	else if(!this->loop)
 	{
 		LOG(this->log_delay, LEVEL_DEBUG,
 		    "Reach end of simulation, keep the last value\n");
 		// we reached the end of the scenario, keep the last value
-		next_delay = this->delays.rend()->second;
+		next_delay = time_ms_t(this->delays.getLastValue());
 	}
 	else // loop
 	{
 		LOG(this->log_delay, LEVEL_DEBUG,
 		    "Reach end of simulation, restart with the first value\n");
 		// we reached the end of the scenario, restart at beginning
-		delay_it = this->delays.begin();
-		new_time = delay_it->first;
-		next_delay = delay_it->second;
+		next_delay = time_ms_t(this->delays.rewind());
 		this->current_time = 0;
 	}
 
@@ -288,13 +190,6 @@ bool FileDelay::updateSatDelay()
 }
 
 
-static bool pair_compare(const std::pair<unsigned int, time_ms_t> &a,
-                         const std::pair<unsigned int, time_ms_t> &b)
-{
-	return a.second < b.second;
-}
-
-
 bool FileDelay::getMaxDelay(time_ms_t &delay) const
 {
 	if(!this->is_init)
@@ -302,7 +197,6 @@ bool FileDelay::getMaxDelay(time_ms_t &delay) const
 		return false;
 	}
 
-	auto result = std::max_element(this->delays.begin(), this->delays.end(), pair_compare);
-	delay = result->second;
+	delay = time_ms_t(this->delays.getMaxValue());
 	return true;
 }
@@ -38,8 +38,9 @@
 #include "OpenSandCore.h"
 #include "PhysicalLayerPlugin.h"
 
+#include "TimeSeriesTrace.h"
+
 #include <string>
-#include <map>
 
 
 /**
@@ -57,7 +58,7 @@ private:
 	unsigned int current_time;
 
 	/// The satdelay values we will interpolate
-	std::map<unsigned int, time_ms_t> delays;
+	TraceCursor delays;
 
 	/// Reading mode
 	bool loop;
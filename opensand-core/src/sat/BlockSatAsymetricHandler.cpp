@@ -99,7 +99,14 @@ BlockSatAsymetricHandler::Downward::Downward(const std::string& name, AsymetricC
 
 bool BlockSatAsymetricHandler::Downward::onInit()
 {
-	return this->initGround(false, this, this->log_init);
+	if (!this->initGround(false, this, this->log_init))
+	{
+		return false;
+	}
+
+	// Regenerated frames are attenuated according to their source terminal
+	return !this->is_regenerated_traffic ||
+	       this->initTerminalChannels(this, false, this->log_init);
 }
 
 
@@ -109,15 +116,22 @@ bool BlockSatAsymetricHandler::Downward::onEvent(const RtEvent *const event)
 	{
 		case EventType::Message:
 			{
-				LOG(this->log_event, LEVEL_DEBUG, "Incoming DVB frame");
-
 				auto msg_event = static_cast<const MessageEvent *>(event);
-				auto frame = static_cast<DvbFrame *>(msg_event->getData());
-				const bool is_control = isControlCarrier(extractCarrierType(frame->getCarrierId()));
-				if ((is_control || this->is_regenerated_traffic) && IsCnCapableFrame(frame->getMessageType()))
+				if (to_enum<InternalMessageType>(msg_event->getMessageType()) == InternalMessageType::batch)
 				{
-					frame->setCn(this->getCurrentCn());
+					std::unique_ptr<DvbFrameBatch> frames{static_cast<DvbFrameBatch *>(msg_event->getData())};
+					LOG(this->log_event, LEVEL_DEBUG, "Incoming batch of %zu DVB frames", frames->size());
+					for (auto&& frame: *frames)
+					{
+						this->prepareFrame(frame.get());
+					}
+					return this->forwardPackets(std::move(frames));
 				}
+
+				LOG(this->log_event, LEVEL_DEBUG, "Incoming DVB frame");
+
+				auto frame = static_cast<DvbFrame *>(msg_event->getData());
+				this->prepareFrame(frame);
 				return this->forwardPacket(frame);
 			}
 
@@ -148,6 +162,16 @@ bool BlockSatAsymetricHandler::Downward::onEvent(const RtEvent *const event)
 }
 
 
+void BlockSatAsymetricHandler::Downward::prepareFrame(DvbFrame *frame)
+{
+	const bool is_control = isControlCarrier(extractCarrierType(frame->getCarrierId()));
+	if ((is_control || this->is_regenerated_traffic) && IsCnCapableFrame(frame->getMessageType()))
+	{
+		frame->setCn(this->getCurrentCn(frame->getSourceTerminal()));
+	}
+}
+
+
 bool BlockSatAsymetricHandler::Downward::forwardPacket(DvbFrame *dvb_frame)
 {
 	// Send frame to lower layer
@@ -160,3 +184,23 @@ bool BlockSatAsymetricHandler::Downward::forwardPacket(DvbFrame *dvb_frame)
 	}
 	return true;	
 }
+
+
+bool BlockSatAsymetricHandler::Downward::forwardPackets(std::unique_ptr<DvbFrameBatch> frames)
+{
+	if (frames->size() == 1)
+	{
+		return this->forwardPacket(frames->begin()->release());
+	}
+
+	// Send the whole batch to lower layer at once
+	auto batch = frames.release();
+	if (!this->enqueueMessage((void **)&batch, 0, to_underlying(InternalMessageType::batch)))
+	{
+		LOG(this->log_send, LEVEL_ERROR,
+		    "Failed to send batch of DVB frames to lower layer");
+		delete batch;
+		return false;
+	}
+	return true;
+}
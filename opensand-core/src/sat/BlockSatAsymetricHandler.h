@@ -80,6 +80,8 @@ public:
 	private:
 		bool onEvent(const RtEvent *const event) override;
 		bool forwardPacket(DvbFrame *frame) override;
+		bool forwardPackets(std::unique_ptr<DvbFrameBatch> frames) override;
+		void prepareFrame(DvbFrame *frame);
 
 		bool is_regenerated_traffic;
 	};
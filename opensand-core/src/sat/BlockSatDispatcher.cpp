@@ -33,6 +33,7 @@
  */
 
 
+#include <algorithm>
 #include <tuple>
 
 #include "BlockSatDispatcher.h"
@@ -76,17 +77,134 @@ spot_id_t BlockSatDispatcher::SpotByEntity::getSpotForEntity(tal_id_t entity) co
 }
 
 
+BlockSatDispatcher::ForwardingTable::ForwardingTable():
+	routes{},
+	output_by_src{},
+	no_route{{0, Component::unknown}, false, 0, RegenLevel::Transparent},
+	bursts{},
+	used_outputs{}
+{
+}
+
+
+std::size_t BlockSatDispatcher::ForwardingTable::getOutput(spot_id_t spot_id, Component dest) const
+{
+	return std::size_t{spot_id} * 2 + (dest == Component::terminal ? 1 : 0);
+}
+
+
+void BlockSatDispatcher::ForwardingTable::build(const SpotByEntity &spot_by_entity,
+                                                const std::unordered_map<tal_id_t, Component> &entities_type,
+                                                const std::unordered_map<SpotComponentPair, tal_id_t> &sat_routes,
+                                                const std::unordered_map<SpotComponentPair, RegenLevel> &regen_levels)
+{
+	// Packets are routed toward the component facing their source in
+	// the spot of their source, compile the output of each entity
+	tal_id_t max_entity_id = 0;
+	spot_id_t max_spot_id = 0;
+	for (auto &&[entity, type]: entities_type)
+	{
+		max_entity_id = std::max(max_entity_id, entity);
+		max_spot_id = std::max(max_spot_id, spot_by_entity.getSpotForEntity(entity));
+	}
+	for (auto &&[key, sat_id]: sat_routes)
+	{
+		max_spot_id = std::max(max_spot_id, key.spot_id);
+	}
+
+	routes.clear();
+	for (std::size_t spot_id = 0; spot_id <= max_spot_id; ++spot_id)
+	{
+		for (auto &&dest: {Component::gateway, Component::terminal})
+		{
+			SpotComponentPair key{static_cast<spot_id_t>(spot_id), dest};
+			Route route{key, false, 0, RegenLevel::Transparent};
+			const auto sat_id_it = sat_routes.find(key);
+			const auto regen_level_it = regen_levels.find(key);
+			if (sat_id_it != sat_routes.end() && regen_level_it != regen_levels.end())
+			{
+				route.found = true;
+				route.sat_id = sat_id_it->second;
+				route.regen_level = regen_level_it->second;
+			}
+			routes.push_back(route);
+		}
+	}
+
+	output_by_src.assign(std::size_t{max_entity_id} + 1, no_output);
+	for (auto &&[entity, type]: entities_type)
+	{
+		if (type == Component::gateway || type == Component::terminal)
+		{
+			const Component dest = type == Component::gateway ? Component::terminal : Component::gateway;
+			output_by_src[entity] = getOutput(spot_by_entity.getSpotForEntity(entity), dest);
+		}
+	}
+
+	bursts.clear();
+	bursts.resize(routes.size());
+	used_outputs.clear();
+	used_outputs.reserve(routes.size());
+}
+
+
+const BlockSatDispatcher::ForwardingTable::Route &
+BlockSatDispatcher::ForwardingTable::getRoute(spot_id_t spot_id, Component dest) const
+{
+	const std::size_t output = getOutput(spot_id, dest);
+	if (output >= routes.size())
+	{
+		return no_route;
+	}
+	return routes[output];
+}
+
+
 BlockSatDispatcher::BlockSatDispatcher(const std::string &name, SatDispatcherConfig config):
 	Block(name),
 	entity_id{config.entity_id},
-	isl_enabled{config.isl_enabled}
+	isl_enabled{config.isl_enabled},
+	spots{config.spots}
 {
 }
 
 
+void BlockSatDispatcher::addShard(BlockSatDispatcher *shard, const std::vector<IslComponentPair> &isl_keys)
+{
+	auto upward = dynamic_cast<Upward *>(this->upward);
+	auto downward = dynamic_cast<Downward *>(this->downward);
+	auto shard_upward = dynamic_cast<Upward *>(shard->upward);
+	auto shard_downward = dynamic_cast<Downward *>(shard->downward);
+
+	// the shard sends in the fifos of the upper blocks, so that the
+	// messages going up do not cross this dispatcher
+	for (auto &&key: isl_keys)
+	{
+		Rt::shareChannel(*shard_upward, *upward, key);
+	}
+
+	// the messages received from the upper blocks for a spot of
+	// the shard are handed over to it untouched
+	for (auto &&spot_id: shard->spots)
+	{
+		for (auto &&dest: {Component::gateway, Component::terminal})
+		{
+			Rt::connectChannels(*downward, *shard_downward, {spot_id, dest, false});
+		}
+	}
+}
+
+
 bool BlockSatDispatcher::onInit()
 {
 	const auto conf = OpenSandModelConf::Get();
+	return this->initRoutes(conf->getSpotsTopology(), conf->getEntitiesType());
+}
+
+
+bool BlockSatDispatcher::initRoutes(const std::unordered_map<spot_id_t, SpotTopology> &spots_topology,
+                                    const std::unordered_map<tal_id_t, Component> &entities_type)
+{
 	auto downward = dynamic_cast<Downward *>(this->downward);
 	auto upward = dynamic_cast<Upward *>(this->upward);
 
@@ -94,7 +212,7 @@ bool BlockSatDispatcher::onInit()
 	std::unordered_map<SpotComponentPair, tal_id_t> routes;
 	std::unordered_map<SpotComponentPair, RegenLevel> regen_levels;
 
-	for (auto &&spot: conf->getSpotsTopology())
+	for (auto &&spot: spots_topology)
 	{
 		const SpotTopology &topo = spot.second;
 
@@ -127,12 +245,17 @@ bool BlockSatDispatcher::onInit()
 		    spot.first, topo.spot_id);
 	}
 
-	upward->routes = routes;
-	downward->routes = routes;
-	upward->spot_by_entity = spot_by_entity;
-	downward->spot_by_entity = spot_by_entity;
-	upward->regen_levels = regen_levels;
-	downward->regen_levels = regen_levels;
+	// a shard only advertises the links of its own spots
+	for (auto &&[key, sat_id]: routes)
+	{
+		if (spots.empty() || spots.find(key.spot_id) != spots.end())
+		{
+			upward->routes[key] = sat_id;
+			upward->regen_levels[key] = regen_levels.at(key);
+		}
+	}
+	upward->forwarding.build(spot_by_entity, entities_type, routes, regen_levels);
+	downward->forwarding.build(spot_by_entity, entities_type, routes, regen_levels);
 	return true;
 }
 
@@ -217,15 +340,15 @@ bool BlockSatDispatcher::Upward::handleDvbFrame(std::unique_ptr<DvbFrame> frame)
 
 	const Component dest = isGatewayCarrier(carrier_type) ? Component::terminal : Component::gateway;
 
-	const auto dest_sat_id_it = routes.find({spot_id, dest});
-	if (dest_sat_id_it == routes.end())
+	const auto &route = forwarding.getRoute(spot_id, dest);
+	if (!route.found)
 	{
 		LOG(log_receive, LEVEL_ERROR,
 		    "No route found for %s in spot %d",
 		    dest == Component::gateway ? "GW" : "ST", spot_id);
 		return false;
 	}
-	const tal_id_t dest_sat_id = dest_sat_id_it->second;
+	const tal_id_t dest_sat_id = route.sat_id;
 
 	if (dest_sat_id == entity_id)
 	{
@@ -244,74 +367,27 @@ bool BlockSatDispatcher::Upward::handleDvbFrame(std::unique_ptr<DvbFrame> frame)
 
 bool BlockSatDispatcher::Upward::handleNetBurst(std::unique_ptr<NetBurst> in_burst)
 {
-	// Separate the packets by destination
-	std::unordered_map<SpotComponentPair, std::unique_ptr<NetBurst>> bursts{};
-	for (auto &&pkt: *in_burst)
+	auto send = [this](const ForwardingTable::Route &route, std::unique_ptr<NetBurst> burst)
 	{
-		const auto dest_id = pkt->getDstTalId();
-		const auto src_id = pkt->getSrcTalId();
-		const spot_id_t spot_id = spot_by_entity.getSpotForEntity(src_id);
-		LOG(log_receive, LEVEL_INFO, "Received a NetBurst (%d->%d, spot_id %d)", src_id, dest_id, spot_id);
-
-		Component src = OpenSandModelConf::Get()->getEntityType(src_id);
-		Component dest;
-		if (src == Component::gateway)
+		if (route.sat_id == entity_id && route.regen_level != RegenLevel::IP)
 		{
-			dest = Component::terminal;
-		}
-		else if (src == Component::terminal)
-		{
-			dest = Component::gateway;
-		}
-		else
-		{
-			LOG(log_receive, LEVEL_ERROR, "The type of the src entity %d is %s", src_id, getComponentName(src).c_str());
-			return false;
+			return sendToOppositeChannel(std::move(burst), InternalMessageType::decap_data);
 		}
 
-		auto &burst = bursts[{spot_id, dest}];
-		if (burst == nullptr)
-		{
-			burst = std::unique_ptr<NetBurst>(new NetBurst{});
-		}
-		burst->push_back(std::move(pkt));
-	}
-
-	// Send all bursts to their respective destination
-	bool ok = true;
-	for (auto &&[dest, burst]: bursts)
-	{
-		const auto dest_sat_id_it = routes.find(dest);
-		if (dest_sat_id_it == routes.end())
-		{
-			LOG(log_receive, LEVEL_ERROR, "No route found for %s in spot %d",
-			    dest.dest == Component::gateway ? "GW" : "ST", dest.spot_id);
-			ok = false;
-			continue;
-		}
-
-		const tal_id_t dest_sat_id = dest_sat_id_it->second;
-		auto regen_level = regen_levels.at(dest);
-		if (dest_sat_id == entity_id && regen_level != RegenLevel::IP)
-		{
-			ok &= sendToOppositeChannel(std::move(burst), InternalMessageType::decap_data);
-		}
-		else
-		{
-			// send by ISL or to LanAdaptation for IP regen
-			IslComponentPair key{
-				.connected_sat = dest_sat_id,
-				.is_data_channel = regen_level == RegenLevel::IP,
-			};
-			ok &= sendToUpperBlock(key, std::move(burst), InternalMessageType::decap_data);
-		}
-	}
-	return ok;
+		// send by ISL or to LanAdaptation for IP regen
+		IslComponentPair key{
+			.connected_sat = route.sat_id,
+			.is_data_channel = route.regen_level == RegenLevel::IP,
+		};
+		return sendToUpperBlock(key, std::move(burst), InternalMessageType::decap_data);
+	};
+	return forwarding.forwardBurst(std::move(in_burst), log_receive, send);
 }
 
 BlockSatDispatcher::Downward::Downward(const std::string &name, SatDispatcherConfig config):
 	RtDownwardMuxDemux<RegenerativeSpotComponent>{name},
-	entity_id{config.entity_id}
+	entity_id{config.entity_id},
+	relay{config.relay}
 {
 }
 
@@ -368,14 +444,14 @@ bool BlockSatDispatcher::Downward::handleDvbFrame(std::unique_ptr<DvbFrame> fram
 	                       ? std::make_tuple(Component::terminal, Component::gateway)
 	                       : std::make_tuple(Component::gateway, Component::terminal);
 
-	const auto dest_sat_id_it = routes.find({spot_id, dest});
-	if (dest_sat_id_it == routes.end())
+	const auto &route = forwarding.getRoute(spot_id, dest);
+	if (!route.found)
 	{
 		LOG(log_receive, LEVEL_ERROR, "No route found for %s in spot %d",
 		    dest == Component::gateway ? "GW" : "ST", spot_id);
 		return false;
 	}
-	const tal_id_t dest_sat_id = dest_sat_id_it->second;
+	const tal_id_t dest_sat_id = route.sat_id;
 
 	if (dest_sat_id == entity_id)
 	{
@@ -386,10 +462,16 @@ bool BlockSatDispatcher::Downward::handleDvbFrame(std::unique_ptr<DvbFrame> fram
 			return false;
 		}
 
+		if (relay)
+		{
+			// the shard of the spot handles the frame
+			return sendToLowerBlock({spot_id, dest, false}, std::move(frame), msg_type);
+		}
+
 		// add one to the input carrier id to get the corresponding output carrier id
 		frame->setCarrierId(carrier_id + 1);
-		bool is_transparent = regen_levels.at({spot_id, dest}) == RegenLevel::Transparent
-		                   && (is_data_carrier || regen_levels.at({spot_id, src}) == RegenLevel::Transparent);
+		bool is_transparent = route.regen_level == RegenLevel::Transparent
+		                   && (is_data_carrier || forwarding.getRoute(spot_id, src).regen_level == RegenLevel::Transparent);
 		return sendToLowerBlock({spot_id, dest, is_transparent}, std::move(frame), msg_type);
 	}
 	else
@@ -401,60 +483,16 @@ bool BlockSatDispatcher::Downward::handleDvbFrame(std::unique_ptr<DvbFrame> fram
 
 bool BlockSatDispatcher::Downward::handleNetBurst(std::unique_ptr<NetBurst> in_burst)
 {
-	// Separate the packets by destination
-	std::unordered_map<SpotComponentPair, std::unique_ptr<NetBurst>> bursts{};
-	for (auto &&pkt: *in_burst)
+	auto send = [this](const ForwardingTable::Route &route, std::unique_ptr<NetBurst> burst)
 	{
-		const auto dest_id = pkt->getDstTalId();
-		const auto src_id = pkt->getSrcTalId();
-		const spot_id_t spot_id = spot_by_entity.getSpotForEntity(src_id);
-		LOG(log_receive, LEVEL_INFO, "Received a NetBurst (%d->%d, spot_id %d)", src_id, dest_id, spot_id);
-
-		Component src = OpenSandModelConf::Get()->getEntityType(src_id);
-		Component dest;
-		if (src == Component::gateway)
-		{
-			dest = Component::terminal;
-		}
-		else if (src == Component::terminal)
+		if (route.sat_id == entity_id || route.regen_level == RegenLevel::IP)
 		{
-			dest = Component::gateway;
-		}
-		else
-		{
-			LOG(log_receive, LEVEL_ERROR, "The type of the src entity %d is %s", src_id, getComponentName(src).c_str());
-			return false;
+			return sendToLowerBlock({route.dest.spot_id, route.dest.dest, false},
+			                        std::move(burst), InternalMessageType::decap_data);
 		}
 
-		auto &burst = bursts[{spot_id, dest}];
-		if (burst == nullptr) {
-			burst = std::unique_ptr<NetBurst>(new NetBurst{});
-		}
-		burst->push_back(std::move(pkt));
-	}
-
-	// Send all bursts to their respective destination
-	bool ok = true;
-	for (auto &&[dest, burst]: bursts)
-	{
-		const auto dest_sat_id_it = routes.find(dest);
-		if (dest_sat_id_it == routes.end())
-		{
-			LOG(log_receive, LEVEL_ERROR, "No route found for %s in spot %d",
-			    dest.dest == Component::gateway ? "GW" : "ST", dest.spot_id);
-			ok = false;
-			continue;
-		}
-		const tal_id_t dest_sat_id = dest_sat_id_it->second;
-		if (dest_sat_id == entity_id || regen_levels.at(dest) == RegenLevel::IP)
-		{
-			ok &= sendToLowerBlock({dest.spot_id, dest.dest, false}, std::move(burst), InternalMessageType::decap_data);
-		}
-		else
-		{
-			// send by ISL
-			ok &= sendToOppositeChannel(std::move(burst), InternalMessageType::decap_data);
-		}
-	}
-	return ok;
+		// send by ISL
+		return sendToOppositeChannel(std::move(burst), InternalMessageType::decap_data);
+	};
+	return forwarding.forwardBurst(std::move(in_burst), log_receive, send);
 }
@@ -36,6 +36,7 @@
 #define BLOCK_SAT_DISPATCHER_H
 
 #include <memory>
+#include <vector>
 
 #include <opensand_rt/Rt.h>
 #include <opensand_rt/RtChannelMuxDemux.h>
@@ -53,6 +54,15 @@ struct SatDispatcherConfig
 	// If true, the messages for spots that are not handled by 
 	// this satellite will be sent to the upper block
 	bool isl_enabled;
+
+	// The spots whose stacks are connected below this dispatcher,
+	// all of them if empty
+	std::unordered_set<spot_id_t> spots{};
+
+	// If true, the stacks are connected below dispatcher shards and
+	// this dispatcher only relays the ISL messages between them and
+	// the upper blocks
+	bool relay{false};
 };
 
 
@@ -78,11 +88,84 @@ class BlockSatDispatcher: public Block
 		spot_id_t default_spot;
 	};
 
+	/**
+	 * @brief The routes of the topology, compiled into tables indexed
+	 *        by spot and by source entity so that forwarding a message
+	 *        only costs array accesses
+	 */
+	class ForwardingTable
+	{
+	public:
+		struct Route
+		{
+			SpotComponentPair dest;
+			bool found;
+			tal_id_t sat_id;
+			RegenLevel regen_level;
+		};
+
+		ForwardingTable();
+
+		void build(const SpotByEntity &spot_by_entity,
+		           const std::unordered_map<tal_id_t, Component> &entities_type,
+		           const std::unordered_map<SpotComponentPair, tal_id_t> &routes,
+		           const std::unordered_map<SpotComponentPair, RegenLevel> &regen_levels);
+
+		/**
+		 * @brief Get the route toward a component of a spot
+		 *
+		 * @return the route, not found if the spot is not routed
+		 */
+		const Route &getRoute(spot_id_t spot_id, Component dest) const;
+
+		/**
+		 * @brief Separate the packets of a burst by route and send
+		 *        each resulting burst
+		 *
+		 * @param burst  the received burst
+		 * @param log    the log for the routing errors
+		 * @param send   called with the route and the burst of each output
+		 * @return false if a packet cannot be routed or a send failed
+		 */
+		template <typename F>
+		bool forwardBurst(std::unique_ptr<NetBurst> burst,
+		                  const std::shared_ptr<OutputLog> &log,
+		                  F &&send);
+
+	private:
+		static constexpr std::size_t no_output = SIZE_MAX;
+
+		std::size_t getOutput(spot_id_t spot_id, Component dest) const;
+
+		/// The routes, indexed by output
+		std::vector<Route> routes;
+		/// The output of the packets sent by each entity
+		std::vector<std::size_t> output_by_src;
+		Route no_route;
+
+		/// The bursts being built for each output
+		std::vector<std::unique_ptr<NetBurst>> bursts;
+		/// The outputs of the bursts being built, in creation order
+		std::vector<std::size_t> used_outputs;
+	};
+
 public:
 	BlockSatDispatcher(const std::string &name, SatDispatcherConfig config);
 
 	bool onInit();
 
+	/**
+	 * @brief Connect a dispatcher shard below this relay dispatcher
+	 *
+	 * The shard sends its messages directly to the upper blocks, which
+	 * should already be connected to this dispatcher, only the messages
+	 * of the upper blocks cross the relay to reach the shards.
+	 *
+	 * @param shard     the shard, connected to the stacks of its spots
+	 * @param isl_keys  the keys of the upper blocks of this dispatcher
+	 */
+	void addShard(BlockSatDispatcher *shard, const std::vector<IslComponentPair> &isl_keys);
+
 	class Upward: public RtUpwardMuxDemux<IslComponentPair>
 	{
 	public:
@@ -102,7 +185,7 @@ public:
 
 		tal_id_t entity_id;
 
-		SpotByEntity spot_by_entity;
+		ForwardingTable forwarding;
 		std::unordered_map<SpotComponentPair, tal_id_t> routes;
 		std::unordered_map<SpotComponentPair, RegenLevel> regen_levels;
 	};
@@ -125,16 +208,101 @@ public:
 		bool sendToOppositeChannel(std::unique_ptr<T> msg, InternalMessageType msg_type);
 
 		tal_id_t entity_id;
-		SpotByEntity spot_by_entity;
-		std::unordered_map<SpotComponentPair, tal_id_t> routes;
-		std::unordered_map<SpotComponentPair, RegenLevel> regen_levels;
+		bool relay;
+		ForwardingTable forwarding;
 	};
 
+protected:
+	/**
+	 * @brief Build the routes of the topology
+	 *
+	 * @param spots_topology  the spots and the satellites serving them
+	 * @param entities_type   the type of each entity
+	 * @return true on success, false otherwise
+	 */
+	bool initRoutes(const std::unordered_map<spot_id_t, SpotTopology> &spots_topology,
+	                const std::unordered_map<tal_id_t, Component> &entities_type);
+
 private:
 	tal_id_t entity_id;
 	bool isl_enabled;
+	std::unordered_set<spot_id_t> spots;
 };
 
+template <typename F>
+bool BlockSatDispatcher::ForwardingTable::forwardBurst(std::unique_ptr<NetBurst> burst,
+                                                       const std::shared_ptr<OutputLog> &log,
+                                                       F &&send)
+{
+	// Separate the packets by output, the packets of the first output
+	// stay in the received burst and the others are spliced out of it
+	std::size_t first_output = no_output;
+	auto pkt_it = burst->begin();
+	while (pkt_it != burst->end())
+	{
+		const tal_id_t src_id = (*pkt_it)->getSrcTalId();
+		const std::size_t output = src_id < output_by_src.size() ? output_by_src[src_id] : no_output;
+		if (output == no_output)
+		{
+			LOG(log, LEVEL_ERROR,
+			    "The src entity %d is neither a gateway nor a terminal", src_id);
+			for (auto &&used_output: used_outputs)
+			{
+				bursts[used_output].reset();
+			}
+			used_outputs.clear();
+			return false;
+		}
+
+		if (first_output == no_output)
+		{
+			first_output = output;
+		}
+		if (output == first_output)
+		{
+			++pkt_it;
+			continue;
+		}
+
+		auto &output_burst = bursts[output];
+		if (output_burst == nullptr)
+		{
+			output_burst = std::unique_ptr<NetBurst>(new NetBurst{});
+			used_outputs.push_back(output);
+		}
+		output_burst->splice(output_burst->end(), *burst, pkt_it++);
+	}
+
+	if (first_output == no_output)
+	{
+		return true;
+	}
+
+	// Send all bursts to their respective destination
+	auto send_output = [&](std::size_t output, std::unique_ptr<NetBurst> output_burst)
+	{
+		const Route &route = routes[output];
+		if (!route.found)
+		{
+			LOG(log, LEVEL_ERROR, "No route found for %s in spot %d",
+			    route.dest.dest == Component::gateway ? "GW" : "ST", route.dest.spot_id);
+			return false;
+		}
+		LOG(log, LEVEL_INFO, "Forwarding a NetBurst of %zu packets to %s in spot %d",
+		    output_burst->size(), route.dest.dest == Component::gateway ? "GW" : "ST",
+		    route.dest.spot_id);
+		return send(route, std::move(output_burst));
+	};
+
+	bool ok = send_output(first_output, std::move(burst));
+	for (auto &&output: used_outputs)
+	{
+		ok &= send_output(output, std::move(bursts[output]));
+	}
+	used_outputs.clear();
+	return ok;
+}
+
 template <typename T>
 bool BlockSatDispatcher::Upward::sendToUpperBlock(IslComponentPair key, std::unique_ptr<T> msg, InternalMessageType msg_type)
 {
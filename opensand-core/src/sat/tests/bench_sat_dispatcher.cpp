@@ -0,0 +1,492 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+/*
+ * Benchmark for the satellite dispatcher shards
+ *
+ * The application builds the dispatching part of a satellite serving a
+ * synthetic topology of several spots, without configuration file: one
+ * dispatcher shard per spot, or a single dispatcher for all the spots, with
+ * a gateway and a terminal stack below it for each spot. Each stack sends
+ * messages to the other stack of its spot and the application reports the
+ * messages/s forwarded by the dispatchers once all of them are received.
+ *
+ * In transparent mode, the stacks exchange DvbFrames which go through the
+ * dispatchers only. In IP mode, they exchange NetBursts which go through
+ * the upper block regenerating the IP packets and, when sharded, through
+ * the relay dispatcher between this block and the shards.
+ *
+ * Launch the application with -h to learn how to use it.
+ */
+
+// OpenSAND includes
+#include "BlockSatDispatcher.h"
+#include "CarrierType.h"
+#include "DvbFrame.h"
+#include "NetBurst.h"
+#include "NetPacket.h"
+
+#include <opensand_output/Output.h>
+#include <opensand_rt/Rt.h>
+#include <opensand_rt/RtChannel.h>
+#include <opensand_rt/MessageEvent.h>
+
+// system includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <sys/types.h>
+#include <unistd.h>
+
+
+/// The program version
+#define VERSION   "Satellite dispatcher benchmark application, version 0.1\n"
+
+/// The program usage
+#define USAGE \
+"Satellite dispatcher benchmark application: measure the dispatcher shards with synthetic traffic\n\n\
+usage: bench [-h] [-v] [-i] [-u] [-n count] [-s spots]\n\
+\t-h         print this usage and exit\n\
+\t-v         print version information and exit\n\
+\t-i         exchange NetBursts regenerated at IP level instead of DvbFrames\n\
+\t-u         use a single dispatcher for all the spots instead of one shard per spot\n\
+\t-n count   number of messages sent by each stack (default: 100000)\n\
+\t-s spots   number of spots, from 1 to 16 (default: 1)\n\n"
+
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+/// The maximum number of spots, carrier ids are coded on 8 bits
+constexpr unsigned int BENCH_MAX_SPOTS = 16;
+
+/// The ID of the satellite, gateways and terminals are numbered below it
+constexpr tal_id_t BENCH_SAT_ID = 100;
+
+/// The ID of the terminal of a spot, the gateway ID is the spot ID
+constexpr tal_id_t BENCH_ST_OFFSET = 32;
+
+/// The length of the IP packets
+constexpr std::size_t BENCH_PACKET_LENGTH = 64;
+
+/// The time after which the benchmark fails if the messages are not received
+constexpr double BENCH_TIMEOUT_MS = 120000;
+
+
+/// The benchmark parameters, shared by all the blocks
+static struct
+{
+	bool ip_regen;
+	unsigned int count;
+	std::unordered_map<spot_id_t, SpotTopology> spots_topology;
+	std::unordered_map<tal_id_t, Component> entities_type;
+} bench;
+
+/// The time the first message was sent
+static std::atomic<int64_t> bench_start_ns{0};
+/// The time the last message was received
+static std::atomic<int64_t> bench_end_ns{0};
+/// The number of messages received by all the stacks
+static std::atomic<uint64_t> bench_received{0};
+/// The number of messages the stacks have to receive
+static uint64_t bench_expected;
+
+
+static int64_t nowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+/**
+ * @brief A dispatcher that routes the synthetic topology
+ */
+class BenchSatDispatcher: public BlockSatDispatcher
+{
+ public:
+	using BlockSatDispatcher::BlockSatDispatcher;
+
+	bool onInit()
+	{
+		return this->initRoutes(bench.spots_topology, bench.entities_type);
+	}
+};
+
+
+/// The parameters of a stack
+struct StackSpecific
+{
+	spot_id_t spot_id;
+	Component component;
+};
+
+/**
+ * @brief A gateway or terminal stack below the dispatchers, it sends the
+ *        messages of its entity and counts the messages it receives
+ */
+class BenchStack: public Block
+{
+ public:
+	BenchStack(const std::string &name, StackSpecific):
+		Block(name)
+	{
+	}
+
+	class Upward: public RtUpward
+	{
+	 public:
+		Upward(const std::string &name, StackSpecific specific):
+			RtUpward(name),
+			spot_id{specific.spot_id},
+			component{specific.component}
+		{
+		}
+
+		bool onInit()
+		{
+			// start sending once all the blocks are running
+			this->addTimerEvent("bench_start", 1, false);
+			return true;
+		}
+
+		bool onEvent(const RtEvent *const event)
+		{
+			if(event->getType() != EventType::Timer)
+			{
+				Rt::reportError(this->getName(), std::this_thread::get_id(), true,
+				                "Unexpected event received");
+				return false;
+			}
+
+			int64_t no_start = 0;
+			bench_start_ns.compare_exchange_strong(no_start, nowNs());
+			for(unsigned int i = 0; i < bench.count; i++)
+			{
+				if(!(bench.ip_regen ? this->sendBurst() : this->sendFrame()))
+				{
+					Rt::reportError(this->getName(), std::this_thread::get_id(), true,
+					                "Cannot send message %u", i);
+					return false;
+				}
+			}
+			return true;
+		}
+
+	 private:
+		bool sendFrame()
+		{
+			// the input data carrier of the entity
+			CarrierType carrier_type = this->component == Component::gateway ?
+			                           CarrierType::DATA_IN_GW : CarrierType::DATA_IN_ST;
+			DvbFrame *frame = new DvbFrame();
+			frame->setMessageType(EmulatedMessageType::BbFrame);
+			frame->setSpot(this->spot_id);
+			frame->setCarrierId(this->spot_id * 10 + carrier_type);
+			if(!this->enqueueMessage((void **)&frame, sizeof(*frame),
+			                         to_underlying(InternalMessageType::encap_data)))
+			{
+				delete frame;
+				return false;
+			}
+			return true;
+		}
+
+		bool sendBurst()
+		{
+			unsigned char payload[BENCH_PACKET_LENGTH] = {0x45};
+			tal_id_t src_id = this->spot_id;
+			tal_id_t dst_id = this->spot_id + BENCH_ST_OFFSET;
+			if(this->component == Component::terminal)
+			{
+				std::swap(src_id, dst_id);
+			}
+			NetBurst *burst = new NetBurst();
+			burst->add(std::unique_ptr<NetPacket>(new NetPacket(payload, sizeof(payload),
+			                                                    "IP", NET_PROTO::IPV4,
+			                                                    0, src_id, dst_id, 20)));
+			if(!this->enqueueMessage((void **)&burst, sizeof(*burst),
+			                         to_underlying(InternalMessageType::decap_data)))
+			{
+				delete burst;
+				return false;
+			}
+			return true;
+		}
+
+		spot_id_t spot_id;
+		Component component;
+	};
+
+	class Downward: public RtDownward
+	{
+	 public:
+		Downward(const std::string &name, StackSpecific):
+			RtDownward(name)
+		{
+		}
+
+		bool onInit()
+		{
+			this->addTimerEvent("bench_timeout", BENCH_TIMEOUT_MS, false);
+			return true;
+		}
+
+		bool onEvent(const RtEvent *const event)
+		{
+			if(event->getType() != EventType::Message)
+			{
+				Rt::reportError(this->getName(), std::this_thread::get_id(), true,
+				                "Timeout while waiting for the messages");
+				return false;
+			}
+
+			auto msg = static_cast<const MessageEvent *>(event);
+			if(bench.ip_regen)
+			{
+				delete static_cast<NetBurst *>(msg->getData());
+			}
+			else
+			{
+				delete static_cast<DvbFrame *>(msg->getData());
+			}
+
+			if(++bench_received == bench_expected)
+			{
+				bench_end_ns = nowNs();
+				kill(getpid(), SIGTERM);
+			}
+			return true;
+		}
+	};
+};
+
+
+/**
+ * @brief The block regenerating the IP packets above the dispatchers,
+ *        it sends the bursts back down untouched
+ */
+class BenchRegen: public Block
+{
+ public:
+	using Block::Block;
+
+	class Upward: public RtUpward
+	{
+	 public:
+		using RtUpward::RtUpward;
+
+		bool onEvent(const RtEvent *const event)
+		{
+			if(event->getType() != EventType::Message)
+			{
+				Rt::reportError(this->getName(), std::this_thread::get_id(), true,
+				                "Unexpected event received");
+				return false;
+			}
+			auto msg = static_cast<const MessageEvent *>(event);
+			void *data = msg->getData();
+			if(msg->getMessageType() != to_underlying(InternalMessageType::decap_data))
+			{
+				// link up messages
+				return true;
+			}
+			return this->shareMessage(&data, msg->getLength(), msg->getMessageType());
+		}
+	};
+
+	class Downward: public RtDownward
+	{
+	 public:
+		using RtDownward::RtDownward;
+
+		bool onEvent(const RtEvent *const event)
+		{
+			if(event->getType() != EventType::Message)
+			{
+				Rt::reportError(this->getName(), std::this_thread::get_id(), true,
+				                "Unexpected event received");
+				return false;
+			}
+			auto msg = static_cast<const MessageEvent *>(event);
+			void *data = msg->getData();
+			return this->enqueueMessage(&data, msg->getLength(), msg->getMessageType());
+		}
+	};
+};
+
+
+/// Build a topology of spots served by the satellite with a gateway and a terminal
+static void buildTopology(unsigned int spots, RegenLevel regen_level)
+{
+	bench.entities_type[BENCH_SAT_ID] = Component::satellite;
+	for(spot_id_t spot_id = 1; spot_id <= spots; spot_id++)
+	{
+		SpotTopology topo;
+		topo.spot_id = spot_id;
+		topo.gw_id = spot_id;
+		topo.st_ids = {static_cast<tal_id_t>(spot_id + BENCH_ST_OFFSET)};
+		topo.sat_id_gw = BENCH_SAT_ID;
+		topo.sat_id_st = BENCH_SAT_ID;
+		topo.forward_regen_level = regen_level;
+		topo.return_regen_level = regen_level;
+		bench.spots_topology[spot_id] = topo;
+		bench.entities_type[spot_id] = Component::gateway;
+		bench.entities_type[spot_id + BENCH_ST_OFFSET] = Component::terminal;
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	bool sharded = true;
+	unsigned int spots = 1;
+	int args_used;
+
+	bench.ip_regen = false;
+	bench.count = 100000;
+
+	for(argc--, argv++; argc > 0; argc -= args_used, argv += args_used)
+	{
+		args_used = 1;
+
+		if(!strcmp(*argv, "-v"))
+		{
+			// print version
+			ERROR(VERSION);
+			return EXIT_FAILURE;
+		}
+		else if(!strcmp(*argv, "-h"))
+		{
+			// print help
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+		else if(!strcmp(*argv, "-i"))
+		{
+			bench.ip_regen = true;
+		}
+		else if(!strcmp(*argv, "-u"))
+		{
+			sharded = false;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-n"))
+		{
+			bench.count = atoi(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "-s"))
+		{
+			spots = atoi(argv[1]);
+			args_used++;
+		}
+		else
+		{
+			ERROR(USAGE);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(bench.count == 0 || spots == 0 || spots > BENCH_MAX_SPOTS)
+	{
+		ERROR(USAGE);
+		return EXIT_FAILURE;
+	}
+
+	buildTopology(spots, bench.ip_regen ? RegenLevel::IP : RegenLevel::Transparent);
+	bench_expected = 2ULL * spots * bench.count;
+
+	// the dispatchers, as built by the satellite entity
+	SatDispatcherConfig dispatch_cfg;
+	dispatch_cfg.entity_id = BENCH_SAT_ID;
+	dispatch_cfg.isl_enabled = bench.ip_regen;
+	dispatch_cfg.relay = sharded;
+	BenchSatDispatcher *block_dispatch = nullptr;
+	if(!sharded || bench.ip_regen)
+	{
+		block_dispatch = Rt::createBlock<BenchSatDispatcher>("Sat_Dispatch", dispatch_cfg);
+	}
+
+	std::vector<IslComponentPair> isl_keys;
+	if(bench.ip_regen)
+	{
+		auto block_regen = Rt::createBlock<BenchRegen>("Regen");
+		Rt::connectBlocks(block_regen, block_dispatch, {.connected_sat = BENCH_SAT_ID, .is_data_channel = true});
+		isl_keys.push_back({.connected_sat = BENCH_SAT_ID, .is_data_channel = true});
+	}
+
+	for(auto &&[spot_id, topo]: bench.spots_topology)
+	{
+		BenchSatDispatcher *block_spot_dispatch = block_dispatch;
+		if(sharded)
+		{
+			SatDispatcherConfig shard_cfg;
+			shard_cfg.entity_id = BENCH_SAT_ID;
+			shard_cfg.isl_enabled = bench.ip_regen;
+			shard_cfg.spots = {spot_id};
+			block_spot_dispatch = Rt::createBlock<BenchSatDispatcher>("Sat_Dispatch." + std::to_string(spot_id),
+			                                                          shard_cfg);
+			if(block_dispatch != nullptr)
+			{
+				block_dispatch->addShard(block_spot_dispatch, isl_keys);
+			}
+		}
+
+		for(auto &&component: {Component::gateway, Component::terminal})
+		{
+			std::string name = std::string(component == Component::gateway ? "Gw." : "St.") +
+			                   std::to_string(spot_id);
+			auto block_stack = Rt::createBlock<BenchStack>(name, StackSpecific{spot_id, component});
+			Rt::connectBlocks(block_spot_dispatch, block_stack, {spot_id, component, !bench.ip_regen});
+		}
+	}
+
+	auto output = Output::Get();
+	output->configureTerminalOutput();
+	// registered by the entity in the emulator
+	NetBurst::log_net_burst = output->registerLog(LEVEL_WARNING, "NetBurst");
+	output->finalizeConfiguration();
+
+	if(!Rt::run(true) || bench_received != bench_expected)
+	{
+		ERROR("%lu messages received out of %lu\n", bench_received.load(), bench_expected);
+		return EXIT_FAILURE;
+	}
+
+	double duration_s = (bench_end_ns - bench_start_ns) / 1e9;
+	printf("%u spots, %s, %s: %lu messages in %.3f s, %.0f messages/s\n",
+	       spots, sharded ? "sharded" : "single dispatcher",
+	       bench.ip_regen ? "IP regenerative" : "transparent",
+	       bench_expected, duration_s, bench_expected / duration_s);
+	return EXIT_SUCCESS;
+}
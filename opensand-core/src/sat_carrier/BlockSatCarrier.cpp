@@ -40,6 +40,7 @@
 #include <opensand_output/Output.h>
 
 #include "DvbFrame.h"
+#include "DvbFrameBatch.h"
 #include "OpenSandFrames.h"
 #include "OpenSandCore.h"
 
@@ -78,20 +79,30 @@ bool BlockSatCarrier::Downward::onEvent(const RtEvent *const event)
 	{
 		case EventType::Message:
 		{
-			DvbFrame *dvb_frame = (DvbFrame *)((MessageEvent *)event)->getData();
+			auto msg_event = static_cast<const MessageEvent *>(event);
+			if(to_enum<InternalMessageType>(msg_event->getMessageType()) == InternalMessageType::batch)
+			{
+				std::unique_ptr<DvbFrameBatch> frames{static_cast<DvbFrameBatch *>(msg_event->getData())};
+
+				LOG(this->log_receive, LEVEL_DEBUG,
+				    "batch of %zu frames received\n",
+				    frames->size());
+
+				for(auto &&frame: *frames)
+				{
+					this->sendFrame(*frame);
+				}
+				break;
+			}
+
+			DvbFrame *dvb_frame = (DvbFrame *)msg_event->getData();
 
 			LOG(this->log_receive, LEVEL_DEBUG,
 			    "%u-bytes %s message event received\n",
 			    dvb_frame->getMessageLength(),
 			    event->getName().c_str());
 
-			if(!this->out_channel_set.send(dvb_frame->getCarrierId(),
-			                               dvb_frame->getRawData(),
-			                               dvb_frame->getTotalLength()))
-			{
-				LOG(this->log_receive, LEVEL_ERROR,
-				    "error when sending data\n");
-			}
+			this->sendFrame(*dvb_frame);
 			delete dvb_frame;
 		}
 		break;
@@ -105,6 +116,17 @@ bool BlockSatCarrier::Downward::onEvent(const RtEvent *const event)
 	return true;
 }
 
+void BlockSatCarrier::Downward::sendFrame(DvbFrame &dvb_frame)
+{
+	if(!this->out_channel_set.send(dvb_frame.getCarrierId(),
+	                               dvb_frame.getRawData(),
+	                               dvb_frame.getTotalLength()))
+	{
+		LOG(this->log_receive, LEVEL_ERROR,
+		    "error when sending data\n");
+	}
+}
+
 bool BlockSatCarrier::Upward::onEvent(const RtEvent *const event)
 {
 	bool status = true;
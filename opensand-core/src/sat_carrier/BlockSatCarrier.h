@@ -38,6 +38,7 @@
 #define BlockSatCarrier_H
 
 #include "sat_carrier_channel_set.h"
+#include "DvbFrame.h"
 
 #include <opensand_rt/Rt.h>
 #include <opensand_rt/RtChannel.h>
@@ -111,6 +112,13 @@ public:
 		bool onEvent(const RtEvent *const event);
 
 	private:
+		/**
+		 * @brief Send a DVB frame on the output channel of its carrier
+		 *
+		 * @param dvb_frame  the frame to send
+		 */
+		void sendFrame(DvbFrame &dvb_frame);
+
 		/// the IP address for emulation newtork
 		std::string ip_addr;
 		/// the terminal id for the emulation newtork
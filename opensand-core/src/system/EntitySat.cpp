@@ -53,6 +53,12 @@
  *
  * </pre>
  *
+ * When the satellite handles several spots, none of them regenerated up
+ * to IP, each spot gets its own BlockSatDispatcher shard so that the
+ * spots are dispatched in parallel. The shards send directly to the ISL
+ * blocks, the messages of these blocks reach the shards through a relay
+ * BlockSatDispatcher.
+ *
  */
 
 #include <sstream>
@@ -88,10 +94,33 @@ bool EntitySat::createSpecificBlocks()
 		auto Conf = OpenSandModelConf::Get();
 		const auto &spot_topo = Conf->getSpotsTopology();
 
+		std::unordered_set<spot_id_t> local_spots;
+		bool ip_regen = false;
+		for (auto &&[spot_id, topo]: spot_topo)
+		{
+			if (topo.sat_id_gw == instance_id || topo.sat_id_st == instance_id)
+			{
+				local_spots.insert(spot_id);
+			}
+			if ((topo.sat_id_gw == instance_id && topo.forward_regen_level == RegenLevel::IP) ||
+			    (topo.sat_id_st == instance_id && topo.return_regen_level == RegenLevel::IP))
+			{
+				ip_regen = true;
+			}
+		}
+		// the messages going down from the IP blocks cross the relay, which
+		// costs more than the shards gain: keep a single dispatcher then
+		bool sharded = local_spots.size() > 1 && !ip_regen;
+
 		SatDispatcherConfig sat_dispatch_cfg;
 		sat_dispatch_cfg.entity_id = instance_id;
 		sat_dispatch_cfg.isl_enabled = this->isl_enabled;
-		auto block_sat_dispatch = Rt::createBlock<BlockSatDispatcher>("Sat_Dispatch", sat_dispatch_cfg);
+		sat_dispatch_cfg.relay = sharded;
+		BlockSatDispatcher *block_sat_dispatch = nullptr;
+		if (!sharded || this->isl_enabled)
+		{
+			block_sat_dispatch = Rt::createBlock<BlockSatDispatcher>("Sat_Dispatch", sat_dispatch_cfg);
+		}
 
 		int isl_delay = 0;
 		if (isl_enabled)
@@ -103,6 +132,7 @@ bool EntitySat::createSpecificBlocks()
 			}
 		}
 
+		std::vector<IslComponentPair> isl_keys;
 		std::size_t index = 0;
 		for (auto&& cfg : isl_config)
 		{
@@ -117,6 +147,7 @@ bool EntitySat::createSpecificBlocks()
 					};
 					auto block_interco = Rt::createBlock<BlockInterconnectUpward>("Interconnect.Isl", interco_cfg);
 					Rt::connectBlocks(block_interco, block_sat_dispatch, {.connected_sat = cfg.linked_sat_id, .is_data_channel = false});
+					isl_keys.push_back({.connected_sat = cfg.linked_sat_id, .is_data_channel = false});
 				}
 					break;
 				case IslType::LanAdaptation:
@@ -131,6 +162,7 @@ bool EntitySat::createSpecificBlocks()
 					};
 					auto block_lan_adapt = Rt::createBlock<BlockLanAdaptation>(is_used_for_isl ? "Lan_Adaptation.Isl" : "Lan_Adaptation", la_cfg);
 					Rt::connectBlocks(block_lan_adapt, block_sat_dispatch, {.connected_sat = cfg.linked_sat_id, .is_data_channel = true});
+					isl_keys.push_back({.connected_sat = cfg.linked_sat_id, .is_data_channel = true});
 				}
 					break;
 				case IslType::None:
@@ -146,9 +178,24 @@ bool EntitySat::createSpecificBlocks()
 
 		for (auto &&[spot_id, topo]: spot_topo)
 		{
+			auto block_spot_dispatch = block_sat_dispatch;
+			if (sharded && local_spots.find(spot_id) != local_spots.end())
+			{
+				SatDispatcherConfig shard_cfg;
+				shard_cfg.entity_id = instance_id;
+				shard_cfg.isl_enabled = this->isl_enabled;
+				shard_cfg.spots = {spot_id};
+				block_spot_dispatch = Rt::createBlock<BlockSatDispatcher>("Sat_Dispatch." + std::to_string(spot_id),
+				                                                          shard_cfg);
+				if (block_sat_dispatch != nullptr)
+				{
+					block_sat_dispatch->addShard(block_spot_dispatch, isl_keys);
+				}
+			}
+
 			if (topo.sat_id_gw == instance_id)
 			{
-				if (!createStack<BlockDvbTal>(block_sat_dispatch, spot_id, Component::gateway,
+				if (!createStack<BlockDvbTal>(block_spot_dispatch, spot_id, Component::gateway,
 				                              topo.forward_regen_level, topo.return_regen_level))
 				{
 					DFLTLOG(LEVEL_CRITICAL,
@@ -161,7 +208,7 @@ bool EntitySat::createSpecificBlocks()
 
 			if (topo.sat_id_st == instance_id)
 			{
-				if (!createStack<BlockDvbNcc>(block_sat_dispatch, spot_id, Component::terminal,
+				if (!createStack<BlockDvbNcc>(block_spot_dispatch, spot_id, Component::terminal,
 				                              topo.forward_regen_level, topo.return_regen_level))
 				{
 					DFLTLOG(LEVEL_CRITICAL,
@@ -42,6 +42,8 @@
 
 #include <opensand_output/Output.h>
 
+#include <algorithm>
+#include <array>
 #include <utility>
 
 
@@ -51,8 +53,39 @@ constexpr std::size_t MAX_CNI_EXT_LEN = 6;
 constexpr std::size_t GSE_MANDATORY_FIELDS_LENGTH = 2;
 constexpr std::size_t GSE_FRAG_ID_LENGTH = 1;
 constexpr std::size_t GSE_TOTAL_LENGTH_LENGTH = 2;
+constexpr std::size_t GSE_PROTOCOL_TYPE_LENGTH = 2;
+constexpr std::size_t GSE_MAX_TOTAL_LENGTH = 0x0FFF + GSE_MANDATORY_FIELDS_LENGTH;
 
 
+
+/**
+ * @brief Virtual fragment and buffer reused to refragment GSE packets
+ *
+ * The packet handler is shared by blocks running in different threads,
+ * so each thread keeps its own fragment.
+ */
+struct RefragFragment
+{
+	RefragFragment():
+		vfrag{nullptr},
+		buf{}
+	{
+	}
+
+	~RefragFragment()
+	{
+		if(this->vfrag != nullptr)
+		{
+			gse_free_vfrag_no_alloc(&this->vfrag, 0, 1);
+		}
+	}
+
+	gse_vfrag_t *vfrag;
+	std::array<unsigned char, GSE_MAX_REFRAG_HEAD_OFFSET + GSE_MAX_TOTAL_LENGTH> buf;
+};
+
+static thread_local RefragFragment refrag_fragment;
+
 static int encodeHeaderCniExtensions(unsigned char *ext,
                                      size_t *length,  
                                      uint16_t *protocol_type, 
@@ -295,7 +328,7 @@ Gse::Context::~Context()
 }
 
 NetBurst *Gse::Context::encapsulate(NetBurst *burst,
-                                    std::map<long, int> &time_contexts)
+                                    std::map<int, long> &time_contexts)
 {
 	NetBurst *gse_packets = nullptr;
 
@@ -364,7 +397,8 @@ NetBurst *Gse::Context::encapsulate(NetBurst *burst,
 		{
 			continue;
 		}
-		time_contexts.insert(std::make_pair(time, context_id));
+		// the last packet gives the state of the context
+		time_contexts[context_id] = time;
 	}
 
 	// delete the burst and all packets in it
@@ -631,12 +665,11 @@ bool Gse::Context::encapPacket(NetPacket *packet,
 		if(status == GSE_STATUS_OK)
 		{
       std::unique_ptr<NetPacket> gse;
-			Data gse_packet(gse_get_vfrag_start(this->vfrag_gse),
-			                gse_get_vfrag_length(this->vfrag_gse));
       try
       {
-        // create a GSE packet from fragments computed by the GSE library
-        gse = this->createPacket(gse_packet,
+        // create a GSE packet from fragments computed by the GSE library,
+        // the packet is copied once from the GSE buffer
+        gse = this->createPacket(gse_get_vfrag_start(this->vfrag_gse),
                                  gse_get_vfrag_length(this->vfrag_gse),
                                  qos, src_tal_id, dst_tal_id);
       }
@@ -752,9 +785,8 @@ NetBurst *Gse::Context::deencapsulate(NetBurst *burst)
 		}
 
 		// Create a virtual fragment containing the GSE packet
-		// TODO : this function could be optimized (preallocating vfrag_gse), but
-		// gse_deencap_packet call below frees vfrag struct (need to change that
-		// function in order to be no_alloc compatible).
+		// It cannot be preallocated nor lent the packet buffer:
+		// gse_deencap_packet frees the vfrag and its buffer itself.
 		status = gse_create_vfrag_with_data(&vfrag_gse, packet->getTotalLength(),
 		                                    0, 0,
 		                                    packet->getRawData(),
@@ -885,11 +917,9 @@ bool Gse::Context::deencapFixedLength(gse_vfrag_t *vfrag_pdu,
 	while(gse_get_vfrag_length(vfrag_pdu) > 0)
 	{
     std::unique_ptr<NetPacket> packet;
-		Data pdu_frag(gse_get_vfrag_start(vfrag_pdu),
-		              this->current_upper->getFixedLength());
     try
     {
-      packet = this->current_upper->build(pdu_frag,
+      packet = this->current_upper->build(gse_get_vfrag_start(vfrag_pdu),
                                           this->current_upper->getFixedLength(),
                                           qos, src_tal_id, dst_tal_id);
     }
@@ -898,7 +928,6 @@ bool Gse::Context::deencapFixedLength(gse_vfrag_t *vfrag_pdu,
 			LOG(this->log, LEVEL_ERROR,
 			    "cannot build a %s packet, drop the GSE packet\n",
 			    this->current_upper->getName().c_str());
-			gse_free_vfrag(&vfrag_pdu);
 			// move the data pointer after the current packet
 			status = gse_shift_vfrag(vfrag_pdu,
 			                         this->current_upper->getFixedLength(), 0);
@@ -951,8 +980,6 @@ bool Gse::Context::deencapVariableLength(gse_vfrag_t *vfrag_pdu,
 	uint8_t src_tal_id, dst_tal_id;
 	uint8_t qos;
 	unsigned int pkt_nbr = 0;
-	Data pdu_frag(gse_get_vfrag_start(vfrag_pdu),
-	              gse_get_vfrag_length(vfrag_pdu));
 
 	src_tal_id = Gse::getSrcTalIdFromLabel(label);
 	dst_tal_id = Gse::getDstTalIdFromLabel(label);
@@ -961,7 +988,8 @@ bool Gse::Context::deencapVariableLength(gse_vfrag_t *vfrag_pdu,
   std::unique_ptr<NetPacket> packet;
   try
   {
-    packet = this->current_upper->build(pdu_frag,
+    // the PDU is copied once from the GSE buffer
+    packet = this->current_upper->build(gse_get_vfrag_start(vfrag_pdu),
                                         gse_get_vfrag_length(vfrag_pdu),
                                         qos, src_tal_id, dst_tal_id);
   }
@@ -1203,6 +1231,34 @@ drop:
 	return NULL;
 }
 
+double Gse::Context::getFillRatio(int context_id) const
+{
+	GseIdentifier identifier((context_id >> 8) & 0x1f,
+	                         (context_id >> 3) & 0x1f,
+	                         context_id & 0x07);
+	auto context_it = this->contexts.find(&identifier);
+	if(context_it == this->contexts.end())
+	{
+		return 0.0;
+	}
+	return static_cast<double>(context_it->second->length()) / GSE_MAX_PACKET_LENGTH;
+}
+
+int Gse::Context::getContextId(tal_id_t src_tal_id,
+                               tal_id_t dst_tal_id,
+                               qos_t qos) const
+{
+	// only the packets of fixed length are held in the contexts
+	if(this->current_upper == nullptr ||
+	   this->current_upper->getFixedLength() == 0)
+	{
+		return -1;
+	}
+	return ((src_tal_id & 0x1f) << 8) |
+	       ((dst_tal_id & 0x1f) << 3) |
+	       (qos & 0x07);
+}
+
 NetBurst *Gse::Context::flushAll()
 {
 	//TODO
@@ -1210,6 +1266,17 @@ NetBurst *Gse::Context::flushAll()
 }
 
 std::unique_ptr<NetPacket> Gse::PacketHandler::build(const Data &data,
+                                                     size_t data_length,
+                                                     uint8_t qos,
+                                                     uint8_t src_tal_id,
+                                                     uint8_t dst_tal_id) const
+{
+	return this->build(data.data(), std::min(data.length(), data_length),
+	                   qos, src_tal_id, dst_tal_id);
+}
+
+
+std::unique_ptr<NetPacket> Gse::PacketHandler::build(const unsigned char *data,
                                                      size_t data_length,
                                                      uint8_t UNUSED(_qos),
                                                      uint8_t UNUSED(_src_tal_id),
@@ -1226,7 +1293,7 @@ std::unique_ptr<NetPacket> Gse::PacketHandler::build(const Data &data,
 	uint8_t dst_tal_id = BROADCAST_TAL_ID;
 	uint8_t frag_id;
 	uint16_t header_length = 0;
-	unsigned char *packet = (unsigned char *)data.c_str();
+	unsigned char *packet = const_cast<unsigned char *>(data);
 
 	status = gse_get_start_indicator(packet, &s);
 	if(status != GSE_STATUS_OK)
@@ -1337,27 +1404,57 @@ bool Gse::PacketHandler::getChunk(std::unique_ptr<NetPacket> packet,
                                   std::unique_ptr<NetPacket>& data,
                                   std::unique_ptr<NetPacket>& remaining_data) const
 {
-	gse_vfrag_t *first_frag;
-	gse_vfrag_t *second_frag;
+	gse_vfrag_t *first_frag = nullptr;
+	gse_vfrag_t *second_frag = nullptr;
 	gse_status_t status;
 	uint8_t frag_id;
 
 	frag_id = Gse::getFragId(packet.get());
 
+	if(packet->getTotalLength() > GSE_MAX_TOTAL_LENGTH)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "GSE packet too long to be refragmented (%zu bytes)\n",
+		    packet->getTotalLength());
+		goto error;
+	}
+
 	LOG(this->log, LEVEL_DEBUG,
-	    "Create a virtual fragment with GSE packet to "
-	    "refragment it\n");
-	// TODO : this vfrag creation could be optimized with no_alloc
-	status = gse_create_vfrag_with_data(&first_frag,
-	                                    packet->getTotalLength(),
-	                                    GSE_MAX_REFRAG_HEAD_OFFSET, 0,
-	                                    packet->getRawData(),
-	                                    packet->getTotalLength());
+	    "Affect the thread buffer to a virtual fragment with GSE "
+	    "packet to refragment it\n");
+	// the buffer keeps room in front of the packet for the fields
+	// added by the refragmentation
+	if(refrag_fragment.vfrag == nullptr)
+	{
+		status = gse_allocate_vfrag(&refrag_fragment.vfrag, 1);
+		if(status != GSE_STATUS_OK)
+		{
+			LOG(this->log, LEVEL_ERROR,
+			    "cannot allocate the refragmentation vfrag (%s)\n",
+			    gse_get_status(status));
+			refrag_fragment.vfrag = nullptr;
+			goto error;
+		}
+	}
+	status = gse_affect_buf_vfrag(refrag_fragment.vfrag,
+	                              refrag_fragment.buf.data(),
+	                              GSE_MAX_REFRAG_HEAD_OFFSET, 0,
+	                              packet->getTotalLength());
+	if(status != GSE_STATUS_OK)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "cannot affect buf to the refragmentation vfrag (%s)\n",
+		    gse_get_status(status));
+		goto error;
+	}
+	first_frag = refrag_fragment.vfrag;
+	status = gse_copy_data(first_frag, packet->getRawData(),
+	                       packet->getTotalLength());
 	if(status != GSE_STATUS_OK)
 	{
 		LOG(this->log, LEVEL_ERROR,
-		    "Failed to create a virtual fragment for the GSE packet "
-		    "refragmentation (%s)\n", gse_get_status(status));
+		    "Failed to copy the GSE packet for its refragmentation "
+		    "(%s)\n", gse_get_status(status));
 		goto error;
 	}
 
@@ -1392,11 +1489,7 @@ bool Gse::PacketHandler::getChunk(std::unique_ptr<NetPacket> packet,
 	else if(status == GSE_STATUS_OK)
 	{
 		// the packet has been fragmented in order to be encapsulated partially
-		// (use case 2)
-		Data gse_first(gse_get_vfrag_start(first_frag),
-		               gse_get_vfrag_length(first_frag));
-		Data gse_second(gse_get_vfrag_start(second_frag),
-		                gse_get_vfrag_length(second_frag));
+		// (use case 2), the fragments are copied once from the GSE buffer
 
 		LOG(this->log, LEVEL_INFO,
 		    "packet has been refragmented, first fragment is "
@@ -1405,7 +1498,7 @@ bool Gse::PacketHandler::getChunk(std::unique_ptr<NetPacket> packet,
 		// add the first fragment to the BB frame
 		try
 		{
-			data = this->build(gse_first,
+			data = this->build(gse_get_vfrag_start(first_frag),
 			                   gse_get_vfrag_length(first_frag),
 			                   packet->getQos(),
 			                   packet->getSrcTalId(),
@@ -1421,7 +1514,7 @@ bool Gse::PacketHandler::getChunk(std::unique_ptr<NetPacket> packet,
 		// create a new NetPacket containing the second fragment
 		try
 		{
-			remaining_data = this->build(gse_second,
+			remaining_data = this->build(gse_get_vfrag_start(second_frag),
 			                             gse_get_vfrag_length(second_frag),
 			                             packet->getQos(),
 			                             packet->getSrcTalId(),
@@ -1443,11 +1536,13 @@ bool Gse::PacketHandler::getChunk(std::unique_ptr<NetPacket> packet,
 	}
 
 success:
+	// the second fragment is allocated by the library on the same
+	// buffer, release it before resetting the thread fragment
 	if(second_frag != nullptr)
 	{
 		gse_free_vfrag(&second_frag);
 	}
-	gse_free_vfrag(&first_frag);
+	gse_free_vfrag_no_alloc(&first_frag, 1, 0);
 	return true;
 
 error:
@@ -1459,7 +1554,7 @@ error:
 	}
 	if (first_frag != nullptr)
 	{
-		gse_free_vfrag(&first_frag);
+		gse_free_vfrag_no_alloc(&first_frag, 1, 0);
 	}
 
 	return false;
@@ -1645,16 +1740,12 @@ bool Gse::PacketHandler::setHeaderExtensions(std::unique_ptr<NetPacket> packet,
                                              std::string callback_name,
                                              void *opaque)
 {
-
-	gse_status_t status;
-	gse_vfrag_t *vfrag;
-	gse_vfrag_t *vfrag2;
-	uint32_t crc;
+	std::size_t ext_offset;
 
 	// Empty GSE packet
 	// TODO macro for sizes
 	// TODO endianess !!
-	static unsigned char empty_gse[7] = 
+	unsigned char empty_gse[7] = 
 	{
 		0xd0, /* LT = 01 (three bytes label) */
 		0x05, /* length */
@@ -1672,6 +1763,121 @@ bool Gse::PacketHandler::setHeaderExtensions(std::unique_ptr<NetPacket> packet,
 		packet.reset(new NetPacket(empty_gse, 7));
 	}
 
+	// Complete packets without extension: write the extension and the
+	// new header straight into the new packet, as libgse would
+	auto callback = this->encap_callback.find(callback_name);
+	const unsigned char *packet_data = packet->getRawData();
+	std::size_t packet_length = packet->getTotalLength();
+	if(callback != this->encap_callback.end() &&
+	   packet_length + MAX_CNI_EXT_LEN <= GSE_MAX_TOTAL_LENGTH &&
+	   getCompletePacketExtOffset(packet_data, packet_length, ext_offset))
+	{
+		uint16_t protocol_type = (packet_data[2] << 8) | packet_data[3];
+		if(protocol_type >= GSE_MIN_ETHER_TYPE)
+		{
+			return this->addHeaderExtension(packet, new_packet, ext_offset,
+			                                callback->second, opaque);
+		}
+	}
+
+	if(callback == this->encap_callback.end())
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "unknown header extension callback %s\n", callback_name.c_str());
+		return false;
+	}
+	return this->addLibgseHeaderExtension(packet, new_packet,
+	                                      callback->second, opaque);
+}
+
+
+bool Gse::PacketHandler::getHeaderExtensions(const std::unique_ptr<NetPacket>& packet,
+                                             std::string callback_name,
+                                             void *opaque)
+{
+	gse_status_t status;
+	std::size_t ext_offset;
+
+	// Complete packets: read the extension in place
+	auto callback = this->deencap_callback.find(callback_name);
+	unsigned char *packet_data = packet->getRawData();
+	if(callback != this->deencap_callback.end() &&
+	   getCompletePacketExtOffset(packet_data, packet->getTotalLength(), ext_offset))
+	{
+		uint16_t protocol_type = (packet_data[2] << 8) | packet_data[3];
+		if(protocol_type >= GSE_MIN_ETHER_TYPE)
+		{
+			// no extension
+			return true;
+		}
+		std::size_t ext_length = 0;
+		if(callback->second(packet_data + ext_offset, &ext_length,
+		                    &protocol_type, protocol_type, opaque) != 0)
+		{
+			LOG(this->log, LEVEL_ERROR,
+			    "cannot deencapsulate header extension\n");
+			return false;
+		}
+		return true;
+	}
+
+	// Get the in-band extension
+	status = gse_deencap_get_header_ext(packet->getRawData(),
+	                                    this->deencap_callback[callback_name],
+	                                    opaque);
+	if(status != GSE_STATUS_OK && status != GSE_STATUS_EXTENSION_UNAVAILABLE)
+	{
+		LOG(this->log, LEVEL_ERROR, 
+		    "cannot deencapsulate header extension (%s)",
+		    gse_get_status(status));
+		return false;
+	}
+
+	return true;
+}
+
+
+bool Gse::PacketHandler::getCompletePacketExtOffset(const unsigned char *packet,
+                                                   std::size_t length,
+                                                   std::size_t &ext_offset)
+{
+	// S and E bits both set
+	if(length < GSE_MANDATORY_FIELDS_LENGTH || (packet[0] & 0xC0) != 0xC0)
+	{
+		return false;
+	}
+
+	// LT: 6, 3 bytes or no label (broadcast or re-use)
+	std::size_t label_length = 0;
+	switch((packet[0] >> 4) & 0x03)
+	{
+		case 0:
+			label_length = 6;
+			break;
+		case 1:
+			label_length = 3;
+			break;
+		default:
+			break;
+	}
+
+	std::size_t gse_length = ((packet[0] & 0x0F) << 8) | packet[1];
+	ext_offset = GSE_MANDATORY_FIELDS_LENGTH + GSE_PROTOCOL_TYPE_LENGTH + label_length;
+	return gse_length + GSE_MANDATORY_FIELDS_LENGTH == length &&
+	       ext_offset <= length;
+}
+
+
+bool Gse::PacketHandler::addLibgseHeaderExtension(const std::unique_ptr<NetPacket>& packet,
+                                                  std::unique_ptr<NetPacket>& new_packet,
+                                                  gse_encap_build_header_ext_cb_t callback,
+                                                  void *opaque)
+{
+	gse_status_t status;
+	gse_vfrag_t *vfrag;
+	gse_vfrag_t *vfrag2 = nullptr;
+	uint32_t crc;
+
 	// TODO : this could be optimized using no_alloc
 	status = gse_create_vfrag_with_data(&vfrag, GSE_MAX_PACKET_LENGTH,
 	                                    MAX_CNI_EXT_LEN, 0,
@@ -1688,7 +1894,7 @@ bool Gse::PacketHandler::setHeaderExtensions(std::unique_ptr<NetPacket> packet,
 	// TODO: once packet refragmentation will be handled, set QoS to actual
 	// value (see NOTE #2).
 	status = gse_encap_add_header_ext(vfrag, &vfrag2, &crc,
-	                                  this->encap_callback[callback_name],
+	                                  callback,
 	                                  GSE_MAX_PACKET_LENGTH, 0, 0,
 	                                  /* qos */ 0,
 	                                  opaque);
@@ -1737,6 +1943,7 @@ bool Gse::PacketHandler::setHeaderExtensions(std::unique_ptr<NetPacket> packet,
 	{
 		LOG(this->log, LEVEL_ERROR, 
 		    "failed to create the GSE packet with extensions\n");
+		gse_free_vfrag(&vfrag);
 		return false;
 	}
 
@@ -1748,34 +1955,54 @@ bool Gse::PacketHandler::setHeaderExtensions(std::unique_ptr<NetPacket> packet,
 }
 
 
-bool Gse::PacketHandler::getHeaderExtensions(const std::unique_ptr<NetPacket>& packet,
-                                             std::string callback_name,
-                                             void *opaque)
+bool Gse::PacketHandler::addHeaderExtension(const std::unique_ptr<NetPacket>& packet,
+                                            std::unique_ptr<NetPacket>& new_packet,
+                                            std::size_t ext_offset,
+                                            gse_encap_build_header_ext_cb_t callback,
+                                            void *opaque)
 {
-	gse_vfrag_t *gse_data;
-	gse_status_t status;
-
-	status = gse_create_vfrag_with_data(&gse_data,
-	                                    packet->getTotalLength(),
-	                                    0, 0,
-	                                    packet->getRawData(),
-	                                    packet->getTotalLength());
-	if(status != GSE_STATUS_OK)
+	std::array<unsigned char, GSE_MAX_TOTAL_LENGTH> buffer;
+	const unsigned char *packet_data = packet->getRawData();
+	std::size_t packet_length = packet->getTotalLength();
+	uint16_t protocol_type = (packet_data[2] << 8) | packet_data[3];
+	uint16_t ext_protocol_type = protocol_type;
+	std::size_t ext_length = 0;
+
+	// the callback writes the extension right after the label
+	if(callback(buffer.data() + ext_offset, &ext_length,
+	            &ext_protocol_type, protocol_type, opaque) != 0 ||
+	   ext_length > MAX_CNI_EXT_LEN)
 	{
-		LOG(this->log, LEVEL_ERROR, "cannot create virtual fragment (%s)",
-		    gse_get_status(status));
+		LOG(this->log, LEVEL_ERROR,
+		    "cannot build header extension in packet\n");
 		return false;
 	}
-	
-	// Get the in-band extension
-	status = gse_deencap_get_header_ext(packet->getRawData(),
-	                                    this->deencap_callback[callback_name],
-	                                    opaque);
-	if(status != GSE_STATUS_OK && status != GSE_STATUS_EXTENSION_UNAVAILABLE)
+
+	// header with the new length and protocol type, label, then the PDU
+	// after the extension
+	std::size_t length = packet_length + ext_length;
+	std::size_t gse_length = length - GSE_MANDATORY_FIELDS_LENGTH;
+	buffer[0] = (packet_data[0] & 0xF0) | ((gse_length >> 8) & 0x0F);
+	buffer[1] = gse_length & 0xFF;
+	buffer[2] = (ext_protocol_type >> 8) & 0xFF;
+	buffer[3] = ext_protocol_type & 0xFF;
+	std::copy(packet_data + GSE_MANDATORY_FIELDS_LENGTH + GSE_PROTOCOL_TYPE_LENGTH,
+	          packet_data + ext_offset,
+	          buffer.begin() + GSE_MANDATORY_FIELDS_LENGTH + GSE_PROTOCOL_TYPE_LENGTH);
+	std::copy(packet_data + ext_offset,
+	          packet_data + packet_length,
+	          buffer.begin() + ext_offset + ext_length);
+
+	try
 	{
-		LOG(this->log, LEVEL_ERROR, 
-		    "cannot deencapsulate header extension (%s)",
-		    gse_get_status(status));
+		new_packet = this->build(buffer.data(), length,
+		                         /* qos and tal_ids are read from label */
+		                         0, 0, packet->getDstTalId());
+	}
+	catch (const std::bad_alloc&)
+	{
+		LOG(this->log, LEVEL_ERROR,
+		    "failed to create the GSE packet with extensions\n");
 		return false;
 	}
 
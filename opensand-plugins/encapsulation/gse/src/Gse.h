@@ -106,10 +106,14 @@ class Gse: public EncapPlugin
 		~Context();
 
 		bool init();
-		NetBurst *encapsulate(NetBurst *burst, std::map<long, int> &time_contexts);
+		NetBurst *encapsulate(NetBurst *burst, std::map<int, long> &time_contexts);
 		NetBurst *deencapsulate(NetBurst *burst);
 		NetBurst *flush(int context_id);
 		NetBurst *flushAll();
+		double getFillRatio(int context_id) const;
+		int getContextId(tal_id_t src_tal_id,
+		                 tal_id_t dst_tal_id,
+		                 qos_t qos) const;
 
 	 private:
 		bool encapFixedLength(NetPacket *packet, NetBurst *gse_packets, long &time);
@@ -146,6 +150,11 @@ class Gse: public EncapPlugin
 		                                 uint8_t qos,
 		                                 uint8_t src_tal_id,
 		                                 uint8_t dst_tal_id) const override;
+		std::unique_ptr<NetPacket> build(const unsigned char *data,
+		                                 std::size_t data_length,
+		                                 uint8_t qos,
+		                                 uint8_t src_tal_id,
+		                                 uint8_t dst_tal_id) const override;
 		size_t getFixedLength() const {return 0;};
 		size_t getMinLength() const {return 3;};
 		size_t getLength(const unsigned char *data) const;
@@ -165,6 +174,53 @@ class Gse: public EncapPlugin
 		                         void *opaque) override;
 
 	 protected:
+		/**
+		 * @brief Add a header extension to a complete GSE packet
+		 *        without extension, like gse_encap_add_header_ext
+		 *        but without intermediate virtual fragments
+		 *
+		 * @param packet      the GSE packet
+		 * @param new_packet  OUT: the GSE packet with the extension
+		 * @param ext_offset  the offset of the extension in the packet
+		 * @param callback    the callback building the extension
+		 * @param opaque      the data given to the callback
+		 * @return true on success, false otherwise
+		 */
+		bool addHeaderExtension(const std::unique_ptr<NetPacket>& packet,
+		                        std::unique_ptr<NetPacket>& new_packet,
+		                        std::size_t ext_offset,
+		                        gse_encap_build_header_ext_cb_t callback,
+		                        void *opaque);
+
+		/**
+		 * @brief Add a header extension to a GSE packet or fragment
+		 *        with gse_encap_add_header_ext
+		 *
+		 * @param packet      the GSE packet
+		 * @param new_packet  OUT: the GSE packet with the extension
+		 * @param callback    the callback building the extension
+		 * @param opaque      the data given to the callback
+		 * @return true on success, false otherwise
+		 */
+		bool addLibgseHeaderExtension(const std::unique_ptr<NetPacket>& packet,
+		                              std::unique_ptr<NetPacket>& new_packet,
+		                              gse_encap_build_header_ext_cb_t callback,
+		                              void *opaque);
+
+		/**
+		 * @brief Locate the header extensions of a complete GSE packet
+		 *
+		 * Fragments are left to libgse as extensions change their CRC.
+		 *
+		 * @param packet      the GSE packet
+		 * @param length      the length of the GSE packet
+		 * @param ext_offset  OUT: the offset of the extensions (or the PDU)
+		 * @return true if the packet is complete and its header is valid
+		 */
+		static bool getCompletePacketExtOffset(const unsigned char *packet,
+		                                       std::size_t length,
+		                                       std::size_t &ext_offset);
+
 		bool getChunk(std::unique_ptr<NetPacket> packet,
                   std::size_t remaining_length,
 		              std::unique_ptr<NetPacket>& data,
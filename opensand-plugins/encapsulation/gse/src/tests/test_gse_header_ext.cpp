@@ -0,0 +1,293 @@
+/*
+ *
+ * OpenSAND is an emulation testbed aiming to represent in a cost effective way a
+ * satellite telecommunication system for research and engineering activities.
+ *
+ *
+ * Copyright © 2019 TAS
+ * Copyright © 2019 CNES
+ *
+ *
+ * This file is part of the OpenSAND testbed.
+ *
+ *
+ * OpenSAND is free software : you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see http://www.gnu.org/licenses/.
+ *
+ */
+/*
+ * GSE header extensions test
+ *
+ * The application adds header extensions to complete GSE packets with the
+ * in place path of the plugin and with libgse, for each label type,
+ * protocol type, PDU length and extension length, and checks that both
+ * packets are identical. It also checks that the CNI extension read in
+ * place matches the one read by libgse. It returns a non-zero status on
+ * failure.
+ */
+
+#include "Gse.h"
+
+#include <NetPacket.h>
+
+#include <opensand_output/Output.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+
+#define ERROR(format, ...) \
+	do { \
+		fprintf(stderr, format, ##__VA_ARGS__); \
+	} while(0)
+
+
+constexpr std::size_t GSE_FIXED_HEADER_LENGTH = 4;
+constexpr std::size_t GSE_MAX_TOTAL_LENGTH = 0x0FFF + 2;
+constexpr std::size_t MAX_EXT_LENGTH = 6;
+
+
+/**
+ * @brief The packet handler with its extension paths exposed
+ */
+class TestPacketHandler: public Gse::PacketHandler
+{
+ public:
+	TestPacketHandler(EncapPlugin &plugin):
+		Gse::PacketHandler(plugin)
+	{
+	}
+
+	using Gse::PacketHandler::addHeaderExtension;
+	using Gse::PacketHandler::addLibgseHeaderExtension;
+	using Gse::PacketHandler::getCompletePacketExtOffset;
+};
+
+
+/// The extension built by the test callback
+struct TestExtension
+{
+	std::size_t length;
+	unsigned char fill;
+};
+
+/// Build an extension of the requested length, followed by the protocol type
+static int buildTestExtension(unsigned char *ext,
+                              size_t *length,
+                              uint16_t *protocol_type,
+                              uint16_t extension_type,
+                              void *opaque)
+{
+	const TestExtension *test_ext = static_cast<const TestExtension *>(opaque);
+	std::size_t data_length = test_ext->length - sizeof(uint16_t);
+
+	memset(ext, test_ext->fill, data_length);
+	ext[data_length] = (extension_type >> 8) & 0xFF;
+	ext[data_length + 1] = extension_type & 0xFF;
+	*length = test_ext->length;
+	// H-LEN counts the extension in 2-byte words
+	*protocol_type = ((test_ext->length / 2) << 8) |
+	                 to_underlying(NET_PROTO::GSE_EXTENSION_CNI);
+	return 0;
+}
+
+/// Read the CNI of an extension as the plugin callback does
+static int readTestCni(unsigned char *ext,
+                       size_t *UNUSED(length),
+                       uint16_t *UNUSED(protocol_type),
+                       uint16_t UNUSED(extension_type),
+                       void *opaque)
+{
+	memcpy(opaque, ext, sizeof(uint32_t));
+	return 0;
+}
+
+
+/// Build a complete GSE packet without extension
+static std::unique_ptr<NetPacket> buildPacket(uint8_t label_type,
+                                              uint16_t protocol_type,
+                                              std::size_t pdu_length)
+{
+	std::size_t label_length = (label_type == 0) ? 6 : (label_type == 1 ? 3 : 0);
+	std::size_t gse_length = 2 + label_length + pdu_length;
+	std::vector<unsigned char> packet;
+
+	packet.push_back(0xC0 | (label_type << 4) | ((gse_length >> 8) & 0x0F));
+	packet.push_back(gse_length & 0xFF);
+	packet.push_back(protocol_type >> 8);
+	packet.push_back(protocol_type & 0xFF);
+	for(std::size_t i = 0; i < label_length; i++)
+	{
+		packet.push_back(0x10 + i);
+	}
+	for(std::size_t i = 0; i < pdu_length; i++)
+	{
+		packet.push_back(i & 0xFF);
+	}
+	return std::unique_ptr<NetPacket>(new NetPacket(packet.data(), packet.size()));
+}
+
+
+/// Both paths give the same packet for every combination
+static bool testEquivalence(TestPacketHandler &handler)
+{
+	const uint8_t label_types[] = {0, 1, 2};
+	const uint16_t protocol_types[] = {
+		to_underlying(NET_PROTO::IPV4),
+		to_underlying(NET_PROTO::IPV6),
+		to_underlying(NET_PROTO::ETH),
+	};
+	const std::size_t ext_lengths[] = {2, 4, 6};
+	unsigned int count = 0;
+
+	for(uint8_t label_type : label_types)
+	{
+		std::size_t label_length = (label_type == 0) ? 6 : (label_type == 1 ? 3 : 0);
+		std::size_t max_pdu_length = GSE_MAX_TOTAL_LENGTH - MAX_EXT_LENGTH -
+		                             GSE_FIXED_HEADER_LENGTH - label_length;
+		const std::size_t pdu_lengths[] = {0, 1, 64, 1500, max_pdu_length};
+
+		for(uint16_t protocol_type : protocol_types)
+		{
+			for(std::size_t pdu_length : pdu_lengths)
+			{
+				for(std::size_t ext_length : ext_lengths)
+				{
+					TestExtension ext{ext_length, static_cast<unsigned char>(0xA0 + ext_length)};
+					std::unique_ptr<NetPacket> packet = buildPacket(label_type,
+					                                                protocol_type,
+					                                                pdu_length);
+					std::unique_ptr<NetPacket> in_place;
+					std::unique_ptr<NetPacket> libgse;
+					std::size_t ext_offset = 0;
+
+					if(!TestPacketHandler::getCompletePacketExtOffset(packet->getRawData(),
+					                                                 packet->getTotalLength(),
+					                                                 ext_offset))
+					{
+						ERROR("LT %u, PDU %zu: packet not seen as complete\n",
+						      label_type, pdu_length);
+						return false;
+					}
+					if(ext_offset != GSE_FIXED_HEADER_LENGTH + label_length)
+					{
+						ERROR("LT %u: extension offset %zu instead of %zu\n",
+						      label_type, ext_offset, GSE_FIXED_HEADER_LENGTH + label_length);
+						return false;
+					}
+
+					if(!handler.addHeaderExtension(packet, in_place, ext_offset,
+					                               buildTestExtension, &ext))
+					{
+						ERROR("LT %u, PDU %zu, ext %zu: in place extension failed\n",
+						      label_type, pdu_length, ext_length);
+						return false;
+					}
+					if(!handler.addLibgseHeaderExtension(packet, libgse,
+					                                     buildTestExtension, &ext))
+					{
+						ERROR("LT %u, PDU %zu, ext %zu: libgse extension failed\n",
+						      label_type, pdu_length, ext_length);
+						return false;
+					}
+
+					if(in_place->getTotalLength() != libgse->getTotalLength())
+					{
+						ERROR("LT %u, protocol 0x%04x, PDU %zu, ext %zu: "
+						      "%zu bytes in place, %zu bytes with libgse\n",
+						      label_type, protocol_type, pdu_length, ext_length,
+						      in_place->getTotalLength(), libgse->getTotalLength());
+						return false;
+					}
+					if(memcmp(in_place->getRawData(), libgse->getRawData(),
+					          libgse->getTotalLength()) != 0)
+					{
+						ERROR("LT %u, protocol 0x%04x, PDU %zu, ext %zu: "
+						      "packets differ\n",
+						      label_type, protocol_type, pdu_length, ext_length);
+						return false;
+					}
+					count++;
+				}
+			}
+		}
+	}
+
+	printf("%u combinations of header extensions are identical\n", count);
+	return true;
+}
+
+/// The CNI extension added by the plugin is read alike in place and by libgse
+static bool testCniExtension(TestPacketHandler &handler)
+{
+	const uint32_t cnis[] = {0, 0x12345678, 0xFFFFFFFF};
+
+	for(uint32_t cni : cnis)
+	{
+		std::unique_ptr<NetPacket> packet;
+		uint32_t in_place_cni = ~cni;
+		uint32_t libgse_cni = ~cni;
+
+		// the empty packet built by the plugin
+		if(!handler.setHeaderExtensions(nullptr, packet, 1, 2,
+		                                "encodeCniExt", &cni))
+		{
+			ERROR("cannot add the CNI extension\n");
+			return false;
+		}
+
+		if(!handler.getHeaderExtensions(packet, "deencodeCniExt", &in_place_cni))
+		{
+			ERROR("cannot read the CNI extension in place\n");
+			return false;
+		}
+		if(gse_deencap_get_header_ext(packet->getRawData(), readTestCni,
+		                              &libgse_cni) != GSE_STATUS_OK)
+		{
+			ERROR("cannot read the CNI extension with libgse\n");
+			return false;
+		}
+		if(in_place_cni != cni || libgse_cni != cni)
+		{
+			ERROR("CNI 0x%08x read as 0x%08x in place and 0x%08x by libgse\n",
+			      cni, in_place_cni, libgse_cni);
+			return false;
+		}
+	}
+	return true;
+}
+
+
+int main()
+{
+	Gse plugin;
+	TestPacketHandler handler(plugin);
+
+	if(!handler.init())
+	{
+		fprintf(stderr, "FAIL: cannot initialize the GSE packet handler\n");
+		return EXIT_FAILURE;
+	}
+	Output::Get()->finalizeConfiguration();
+
+	if(!testEquivalence(handler) ||
+	   !testCniExtension(handler))
+	{
+		return EXIT_FAILURE;
+	}
+
+	printf("PASS\n");
+	return EXIT_SUCCESS;
+}
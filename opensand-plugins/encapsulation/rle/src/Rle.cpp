@@ -50,6 +50,7 @@ const std::string ALPDU_PROTECTION_SEQ_NUM{"Sequence Number"};
 constexpr std::size_t LABEL_SIZE = 3;        // bytes
 constexpr std::size_t SDU_MAX_SIZE = 4096;   // bytes
 constexpr std::size_t ALPDU_HEADER_SIZE = 3; // bytes
+constexpr std::size_t LABEL_TAL_ID_COUNT = 32; // terminal IDs are 5 bits in labels
 
 
 void rle_log(const int module_id,
@@ -226,20 +227,22 @@ unload:
 }
 
 Rle::Context::Context(EncapPlugin &plugin):
-	EncapPlugin::EncapContext(plugin)
+	EncapPlugin::EncapContext(plugin),
+	receivers(LABEL_TAL_ID_COUNT * LABEL_TAL_ID_COUNT, nullptr),
+	sdus(),
+	sdus_buffer()
 {
 }
 
 Rle::Context::~Context()
 {
-	std::map<RleIdentifier *, struct rle_receiver *, ltRleIdentifier>::iterator recei_it;
-
 	// Clean decapsulation
-	for(recei_it = this->receivers.begin();
-		recei_it != this->receivers.end(); ++recei_it)
+	for(auto &&receiver : this->receivers)
 	{
-		delete recei_it->first;
-		rle_receiver_destroy(&(recei_it->second));
+		if(receiver != nullptr)
+		{
+			rle_receiver_destroy(&receiver);
+		}
 	}
 	this->receivers.clear();
 }
@@ -259,7 +262,7 @@ bool Rle::Context::init()
 }
 
 NetBurst *Rle::Context::encapsulate(NetBurst *burst,
-                                    std::map<long, int> &UNUSED(time_encap_contexts))
+                                    std::map<int, long> &UNUSED(time_encap_contexts))
 {
 	NetBurst *encap_burst;
 
@@ -282,8 +285,8 @@ NetBurst *Rle::Context::encapsulate(NetBurst *burst,
 	{
 		try
 		{
-			// Create a new packet (already encapsulated)
-			std::unique_ptr<NetPacket> encap_packet{new NetPacket(packet->getData(),
+			// Create a new packet (already encapsulated) from the original buffer
+			std::unique_ptr<NetPacket> encap_packet{new NetPacket(packet->getRawData(),
 			                                                      packet->getTotalLength(),
 			                                                      this->getName(),
 			                                                      this->getEtherType(),
@@ -367,13 +370,10 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 	uint8_t src_tal_id, dst_tal_id, qos;
 	uint8_t label[LABEL_SIZE];
 	unsigned char label_str[LABEL_SIZE];
-	RleIdentifier *identifier = NULL;
-	std::map<RleIdentifier *, struct rle_receiver *, ltRleIdentifier>::iterator it;
+	unsigned char *payload;
 
 	struct rle_receiver *receiver;
-	struct rle_sdu *sdus = NULL;
 	size_t sdus_count = 0;
-	size_t sdus_capacity = 0;
 	size_t sdus_max_count = 0;
 	enum rle_decap_status status;
 
@@ -387,14 +387,15 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 		LOG(this->log, LEVEL_ERROR,
 		    "Not enough payload in %s packet\n",
 		    this->getName().c_str());
-		goto error;
+		return false;
 	}
-	if(!Rle::getLabel(packet->getPayload(), label))
+	payload = packet->getRawData() + packet->getHeaderLength();
+	if(!Rle::getLabel(payload, label))
 	{
 		LOG(this->log, LEVEL_ERROR,
 		    "Unable to get label from %s packet\n",
 		    this->getName().c_str());
-		goto error;
+		return false;
 	}
 	src_tal_id = label[0];
 	dst_tal_id = label[1];
@@ -403,54 +404,52 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 	    "RLE packet from tal %u to tal %u with qos %u",
 	    src_tal_id, dst_tal_id, qos);
 
-	// Get receiver
-	identifier = new RleIdentifier(src_tal_id, dst_tal_id);
-	it = this->receivers.find(identifier);
-	if(it == this->receivers.end())
+	// Get receiver, labels ensure the terminal IDs fit in the table
+	struct rle_receiver *&slot = this->receivers[src_tal_id * LABEL_TAL_ID_COUNT + dst_tal_id];
+	if(slot == nullptr)
 	{
 		LOG(this->log, LEVEL_DEBUG, "Packet requiring a new RLE receiver");
 
 		// Create receiver
-		receiver = rle_receiver_new(&this->rle_conf);
-		if(!receiver)
+		slot = rle_receiver_new(&this->rle_conf);
+		if(!slot)
 		{
-			delete identifier;
 			LOG(this->log, LEVEL_ERROR,
 			    "cannot create a RLE receiver\n");
-			goto error;
+			return false;
 		}
-
-		// Store receiver
-		this->receivers[identifier] = receiver;
 		LOG(this->log, LEVEL_DEBUG, "RLE receiver created");
 	}
 	else
 	{
 		LOG(this->log, LEVEL_DEBUG, "Packet requiring an existing RLE receiver");
-		// Get existing identifier and context
-		delete identifier;
-		identifier = it->first;
-		receiver = it->second;
 	}
+	receiver = slot;
 
-	// Prepare SDUs structures
+	// Prepare SDUs structures, the buffers are kept between packets
+	// and only grow with the largest FPDU received
 	sdus_max_count = packet->getPayloadLength() / LABEL_SIZE;
-	sdus_capacity = SDU_MAX_SIZE;
-	sdus_count = 0;
-	sdus = new struct rle_sdu[sdus_max_count];
+	if(this->sdus.size() < sdus_max_count)
+	{
+		this->sdus.resize(sdus_max_count);
+		this->sdus_buffer.reset(new unsigned char[sdus_max_count * SDU_MAX_SIZE]);
+		for(unsigned int i = 0; i < sdus_max_count; ++i)
+		{
+			this->sdus[i].buffer = this->sdus_buffer.get() + i * SDU_MAX_SIZE;
+		}
+	}
 	for(unsigned int i = 0; i < sdus_max_count; ++i)
 	{
-		sdus[i].size = 0;
-		sdus[i].buffer = new unsigned char[sdus_capacity];
+		this->sdus[i].size = 0;
 	}
 	LOG(this->log, LEVEL_DEBUG, "Initialize SDUs before RLE decapsulation (max_count=%u, count=%u)",
 			sdus_max_count, sdus_count);
 
 	// Decapsulate RLE FPDU
 	status = rle_decapsulate(receiver,
-	                         const_cast<unsigned char *>(packet->getPayload().c_str()),
+	                         payload,
 	                         packet->getPayloadLength(),
-	                         sdus,
+	                         this->sdus.data(),
 	                         sdus_max_count,
 	                         &sdus_count,
 	                         label_str,
@@ -459,7 +458,7 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 	{
 		LOG(this->log, LEVEL_ERROR,
 		    "RLE failed to decaspulate SDU\n");
-		goto error;
+		return false;
 	}
 	LOG(this->log, LEVEL_DEBUG,
 	    "Decapsulated SDUs (max_count=%u, count=%u)",
@@ -468,7 +467,7 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 	// Add all SDUs to decapsulated packets list
 	for(unsigned int i = 0; i< sdus_count; ++i)
 	{
-		struct rle_sdu sdu = sdus[i];
+		const struct rle_sdu &sdu = this->sdus[i];
 		std::unique_ptr<NetPacket> decap_packet;
 
 		LOG(this->log, LEVEL_DEBUG,
@@ -479,49 +478,27 @@ bool Rle::Context::decapNextPacket(const std::unique_ptr<NetPacket>& packet, Net
 		{
 			LOG(this->log, LEVEL_ERROR,
 			    "Empty RLE decapsulated packet\n");
-			goto error;
+			return false;
 		}
 
-		// Create packet from SDU
+		// Create packet from SDU, copied once from the pooled buffer
 		try
 		{
-			decap_packet = this->current_upper->build(Data(sdu.buffer, sdu.size), sdu.size,
+			decap_packet = this->current_upper->build(sdu.buffer, sdu.size,
 			                                          qos, src_tal_id, dst_tal_id);
 		}
 		catch (const std::bad_alloc&)
 		{
 			LOG(this->log, LEVEL_ERROR,
 			    "RLE failed to create decapsulated packet\n");
-			goto error;
+			return false;
 		}
 
 		// Add SDU to decapsulated packets list
 		burst->add(std::move(decap_packet));
-		delete[] sdus[i].buffer;
-		sdus[i].buffer = NULL;
-		sdus[i].size = 0;
-	}
-	for(unsigned int i = sdus_count; i < sdus_max_count; ++i)
-	{
-		delete[] sdus[i].buffer;
 	}
-	delete[] sdus;
 
 	return true;
-	
-error:
-	if(sdus)
-	{
-		for(unsigned int i = 0; i< sdus_count; ++i)
-		{
-			if(sdus[i].buffer != NULL)
-			{
-				delete[] sdus[i].buffer;
-			}
-		}
-		delete[] sdus;
-	}
-	return false;
 }
 
 Rle::PacketHandler::PacketHandler(EncapPlugin &plugin):
@@ -987,9 +964,18 @@ bool Rle::getLabel(NetPacket *packet, uint8_t label[])
 
 bool Rle::getLabel(const Data &data, uint8_t label[])
 {
-	uint8_t src_tal_id = (uint8_t)(data.at(0));
-	uint8_t dst_tal_id = (uint8_t)(data.at(1));
-	uint8_t qos = (uint8_t)(data.at(2));
+	if(data.length() < LABEL_SIZE)
+	{
+		return false;
+	}
+	return Rle::getLabel(data.data(), label);
+}
+
+bool Rle::getLabel(const unsigned char *data, uint8_t label[])
+{
+	uint8_t src_tal_id = (uint8_t)(data[0]);
+	uint8_t dst_tal_id = (uint8_t)(data[1]);
+	uint8_t qos = (uint8_t)(data[2]);
 
 	//DFLTLOG(LEVEL_ERROR, "Src_tal_id = %u (& 0x1F = %u)",
 	//	src_tal_id, src_tal_id & 0x1F);
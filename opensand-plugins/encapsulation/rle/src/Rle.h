@@ -41,6 +41,7 @@
 #include <EncapPlugin.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -84,7 +85,7 @@ class Rle: public EncapPlugin
 		void loadRleConf(const struct rle_config &conf);
 		bool init();
 
-		NetBurst *encapsulate(NetBurst *burst, std::map<long, int> &time_contexts);
+		NetBurst *encapsulate(NetBurst *burst, std::map<int, long> &time_contexts);
 		NetBurst *deencapsulate(NetBurst *burst);
 		NetBurst *flush(int context_id);
 		NetBurst *flushAll();
@@ -93,8 +94,14 @@ class Rle: public EncapPlugin
 		/// RLE configuration
 		struct rle_config rle_conf;
 
-		/// Receivers identified by an unique identifier
-		std::map<RleIdentifier *, struct rle_receiver *, ltRleIdentifier> receivers;
+		/// Receivers indexed by source then destination terminal ID
+		std::vector<struct rle_receiver *> receivers;
+
+		/// SDUs reused for each decapsulated FPDU
+		std::vector<struct rle_sdu> sdus;
+
+		/// The buffers of the reused SDUs
+		std::unique_ptr<unsigned char[]> sdus_buffer;
 
 		bool decapNextPacket(const std::unique_ptr<NetPacket>& packet, NetBurst *burst);
 	};
@@ -120,6 +127,7 @@ class Rle: public EncapPlugin
 		void loadRleConf(const struct rle_config &conf);
 		bool init();
 
+		using EncapPacketHandler::build;
 		std::unique_ptr<NetPacket> build(const Data &data,
 		                                 size_t data_length,
 		                                 uint8_t qos,
@@ -136,6 +144,8 @@ class Rle: public EncapPlugin
 		                     bool new_burst,
 		                     std::unique_ptr<NetPacket> &encap_packet,
 		                     std::unique_ptr<NetPacket> &remaining_data) override;
+		// the transmitter contexts are shared between destinations
+		bool isEncapReentrant() const override {return false;};
 
 		bool getEncapsulatedPackets(std::unique_ptr<NetContainer> packet,
 		                            bool &partial_decap,
@@ -177,6 +187,7 @@ class Rle: public EncapPlugin
 
 	static bool getLabel(NetPacket *packet, uint8_t label[]);
 	static bool getLabel(const Data &data, uint8_t label[]);
+	static bool getLabel(const unsigned char *data, uint8_t label[]);
 };
 
 
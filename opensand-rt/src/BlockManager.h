@@ -160,6 +160,18 @@ class BlockManager
 	template <class SenderCh, class ReceiverCh>
 	void connectChannels(SenderCh &sender, ReceiverCh &receiver, typename SenderCh::DemuxKey key);
 
+	/**
+	 * @brief Connects a channel to the fifo another channel already uses
+	 *        for a key, the receiver then gets the messages of both
+	 *
+	 * @param sender     The channel that will also send data into the fifo
+	 * @param connected  The channel already connected to the receiver
+	 * @param key        The key under which the receiver is known from
+	 *                   both senders
+	 */
+	template <class SenderCh>
+	void shareChannel(SenderCh &sender, const SenderCh &connected, typename SenderCh::DemuxKey key);
+
 	/**
 	 * @brief stops the application
 	 *        Force kill if a thread don't stop
@@ -420,4 +432,19 @@ void BlockManager::connectChannels(SenderCh &sender,
 }
 
 
+template <class SenderCh>
+void BlockManager::shareChannel(SenderCh &sender,
+                                const SenderCh &connected,
+                                typename SenderCh::DemuxKey key)
+{
+	auto fifo = connected.getNextFifo(key);
+	if (fifo == nullptr)
+	{
+		this->reportError("Cannot share FIFO: no FIFO found for this key", false);
+		return;
+	}
+	sender.addNextFifo(key, fifo);
+}
+
+
 #endif
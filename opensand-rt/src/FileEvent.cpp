@@ -68,8 +68,9 @@ bool FileEvent::handle(void)
 		                this->name.c_str());
 		delete [] this->data;
 	}
-	// one more byte so we can use it as char*
-	this->data = new unsigned char[this->max_size + 1]();  // parens do value initialization to 0
+	// one more byte so we can use it as char*, only this byte is
+	// initialized as the remaining of the buffer is overwritten by read
+	this->data = new unsigned char[this->max_size + 1];
 
 	int ret = read(this->fd, this->data, this->max_size);
 	std::size_t actual_size = static_cast<std::size_t>(ret);
@@ -93,6 +94,10 @@ bool FileEvent::handle(void)
 		delete [] this->data;
 		this->data = nullptr;
 	}
+	else
+	{
+		this->data[actual_size] = '\0';
+	}
 	this->size = actual_size;
 
 	return true;
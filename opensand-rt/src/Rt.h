@@ -150,6 +150,18 @@ class Rt
 	template <class SenderCh, class ReceiverCh>
 	static void connectChannels(SenderCh &sender, ReceiverCh &receiver, typename SenderCh::DemuxKey key);
 
+	/**
+	 * @brief Connects a channel to the fifo another channel already uses
+	 *        for a key, the receiver then gets the messages of both
+	 *
+	 * @param sender     The channel that will also send data into the fifo
+	 * @param connected  The channel already connected to the receiver
+	 * @param key        The key under which the receiver is known from
+	 *                   both senders
+	 */
+	template <class SenderCh>
+	static void shareChannel(SenderCh &sender, const SenderCh &connected, typename SenderCh::DemuxKey key);
+
 	/**
 	 * @brief Initialize the blocks
 	 *
@@ -254,4 +266,11 @@ void Rt::connectChannels(SenderCh &sender, ReceiverCh &receiver, typename Sender
 }
 
 
+template <class SenderCh>
+void Rt::shareChannel(SenderCh &sender, const SenderCh &connected, typename SenderCh::DemuxKey key)
+{
+	Rt::manager.shareChannel(sender, connected, key);
+}
+
+
 #endif
@@ -88,6 +88,14 @@ class RtChannelDemux: public RtChannelBase
 	 */
 	void addNextFifo(Key key, std::shared_ptr<RtFifo> &fifo);
 
+	/**
+	 * @brief Get the fifo of the next channel mapped to key
+	 *
+	 * @param key  The key mapped to the fifo
+	 * @return the fifo, nullptr if no fifo is mapped to key
+	 */
+	std::shared_ptr<RtFifo> getNextFifo(Key key) const;
+
  protected:
 	bool initPreviousFifo() override;
 
@@ -140,6 +148,18 @@ void RtChannelDemux<Key>::addNextFifo(Key key, std::shared_ptr<RtFifo> &fifo)
 };
 
 
+template <typename Key>
+std::shared_ptr<RtFifo> RtChannelDemux<Key>::getNextFifo(Key key) const
+{
+	auto fifo_it = this->next_fifos.find(key);
+	if (fifo_it == this->next_fifos.end())
+	{
+		return nullptr;
+	}
+	return fifo_it->second;
+}
+
+
 template <typename Key>
 void RtChannelDemux<Key>::setPreviousFifo(std::shared_ptr<RtFifo> &fifo)
 {